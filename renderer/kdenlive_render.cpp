@@ -8,6 +8,8 @@
 #include "kdenlive_renderer_debug.h"
 #include "mlt++/Mlt.h"
 #include "renderjob.h"
+#include "renderqueue.h"
+#include "segmentrenderjob.h"
 
 #include <../config-kdenlive.h>
 #include <QApplication>
@@ -17,6 +19,7 @@
 #include <QDomDocument>
 #include <QImageReader>
 #include <QTemporaryFile>
+#include <QThread>
 #include <QtGlobal>
 
 QString getCIMltRepositoryPath()
@@ -60,7 +63,7 @@ int main(int argc, char **argv)
     parser.addHelpOption();
     parser.addVersionOption();
 
-    parser.addPositionalArgument("mode", "Render mode. Either \"delivery\" or \"preview-chunks\".");
+    parser.addPositionalArgument("mode", "Render mode. Either \"delivery\", \"segments\", \"queue\" or \"preview-chunks\".");
     parser.parse(QCoreApplication::arguments());
     QStringList args = parser.positionalArguments();
     const QString mode = args.isEmpty() ? QString() : args.first();
@@ -71,7 +74,7 @@ int main(int argc, char **argv)
         parser.addPositionalArgument("preview-chunks", "Mode: Render split into multiple files for timeline preview.");
         parser.addPositionalArgument("source", "Source file (usually MLT XML).");
         parser.addPositionalArgument("destination", "Destination directory.");
-        parser.addPositionalArgument("chunks", "Chunks to render.");
+        parser.addPositionalArgument("chunks", "Chunks to render, or \"-\" to read them one per line on standard input.");
         parser.addPositionalArgument("chunk_size", "Size of chunks to render.");
         parser.addPositionalArgument("profile_path", "Path to profile.");
         parser.addPositionalArgument("file_extension", "Rendered file extension.");
@@ -106,7 +109,8 @@ int main(int argc, char **argv)
         // destination - where to save result
         QDir baseFolder(args.takeFirst());
         // chunks to render
-        QStringList chunks = args.takeFirst().split(QLatin1Char(','), Qt::SkipEmptyParts);
+        const QString chunksArg = args.takeFirst();
+        QStringList chunks = chunksArg.split(QLatin1Char(','), Qt::SkipEmptyParts);
         // chunk size in frames
         int chunkSize = args.takeFirst().toInt();
         // path to profile
@@ -125,6 +129,54 @@ int main(int argc, char **argv)
         const char *localename = prod.get_lcnumeric();
         QLocale::setDefault(QLocale(localename));
 
+        auto renderChunk = [&](int frame) {
+            fprintf(stderr, "START:%d \n", frame);
+            QString fileName = QStringLiteral("%1.%2").arg(frame).arg(extension);
+            if (baseFolder.exists(fileName)) {
+                // Don't overwrite an existing file
+                fprintf(stderr, "DONE:%d \n", frame);
+                return true;
+            }
+            QScopedPointer<Mlt::Producer> playlst(prod.cut(frame, frame + chunkSize));
+            QScopedPointer<Mlt::Consumer> cons(
+                new Mlt::Consumer(profile, QStringLiteral("avformat:%1").arg(baseFolder.absoluteFilePath(fileName)).toUtf8().constData()));
+            for (const QString &param : std::as_const(consumerParams)) {
+                if (param.contains(QLatin1Char('='))) {
+                    cons->set(param.section(QLatin1Char('='), 0, 0).toUtf8().constData(), param.section(QLatin1Char('='), 1).toUtf8().constData());
+                }
+            }
+            if (!cons->is_valid()) {
+                fprintf(stderr, " = =  = INVALID CONSUMER\n\n");
+                return false;
+            }
+            cons->set("terminate_on_pause", 1);
+            cons->connect(*playlst);
+            playlst.reset();
+            cons->run();
+            cons->stop();
+            cons->purge();
+            fprintf(stderr, "DONE:%d \n", frame);
+            return true;
+        };
+
+        if (chunksArg == QLatin1String("-")) {
+            // Kdenlive shares the chunks between several renderers and sends us the next one when we are done,
+            // an empty line or the end of the input means that there is nothing left to render
+            char line[32];
+            while (fgets(line, sizeof(line), stdin) != nullptr) {
+                bool ok = false;
+                const int frame = QByteArray(line).trimmed().toInt(&ok);
+                if (!ok) {
+                    break;
+                }
+                if (!renderChunk(frame)) {
+                    return 1;
+                }
+            }
+            fprintf(stderr, "+ + + RENDERING FINISHED + + + \n");
+            return 0;
+        }
+
         int currentFrame = 0;
         int rangeStart = 0;
         int rangeEnd = 0;
@@ -154,32 +206,9 @@ int main(int argc, char **argv)
                 // Frame will be processed, remove from stack
                 chunks.removeFirst();
             }
-            fprintf(stderr, "START:%d \n", frame.toInt());
-            QString fileName = QStringLiteral("%1.%2").arg(frame, extension);
-            if (baseFolder.exists(fileName)) {
-                // Don't overwrite an existing file
-                fprintf(stderr, "DONE:%d \n", frame.toInt());
-                continue;
-            }
-            QScopedPointer<Mlt::Producer> playlst(prod.cut(frame.toInt(), frame.toInt() + chunkSize));
-            QScopedPointer<Mlt::Consumer> cons(
-                new Mlt::Consumer(profile, QStringLiteral("avformat:%1").arg(baseFolder.absoluteFilePath(fileName)).toUtf8().constData()));
-            for (const QString &param : std::as_const(consumerParams)) {
-                if (param.contains(QLatin1Char('='))) {
-                    cons->set(param.section(QLatin1Char('='), 0, 0).toUtf8().constData(), param.section(QLatin1Char('='), 1).toUtf8().constData());
-                }
-            }
-            if (!cons->is_valid()) {
-                fprintf(stderr, " = =  = INVALID CONSUMER\n\n");
+            if (!renderChunk(frame.toInt())) {
                 return 1;
             }
-            cons->set("terminate_on_pause", 1);
-            cons->connect(*playlst);
-            playlst.reset();
-            cons->run();
-            cons->stop();
-            cons->purge();
-            fprintf(stderr, "DONE:%d \n", frame.toInt());
         }
         // Mlt::Factory::close();
         fprintf(stderr, "+ + + RENDERING FINISHED + + + \n");
@@ -291,6 +320,79 @@ int main(int argc, char **argv)
         return app.exec();
     }
 
+    if (mode == "segments") {
+        parser.clearPositionalArguments();
+        parser.addPositionalArgument("segments", "Mode: Render video segments in parallel and join them into a final output file.");
+        parser.addPositionalArgument("renderer", "Path to MLT melt renderer.");
+        parser.addPositionalArgument("audio", "Source file (usually MLT XML) rendering the audio of the whole range.");
+        parser.addPositionalArgument("parts", "Source files rendering the video segments, in order.", "part1 [part2 ...]");
+
+        QCommandLineOption outputOption({"o", "output"}, "The final destination file.", "file");
+        parser.addOption(outputOption);
+
+        QCommandLineOption pidOption("pid", "Process ID to send back progress.", "pid", QString::number(-1));
+        parser.addOption(pidOption);
+
+        QCommandLineOption debugOption("debug", "Enable debug mode, doesn't delete log file on render success.");
+        parser.addOption(debugOption);
+
+        parser.process(app);
+        args = parser.positionalArguments();
+        int pid = parser.value(pidOption).toInt();
+        const QString output = parser.value(outputOption);
+
+        if (args.count() < 4 || output.isEmpty()) {
+            qCritical() << "Error: wrong number of arguments specified\n";
+            RenderJob r(QStringLiteral("Error: wrong number of arguments specified\n"), pid, &app);
+            parser.showHelp(1);
+            // the command above will quit the app with return 1;
+        }
+
+        // mode
+        args.removeFirst();
+        // renderer path (melt)
+        QString render = args.takeFirst();
+        // Audio playlist path
+        QString audioPlaylist = args.takeFirst();
+
+        LocaleHandling::resetAllLocale();
+        auto *rJob = new SegmentRenderJob(render, audioPlaylist, args, output, pid, parser.isSet(debugOption), &app);
+        QObject::connect(rJob, &SegmentRenderJob::renderingFinished, rJob, [&]() {
+            rJob->deleteLater();
+            qApp->quit();
+        });
+        QMetaObject::invokeMethod(rJob, "start", Qt::QueuedConnection);
+        return app.exec();
+    }
+
+    if (mode == "queue") {
+        parser.clearPositionalArguments();
+        parser.addPositionalArgument("queue", "Mode: Render the jobs dropped in a spool folder until stopped.");
+        parser.addPositionalArgument("renderer", "Path to MLT melt renderer.");
+        parser.addPositionalArgument("spool", "Folder watched for render jobs (MLT XML files with render parameters, or json job descriptions).");
+
+        QCommandLineOption jobsOption({"j", "jobs"}, "Maximum number of jobs rendered at the same time.", "count",
+                                      QString::number(qMax(1, QThread::idealThreadCount() / 4)));
+        parser.addOption(jobsOption);
+
+        QCommandLineOption pidOption("pid", "Process ID of the Kdenlive instance to send back progress, any running instance if not set.", "pid",
+                                     QString::number(-1));
+        parser.addOption(pidOption);
+
+        parser.process(app);
+        args = parser.positionalArguments();
+        if (args.count() != 3) {
+            qCritical() << "Error: wrong number of arguments specified\n";
+            parser.showHelp(1);
+            // the command above will quit the app with return 1;
+        }
+
+        LocaleHandling::resetAllLocale();
+        RenderQueue queue(args.at(1), args.at(2), parser.value(jobsOption).toInt(), parser.value(pidOption).toInt());
+        QMetaObject::invokeMethod(&queue, "start", Qt::QueuedConnection);
+        return app.exec();
+    }
+
     qCritical() << "Error: unknown mode" << mode << "\n";
     parser.showHelp(1);
     // the command above will quit the app with return 1;
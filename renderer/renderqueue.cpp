@@ -0,0 +1,461 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "renderqueue.h"
+#include "kdenlive_renderer_debug.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QThread>
+#include <QUrl>
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+const QString runningFolder = QStringLiteral("running");
+const QString doneFolder = QStringLiteral("done");
+const QString failedFolder = QStringLiteral("failed");
+// Files modified more recently than this may still be being written
+constexpr qint64 settleDelay = 2000;
+
+#ifdef Q_OS_UNIX
+int signalSockets[2] = {-1, -1};
+
+void quitSignalHandler(int)
+{
+    // Only async-signal-safe calls here, the event loop is notified through the socket
+    char byte = 1;
+    (void)::write(signalSockets[0], &byte, sizeof(byte));
+}
+
+/** @brief Returns true if the process is running and its command line contains @param argument */
+bool processIsRunning(qint64 pid, const QString &argument)
+{
+    QFile cmdline(QStringLiteral("/proc/%1/cmdline").arg(pid));
+    if (pid <= 0 || !cmdline.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return QString::fromLocal8Bit(cmdline.readAll()).contains(QString::fromUtf8(QUrl::toPercentEncoding(argument)));
+}
+#endif
+} // namespace
+
+RenderQueue::RenderQueue(const QString &render, const QString &spoolFolder, int maxJobs, int pid, QObject *parent)
+    : QObject(parent)
+    , m_render(render)
+    , m_spool(spoolFolder)
+    , m_maxJobs(qMax(1, maxJobs))
+    , m_pid(pid)
+    , m_threads(qMax(1, QThread::idealThreadCount() / m_maxJobs))
+{
+    m_scanTimer.setInterval(5000);
+    connect(&m_scanTimer, &QTimer::timeout, this, &RenderQueue::schedule);
+    connect(&m_scanTimer, &QTimer::timeout, this, &RenderQueue::attach);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &RenderQueue::schedule);
+}
+
+RenderQueue::~RenderQueue()
+{
+    // Jobs still running are left in the running folder and will be rendered again on next start
+    for (auto &job : m_jobs) {
+        job->process->disconnect(this);
+        job->process->kill();
+        if (job->process->waitForFinished(1000)) {
+            QFile::remove(pidFile(job->name));
+        }
+        QFile::remove(job->playlist);
+    }
+}
+
+void RenderQueue::handleQuitSignals()
+{
+#ifdef Q_OS_UNIX
+    // Quit the event loop on termination, so that the renders are stopped by the destructor instead of being left orphaned
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, signalSockets) != 0) {
+        qCWarning(KDENLIVE_RENDERER_LOG) << "Cannot watch termination signals, renders will keep running if the queue is killed";
+        return;
+    }
+    auto *notifier = new QSocketNotifier(signalSockets[1], QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, []() {
+        char byte;
+        (void)::read(signalSockets[1], &byte, sizeof(byte));
+        qCInfo(KDENLIVE_RENDERER_LOG) << "Render queue stopping";
+        qApp->quit();
+    });
+    struct sigaction action = {};
+    action.sa_handler = quitSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    for (int quitSignal : {SIGTERM, SIGINT, SIGHUP}) {
+        sigaction(quitSignal, &action, nullptr);
+    }
+#endif
+}
+
+void RenderQueue::stopOrphanedRender(const QString &name)
+{
+    QFile file(pidFile(name));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const qint64 pid = file.readLine().trimmed().toLongLong();
+    const QString playlist = QString::fromUtf8(file.readLine().trimmed());
+    file.close();
+#ifdef Q_OS_UNIX
+    // The queue was killed without stopping its renders, the previous melt process may still be writing the target
+    if (processIsRunning(pid, playlist)) {
+        qCInfo(KDENLIVE_RENDERER_LOG) << "Stopping render of interrupted job" << name << "still running as process" << pid;
+        ::kill(pid_t(pid), SIGTERM);
+        QElapsedTimer timer;
+        timer.start();
+        while (processIsRunning(pid, playlist) && timer.elapsed() < 5000) {
+            QThread::msleep(100);
+        }
+        if (processIsRunning(pid, playlist)) {
+            ::kill(pid_t(pid), SIGKILL);
+        }
+    }
+#else
+    Q_UNUSED(pid);
+#endif
+    QFile::remove(playlist);
+    file.remove();
+}
+
+QString RenderQueue::pidFile(const QString &name) const
+{
+    return m_spool.absoluteFilePath(runningFolder + QLatin1Char('/') + name + QStringLiteral(".pid"));
+}
+
+void RenderQueue::start()
+{
+    if (!m_spool.exists() || !m_spool.mkpath(runningFolder) || !m_spool.mkpath(doneFolder) || !m_spool.mkpath(failedFolder)) {
+        qCCritical(KDENLIVE_RENDERER_LOG) << "Cannot use spool folder" << m_spool.absolutePath();
+        qApp->exit(1);
+        return;
+    }
+    // Jobs interrupted by a previous shutdown are queued again
+    QDir running(m_spool.absoluteFilePath(runningFolder));
+    const QStringList interrupted = running.entryList({QStringLiteral("*.json"), QStringLiteral("*.mlt")}, QDir::Files);
+    for (const QString &name : interrupted) {
+        stopOrphanedRender(name);
+        qCInfo(KDENLIVE_RENDERER_LOG) << "Restarting interrupted job" << name;
+        if (!QFile::rename(running.absoluteFilePath(name), m_spool.absoluteFilePath(name))) {
+            // A new job with the same name was submitted in the meantime
+            running.remove(name);
+        }
+    }
+    handleQuitSignals();
+    qCInfo(KDENLIVE_RENDERER_LOG) << "Render queue watching" << m_spool.absolutePath() << "with" << m_maxJobs << "concurrent jobs";
+    m_watcher.addPath(m_spool.absolutePath());
+    m_scanTimer.start();
+    schedule();
+}
+
+void RenderQueue::schedule()
+{
+    if (int(m_jobs.size()) >= m_maxJobs) {
+        return;
+    }
+    const QFileInfoList pending = m_spool.entryInfoList({QStringLiteral("*.json"), QStringLiteral("*.mlt")}, QDir::Files, QDir::Name);
+    const QDateTime settled = QDateTime::currentDateTime().addMSecs(-settleDelay);
+    for (const QFileInfo &info : pending) {
+        if (int(m_jobs.size()) >= m_maxJobs) {
+            break;
+        }
+        if (info.lastModified() > settled) {
+            // Wait until the file is completely written, the scan timer will pick it up
+            continue;
+        }
+        // Claim the job before processing it, so that it is not started twice
+        const QString jobFile = m_spool.absoluteFilePath(runningFolder + QLatin1Char('/') + info.fileName());
+        if (!QFile::rename(info.absoluteFilePath(), jobFile)) {
+            continue;
+        }
+        auto job = std::make_unique<Job>();
+        job->name = info.fileName();
+        if (!prepareJob(job.get(), jobFile)) {
+            qCWarning(KDENLIVE_RENDERER_LOG) << "Invalid render job" << job->name << job->errors;
+            archiveJob(job->name, failedFolder, job->errors);
+            continue;
+        }
+        m_jobs.push_back(std::move(job));
+        startJob(m_jobs.back().get());
+    }
+}
+
+bool RenderQueue::prepareJob(Job *job, const QString &jobFile)
+{
+    QString playlist = jobFile;
+    QJsonObject description;
+    if (jobFile.endsWith(QLatin1String(".json"))) {
+        QFile file(jobFile);
+        if (!file.open(QIODevice::ReadOnly)) {
+            job->errors = tr("Cannot read job file %1").arg(jobFile);
+            return false;
+        }
+        QJsonParseError error;
+        description = QJsonDocument::fromJson(file.readAll(), &error).object();
+        if (error.error != QJsonParseError::NoError || !description.contains(QLatin1String("playlist"))) {
+            job->errors = tr("Invalid job file %1: %2").arg(jobFile, error.errorString());
+            return false;
+        }
+        playlist = QDir::cleanPath(m_spool.absoluteFilePath(description.value(QLatin1String("playlist")).toString()));
+        if (QFileInfo(playlist).absolutePath() == m_spool.absolutePath()) {
+            // It would be picked up as a job of its own
+            job->errors = tr("Playlist %1 must not be in the spool folder, put it in a subfolder like media/").arg(playlist);
+            return false;
+        }
+    }
+    QFile file(playlist);
+    QDomDocument doc;
+    if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file)) {
+        job->errors = tr("Cannot read playlist %1").arg(playlist);
+        return false;
+    }
+    file.close();
+    QDomElement mlt = doc.documentElement();
+    QDomElement consumer = mlt.firstChildElement(QStringLiteral("consumer"));
+    if (consumer.isNull()) {
+        job->errors = tr("Playlist %1 has no render parameters").arg(playlist);
+        return false;
+    }
+    if (!mlt.hasAttribute(QStringLiteral("root"))) {
+        // The playlist is rendered from a copy, keep its relative paths working
+        mlt.setAttribute(QStringLiteral("root"), QFileInfo(playlist).absolutePath());
+    }
+    const QStringList params = description.value(QLatin1String("params")).toString().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    for (const QString &param : params) {
+        if (param.contains(QLatin1Char('='))) {
+            consumer.setAttribute(param.section(QLatin1Char('='), 0, 0), param.section(QLatin1Char('='), 1));
+        }
+    }
+    if (description.contains(QLatin1String("in"))) {
+        consumer.setAttribute(QStringLiteral("in"), description.value(QLatin1String("in")).toInt());
+    }
+    if (description.contains(QLatin1String("out"))) {
+        consumer.setAttribute(QStringLiteral("out"), description.value(QLatin1String("out")).toInt());
+    }
+    if (description.contains(QLatin1String("output"))) {
+        consumer.setAttribute(QStringLiteral("target"), QDir::cleanPath(m_spool.absoluteFilePath(description.value(QLatin1String("output")).toString())));
+    }
+    if (!consumer.hasAttribute(QStringLiteral("threads"))) {
+        consumer.setAttribute(QStringLiteral("threads"), m_threads);
+    }
+    job->target = consumer.attribute(QStringLiteral("target"));
+    if (job->target.isEmpty()) {
+        job->errors = tr("No output file for job %1").arg(job->name);
+        return false;
+    }
+
+    QTemporaryFile tmp(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.mlt")));
+    tmp.setAutoRemove(false);
+    if (!tmp.open()) {
+        job->errors = tr("Cannot create temporary file");
+        return false;
+    }
+    QTextStream stream(&tmp);
+    stream << doc.toString();
+    stream.flush();
+    job->playlist = tmp.fileName();
+    return true;
+}
+
+void RenderQueue::startJob(Job *job)
+{
+    job->socket = new QLocalSocket(this);
+    connect(job->socket, &QLocalSocket::connected, this, [this, job]() {
+        QJsonObject obj;
+        obj["url"] = job->target;
+        job->socket->write(QJsonDocument(obj).toJson());
+        job->socket->flush();
+        sendProgress(job);
+    });
+    connect(job->socket, &QLocalSocket::readyRead, this, [this, job]() {
+        if (job->socket->readAll() == "abort") {
+            abortJob(job);
+        }
+    });
+
+    job->process = new QProcess(this);
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    // Disable VDPAU so that rendering will work even if there is a Kdenlive instance using VDPAU
+    env.insert(QStringLiteral("MLT_NO_VDPAU"), QStringLiteral("1"));
+    job->process->setProcessEnvironment(env);
+    job->process->setProgram(m_render);
+    job->process->setArguments(
+        {QStringLiteral("-loglevel"), QStringLiteral("error"), QStringLiteral("-progress2"), QString::fromUtf8(QUrl::toPercentEncoding(job->playlist))});
+    job->process->setReadChannel(QProcess::StandardError);
+    connect(job->process, &QProcess::readyReadStandardError, this, [this, job]() { receivedStderr(job); });
+    connect(job->process, &QProcess::finished, this, [this, job](int exitCode, QProcess::ExitStatus status) { jobFinished(job, exitCode, status); });
+    connect(job->process, &QProcess::started, this, [this, job]() {
+        // Allows a restarted queue to stop this render if the queue is killed
+        QFile file(pidFile(job->name));
+        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QTextStream stream(&file);
+            stream << job->process->processId() << "\n" << job->playlist << "\n";
+        }
+    });
+    qCInfo(KDENLIVE_RENDERER_LOG) << "Starting job" << job->name << "rendering" << job->target;
+    job->process->start();
+    attach();
+}
+
+void RenderQueue::receivedStderr(Job *job)
+{
+    QString result = QString::fromLocal8Bit(job->process->readAllStandardError());
+    if (!result.contains(QLatin1Char('\n'))) {
+        job->outputData.append(result);
+        return;
+    }
+    result.prepend(job->outputData);
+    job->outputData.clear();
+    result = result.simplified();
+    if (!result.startsWith(QLatin1String("Current Frame"))) {
+        job->errors.append(result + QLatin1Char('\n'));
+        return;
+    }
+    bool ok;
+    int progress = result.section(QLatin1Char(' '), -1).toInt(&ok);
+    if (!ok || progress <= job->progress || progress > 100) {
+        return;
+    }
+    int frame = result.section(QLatin1Char(','), 0, 0).section(QLatin1Char(' '), -1).toInt(&ok);
+    if (!ok) {
+        return;
+    }
+    job->progress = progress;
+    job->frame = frame;
+    sendProgress(job);
+}
+
+void RenderQueue::jobFinished(Job *job, int exitCode, QProcess::ExitStatus status)
+{
+    QFile::remove(job->playlist);
+    if (job->aborted) {
+        QFile::remove(job->target);
+        sendFinish(job, -3, QString());
+        archiveJob(job->name, failedFolder, tr("Job aborted by user"));
+    } else if (status == QProcess::CrashExit || exitCode != 0 || !QFile::exists(job->target)) {
+        QString error = tr("Rendering of %1 aborted, resulting video will probably be corrupted.").arg(job->target);
+        if (job->frame > 0) {
+            error += QLatin1Char('\n') + tr("Frame: %1").arg(job->frame);
+        }
+        job->errors.append(error);
+        qCWarning(KDENLIVE_RENDERER_LOG) << "Job" << job->name << "failed:" << job->errors;
+        sendFinish(job, -2, job->errors);
+        archiveJob(job->name, failedFolder, job->errors);
+    } else {
+        qCInfo(KDENLIVE_RENDERER_LOG) << "Job" << job->name << "finished";
+        sendFinish(job, -1, QString());
+        archiveJob(job->name, doneFolder, job->errors);
+    }
+    job->process->disconnect(this);
+    job->process->deleteLater();
+    job->socket->disconnect(this);
+    job->socket->deleteLater();
+    m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(), [job](const std::unique_ptr<Job> &j) { return j.get() == job; }), m_jobs.end());
+    QMetaObject::invokeMethod(this, &RenderQueue::schedule, Qt::QueuedConnection);
+}
+
+void RenderQueue::abortJob(Job *job)
+{
+    qCInfo(KDENLIVE_RENDERER_LOG) << "Aborting job" << job->name;
+    job->aborted = true;
+    job->process->kill();
+}
+
+void RenderQueue::sendProgress(Job *job)
+{
+    if (job->socket->state() != QLocalSocket::ConnectedState) {
+        return;
+    }
+    QJsonObject method, args;
+    args["url"] = job->target;
+    args["progress"] = job->progress;
+    args["frame"] = job->frame;
+    method["setRenderingProgress"] = args;
+    job->socket->write(QJsonDocument(method).toJson());
+    job->socket->flush();
+}
+
+void RenderQueue::sendFinish(Job *job, int status, const QString &error)
+{
+    if (job->socket->state() != QLocalSocket::ConnectedState) {
+        return;
+    }
+    QJsonObject method, args;
+    args["url"] = job->target;
+    args["status"] = status;
+    args["error"] = error;
+    method["setRenderingFinished"] = args;
+    job->socket->write(QJsonDocument(method).toJson());
+    job->socket->flush();
+}
+
+void RenderQueue::archiveJob(const QString &name, const QString &folder, const QString &log)
+{
+    QFile::remove(pidFile(name));
+    const QString archived = m_spool.absoluteFilePath(folder + QLatin1Char('/') + name);
+    QFile::remove(archived);
+    QFile::rename(m_spool.absoluteFilePath(runningFolder + QLatin1Char('/') + name), archived);
+    QFile logFile(archived + QStringLiteral(".log"));
+    if (!log.isEmpty() && logFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QTextStream stream(&logFile);
+        stream << log << "\n";
+    }
+}
+
+void RenderQueue::attach()
+{
+    QString server;
+    for (auto &job : m_jobs) {
+        if (job->socket->state() != QLocalSocket::UnconnectedState) {
+            continue;
+        }
+        if (server.isEmpty()) {
+            server = serverName();
+            if (server.isEmpty()) {
+                // No Kdenlive instance running
+                return;
+            }
+        }
+        job->socket->connectToServer(server);
+    }
+}
+
+QString RenderQueue::serverName() const
+{
+    if (m_pid > -1) {
+        return QStringLiteral("org.kde.kdenlive-%1").arg(m_pid);
+    }
+#if defined(Q_OS_WIN) || defined(Q_OS_MAC)
+    return QString();
+#else
+    // Look for a running instance, socket files of crashed instances may remain
+    const QStringList files = QDir::temp().entryList({QStringLiteral("org.kde.kdenlive-*")}, QDir::System);
+    for (const QString &file : files) {
+        QLocalSocket probe;
+        probe.connectToServer(file);
+        if (probe.waitForConnected(100)) {
+            probe.disconnectFromServer();
+            return file;
+        }
+    }
+    return QString();
+#endif
+}
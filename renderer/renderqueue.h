@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDir>
+#include <QFileSystemWatcher>
+#include <QLocalSocket>
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+#include <memory>
+#include <vector>
+
+/** @class RenderQueue
+    @brief A headless render queue: render jobs dropped in a spool folder are rendered with melt, with a limited number of jobs running at the same time.
+    A job is either an MLT playlist containing a consumer (like the scripts created by Kdenlive's delayed rendering),
+    or a json file describing the job:
+    @code
+    {"playlist": "project.mlt", "output": "result.mp4", "in": 0, "out": 1499, "params": "vcodec=libx264 crf=23"}
+    @endcode
+    where only playlist is required, relative paths being resolved from the spool folder, and params overriding the consumer properties.
+    Every file at the top of the spool folder is a job, so the playlist of a json job must be in a subfolder (for example media/project.mlt).
+    Job files are moved to the running, done and failed subfolders as they are processed, so the queue resumes where it stopped after a restart.
+    The queue stops its renders when it receives a termination signal. If it was killed, renders it left running are stopped on next start.
+    Progress is reported to a running Kdenlive instance like any render job, Kdenlive can be started or closed while jobs are running.
+ */
+class RenderQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @param maxJobs the maximum number of jobs rendered at the same time
+        @param pid process id of the Kdenlive instance to report to, -1 to use any running instance */
+    RenderQueue(const QString &render, const QString &spoolFolder, int maxJobs, int pid = -1, QObject *parent = nullptr);
+    ~RenderQueue() override;
+
+public Q_SLOTS:
+    void start();
+
+private Q_SLOTS:
+    void schedule();
+    /** @brief Connect the running jobs to a Kdenlive instance if they are not */
+    void attach();
+
+private:
+    struct Job
+    {
+        /** @brief The file name of the job in the spool folder */
+        QString name;
+        /** @brief The temporary playlist rendered by melt */
+        QString playlist;
+        QString target;
+        int progress{0};
+        int frame{0};
+        bool aborted{false};
+        QProcess *process{nullptr};
+        QLocalSocket *socket{nullptr};
+        QString outputData;
+        QString errors;
+    };
+    QString m_render;
+    QDir m_spool;
+    int m_maxJobs;
+    int m_pid;
+    /** @brief Encoder threads given to each job, so that running jobs share the cores */
+    int m_threads;
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    QFileSystemWatcher m_watcher;
+    QTimer m_scanTimer;
+
+    /** @brief Create the temporary playlist of a job from its job file, returns false and fills the errors on failure */
+    bool prepareJob(Job *job, const QString &jobFile);
+    void startJob(Job *job);
+    void receivedStderr(Job *job);
+    void jobFinished(Job *job, int exitCode, QProcess::ExitStatus status);
+    void abortJob(Job *job);
+    void sendProgress(Job *job);
+    void sendFinish(Job *job, int status, const QString &error);
+    /** @brief Move a job file from the running folder to @param folder, writing its log next to it */
+    void archiveJob(const QString &name, const QString &folder, const QString &log);
+    /** @brief The name of the local server of the Kdenlive instance to report to, or an empty string if there is none */
+    QString serverName() const;
+    /** @brief Quit the application on SIGTERM, SIGINT and SIGHUP, so that the destructor stops the running renders */
+    void handleQuitSignals();
+    /** @brief Stop the render of an interrupted job if it is still running from a killed queue */
+    void stopOrphanedRender(const QString &name);
+    /** @brief The file storing the process id of the render of a running job */
+    QString pidFile(const QString &name) const;
+};
@@ -0,0 +1,353 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "segmentrenderjob.h"
+#include "kdenlive_renderer_debug.h"
+
+#include <QDir>
+#include <QDomDocument>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+#include <QUrl>
+
+SegmentRenderJob::SegmentRenderJob(const QString &render, const QString &audioPlaylist, const QStringList &segmentPlaylists, const QString &target, int pid,
+                                   bool debugMode, QObject *parent)
+    : QObject(parent)
+    , m_render(render)
+    , m_dest(target)
+    , m_kdenlivesocket(new QLocalSocket(this))
+    , m_pid(pid)
+    , m_debugMode(debugMode)
+    , m_erase(!debugMode && audioPlaylist.startsWith(QDir::tempPath()))
+{
+    m_logfile.setFileName(m_dest + QStringLiteral(".log"));
+    if (!m_logfile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(KDENLIVE_RENDERER_LOG) << "Unable to log to" << m_logfile.fileName();
+    } else {
+        m_logstream.setDevice(&m_logfile);
+    }
+    connect(&m_concatProcess, &QProcess::finished, this, &SegmentRenderJob::slotConcatFinished);
+
+    Part audio;
+    audio.playlist = audioPlaylist;
+    if (readPart(audio)) {
+        // Audio only encoding is much faster than video, don't let it slow down the progress
+        audio.weight = qMax(1, (audio.out - audio.in + 1) / 10);
+    }
+    m_parts.push_back(audio);
+    for (const QString &playlist : segmentPlaylists) {
+        Part segment;
+        segment.playlist = playlist;
+        if (readPart(segment)) {
+            segment.weight = qMax(1, segment.out - segment.in + 1);
+        }
+        m_parts.push_back(segment);
+    }
+}
+
+SegmentRenderJob::~SegmentRenderJob()
+{
+    if (m_kdenlivesocket->state() == QLocalSocket::ConnectedState) {
+        m_kdenlivesocket->disconnectFromServer();
+    }
+    delete m_kdenlivesocket;
+    m_logfile.close();
+}
+
+bool SegmentRenderJob::readPart(Part &part)
+{
+    QFile file(part.playlist);
+    QDomDocument doc;
+    if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file)) {
+        m_errorMessage.append(tr("Failed to read file %1").arg(part.playlist) + QStringLiteral("<br>"));
+        return false;
+    }
+    QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+    part.in = consumer.attribute(QStringLiteral("in")).toInt();
+    part.out = consumer.attribute(QStringLiteral("out")).toInt();
+    part.target = consumer.attribute(QStringLiteral("target"));
+    if (part.target.isEmpty() || part.out < part.in) {
+        m_errorMessage.append(tr("Invalid render parameters in file %1").arg(part.playlist) + QStringLiteral("<br>"));
+        return false;
+    }
+    if (m_parts.empty()) {
+        // The audio part keeps the muxer parameters of the preset
+        m_format = consumer.attribute(QStringLiteral("f"));
+        m_movflags = consumer.attribute(QStringLiteral("movflags"));
+    }
+    return true;
+}
+
+void SegmentRenderJob::start()
+{
+    m_startTime = QDateTime::currentDateTime();
+    if (m_pid > -1) {
+        connect(m_kdenlivesocket, &QLocalSocket::connected, this, [this]() {
+            QJsonObject obj;
+            obj["url"] = m_dest;
+            m_kdenlivesocket->write(QJsonDocument(obj).toJson());
+            m_kdenlivesocket->flush();
+            QJsonObject method, args;
+            args["url"] = m_dest;
+            args["progress"] = 0;
+            args["frame"] = 0;
+            method["setRenderingProgress"] = args;
+            m_kdenlivesocket->write(QJsonDocument(method).toJson());
+            m_kdenlivesocket->flush();
+        });
+        m_kdenlivesocket->connectToServer(QStringLiteral("org.kde.kdenlive-%1").arg(m_pid));
+        if (!m_kdenlivesocket->waitForConnected(1000)) {
+            qCDebug(KDENLIVE_RENDERER_LOG) << "==== RENDER SOCKET NOT CONNECTED";
+        }
+        connect(m_kdenlivesocket, &QLocalSocket::readyRead, this, &SegmentRenderJob::gotMessage);
+    }
+    if (!m_errorMessage.isEmpty()) {
+        m_stopped = true;
+        m_logstream << m_errorMessage << "\n";
+        sendFinish(-2, m_errorMessage);
+        Q_EMIT renderingFinished();
+        return;
+    }
+
+    // Disable VDPAU so that rendering will work even if there is a Kdenlive instance using VDPAU
+    qputenv("MLT_NO_VDPAU", "1");
+    const QString logLevel = m_debugMode ? QStringLiteral("debug") : QStringLiteral("error");
+    for (size_t ix = 0; ix < m_parts.size(); ix++) {
+        Part &part = m_parts[ix];
+        part.process = new QProcess(this);
+        part.process->setProgram(m_render);
+        part.process->setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+        part.process->setReadChannel(QProcess::StandardError);
+        part.process->setArguments(
+            {QStringLiteral("-loglevel"), logLevel, QStringLiteral("-progress2"), QString::fromUtf8(QUrl::toPercentEncoding(part.playlist))});
+        connect(part.process, &QProcess::readyReadStandardError, this, [this, ix]() { receivedStderr(ix); });
+        connect(part.process, &QProcess::finished, this, [this, ix](int exitCode, QProcess::ExitStatus status) { partFinished(ix, exitCode, status); });
+        m_logstream << "Started render process: " << m_render << ' ' << part.process->arguments().join(QLatin1Char(' ')) << "\n";
+        part.process->start();
+    }
+    m_logstream.flush();
+}
+
+void SegmentRenderJob::gotMessage()
+{
+    const QByteArray msg = m_kdenlivesocket->readAll();
+    if (msg == "abort") {
+        abort();
+    }
+}
+
+void SegmentRenderJob::receivedStderr(size_t ix)
+{
+    Part &part = m_parts[ix];
+    QString result = QString::fromLocal8Bit(part.process->readAllStandardError());
+    if (!result.contains(QLatin1Char('\n'))) {
+        part.outputData.append(result);
+        return;
+    }
+    result.prepend(part.outputData);
+    part.outputData.clear();
+    result = result.simplified();
+    if (!result.startsWith(QLatin1String("Current Frame"))) {
+        m_errorMessage.append(result + QStringLiteral("<br>"));
+        m_logstream << result << "\n";
+        return;
+    }
+    bool ok;
+    int progress = result.section(QLatin1Char(' '), -1).toInt(&ok);
+    if (!ok || progress <= part.progress || progress > 100) {
+        return;
+    }
+    int frame = result.section(QLatin1Char(','), 0, 0).section(QLatin1Char(' '), -1).toInt(&ok);
+    if (!ok) {
+        return;
+    }
+    part.progress = progress;
+    part.frames = qBound(0, frame - part.in, part.out - part.in + 1);
+    qint64 elapsedTime = m_startTime.secsTo(QDateTime::currentDateTime());
+    if (elapsedTime == m_seconds) {
+        return;
+    }
+    m_seconds = elapsedTime;
+    updateProgress();
+}
+
+void SegmentRenderJob::updateProgress()
+{
+    qint64 done = 0;
+    qint64 total = 0;
+    int frames = 0;
+    for (size_t ix = 0; ix < m_parts.size(); ix++) {
+        const Part &part = m_parts.at(ix);
+        done += qint64(part.weight) * part.progress;
+        total += part.weight;
+        if (ix > 0) {
+            frames += part.frames;
+        }
+    }
+    // Keep the last percent for joining the parts
+    int progress = qMin(99, int(done / qMax(qint64(1), total)));
+    if (progress <= m_progress) {
+        return;
+    }
+    m_progress = progress;
+    if (m_kdenlivesocket->state() == QLocalSocket::ConnectedState) {
+        QJsonObject method, args;
+        args["url"] = m_dest;
+        args["progress"] = m_progress;
+        args["frame"] = frames;
+        method["setRenderingProgress"] = args;
+        m_kdenlivesocket->write(QJsonDocument(method).toJson());
+        m_kdenlivesocket->flush();
+    } else {
+        qCDebug(KDENLIVE_RENDERER_LOG) << "Progress:" << m_progress << "%,"
+                                       << "frames" << frames;
+    }
+    m_logstream << QStringLiteral("%1\t%2\t%3\n").arg(m_seconds).arg(frames).arg(m_progress);
+}
+
+void SegmentRenderJob::partFinished(size_t ix, int exitCode, QProcess::ExitStatus status)
+{
+    if (m_stopped) {
+        return;
+    }
+    Part &part = m_parts[ix];
+    if (status == QProcess::CrashExit || exitCode != 0 || !QFile::exists(part.target)) {
+        // One part failed, the others are useless
+        m_stopped = true;
+        QString error = tr("Rendering of %1 aborted, resulting video will probably be corrupted.").arg(m_dest);
+        m_logstream << "Rendering of " << part.playlist << " failed with exit code " << exitCode << "\n" << error << "\n";
+        m_errorMessage.append(error);
+        cleanup();
+        sendFinish(-2, m_errorMessage);
+        QProcess::startDetached(QStringLiteral("kdialog"), {QStringLiteral("--error"), error});
+        Q_EMIT renderingFinished();
+        return;
+    }
+    part.finished = true;
+    part.progress = 100;
+    part.frames = part.out - part.in + 1;
+    m_logstream << "Rendering of " << part.target << " finished\n";
+    m_logstream.flush();
+    for (const Part &p : m_parts) {
+        if (!p.finished) {
+            updateProgress();
+            return;
+        }
+    }
+    concatenate();
+}
+
+void SegmentRenderJob::concatenate()
+{
+    const QString ffmpegExe = QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
+    QTemporaryFile list(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.txt")));
+    list.setAutoRemove(false);
+    if (ffmpegExe.isEmpty() || !list.open()) {
+        m_stopped = true;
+        QString error = ffmpegExe.isEmpty() ? tr("FFmpeg is required to join the rendered segments.") : tr("Cannot create temporary file.");
+        m_logstream << error << "\n";
+        cleanup();
+        sendFinish(-2, error);
+        Q_EMIT renderingFinished();
+        return;
+    }
+    m_concatList = list.fileName();
+    QTextStream stream(&list);
+    for (size_t ix = 1; ix < m_parts.size(); ix++) {
+        QString path = m_parts.at(ix).target;
+        path.replace(QLatin1Char('\''), QStringLiteral("'\\''"));
+        stream << "file '" << path << "'\n";
+    }
+    stream.flush();
+    list.close();
+
+    // Parts are joined without re-encoding: the video segments one after the other, and the continuous audio track
+    QStringList args = {"-y", "-v", "error", "-f", "concat", "-safe", "0", "-i", m_concatList, "-i", m_parts.front().target};
+    args << QStringLiteral("-map") << QStringLiteral("0:v") << QStringLiteral("-map") << QStringLiteral("1:a?");
+    args << QStringLiteral("-c") << QStringLiteral("copy");
+    if (!m_movflags.isEmpty()) {
+        args << QStringLiteral("-movflags") << m_movflags;
+    }
+    if (!m_format.isEmpty()) {
+        args << QStringLiteral("-f") << m_format;
+    }
+    args << m_dest;
+    m_logstream << "Joining parts: " << ffmpegExe << ' ' << args.join(QLatin1Char(' ')) << "\n";
+    m_logstream.flush();
+    m_concatProcess.start(ffmpegExe, args);
+}
+
+void SegmentRenderJob::slotConcatFinished(int exitCode, QProcess::ExitStatus status)
+{
+    if (m_stopped) {
+        return;
+    }
+    m_stopped = true;
+    cleanup();
+    if (status == QProcess::CrashExit || exitCode != 0 || !QFile::exists(m_dest)) {
+        QString error = QString::fromLocal8Bit(m_concatProcess.readAllStandardError()).simplified();
+        m_logstream << error << "\n";
+        error.append(QLatin1Char('\n'));
+        error.append(tr("Rendering of %1 aborted, resulting video will probably be corrupted.").arg(m_dest));
+        sendFinish(-2, error);
+    } else {
+        m_logstream << "Rendering of " << m_dest << " finished\n";
+        if (!m_debugMode) {
+            m_logfile.remove();
+        }
+        sendFinish(-1, QString());
+    }
+    Q_EMIT renderingFinished();
+}
+
+void SegmentRenderJob::sendFinish(int status, const QString &error)
+{
+    if (m_kdenlivesocket->state() == QLocalSocket::ConnectedState) {
+        QJsonObject method, args;
+        args["url"] = m_dest;
+        args["status"] = status;
+        args["error"] = error;
+        method["setRenderingFinished"] = args;
+        m_kdenlivesocket->write(QJsonDocument(method).toJson());
+        m_kdenlivesocket->flush();
+    } else {
+        qCDebug(KDENLIVE_RENDERER_LOG) << "Rendering to" << m_dest << "finished. Status:" << status << "Errors:" << error;
+    }
+}
+
+void SegmentRenderJob::abort()
+{
+    if (m_stopped) {
+        return;
+    }
+    m_stopped = true;
+    m_concatProcess.kill();
+    cleanup();
+    QFile::remove(m_dest);
+    sendFinish(-3, QString());
+    m_logstream << "Job aborted by user\n";
+    m_logstream.flush();
+    Q_EMIT renderingFinished();
+}
+
+void SegmentRenderJob::cleanup()
+{
+    for (Part &part : m_parts) {
+        if (part.process && part.process->state() != QProcess::NotRunning) {
+            part.process->kill();
+            part.process->waitForFinished(1000);
+        }
+        QFile::remove(part.target);
+        if (m_erase) {
+            QFile::remove(part.playlist);
+        }
+    }
+    if (!m_concatList.isEmpty()) {
+        QFile::remove(m_concatList);
+    }
+    m_logstream.flush();
+}
@@ -0,0 +1,88 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDateTime>
+#include <QFile>
+#include <QLocalSocket>
+#include <QObject>
+#include <QProcess>
+#include <QTextStream>
+#include <vector>
+
+/** @class SegmentRenderJob
+    @brief Renders a project in several video segments with one melt process each, and the audio in one continuous pass,
+    all running in parallel. When all parts are rendered, they are joined into the final file with ffmpeg without re-encoding.
+    Progress is reported to the Kdenlive instance like a single render job.
+ */
+class SegmentRenderJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    SegmentRenderJob(const QString &render, const QString &audioPlaylist, const QStringList &segmentPlaylists, const QString &target, int pid = -1,
+                     bool debugMode = false, QObject *parent = nullptr);
+    ~SegmentRenderJob() override;
+
+public Q_SLOTS:
+    void start();
+
+private Q_SLOTS:
+    void gotMessage();
+    void slotConcatFinished(int exitCode, QProcess::ExitStatus status);
+
+private:
+    struct Part
+    {
+        QString playlist;
+        /** @brief The file rendered by this part */
+        QString target;
+        int in{0};
+        int out{0};
+        /** @brief Weight of this part in the overall progress */
+        int weight{1};
+        int progress{0};
+        /** @brief Number of frames rendered */
+        int frames{0};
+        bool finished{false};
+        QProcess *process{nullptr};
+        QString outputData;
+    };
+    QString m_render;
+    QString m_dest;
+    /** @brief The audio part comes first, followed by the video segments */
+    std::vector<Part> m_parts;
+    /** @brief Muxer parameters of the render preset, applied when joining the parts */
+    QString m_format;
+    QString m_movflags;
+    QLocalSocket *m_kdenlivesocket;
+    int m_pid;
+    bool m_debugMode;
+    bool m_erase;
+    /** @brief Set when the job was aborted or failed, to ignore the processes we stop */
+    bool m_stopped{false};
+    int m_progress{0};
+    qint64 m_seconds{0};
+    QDateTime m_startTime;
+    QString m_errorMessage;
+    QString m_concatList;
+    QProcess m_concatProcess;
+    QFile m_logfile;
+    QTextStream m_logstream;
+
+    bool readPart(Part &part);
+    void receivedStderr(size_t ix);
+    void partFinished(size_t ix, int exitCode, QProcess::ExitStatus status);
+    void concatenate();
+    void updateProgress();
+    void sendFinish(int status, const QString &error);
+    void abort();
+    /** @brief Stop all processes and delete the temporary files */
+    void cleanup();
+
+Q_SIGNALS:
+    void renderingFinished();
+};
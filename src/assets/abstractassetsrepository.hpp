@@ -6,6 +6,7 @@
 #pragma once
 
 #include "definitions.h"
+#include <QMutex>
 #include <QSet>
 #include <memory>
 #include <mlt++/Mlt.h>
@@ -14,6 +15,9 @@
 
 /** @class AbstractAssetsRepository
     @brief This class is the base class for assets (transitions or effets) repositories
+    The parsed assets are stored in a cache file, keyed by the MLT version, the available MLT services and the asset files,
+    so that MLT metadata and custom asset files are only parsed again when one of them changed.
+    The xml of an asset restored from the cache is only parsed when it is first used.
  */
 template <typename AssetType> class AbstractAssetsRepository
 {
@@ -59,7 +63,10 @@ protected:
         int version{};
         bool included{false};
         QMap<QString, QVariant> features;
-        QDomElement xml;
+        /** Use assetXml() to read it, it is null until first use for an asset restored from the cache */
+        mutable QDomElement xml;
+        /** Serialized xml of an asset restored from the cache */
+        mutable QByteArray xmlData;
         AssetType type;
     };
 
@@ -115,6 +122,15 @@ protected:
 
     QStringList qtDataDir(const QString &assetLocation) const;
 
+    /** @brief Returns the xml of an asset, parsing it if the asset was restored from the cache */
+    QDomElement assetXml(const Info &info) const;
+
+    /** @brief Returns the file name of the asset cache, in the application cache folder */
+    virtual QString assetCacheName() const = 0;
+
+    /** @brief Remove the asset cache, so that the assets are parsed again on next start */
+    void invalidateCache() const;
+
     std::unordered_map<QString, Info> m_assets;
 
     QSet<QString> m_hiddenList;
@@ -122,6 +138,20 @@ protected:
     QSet<QString> m_includedList;
 
     QSet<QString> m_preferred_list;
+
+private:
+    /** @brief Increase when the cache format or the parsing of the assets changes */
+    static constexpr quint32 cacheVersion = 1;
+    static constexpr quint32 cacheMagic = 0x4b444152;
+    /** @brief Protects the lazy parsing of the assets xml */
+    mutable QMutex m_xmlMutex;
+
+    QString assetCachePath() const;
+    /** @brief Hash of everything the parsed assets depend on: MLT version and services, asset files and lists, language */
+    QByteArray assetCacheKey() const;
+    /** @brief Replace the assets by the cached ones if the cache matches @param key, returns false otherwise */
+    bool loadAssetCache(const QByteArray &key);
+    void saveAssetCache(const QByteArray &key) const;
 };
 
 #include "abstractassetsrepository.ipp"
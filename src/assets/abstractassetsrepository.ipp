@@ -7,8 +7,15 @@
 #include "kdenlivesettings.h"
 #include "core.h"
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
 #include <QStandardPaths>
 #include <QString>
 #include <QTextStream>
@@ -28,6 +35,11 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
     // Parse preferred list
     parseAssetList({assetPreferredListPath()}, m_preferred_list);
 
+    const QByteArray cacheKey = assetCacheKey();
+    if (loadAssetCache(cacheKey)) {
+        return;
+    }
+
     // Retrieve the list of MLT's available assets.
     QScopedPointer<Mlt::Properties> assets(retrieveListFromMlt());
     QStringList emptyMetaAssets;
@@ -128,6 +140,189 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
     for (const auto &invalid : std::as_const(emptyMetaAssets)) {
         m_assets.erase(invalid);
     }
+    saveAssetCache(cacheKey);
+}
+
+template <typename AssetType> QString AbstractAssetsRepository<AssetType>::assetCachePath() const
+{
+    const QString folder = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return folder.isEmpty() ? QString() : QDir(folder).absoluteFilePath(assetCacheName());
+}
+
+template <typename AssetType> QByteArray AbstractAssetsRepository<AssetType>::assetCacheKey() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    auto addFile = [&hash](const QFileInfo &info) {
+        hash.addData(info.absoluteFilePath().toUtf8());
+        hash.addData(QByteArray::number(info.size()));
+        hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    };
+    hash.addData(QByteArray::number(cacheVersion));
+    // The application covers the parsing code and the bundled asset lists
+    hash.addData(QCoreApplication::applicationVersion().toUtf8());
+    addFile(QFileInfo(QCoreApplication::applicationFilePath()));
+    hash.addData(QByteArray(mlt_version_get_string()));
+    // Names and descriptions are translated when parsed
+    hash.addData(KLocalizedString::languages().join(QLatin1Char(',')).toUtf8());
+    hash.addData(pCore->debugMode ? QByteArrayLiteral("debug") : QByteArrayLiteral("release"));
+
+    // Custom assets can depend on any filter or transition
+    QScopedPointer<Mlt::Properties> filters(pCore->getMltRepository()->filters());
+    for (int i = 0; i < filters->count(); ++i) {
+        hash.addData(QByteArray(filters->get_name(i)));
+    }
+    hash.addData(QByteArrayLiteral("/"));
+    QScopedPointer<Mlt::Properties> transitions(pCore->getMltRepository()->transitions());
+    for (int i = 0; i < transitions->count(); ++i) {
+        hash.addData(QByteArray(transitions->get_name(i)));
+    }
+    // Updated MLT modules and frei0r or LADSPA plugins can change the metadata of an asset without changing its name
+    QStringList pluginDirs = {QString::fromUtf8(mlt_factory_directory())};
+    const QByteArray frei0rPath = qgetenv("FREI0R_PATH");
+    if (frei0rPath.isEmpty()) {
+        pluginDirs << QStringLiteral("/usr/lib/frei0r-1") << QStringLiteral("/usr/lib64/frei0r-1") << QStringLiteral("/usr/local/lib/frei0r-1")
+                   << QStringLiteral("/opt/local/lib/frei0r-1") << QDir::home().absoluteFilePath(QStringLiteral(".frei0r-1/lib"));
+    } else {
+        pluginDirs << QString::fromLocal8Bit(frei0rPath).split(QDir::listSeparator(), Qt::SkipEmptyParts);
+    }
+    const QByteArray ladspaPath = qgetenv("LADSPA_PATH");
+    if (ladspaPath.isEmpty()) {
+        pluginDirs << QStringLiteral("/usr/lib/ladspa") << QStringLiteral("/usr/lib64/ladspa") << QStringLiteral("/usr/local/lib/ladspa");
+    } else {
+        pluginDirs << QString::fromLocal8Bit(ladspaPath).split(QDir::listSeparator(), Qt::SkipEmptyParts);
+    }
+    for (const QString &dir : std::as_const(pluginDirs)) {
+        const QFileInfo info(dir);
+        if (dir.isEmpty() || !info.isDir()) {
+            continue;
+        }
+        addFile(info);
+        const QFileInfoList files = QDir(dir).entryInfoList(QDir::Files, QDir::Name);
+        for (const QFileInfo &file : files) {
+            addFile(file);
+        }
+    }
+
+    QStringList lists = assetIncludedPath() + assetExcludedPath() + assetHiddenPath();
+    lists << assetPreferredListPath();
+    for (const QString &list : std::as_const(lists)) {
+        if (!list.isEmpty() && !list.startsWith(QLatin1Char(':'))) {
+            addFile(QFileInfo(list));
+        }
+    }
+    // A folder modification time changes when files are added or removed, a file one when it is edited in place
+    const QStringList dirs = assetDirs();
+    for (const QString &dir : dirs) {
+        addFile(QFileInfo(dir));
+        const QFileInfoList files = QDir(dir).entryInfoList({QStringLiteral("*.xml")}, QDir::Files, QDir::Name);
+        for (const QFileInfo &file : files) {
+            addFile(file);
+        }
+    }
+    return hash.result();
+}
+
+template <typename AssetType> bool AbstractAssetsRepository<AssetType>::loadAssetCache(const QByteArray &key)
+{
+    const QString path = assetCachePath();
+    if (path.isEmpty()) {
+        return false;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    // Map the whole file so that it is read at once, the mapping is released when the file is closed
+    const qint64 size = file.size();
+    uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+    const QByteArray data = mapped != nullptr ? QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), size) : file.readAll();
+    QDataStream stream(data);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray storedKey;
+    qint32 count = 0;
+    stream >> magic >> version >> storedKey >> count;
+    if (stream.status() != QDataStream::Ok || magic != cacheMagic || version != cacheVersion || count < 0) {
+        qWarning() << "Discarding invalid asset cache" << path;
+        return false;
+    }
+    if (storedKey != key) {
+        qDebug() << "Assets changed, parsing them again";
+        return false;
+    }
+    std::unordered_map<QString, Info> assets;
+    assets.reserve(size_t(count));
+    for (int i = 0; i < count; ++i) {
+        QString assetId;
+        Info info;
+        qint32 type = 0;
+        stream >> assetId >> info.id >> info.mltId >> info.name >> info.description >> info.author >> info.version_str >> info.version >> info.included >>
+            info.features >> type >> info.xmlData;
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << "Truncated asset cache" << path;
+            return false;
+        }
+        info.type = AssetType(type);
+        assets[assetId] = std::move(info);
+    }
+    m_assets = std::move(assets);
+    qDebug() << "Restored" << m_assets.size() << "assets from" << path;
+    return true;
+}
+
+template <typename AssetType> void AbstractAssetsRepository<AssetType>::saveAssetCache(const QByteArray &key) const
+{
+    const QString path = assetCachePath();
+    if (path.isEmpty()) {
+        return;
+    }
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write asset cache" << path << file.errorString();
+        return;
+    }
+    QDataStream stream(&file);
+    stream << cacheMagic << cacheVersion << key << qint32(m_assets.size());
+    for (const auto &asset : m_assets) {
+        const Info &info = asset.second;
+        QByteArray xmlData = info.xmlData;
+        if (!info.xml.isNull()) {
+            xmlData.clear();
+            QTextStream xmlStream(&xmlData);
+            info.xml.save(xmlStream, 0);
+        }
+        stream << asset.first << info.id << info.mltId << info.name << info.description << info.author << info.version_str << info.version << info.included
+               << info.features << qint32(info.type) << xmlData;
+    }
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "Cannot write asset cache" << path << file.errorString();
+    }
+}
+
+template <typename AssetType> void AbstractAssetsRepository<AssetType>::invalidateCache() const
+{
+    const QString path = assetCachePath();
+    if (!path.isEmpty()) {
+        QFile::remove(path);
+    }
+}
+
+template <typename AssetType> QDomElement AbstractAssetsRepository<AssetType>::assetXml(const Info &info) const
+{
+    QMutexLocker lock(&m_xmlMutex);
+    if (info.xml.isNull() && !info.xmlData.isEmpty()) {
+        // Asset restored from the cache, validate it on first use
+        QDomDocument doc;
+        if (doc.setContent(info.xmlData)) {
+            info.xml = doc.documentElement();
+        } else {
+            qWarning() << "Invalid cached xml for asset" << info.id << ", the assets will be parsed again on next start";
+            invalidateCache();
+        }
+        info.xmlData.clear();
+    }
+    return info.xml;
 }
 
 template <typename AssetType> void AbstractAssetsRepository<AssetType>::parseAssetList(const QStringList &filePaths, QSet<QString> &destination)
@@ -366,7 +561,7 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::getAttri
 template <typename AssetType> bool AbstractAssetsRepository<AssetType>::isUnique(const QString &assetId) const
 {
     if (m_assets.count(assetId) > 0) {
-        return m_assets.at(assetId).xml.hasAttribute(QStringLiteral("unique"));
+        return assetXml(m_assets.at(assetId)).hasAttribute(QStringLiteral("unique"));
     }
     return false;
 }
@@ -404,7 +599,7 @@ template <typename AssetType> bool AbstractAssetsRepository<AssetType>::parseInf
     }
 
     // Check if there is a maximal version set
-    if (assetXml.hasAttribute(QStringLiteral("version")) && !m_assets.at(tag).xml.isNull()) {
+    if (assetXml.hasAttribute(QStringLiteral("version")) && !this->assetXml(m_assets.at(tag)).isNull()) {
         // a specific version of the filter is required
         if (m_assets.at(tag).version < int(100 * assetXml.attribute(QStringLiteral("version")).toDouble())) {
             qDebug() << "plugin version too low:" << tag;
@@ -416,6 +611,7 @@ template <typename AssetType> bool AbstractAssetsRepository<AssetType>::parseInf
     res.mltId = tag;
     res.version = int(100 * assetXml.attribute(QStringLiteral("version")).toDouble());
     res.xml = assetXml;
+    res.xmlData.clear();
 
     // Update name if the xml provide one
     std::pair<QString, QString> nameAndCtx = Xml::getSubTagContentAndContext(assetXml, QStringLiteral("name"));
@@ -478,7 +674,7 @@ template <typename AssetType> QDomElement AbstractAssetsRepository<AssetType>::g
         qWarning() << "Unknown transition" << assetId;
         return QDomElement();
     }
-    return m_assets.at(assetId).xml.cloneNode().toElement();
+    return assetXml(m_assets.at(assetId)).cloneNode().toElement();
 }
 
 template <typename AssetType> QStringList AbstractAssetsRepository<AssetType>::qtDataDir(const QString &assetLocation) const
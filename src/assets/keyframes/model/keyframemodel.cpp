@@ -16,6 +16,7 @@
 #include <QJsonDocument>
 #include <QLineF>
 #include <QSize>
+#include <algorithm>
 #include <mlt++/Mlt.h>
 #include <utility>
 
@@ -119,6 +120,22 @@ const QMap<KeyframeType::KeyframeEnum, QString> KeyframeModel::getKeyframeTypes(
     return KeyframeTypeName;
 }
 
+struct KeyframeModel::CompiledCurve
+{
+    /** The revision, duration and frame size the curve was built from */
+    int revision{-1};
+    int duration{0};
+    QSize frameSize;
+    /** The parsed animation, for MLT animated parameters */
+    Mlt::Properties properties;
+    bool useOpacity{false};
+    bool percent{false};
+    /** Keyframe positions and their parsed spline, for rotoscoping */
+    std::vector<std::pair<int, QList<BPoint>>> rotoKeyframes;
+};
+
+KeyframeModel::~KeyframeModel() = default;
+
 void KeyframeModel::setup()
 {
     // We connect the signals of the abstractitemmodel to a more generic one.
@@ -647,6 +664,7 @@ Fun KeyframeModel::updateKeyframe_lambda(GenTime pos, KeyframeType::KeyframeEnum
         int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
         m_keyframeList[pos].first = type;
         m_keyframeList[pos].second = value;
+        m_revision++;
         if (notify) Q_EMIT dataChanged(index(row), index(row), {ValueRole, NormalizedValueRole, TypeRole});
         return true;
     };
@@ -667,6 +685,7 @@ Fun KeyframeModel::addKeyframe_lambda(GenTime pos, KeyframeType::KeyframeEnum ty
         if (notify) beginInsertRows(QModelIndex(), insertionRow, insertionRow);
         m_keyframeList[pos].first = type;
         m_keyframeList[pos].second = value;
+        m_revision++;
         if (notify) endInsertRows();
         return true;
     };
@@ -683,6 +702,7 @@ Fun KeyframeModel::deleteKeyframe_lambda(GenTime pos, bool notify)
         int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
         if (notify) beginRemoveRows(QModelIndex(), row, row);
         m_keyframeList.erase(pos);
+        m_revision++;
         if (notify) endRemoveRows();
         qDebug() << "after" << getAnimProperty();
         return true;
@@ -1209,6 +1229,7 @@ void KeyframeModel::parseRotoProperty(const QString &prop)
     } else {
         // Empty doc, clear all keyframes
         m_keyframeList.clear();
+        m_revision++;
     }
 }
 
@@ -1267,30 +1288,125 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
     if (m_keyframeList.size() == 0) {
         return QVariant();
     }
+    QMutexLocker lock(&m_curveMutex);
+    if (!compileCurve()) {
+        return QVariant();
+    }
+    return curveValue(pos.frames(pCore->getCurrentFps()));
+}
+
+QVector<QVariant> KeyframeModel::getInterpolatedValues(int startFrame, int count) const
+{
+    std::vector<int> frames;
+    frames.reserve(size_t(qMax(0, count)));
+    for (int frame = startFrame; frame < startFrame + count; ++frame) {
+        frames.push_back(frame);
+    }
+    return getInterpolatedValues(frames);
+}
+
+QVector<QVariant> KeyframeModel::getInterpolatedValues(const std::vector<int> &frames) const
+{
+    QVector<QVariant> values;
+    if (frames.empty() || m_keyframeList.size() == 0) {
+        values.resize(int(frames.size()));
+        return values;
+    }
+    values.reserve(int(frames.size()));
+    const double fps = pCore->getCurrentFps();
+    QMutexLocker lock(&m_curveMutex);
+    const bool compiled = compileCurve();
+    auto keyframe = m_keyframeList.lower_bound(GenTime(frames.front(), fps));
+    for (int frame : frames) {
+        // Keyframes are returned as stored, like in getInterpolatedValue()
+        while (keyframe != m_keyframeList.end() && keyframe->first.frames(fps) < frame) {
+            ++keyframe;
+        }
+        if (keyframe != m_keyframeList.end() && keyframe->first == GenTime(frame, fps)) {
+            values << keyframe->second.second;
+        } else {
+            values << (compiled ? curveValue(frame) : QVariant());
+        }
+    }
+    return values;
+}
+
+bool KeyframeModel::compileCurve() const
+{
+    // Read before the data the curve is built from, so that a concurrent change triggers a new build on next call
+    const int revision = m_revision.load();
+    if (m_paramType == ParamType::Roto_spline) {
+        const QSize frame = pCore->getCurrentFrameSize();
+        if (m_curve && m_curve->revision == revision && m_curve->frameSize == frame) {
+            return true;
+        }
+        m_curve.reset(new CompiledCurve);
+        m_curve->revision = revision;
+        m_curve->frameSize = frame;
+        m_curve->rotoKeyframes.reserve(m_keyframeList.size());
+        for (const auto &keyframe : m_keyframeList) {
+            m_curve->rotoKeyframes.emplace_back(keyframe.first.frames(pCore->getCurrentFps()), RotoHelper::getPoints(keyframe.second.second, frame));
+        }
+        return true;
+    }
+    if (m_paramType != ParamType::KeyframeParam && m_paramType != ParamType::ColorWheel && m_paramType != ParamType::AnimatedRect &&
+        m_paramType != ParamType::AnimatedFakeRect && m_paramType != ParamType::AnimatedFakePoint && m_paramType != ParamType::AnimatedPoint &&
+        m_paramType != ParamType::Color) {
+        return false;
+    }
+    auto ptr = m_model.lock();
+    if (!ptr) {
+        return false;
+    }
+    const int out = ptr->data(m_index, AssetParameterModel::ParentDurationRole).toInt();
+    const QSize frameSize = pCore->getCurrentFrameSize();
+    if (m_curve && m_curve->revision == revision && m_curve->duration == out && m_curve->frameSize == frameSize) {
+        return true;
+    }
+    // The parameter value only changes through sendModification() or refresh(), which both change the revision
+    const QString animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
+    if (animData.isEmpty()) {
+        m_curve.reset();
+        return false;
+    }
+    m_curve.reset(new CompiledCurve);
+    m_curve->revision = revision;
+    m_curve->duration = out;
+    m_curve->frameSize = frameSize;
+    m_curve->useOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
+    m_curve->percent = animData.contains(QLatin1Char('%'));
+    ptr->passProperties(m_curve->properties);
+    m_curve->properties.set("key", animData.toUtf8().constData());
+    // This is a fake query to force the animation to be parsed once
+    (void)m_curve->properties.anim_get_double("key", 0, out);
+    return true;
+}
+
+QVariant KeyframeModel::curveValue(int frame) const
+{
     if (m_paramType == ParamType::Roto_spline) {
         // interpolate
-        auto next = m_keyframeList.upper_bound(pos);
-        if (next == m_keyframeList.cbegin()) {
-            return (m_keyframeList.cbegin())->second.second;
+        const auto &keyframes = m_curve->rotoKeyframes;
+        auto next = std::upper_bound(keyframes.cbegin(), keyframes.cend(), frame,
+                                     [](int position, const std::pair<int, QList<BPoint>> &keyframe) { return position < keyframe.first; });
+        if (next == keyframes.cbegin()) {
+            return m_keyframeList.cbegin()->second.second;
         }
-        if (next == m_keyframeList.cend()) {
-            auto it = m_keyframeList.cend();
-            --it;
-            return it->second.second;
+        if (next == keyframes.cend()) {
+            return m_keyframeList.crbegin()->second.second;
         }
         auto prev = next;
         --prev;
 
-        const QSize frame = pCore->getCurrentFrameSize();
-        QList<BPoint> p1 = RotoHelper::getPoints(prev->second.second, frame);
-        QList<BPoint> p2 = RotoHelper::getPoints(next->second.second, frame);
+        const QSize &frameSize = m_curve->frameSize;
+        const QList<BPoint> &p1 = prev->second;
+        const QList<BPoint> &p2 = next->second;
         // relPos should be in [0,1]:
         // - equal to 0 on prev keyframe
         // - equal to 1 on next keyframe
         qreal relPos = 0;
         if (next->first != prev->first) {
-            relPos = (pos.frames(pCore->getCurrentFps()) - prev->first.frames(pCore->getCurrentFps())) /
-                     qreal(((next->first - prev->first).frames(pCore->getCurrentFps())));
+            relPos = (frame - prev->first) / qreal(next->first - prev->first);
         }
         int count = qMin(p1.count(), p2.count());
         QList<QVariant> vlist;
@@ -1303,37 +1419,22 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
                 } else {
                     bp[j] = p1.at(i)[j];
                 }
-                pl << QVariant(QList<QVariant>() << QVariant(bp[j].x() / frame.width()) << QVariant(bp[j].y() / frame.height()));
+                pl << QVariant(QList<QVariant>() << QVariant(bp[j].x() / frameSize.width()) << QVariant(bp[j].y() / frameSize.height()));
             }
             vlist << QVariant(pl);
         }
         return vlist;
     }
-    Mlt::Properties mlt_prop;
-    QString animData;
-    int out = 0;
-    bool useOpacity = false;
-    if (auto ptr = m_model.lock()) {
-        ptr->passProperties(mlt_prop);
-        out = ptr->data(m_index, AssetParameterModel::ParentDurationRole).toInt();
-        useOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
-        animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
+    Mlt::Properties &mlt_prop = m_curve->properties;
+    const int out = m_curve->duration;
+    if (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel) {
+        return QVariant(mlt_prop.anim_get_double("key", frame, out));
     }
-
-    if (!animData.isEmpty() && (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel)) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        return QVariant(mlt_prop.anim_get_double("key", pos.frames(pCore->getCurrentFps())));
-    }
-    if (!animData.isEmpty() && (m_paramType == ParamType::AnimatedRect || m_paramType == ParamType::AnimatedFakeRect ||
-                                m_paramType == ParamType::AnimatedFakePoint || m_paramType == ParamType::AnimatedPoint)) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        mlt_rect rect = mlt_prop.anim_get_rect("key", pos.frames(pCore->getCurrentFps()));
-        if (animData.contains(QLatin1Char('%'))) {
-            const QSize profileSize = pCore->getCurrentFrameSize();
+    if (m_paramType == ParamType::AnimatedRect || m_paramType == ParamType::AnimatedFakeRect || m_paramType == ParamType::AnimatedFakePoint ||
+        m_paramType == ParamType::AnimatedPoint) {
+        mlt_rect rect = mlt_prop.anim_get_rect("key", frame, out);
+        if (m_curve->percent) {
+            const QSize &profileSize = m_curve->frameSize;
             rect.x *= profileSize.width();
             rect.y *= profileSize.height();
             rect.w *= profileSize.width();
@@ -1344,16 +1445,13 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
             return QVariant(res);
         }
         QString res = QStringLiteral("%1 %2 %3 %4").arg(int(rect.x)).arg(int(rect.y)).arg(int(rect.w)).arg(int(rect.h));
-        if (useOpacity) {
+        if (m_curve->useOpacity) {
             res.append(QStringLiteral(" %1").arg(QString::number(rect.o, 'f')));
         }
         return QVariant(res);
     }
-    if (!animData.isEmpty() && m_paramType == ParamType::Color) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        mlt_color mltColor = mlt_prop.anim_get_color("key", pos.frames(pCore->getCurrentFps()));
+    if (m_paramType == ParamType::Color) {
+        mlt_color mltColor = mlt_prop.anim_get_color("key", frame, out);
         QColor color(mltColor.r, mltColor.g, mltColor.b, mltColor.a);
         return QVariant(QColorUtils::colorToString(color, true));
     }
@@ -1368,6 +1466,7 @@ void KeyframeModel::sendModification()
         if (AssetParameterModel::isAnimated(m_paramType)) {
             m_lastData = getAnimProperty();
             ptr->setParameter(name, m_lastData, false, m_index);
+            m_revision++;
         } else {
             Q_ASSERT(false); // Not implemented, TODO
         }
@@ -1436,6 +1535,7 @@ void KeyframeModel::refresh(int in, int out)
         }
     }
     m_lastData = animData;
+    m_revision++;
 }
 
 void KeyframeModel::reset()
@@ -1473,6 +1573,7 @@ void KeyframeModel::reset()
         }
     }
     m_lastData = animData;
+    m_revision++;
 }
 
 QList<QPoint> KeyframeModel::getRanges(const QString &animData, const std::shared_ptr<AssetParameterModel> &model)
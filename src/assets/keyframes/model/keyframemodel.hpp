@@ -11,13 +11,16 @@
 #include "utils/gentime.h"
 
 #include <QAbstractListModel>
+#include <QMutex>
 #include <QReadWriteLock>
 #include <QtGlobal>
 
 #include <framework/mlt_version.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <vector>
 
 class AssetParameterModel;
 class DocUndoStack;
@@ -44,6 +47,7 @@ public:
      */
     explicit KeyframeModel(std::weak_ptr<AssetParameterModel> model, const QModelIndex &index, std::weak_ptr<DocUndoStack> undo_stack, int in = -1,
                            int out = -1, QObject *parent = nullptr);
+    ~KeyframeModel() override;
 
     enum { TypeRole = Qt::UserRole + 1, PosRole, FrameRole, ValueRole, NormalizedValueRole, SelectedRole, ActiveRole, MoveOnlyRole };
     friend class KeyframeModelList;
@@ -147,6 +151,10 @@ public:
     /** @brief Return the interpolated value at given pos */
     QVariant getInterpolatedValue(int pos) const;
     QVariant getInterpolatedValue(const GenTime &pos) const;
+    /** @brief Return the interpolated values of @p count frames starting at @p startFrame */
+    QVector<QVariant> getInterpolatedValues(int startFrame, int count) const;
+    /** @brief Return the interpolated values at the given @p frames, which must be in increasing order */
+    QVector<QVariant> getInterpolatedValues(const std::vector<int> &frames) const;
     QVariant updateInterpolated(const QVariant &interpValue, double val);
     /** @brief Return the real value from a normalized one */
     QVariant getNormalizedValue(double newVal) const;
@@ -219,6 +227,18 @@ private:
     mutable QReadWriteLock m_lock;
 
     std::map<GenTime, std::pair<KeyframeType::KeyframeEnum, QVariant>> m_keyframeList;
+    /** @brief Incremented on each change of m_keyframeList or of the parameter value. Written by the model thread while the curve is read from others */
+    std::atomic<int> m_revision{0};
+
+    /** @brief The parsed curve used to compute interpolated values, so that the animation is not parsed again on each query */
+    struct CompiledCurve;
+    mutable std::unique_ptr<CompiledCurve> m_curve;
+    mutable QMutex m_curveMutex;
+    /** @brief Rebuild m_curve if the revision, the duration or the frame size changed. Returns false if there is nothing to interpolate.
+        m_curveMutex must be locked */
+    bool compileCurve() const;
+    /** @brief Interpolate the value at a frame with the compiled curve. m_curveMutex must be locked */
+    QVariant curveValue(int frame) const;
     bool moveOneKeyframe(GenTime oldPos, GenTime pos, QVariant newVal, Fun &undo, Fun &redo, bool updateView = true, bool allowedToFail = false);
 
 Q_SIGNALS:
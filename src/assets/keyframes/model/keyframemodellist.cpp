@@ -722,6 +722,13 @@ QVariant KeyframeModelList::getInterpolatedValue(const GenTime &pos, const QPers
     return m_parameters.at(index)->getInterpolatedValue(pos);
 }
 
+QVector<QVariant> KeyframeModelList::getInterpolatedValues(const std::vector<int> &frames, const QPersistentModelIndex &index) const
+{
+    READ_LOCK();
+    Q_ASSERT(m_parameters.count(index) > 0);
+    return m_parameters.at(index)->getInterpolatedValues(frames);
+}
+
 KeyframeModel *KeyframeModelList::getKeyModel()
 {
     if (m_inTimelineIndex.isValid()) {
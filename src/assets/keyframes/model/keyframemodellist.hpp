@@ -15,6 +15,7 @@
 #include <QObject>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 class AssetParameterModel;
 class DocUndoStack;
@@ -128,6 +129,10 @@ public:
        @param pos is the position where we interpolate
        @param index is the index of the queried parameter. */
     QVariant getInterpolatedValue(const GenTime &pos, const QPersistentModelIndex &index) const;
+    /** @brief Return the interpolated values of a parameter at several positions, sharing one lookup of the compiled curve.
+       @param frames are the positions where we interpolate, in increasing order
+       @param index is the index of the queried parameter. */
+    QVector<QVariant> getInterpolatedValues(const std::vector<int> &frames, const QPersistentModelIndex &index) const;
 
     /** @brief Load keyframes from the current parameter value. */
     void refresh();
@@ -12,6 +12,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include <core.h>
 #include <utility>
+#include <vector>
 KeyframeMonitorHelper::KeyframeMonitorHelper(Monitor *monitor, std::shared_ptr<AssetParameterModel> model, SceneType::MonitorSceneType sceneType,
                                              QObject *parent)
     : QObject(parent)
@@ -85,6 +86,8 @@ void KeyframeMonitorHelper::refreshParams(int pos)
         KeyframeModel *kfr = keyframes->getKeyModel(ix);
         bool ok;
         rectAtPosData = kfr->getInterpolatedValue(pos).toString();
+        const double fps = pCore->getCurrentFps();
+        std::vector<int> frames;
         Keyframe kf = kfr->getNextKeyframe(GenTime(-1), &ok);
         while (ok) {
             if (kf.second == KeyframeType::Curve) {
@@ -92,13 +95,16 @@ void KeyframeMonitorHelper::refreshParams(int pos)
             } else {
                 types << 0;
             }
-            QString rectData = kfr->getInterpolatedValue(kf.first).toString();
-            QStringList data = rectData.split(QLatin1Char(' '));
+            frames.push_back(kf.first.frames(fps));
+            kf = kfr->getNextKeyframe(kf.first, &ok);
+        }
+        const QVector<QVariant> rects = kfr->getInterpolatedValues(frames);
+        for (const QVariant &rectData : rects) {
+            QStringList data = rectData.toString().split(QLatin1Char(' '));
             if (data.size() > 3) {
                 QRectF r(data.at(0).toInt(), data.at(1).toInt(), data.at(2).toInt(), data.at(3).toInt());
                 points.append(QVariant(r.center()));
             }
-            kf = kfr->getNextKeyframe(kf.first, &ok);
         }
     }
     if (m_monitor) {
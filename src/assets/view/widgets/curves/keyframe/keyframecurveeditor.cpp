@@ -103,7 +103,15 @@ void KeyframeCurveEditor::paintEvent(QPaintEvent *event)
     BPoint point(m_curve.getPoint(0, m_wWidth, m_wHeight, true));
     BPoint newPoint;
     // QPolygonF handle = QPolygonF() << QPointF(0, -3) << QPointF(3, 0) << QPointF(0, 3) << QPointF(-3, 0);
-    QPointF firstPoint = getPointFromModel(offset, offset);
+    // Fetch the whole curve at once instead of one model lookup per pixel
+    std::vector<int> frames;
+    frames.reserve(size_t(qMax(1, m_wWidth)));
+    frames.push_back(offset);
+    for (int i = 1; i < m_wWidth; ++i) {
+        frames.push_back(i * m_duration / m_wWidth + offset);
+    }
+    const QVector<QVariant> values = m_model->getInterpolatedValues(frames, m_paramindex);
+    QPointF firstPoint = getPointFromValue(frames.front(), offset, values.at(0));
     QPointF nextPoint;
     p.setPen(QPen(Qt::gray, 1, Qt::SolidLine));
     p.setBrush(QBrush(QColor(Qt::gray), Qt::SolidPattern));
@@ -123,7 +131,7 @@ void KeyframeCurveEditor::paintEvent(QPaintEvent *event)
         // }
 
         // Draw normal interpolated curve in gray
-        nextPoint = getPointFromModel(i * m_duration / m_wWidth + offset, offset);
+        nextPoint = getPointFromValue(frames.at(size_t(i)), offset, values.at(i));
         // p.drawLine(qMax(0, i - 1), firstPoint.y(), i, nextPoint.y());
         p.drawLine(firstPoint.x(), firstPoint.y(), nextPoint.x(), nextPoint.y());
         firstPoint = nextPoint;
@@ -161,13 +169,13 @@ void KeyframeCurveEditor::paintEvent(QPaintEvent *event)
     }
 }
 
-const QPointF KeyframeCurveEditor::getPointFromModel(int framePos, int offset)
+const QPointF KeyframeCurveEditor::getPointFromValue(int framePos, int offset, const QVariant &value)
 {
     double val;
     if (m_rectindex == -1) {
-        val = m_model->getInterpolatedValue(framePos, m_paramindex).toDouble();
+        val = value.toDouble();
     } else {
-        val = m_model->getInterpolatedValue(framePos, m_paramindex).toString().split(QLatin1Char(' ')).at(m_rectindex).toDouble();
+        val = value.toString().split(QLatin1Char(' ')).at(m_rectindex).toDouble();
     }
     double normalizedx = (double)(framePos - offset) / m_duration * m_wWidth;
     double normalizedy = 0.5; // center the curve when all values are the same
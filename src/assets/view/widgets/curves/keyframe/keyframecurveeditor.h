@@ -96,5 +96,5 @@ private:
     double valueFromCanvasPos(double ypos);
     void updateKeyframeData(double val);
     int seekPosOnCanvas(double xpos);
-    const QPointF getPointFromModel(int framePos, int offset);
+    const QPointF getPointFromValue(int framePos, int offset, const QVariant &value);
 };
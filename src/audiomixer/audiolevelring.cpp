@@ -0,0 +1,89 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "audiolevelring.hpp"
+
+#include <QtGlobal>
+
+AudioLevelRing::AudioLevelRing(int capacity, int channels)
+    : m_capacity(1)
+    , m_channels(qMax(1, channels))
+{
+    while (m_capacity < capacity) {
+        m_capacity *= 2;
+    }
+    m_slots.reset(new Slot[size_t(m_capacity)]);
+    m_values.reset(new std::atomic<double>[size_t(m_capacity) * size_t(m_channels)]);
+    for (int i = 0; i < m_capacity * m_channels; i++) {
+        m_values[size_t(i)].store(0., std::memory_order_relaxed);
+    }
+}
+
+int AudioLevelRing::channels() const
+{
+    return m_channels;
+}
+
+int AudioLevelRing::capacity() const
+{
+    return m_capacity;
+}
+
+void AudioLevelRing::push(int position, const double *levels)
+{
+    const quint64 index = m_written.load(std::memory_order_relaxed);
+    if (index > m_readFrom.load(std::memory_order_relaxed)) {
+        // The same frame is usually notified several times in a row, keep its first levels
+        const Slot &last = m_slots[size_t((index - 1) & quint64(m_capacity - 1))];
+        if (last.position.load(std::memory_order_relaxed) == position) {
+            return;
+        }
+    }
+    const size_t slotIndex = size_t(index & quint64(m_capacity - 1));
+    Slot &slot = m_slots[slotIndex];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.position.store(position, std::memory_order_relaxed);
+    std::atomic<double> *values = m_values.get() + slotIndex * size_t(m_channels);
+    for (int i = 0; i < m_channels; i++) {
+        values[i].store(levels[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    m_written.store(index + 1, std::memory_order_release);
+}
+
+bool AudioLevelRing::read(int position, QVector<double> &levels) const
+{
+    const quint64 written = m_written.load(std::memory_order_acquire);
+    quint64 from = m_readFrom.load(std::memory_order_relaxed);
+    if (written > quint64(m_capacity)) {
+        from = qMax(from, written - quint64(m_capacity));
+    }
+    // Most recent frames first, they are the ones displayed during playback
+    for (quint64 index = written; index > from; index--) {
+        const size_t slotIndex = size_t((index - 1) & quint64(m_capacity - 1));
+        const Slot &slot = m_slots[slotIndex];
+        const quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * index || slot.position.load(std::memory_order_relaxed) != position) {
+            // Overwritten, being written or another frame
+            continue;
+        }
+        levels.resize(m_channels);
+        const std::atomic<double> *values = m_values.get() + slotIndex * size_t(m_channels);
+        for (int i = 0; i < m_channels; i++) {
+            levels[i] = values[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AudioLevelRing::clear()
+{
+    m_readFrom.store(m_written.load(std::memory_order_acquire), std::memory_order_release);
+}
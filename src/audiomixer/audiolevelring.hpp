@@ -0,0 +1,49 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+/** @class AudioLevelRing
+    @brief A preallocated ring of the audio levels computed for the last frames of a track, indexed by frame position.
+    It is written by a single thread (the MLT consumer) and read by a single thread (the GUI), without locks or allocations:
+    each slot is protected by a sequence number, so the reader detects and skips a slot overwritten while it was read.
+    When the ring is full, the oldest levels are overwritten.
+ */
+class AudioLevelRing
+{
+public:
+    /** @param capacity the number of frames kept, rounded up to a power of 2 */
+    AudioLevelRing(int capacity, int channels);
+    int channels() const;
+    int capacity() const;
+    /** @brief Store the levels of @param channels values for a frame. Must only be called from the writer thread */
+    void push(int position, const double *levels);
+    /** @brief Copy the levels stored for a frame in @param levels. Returns false if they are not available.
+        Must only be called from the reader thread */
+    bool read(int position, QVector<double> &levels) const;
+    /** @brief Discard the stored levels, can be called from the reader thread */
+    void clear();
+
+private:
+    struct Slot
+    {
+        /** 2 * index + 1 while the slot is written, 2 * index + 2 when the levels of write index are complete */
+        std::atomic<quint64> sequence{0};
+        std::atomic<int> position{-1};
+    };
+    int m_capacity;
+    int m_channels;
+    std::unique_ptr<Slot[]> m_slots;
+    /** The levels of slot i are stored at i * m_channels */
+    std::unique_ptr<std::atomic<double>[]> m_values;
+    /** Number of frames written since the creation */
+    std::atomic<quint64> m_written{0};
+    /** Frames written before this index were discarded by clear() */
+    std::atomic<quint64> m_readFrom{0};
+};
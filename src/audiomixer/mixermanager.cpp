@@ -56,6 +56,18 @@ MixerManager::MixerManager(QWidget *parent)
     m_box->addWidget(m_masterSeparator);
     m_box->addLayout(m_masterBox);
     setLayout(m_box);
+    // A single connection updates all the track meters for each displayed frame
+    connect(pCore.get(), &Core::updateMixerLevels, this, &MixerManager::updateMixerLevels);
+}
+
+void MixerManager::updateMixerLevels(int pos)
+{
+    if (!m_visibleMixerManager) {
+        return;
+    }
+    for (auto &mixer : m_mixers) {
+        mixer.second->updateAudioLevel(pos);
+    }
 }
 
 void MixerManager::checkAudioLevelVersion()
@@ -113,7 +125,6 @@ void MixerManager::registerTrack(int tid, Mlt::Tractor *service, const QString &
     if (m_visibleMixerManager) {
         mixer->connectMixer(!KdenliveSettings::mixerCollapse());
     }
-    connect(pCore.get(), &Core::updateMixerLevels, mixer.get(), &MixerWidget::updateAudioLevel);
     connect(this, &MixerManager::clearMixers, mixer.get(), &MixerWidget::clear);
     connect(mixer.get(), &MixerWidget::toggleSolo, this, [&](int trid, bool solo) {
         bool additive = qApp->keyboardModifiers().testFlag(Qt::ShiftModifier);
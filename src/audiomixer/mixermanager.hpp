@@ -52,6 +52,8 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void resetSizePolicy();
+    /** @brief Update the audio meters of all tracks for a displayed frame */
+    void updateMixerLevels(int pos);
 
 Q_SIGNALS:
     void updateLevels(int);
@@ -6,6 +6,7 @@
 #include "mixerwidget.hpp"
 
 #include "audiomixer/audiolevels/audiolevelwidget.hpp"
+#include "audiolevelring.hpp"
 #include "audioslider.hpp"
 #include "capture/mediacapture.h"
 #include "core.h"
@@ -42,17 +43,11 @@ void MixerWidget::property_changed(mlt_service, MixerWidget *widget, mlt_event_d
     if (widget && !strcmp(Mlt::EventData(data).to_string(), "_position")) {
         mlt_properties filter_props = MLT_FILTER_PROPERTIES(widget->m_monitorFilter->get_filter());
         int pos = mlt_properties_get_int(filter_props, "_position");
-        if (!widget->m_levels.contains(pos)) {
-            QVector<double> levels;
-            for (int i = 0; i < widget->m_channels; i++) {
-                // NOTE: this is an approximation. To get the real peak level, we need version 2 of audiolevel MLT filter, see property_changedV2
-                levels << log10(mlt_properties_get_double(filter_props, QStringLiteral("_audio_level.%1").arg(i).toUtf8().constData()) / 1.18) * 20;
-            }
-            widget->m_levels[pos] = std::move(levels);
-            if (widget->m_levels.size() > widget->m_maxLevels) {
-                widget->m_levels.erase(widget->m_levels.begin());
-            }
+        for (int i = 0; i < widget->m_channels; i++) {
+            // NOTE: this is an approximation. To get the real peak level, we need version 2 of audiolevel MLT filter, see property_changedV2
+            widget->m_pendingLevels[size_t(i)] = log10(mlt_properties_get_double(filter_props, widget->m_levelKeys.at(size_t(i)).constData()) / 1.18) * 20;
         }
+        widget->m_levels->push(pos, widget->m_pendingLevels.data());
     }
 }
 
@@ -61,16 +56,10 @@ void MixerWidget::property_changedV2(mlt_service, MixerWidget *widget, mlt_event
     if (widget && !strcmp(Mlt::EventData(data).to_string(), "_position")) {
         mlt_properties filter_props = MLT_FILTER_PROPERTIES(widget->m_monitorFilter->get_filter());
         int pos = mlt_properties_get_int(filter_props, "_position");
-        if (!widget->m_levels.contains(pos)) {
-            QVector<double> levels;
-            for (int i = 0; i < widget->m_channels; i++) {
-                levels << mlt_properties_get_double(filter_props, QStringLiteral("_audio_level.%1").arg(i).toUtf8().constData());
-            }
-            widget->m_levels[pos] = std::move(levels);
-            if (widget->m_levels.size() > widget->m_maxLevels) {
-                widget->m_levels.erase(widget->m_levels.begin());
-            }
+        for (int i = 0; i < widget->m_channels; i++) {
+            widget->m_pendingLevels[size_t(i)] = mlt_properties_get_double(filter_props, widget->m_levelKeys.at(size_t(i)).constData());
         }
+        widget->m_levels->push(pos, widget->m_pendingLevels.data());
     }
 }
 
@@ -85,6 +74,7 @@ MixerWidget::MixerWidget(int tid, Mlt::Tractor *service, QString trackTag, const
     , m_balanceSpin(nullptr)
     , m_balanceSlider(nullptr)
     , m_maxLevels(qMax(30, int(service->get_fps() * 1.5)))
+    , m_levels(new AudioLevelRing(m_maxLevels, m_channels))
     , m_solo(nullptr)
     , m_collapse(nullptr)
     , m_monitor(nullptr)
@@ -96,6 +86,11 @@ MixerWidget::MixerWidget(int tid, Mlt::Tractor *service, QString trackTag, const
     , m_trackTag(std::move(trackTag))
     , m_backgroundColorRole(QPalette::Base)
 {
+    // Build the property names once, they are read for each frame in the MLT thread
+    for (int i = 0; i < m_channels; i++) {
+        m_levelKeys.push_back(QStringLiteral("_audio_level.%1").arg(i).toUtf8());
+    }
+    m_pendingLevels.resize(size_t(m_channels));
     buildUI(service, trackName);
 }
 
@@ -453,7 +448,7 @@ void MixerWidget::setupConnections()
             m_volumeSpin->setValue(dbValue);
             m_levelFilter->set("level", dbValue);
             m_levelFilter->set("disable", value == 60 ? 1 : 0);
-            m_levels.clear();
+            m_levels->clear();
             Q_EMIT m_manager->purgeCache();
             pCore->setDocumentModified();
         }
@@ -477,7 +472,7 @@ void MixerWidget::setupConnections()
             if (m_balanceFilter != nullptr) {
                 m_balanceFilter->set("start", (value + 50) / 100.);
                 m_balanceFilter->set("disable", value == 0 ? 1 : 0);
-                m_levels.clear();
+                m_levels->clear();
                 Q_EMIT m_manager->purgeCache();
                 pCore->setDocumentModified();
             }
@@ -565,10 +560,8 @@ void MixerWidget::updateTrackLabelStyle()
 
 void MixerWidget::updateAudioLevel(int pos)
 {
-    QMutexLocker lk(&m_storeMutex);
-    if (m_levels.contains(pos)) {
-        m_audioMeterWidget->setAudioValues(m_levels.value(pos));
-        // m_levels.remove(pos);
+    if (m_levels->read(pos, m_displayLevels)) {
+        m_audioMeterWidget->setAudioValues(m_displayLevels);
     } else {
         m_audioMeterWidget->setAudioValues(m_audioData);
     }
@@ -576,15 +569,13 @@ void MixerWidget::updateAudioLevel(int pos)
 
 void MixerWidget::reset()
 {
-    QMutexLocker lk(&m_storeMutex);
-    m_levels.clear();
+    m_levels->clear();
     m_audioMeterWidget->reset();
 }
 
 void MixerWidget::clear()
 {
-    QMutexLocker lk(&m_storeMutex);
-    m_levels.clear();
+    m_levels->clear();
 }
 
 bool MixerWidget::isMute() const
@@ -8,10 +8,11 @@
 #include "mlt++/MltService.h"
 
 #include <QAbstractSpinBox>
-#include <QMutex>
 #include <QWidget>
 #include <memory>
+#include <vector>
 
+class AudioLevelRing;
 class KDualAction;
 class AudioLevelWidget;
 class AudioSlider;
@@ -75,13 +76,20 @@ protected:
     std::shared_ptr<Mlt::Filter> m_levelFilter;
     std::shared_ptr<Mlt::Filter> m_monitorFilter;
     std::shared_ptr<Mlt::Filter> m_balanceFilter;
-    QMap<int, QVector<double>> m_levels;
     int m_channels;
     KDualAction *m_muteAction;
     StyledSpinBox *m_balanceSpin;
     AudioSlider *m_balanceSlider;
     StyledDoubleSpinBox *m_volumeSpin;
     int m_maxLevels;
+    /** @brief Audio levels of the last frames, written in the MLT thread and read in the GUI thread */
+    std::unique_ptr<AudioLevelRing> m_levels;
+    /** @brief The names of the level properties of each channel in the audiolevel filter */
+    std::vector<QByteArray> m_levelKeys;
+    /** @brief Levels being read in the MLT thread */
+    std::vector<double> m_pendingLevels;
+    /** @brief Levels being displayed, reused to avoid allocations */
+    QVector<double> m_displayLevels;
 
 private:
     std::shared_ptr<AudioLevelWidget> m_audioMeterWidget;
@@ -92,7 +100,6 @@ private:
     QToolButton *m_muteButton;
     QToolButton *m_showEffects;
     KSqueezedTextLabel *m_trackLabel;
-    QMutex m_storeMutex;
     double m_lastVolume;
     QVector<double> m_audioData;
     Mlt::Event *m_listener;
@@ -22,9 +22,25 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QRegularExpression>
+#include <QSaveFile>
 #include <QStringConverter>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
 #include <utility>
 
+namespace {
+bool writeSubtitleFile(const QString &path, const QByteArray &content)
+{
+    // Replace the file atomically, the filter may read it at any time
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit()) {
+        qWarning() << "Cannot write subtitle file" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+} // namespace
+
 SubtitleModel::SubtitleModel(std::shared_ptr<TimelineItemModel> timeline, const std::weak_ptr<SnapInterface> &snapModel, QObject *parent)
     : QAbstractListModel(parent)
     , m_timeline(timeline)
@@ -39,7 +55,26 @@ SubtitleModel::SubtitleModel(std::shared_ptr<TimelineItemModel> timeline, const
         m_subtitleFilter->set("internal_added", 237);
     }
     setup();
-    connect(this, &SubtitleModel::modelChanged, [this]() { jsontoSubtitle(toJson()); });
+    // Changes are coalesced, so that typing in a subtitle or editing many items doesn't rewrite the whole file each time
+    m_fileUpdateTimer.setSingleShot(true);
+    m_fileUpdateTimer.setInterval(200);
+    connect(&m_fileUpdateTimer, &QTimer::timeout, this, [this]() { updateSubtitleFile(false); });
+    connect(&m_fileWriter, &QFutureWatcher<bool>::finished, this, [this]() {
+        if (m_writingFile.isEmpty()) {
+            // Already handled by a synchronous update
+            return;
+        }
+        if (!m_fileWriter.result()) {
+            m_writtenHash = 0;
+        }
+        applySubtitleFile(m_writingFile, m_writingLines);
+        m_writingFile.clear();
+        pCore->refreshProjectMonitorOnce();
+        if (m_fileUpdatePending) {
+            updateSubtitleFile(false);
+        }
+    });
+    connect(this, &SubtitleModel::modelChanged, &m_fileUpdateTimer, qOverload<>(&QTimer::start));
 
     const QUuid timelineUuid = timeline->uuid();
     int id = pCore->currentDoc()->getSequenceProperty(timelineUuid, QStringLiteral("kdenlive:activeSubtitleIndex"), QStringLiteral("0")).toInt();
@@ -122,6 +157,7 @@ void SubtitleModel::setup()
 
 void SubtitleModel::unsetModel()
 {
+    syncSubtitleFile();
     m_timeline.reset();
 }
 
@@ -489,6 +525,7 @@ bool SubtitleModel::addSubtitle(int id, std::pair<int, GenTime> start, const Sub
     // Strip all leading and trailing whitespaces from the text, to e.g. avoid bogus exports with
     // leading newlines to SRT.
     m_subtitleList[start].setText(event.text().trimmed());
+    updateMaxDuration(start);
 
     endInsertRows();
     addSnapPoint(start.second);
@@ -642,18 +679,24 @@ std::unordered_set<int> SubtitleModel::getItemsInRange(int layer, int startFrame
     GenTime startTime(startFrame, pCore->getCurrentFps());
     GenTime endTime(endFrame, pCore->getCurrentFps());
     std::unordered_set<int> matching;
-    for (const auto &subtitles : m_subtitleList) {
-        // if layer is -1, we check all layers
-        if ((endFrame > -1 && subtitles.first.second > endTime) || (layer != -1 && subtitles.first.first != layer)) {
-            // Outside range
-            continue;
-        }
-        if (subtitles.first.second >= startTime || subtitles.second.endTime() > startTime) {
-            int sid = getIdForStartPos(layer, subtitles.first.second);
-            if (sid > -1) {
-                matching.emplace(sid);
-            } else {
-                qDebug() << "==== FOUND INVALID SUBTITLE AT: " << subtitles.first.second.frames(pCore->getCurrentFps());
+    // if layer is -1, we check all layers
+    const int firstLayer = layer == -1 ? 0 : layer;
+    const int lastLayer = layer > -1 ? layer : (m_subtitleList.empty() ? -1 : m_subtitleList.rbegin()->first.first);
+    for (int l = firstLayer; l <= lastLayer; l++) {
+        // Subtitles starting before the range can only cover it if they start less than the longest duration before
+        auto it = m_subtitleList.lower_bound({l, startTime - m_maxDuration});
+        for (; it != m_subtitleList.end() && it->first.first == l; ++it) {
+            if (endFrame > -1 && it->first.second > endTime) {
+                // Outside range
+                break;
+            }
+            if (it->first.second >= startTime || it->second.endTime() > startTime) {
+                auto sid = m_idForStart.find(it->first);
+                if (sid != m_idForStart.end()) {
+                    matching.emplace(sid->second);
+                } else {
+                    qDebug() << "==== FOUND INVALID SUBTITLE AT: " << it->first.second.frames(pCore->getCurrentFps());
+                }
             }
         }
     }
@@ -785,6 +828,7 @@ void SubtitleModel::editEndPos(int layer, GenTime startPos, GenTime newEndPos, b
         return;
     }
     m_subtitleList[{layer, startPos}].setEndTime(newEndPos);
+    updateMaxDuration({layer, startPos});
     // Trigger update of the qml view
     int id = getIdForStartPos(layer, startPos);
     int row = getSubtitleIndex(id);
@@ -849,6 +893,7 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
         GenTime newEndPos = startPos.second + GenTime(size, pCore->getCurrentFps());
         operation = [this, id, startPos, endPos, newEndPos, logUndo]() {
             m_subtitleList[startPos].setEndTime(newEndPos);
+            updateMaxDuration(startPos);
             removeSnapPoint(endPos);
             addSnapPoint(newEndPos);
             // Trigger update of the qml view
@@ -869,6 +914,7 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
         };
         reverse = [this, id, startPos, endPos, newEndPos, logUndo]() {
             m_subtitleList[startPos].setEndTime(endPos);
+            updateMaxDuration(startPos);
             removeSnapPoint(newEndPos);
             addSnapPoint(endPos);
             // Trigger update of the qml view
@@ -895,9 +941,10 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
         }
         const SubtitleEvent event = m_subtitleList.at(startPos);
         operation = [this, id, startPos, newStartPos, event, logUndo]() {
-            m_allSubtitles[id] = newStartPos;
+            setSubtitleStart(id, newStartPos);
             m_subtitleList.erase(startPos);
             m_subtitleList[newStartPos] = event;
+            updateMaxDuration(newStartPos);
             // Trigger update of the qml view
             removeSnapPoint(startPos.second);
             addSnapPoint(newStartPos.second);
@@ -917,9 +964,10 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
             return true;
         };
         reverse = [this, id, startPos, newStartPos, event, logUndo]() {
-            m_allSubtitles[id] = startPos;
+            setSubtitleStart(id, startPos);
             m_subtitleList.erase(newStartPos);
             m_subtitleList[startPos] = event;
+            updateMaxDuration(startPos);
             removeSnapPoint(newStartPos.second);
             addSnapPoint(startPos.second);
             // Trigger update of the qml view
@@ -1050,7 +1098,7 @@ bool SubtitleModel::moveSubtitle(int subId, int newLayer, GenTime newPos, bool u
     if (newLayer > m_maxLayer) {
         setMaxLayer(newLayer);
     }
-    m_allSubtitles[id] = {newLayer, newPos};
+    setSubtitleStart(id, {newLayer, newPos});
     m_subtitleList.erase({oldLayer, oldPos});
     m_subtitleList[{newLayer, newPos}] = event;
     m_subtitleList[{newLayer, newPos}].setEndTime(endPos);
@@ -1081,13 +1129,20 @@ bool SubtitleModel::moveSubtitle(int subId, int newLayer, GenTime newPos, bool u
 
 int SubtitleModel::getIdForStartPos(int layer, GenTime startTime) const
 {
-    auto findResult = std::find_if(std::begin(m_allSubtitles), std::end(m_allSubtitles), [&](const std::pair<int, std::pair<int, GenTime>> &pair) {
-        return pair.second.second == startTime && (pair.second.first == layer || layer == -1);
-    });
-    if (findResult != std::end(m_allSubtitles)) {
-        return findResult->first;
+    if (layer > -1) {
+        auto it = m_idForStart.find({layer, startTime});
+        return it == m_idForStart.end() ? -1 : it->second;
+    }
+    // Any layer, return the lowest id like a search in m_allSubtitles would
+    int id = -1;
+    const int lastLayer = m_subtitleList.empty() ? -1 : m_subtitleList.rbegin()->first.first;
+    for (int l = 0; l <= lastLayer; l++) {
+        auto it = m_idForStart.find({l, startTime});
+        if (it != m_idForStart.end() && (id == -1 || it->second < id)) {
+            id = it->second;
+        }
     }
-    return -1;
+    return id;
 }
 
 int SubtitleModel::getLayerForId(int id) const
@@ -1110,13 +1165,10 @@ int SubtitleModel::getPreviousSub(int id) const
 {
     GenTime start = getStartPosForId(id);
     int layer = getLayerForId(id);
-    int row = static_cast<int>(std::distance(m_subtitleList.begin(), m_subtitleList.find({layer, start})));
-    if (row > 0) {
-        row--;
-        auto it = m_subtitleList.begin();
-        std::advance(it, row);
-        const GenTime res = it->first.second;
-        return getIdForStartPos(layer, res);
+    auto it = m_subtitleList.find({layer, start});
+    if (it != m_subtitleList.begin()) {
+        --it;
+        return getIdForStartPos(layer, it->first.second);
     }
     return -1;
 }
@@ -1125,13 +1177,9 @@ int SubtitleModel::getNextSub(int id) const
 {
     GenTime start = getStartPosForId(id);
     int layer = getLayerForId(id);
-    int row = static_cast<int>(std::distance(m_subtitleList.begin(), m_subtitleList.find({layer, start})));
-    if (row < static_cast<int>(m_subtitleList.size()) - 1) {
-        row++;
-        auto it = m_subtitleList.begin();
-        std::advance(it, row);
-        const GenTime res = it->first.second;
-        return getIdForStartPos(layer, res);
+    auto it = m_subtitleList.find({layer, start});
+    if (it != m_subtitleList.end() && ++it != m_subtitleList.end()) {
+        return getIdForStartPos(layer, it->first.second);
     }
     return -1;
 }
@@ -1187,6 +1235,7 @@ const QJsonArray SubtitleModel::toJson()
 
 void SubtitleModel::copySubtitle(const QString &path, int ix, bool checkOverwrite, bool updateFilter)
 {
+    syncSubtitleFile();
     QFile srcFile(pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false));
     if (srcFile.exists()) {
         QFile prev(path);
@@ -1224,6 +1273,8 @@ void SubtitleModel::jsontoSubtitle(const QJsonArray &data)
         m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
     }
     int line = saveSubtitleData(data, outFile);
+    // The file was written outside of the incremental updates
+    m_writtenHash = 0;
     qDebug() << "Saving subtitle filter: " << outFile;
     if (line > 0) {
         m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
@@ -1250,34 +1301,7 @@ int SubtitleModel::saveSubtitleData(const QJsonArray &list, const QString &outFi
     if (outF.open(QIODevice::WriteOnly)) {
         QTextStream out(&outF);
         if (assFormat) {
-            out << QStringLiteral("[Script Info]\n; Script generated by Kdenlive %1\n").arg(KDENLIVE_VERSION);
-            for (const auto &entry : std::as_const(m_scriptInfo)) {
-                out << entry.first + ": " + entry.second + '\n';
-            }
-            out << '\n';
-
-            out << "[Kdenlive Extradata]\n";
-            out << "MaxLayer: " + QString::number(getMaxLayer()) + '\n';
-            QString defaultStyles;
-            for (const auto &style : std::as_const(m_defaultStyles)) {
-                defaultStyles += style + ',';
-            }
-            defaultStyles.chop(1);
-            out << "DefaultStyles: " + defaultStyles + '\n';
-
-            out << '\n';
-
-            out << QStringLiteral("[V4+ Styles]\nFormat: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, OutlineColour, BackColour, Bold, "
-                                  "Italic, Underline, StrikeOut, "
-                                  "ScaleX, ScaleY, Spacing, Angle, BorderStyle, Outline, Shadow, Alignment, MarginL, MarginR, MarginV, Encoding\n");
-            for (const auto &entry : std::as_const(m_subtitleStyles)) {
-                out << entry.second.toString(entry.first) << '\n';
-            }
-            out << '\n';
-
-            if (!fontSection.isEmpty()) out << fontSection << '\n';
-
-            out << QStringLiteral("[Events]\nFormat: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n");
+            out << assHeader();
         }
         for (const auto &entry : std::as_const(list)) {
             if (!entry.isObject()) {
@@ -1312,6 +1336,120 @@ int SubtitleModel::saveSubtitleData(const QJsonArray &list, const QString &outFi
     return line;
 }
 
+QString SubtitleModel::assHeader() const
+{
+    QString header = QStringLiteral("[Script Info]\n; Script generated by Kdenlive %1\n").arg(KDENLIVE_VERSION);
+    for (const auto &entry : std::as_const(m_scriptInfo)) {
+        header += entry.first + ": " + entry.second + '\n';
+    }
+    header += '\n';
+
+    header += "[Kdenlive Extradata]\n";
+    header += "MaxLayer: " + QString::number(getMaxLayer()) + '\n';
+    QString defaultStyles;
+    for (const auto &style : std::as_const(m_defaultStyles)) {
+        defaultStyles += style + ',';
+    }
+    defaultStyles.chop(1);
+    header += "DefaultStyles: " + defaultStyles + '\n';
+
+    header += '\n';
+
+    header += QStringLiteral("[V4+ Styles]\nFormat: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, OutlineColour, BackColour, Bold, "
+                             "Italic, Underline, StrikeOut, "
+                             "ScaleX, ScaleY, Spacing, Angle, BorderStyle, Outline, Shadow, Alignment, MarginL, MarginR, MarginV, Encoding\n");
+    for (const auto &entry : std::as_const(m_subtitleStyles)) {
+        header += entry.second.toString(entry.first) + '\n';
+    }
+    header += '\n';
+
+    if (!fontSection.isEmpty()) {
+        header += fontSection + '\n';
+    }
+
+    header += QStringLiteral("[Events]\nFormat: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n");
+    return header;
+}
+
+QByteArray SubtitleModel::subtitleFileContent(int &lines) const
+{
+    // Events are serialized directly from the model, without the json round trip and re-parsing of saveSubtitleData
+    READ_LOCK();
+    QString content = assHeader();
+    for (const auto &subtitle : m_subtitleList) {
+        QString dialogue = subtitle.second.toString(subtitle.first.first, subtitle.first.second);
+        dialogue.replace(QLatin1Char('\n'), QStringLiteral("\\N"));
+        content += dialogue + '\n';
+    }
+    lines = int(m_subtitleList.size());
+    return content.toUtf8();
+}
+
+void SubtitleModel::updateSubtitleFile(bool synchronous)
+{
+    if (!m_timeline || !pCore->currentDoc()) {
+        return;
+    }
+    if (m_fileWriter.isRunning()) {
+        if (!synchronous) {
+            // Write again when the current write is finished
+            m_fileUpdatePending = true;
+            return;
+        }
+        m_fileWriter.waitForFinished();
+        if (!m_writingFile.isEmpty()) {
+            applySubtitleFile(m_writingFile, m_writingLines);
+            m_writingFile.clear();
+        }
+    }
+    m_fileUpdatePending = false;
+    int ix = pCore->currentDoc()->getSequenceProperty(m_timeline->uuid(), QStringLiteral("kdenlive:activeSubtitleIndex"), QStringLiteral("0")).toInt();
+    const QString outFile = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false);
+    int lines = 0;
+    const QByteArray content = subtitleFileContent(lines);
+    const size_t hash = qHash(content);
+    if (outFile == m_writtenFile && hash == m_writtenHash) {
+        // Nothing changed in the file, for example after a selection change
+        return;
+    }
+    m_writtenFile = outFile;
+    m_writtenHash = hash;
+    if (synchronous) {
+        if (!writeSubtitleFile(outFile, content)) {
+            m_writtenHash = 0;
+        }
+        applySubtitleFile(outFile, lines);
+        return;
+    }
+    m_writingFile = outFile;
+    m_writingLines = lines;
+    m_fileWriter.setFuture(QtConcurrent::run(writeSubtitleFile, outFile, content));
+}
+
+void SubtitleModel::syncSubtitleFile()
+{
+    if (m_fileUpdateTimer.isActive() || m_fileUpdatePending || m_fileWriter.isRunning()) {
+        m_fileUpdateTimer.stop();
+        updateSubtitleFile(true);
+    }
+}
+
+void SubtitleModel::applySubtitleFile(const QString &outFile, int lines)
+{
+    if (!m_timeline) {
+        return;
+    }
+    if (lines > 0) {
+        m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
+        m_timeline->tractor()->attach(*m_subtitleFilter.get());
+    } else {
+        if (QString(m_subtitleFilter->get("av.filename")).isEmpty()) {
+            m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
+        }
+        m_timeline->tractor()->detach(*m_subtitleFilter.get());
+    }
+}
+
 void SubtitleModel::updateSub(int id, const QVector<int> &roles)
 {
     int row = getSubtitleIndex(id);
@@ -1898,6 +2036,7 @@ int SubtitleModel::createNewSubtitle(const QString subtitleName, int id)
     m_subtitlesList.insert({maxIx, newName}, newPath);
     if (id >= 0) {
         // Duplicate existing subtitle
+        syncSubtitleFile();
         QString source = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), id, false);
         if (!QFile::exists(source)) {
             source = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), id, true);
@@ -1970,6 +2109,8 @@ void SubtitleModel::activateSubtitle(int ix)
     // QStringLiteral("0")).toInt(); if (currentIx == ix) {
     //     return;
     // }
+    // Save the edits of the current subtitle before switching
+    syncSubtitleFile();
     const QString workPath = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false);
     const QString finalPath = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, true);
     if (!QFile::exists(workPath) && QFile::exists(finalPath)) {
@@ -1988,8 +2129,9 @@ void SubtitleModel::activateSubtitle(int ix)
     m_maxLayer = 0;
     m_defaultStyles.clear();
     while (!m_allSubtitles.empty()) {
-        deregisterSubtitle(m_allSubtitles.begin()->first);
+        deregisterSubtitle(m_allSubtitles.rbegin()->first);
     }
+    m_maxDuration = GenTime();
     endRemoveRows();
     pCore->currentDoc()->setSequenceProperty(m_timeline->uuid(), QStringLiteral("kdenlive:activeSubtitleIndex"), ix);
     parseSubtitle(workPath);
@@ -2012,6 +2154,8 @@ void SubtitleModel::registerSubtitle(int id, std::pair<int, GenTime> startpos, b
 {
     Q_ASSERT(m_allSubtitles.count(id) == 0);
     m_allSubtitles.emplace(id, startpos);
+    m_rowIds.insert(std::lower_bound(m_rowIds.begin(), m_rowIds.end(), id), id);
+    m_idForStart[startpos] = id;
     if (!temporary) {
         m_timeline->m_groups->createGroupItem(id);
     }
@@ -2023,15 +2167,39 @@ void SubtitleModel::deregisterSubtitle(int id, bool temporary)
     if (!temporary && isSelected(id)) {
         m_timeline->requestClearSelection(true);
     }
+    auto start = m_idForStart.find(m_allSubtitles.at(id));
+    if (start != m_idForStart.end() && start->second == id) {
+        m_idForStart.erase(start);
+    }
+    m_rowIds.erase(std::lower_bound(m_rowIds.begin(), m_rowIds.end(), id));
     m_allSubtitles.erase(id);
     if (!temporary) {
         m_timeline->m_groups->destructGroupItem(id);
     }
 }
 
+void SubtitleModel::setSubtitleStart(int id, std::pair<int, GenTime> start)
+{
+    auto previous = m_idForStart.find(m_allSubtitles.at(id));
+    if (previous != m_idForStart.end() && previous->second == id) {
+        m_idForStart.erase(previous);
+    }
+    m_allSubtitles[id] = start;
+    m_idForStart[start] = id;
+}
+
+void SubtitleModel::updateMaxDuration(const std::pair<int, GenTime> &start)
+{
+    // Never decreased when subtitles are shortened or removed, it only needs to be an upper bound
+    const GenTime duration = m_subtitleList.at(start).endTime() - start.second;
+    if (duration > m_maxDuration) {
+        m_maxDuration = duration;
+    }
+}
+
 int SubtitleModel::positionForIndex(int id) const
 {
-    return int(std::distance(m_allSubtitles.begin(), m_allSubtitles.find(id)));
+    return getSubtitleIndex(id);
 }
 
 bool SubtitleModel::hasSubtitle(int id) const
@@ -2051,33 +2219,28 @@ GenTime SubtitleModel::getPosition(int id) const
 
 int SubtitleModel::getSubtitleIndex(int subId) const
 {
-    if (m_allSubtitles.count(subId) == 0) {
+    // Rows are ordered by id
+    auto it = std::lower_bound(m_rowIds.cbegin(), m_rowIds.cend(), subId);
+    if (it == m_rowIds.cend() || *it != subId) {
         return -1;
     }
-    auto it = m_allSubtitles.find(subId);
-    return int(std::distance(m_allSubtitles.begin(), it));
+    return int(std::distance(m_rowIds.cbegin(), it));
 }
 
 std::pair<int, std::pair<int, GenTime>> SubtitleModel::getSubtitleIdFromIndex(int index) const
 {
-    if (index >= static_cast<int>(m_allSubtitles.size())) {
+    if (index < 0 || index >= static_cast<int>(m_rowIds.size())) {
         return {-1, {-1, GenTime()}};
     }
-    auto it = m_allSubtitles.begin();
-    std::advance(it, index);
-    return {it->first, it->second};
+    const int id = m_rowIds.at(size_t(index));
+    return {id, m_allSubtitles.at(id)};
 }
 
 int SubtitleModel::getSubtitleIdByPosition(int layer, int pos)
 {
     GenTime startTime(pos, pCore->getCurrentFps());
-    auto findResult = std::find_if(std::begin(m_allSubtitles), std::end(m_allSubtitles), [&](const std::pair<int, std::pair<int, GenTime>> &pair) {
-        return pair.second.second == startTime && pair.second.first == layer;
-    });
-    if (findResult != std::end(m_allSubtitles)) {
-        return findResult->first;
-    }
-    return -1;
+    auto it = m_idForStart.find({layer, startTime});
+    return it == m_idForStart.end() ? -1 : it->second;
 }
 
 int SubtitleModel::getSubtitleIdAtPosition(int layer, int pos)
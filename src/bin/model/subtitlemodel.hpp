@@ -9,7 +9,9 @@
 #include "undohelper.hpp"
 
 #include <QAbstractListModel>
+#include <QFutureWatcher>
 #include <QReadWriteLock>
+#include <QTimer>
 
 #include <map>
 #include <memory>
@@ -280,6 +282,8 @@ public:
     /** @brief Get default styles for subtitle layers */
     const QString getLayerDefaultStyle(int layer) const;
     int saveSubtitleData(const QJsonArray &data, const QString &outFile);
+    /** @brief Write the pending changes to the subtitle work file now. Must be called before the work file is read or copied */
+    void syncSubtitleFile();
 
 public Q_SLOTS:
     /** @brief Function that parses through a subtitle file */
@@ -301,6 +305,12 @@ private:
     QMap<std::pair<int, QString>, QString> m_subtitlesList;
     /** @brief A list of subtitles as: item id, layer, start time */
     std::map<int, std::pair<int, GenTime>> m_allSubtitles;
+    /** @brief The ids of the subtitles in row order (sorted like m_allSubtitles), so that row lookups don't walk the map */
+    std::vector<int> m_rowIds;
+    /** @brief The id of the subtitle for each layer, start time */
+    std::map<std::pair<int, GenTime>, int> m_idForStart;
+    /** @brief An upper bound of the subtitle durations, to limit the search of the subtitles covering a position */
+    GenTime m_maxDuration;
     /** @brief The max layer in the subtitle model */
     int m_maxLayer{0};
     /** @brief Default styles for subtitle layers */
@@ -321,6 +331,32 @@ private:
     QVector<int> m_selected;
     QVector<int> m_grabbedIds;
     int m_activeSubLayer{0};
+    /** @brief Coalesces the model changes before the subtitle work file is written */
+    QTimer m_fileUpdateTimer;
+    /** @brief Writes the subtitle work file in a background thread */
+    QFutureWatcher<bool> m_fileWriter;
+    /** @brief The file being written by m_fileWriter and its number of dialogues, applied to the filter when written */
+    QString m_writingFile;
+    int m_writingLines{0};
+    /** @brief The last content written to the work file, to skip writes and filter reloads that would not change anything */
+    QString m_writtenFile;
+    size_t m_writtenHash{0};
+    /** @brief The model changed while the work file was being written */
+    bool m_fileUpdatePending{false};
+
+    /** @brief Change the layer, start time of a registered subtitle in the id lookups */
+    void setSubtitleStart(int id, std::pair<int, GenTime> start);
+    /** @brief Take the duration of the subtitle at @param start into account in m_maxDuration */
+    void updateMaxDuration(const std::pair<int, GenTime> &start);
+    /** @brief Returns the header of an ass file (script info, styles and fonts) */
+    QString assHeader() const;
+    /** @brief Returns the content of the ass file for the current events, and their count in @param lines */
+    QByteArray subtitleFileContent(int &lines) const;
+    /** @brief Write the work file used by the filter from the current events
+     *  @param synchronous if false, the file is written in a background thread and the filter updated when it is done */
+    void updateSubtitleFile(bool synchronous);
+    /** @brief Load a written work file in the subtitle filter */
+    void applySubtitleFile(const QString &outFile, int lines);
 
 Q_SIGNALS:
     void modelChanged();
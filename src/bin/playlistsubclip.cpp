@@ -79,6 +79,11 @@ const QString PlaylistSubClip::cutClipId() const
     return QString("%1/%2/%3").arg(m_parentClipId).arg(m_inPoint).arg(m_outPoint);
 }
 
+void PlaylistSubClip::gotApproximateThumb(int pos, const QImage &img)
+{
+    m_approximateThumbs.insert(pos, img);
+}
+
 void PlaylistSubClip::gotThumb(int pos, const QImage &img)
 {
     if (pos == m_inPoint) {
@@ -203,9 +208,11 @@ void PlaylistSubClip::getThumbFromPercent(int percent)
     framePos -= framePos % steps;
     if (ThumbnailCache::get()->hasThumbnail(m_parentClipId, m_inPoint + framePos)) {
         setThumbnail(ThumbnailCache::get()->getThumbnail(m_parentClipId, m_inPoint + framePos));
+    } else if (m_approximateThumbs.contains(m_inPoint + framePos)) {
+        setThumbnail(m_approximateThumbs.value(m_inPoint + framePos));
     } else {
         // Generate percent thumbs
-        CacheTask::start(ObjectId(KdenliveObjectType::BinClip, m_parentClipId.toInt(), QUuid()), 30, m_inPoint, m_outPoint, this);
+        CacheTask::start(ObjectId(KdenliveObjectType::BinClip, m_parentClipId.toInt(), QUuid()), 30, m_inPoint, m_outPoint, this, false, false);
     }
 }
 
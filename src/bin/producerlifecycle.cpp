@@ -0,0 +1,163 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "producerlifecycle.hpp"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+ProducerLifecycle::ProducerLifecycle(std::function<bool(const QString &binId)> release, QObject *parent)
+    : QObject(parent)
+    , m_release(std::move(release))
+{
+    m_budgetTimer.setInterval(1000);
+    m_budgetTimer.setSingleShot(true);
+    connect(&m_budgetTimer, &QTimer::timeout, this, [this]() { enforceBudget(); });
+}
+
+void ProducerLifecycle::touch(const QString &binId, qint64 memory)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_released.remove(binId)) {
+        m_reopenCount++;
+    }
+    auto it = m_open.find(binId);
+    if (it == m_open.end()) {
+        m_open.insert(binId, {++m_clock, memory});
+        m_memory += memory;
+    } else {
+        it->lastUsed = ++m_clock;
+        m_memory += memory - it->memory;
+        it->memory = memory;
+    }
+    if (m_budget > 0 && m_open.size() > m_budget) {
+        QMetaObject::invokeMethod(&m_budgetTimer, static_cast<void (QTimer::*)()>(&QTimer::start), Qt::QueuedConnection);
+    }
+}
+
+void ProducerLifecycle::remove(const QString &binId)
+{
+    QMutexLocker lock(&m_mutex);
+    m_released.remove(binId);
+    auto it = m_open.find(binId);
+    if (it != m_open.end()) {
+        m_memory -= it->memory;
+        m_open.erase(it);
+    }
+}
+
+void ProducerLifecycle::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_open.clear();
+    m_released.clear();
+    m_memory = 0;
+    m_releaseCount = 0;
+    m_reopenCount = 0;
+}
+
+void ProducerLifecycle::setBudget(int maxOpen)
+{
+    QMutexLocker lock(&m_mutex);
+    m_budget = qMax(0, maxOpen);
+    if (m_budget > 0 && m_open.size() > m_budget) {
+        QMetaObject::invokeMethod(&m_budgetTimer, static_cast<void (QTimer::*)()>(&QTimer::start), Qt::QueuedConnection);
+    }
+}
+
+int ProducerLifecycle::enforceBudget()
+{
+    std::vector<std::pair<quint64, QString>> candidates;
+    int excess = 0;
+    {
+        QMutexLocker lock(&m_mutex);
+        excess = m_budget > 0 ? int(m_open.size()) - m_budget : 0;
+        if (excess <= 0) {
+            return 0;
+        }
+        candidates.reserve(size_t(m_open.size()));
+        for (auto it = m_open.cbegin(); it != m_open.cend(); ++it) {
+            candidates.emplace_back(it->lastUsed, it.key());
+        }
+    }
+    // Least recently used first
+    std::sort(candidates.begin(), candidates.end());
+    int released = 0;
+    // The callback is called without holding the mutex, since it can take the clip locks
+    for (const auto &candidate : candidates) {
+        if (released >= excess) {
+            break;
+        }
+        {
+            QMutexLocker lock(&m_mutex);
+            auto it = m_open.find(candidate.second);
+            if (it == m_open.end() || it->lastUsed != candidate.first) {
+                // Removed or used again in the meantime
+                continue;
+            }
+        }
+        if (!m_release(candidate.second)) {
+            continue;
+        }
+        QMutexLocker lock(&m_mutex);
+        auto it = m_open.find(candidate.second);
+        if (it != m_open.end()) {
+            m_memory -= it->memory;
+            m_open.erase(it);
+        }
+        m_released.insert(candidate.second);
+        m_releaseCount++;
+        released++;
+    }
+    if (released > 0) {
+        qDebug() << "::: Released" << released << "idle producers," << openCount() << "still open";
+    }
+    return released;
+}
+
+bool ProducerLifecycle::isOpen(const QString &binId) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_open.contains(binId);
+}
+
+int ProducerLifecycle::openCount() const
+{
+    QMutexLocker lock(&m_mutex);
+    return int(m_open.size());
+}
+
+qint64 ProducerLifecycle::openMemory() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_memory;
+}
+
+int ProducerLifecycle::releaseCount() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_releaseCount;
+}
+
+int ProducerLifecycle::reopenCount() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_reopenCount;
+}
+
+// static
+qint64 ProducerLifecycle::estimateMemory(int width, int height, bool hasVideo)
+{
+    // Demuxer, io buffers and audio decoder
+    qint64 memory = 2 * 1024 * 1024;
+    if (hasVideo && width > 0 && height > 0) {
+        // Decoder reference frames and the producer image cache, in 4:2:0
+        memory += qint64(width) * height * 3 / 2 * 8;
+    }
+    return memory;
+}
@@ -0,0 +1,71 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <functional>
+
+/** @class ProducerLifecycle
+    @brief This class keeps track of the bin clips whose master producer has its media file open (demuxer, decoder and file descriptors).
+    When the number of open producers exceeds the budget, the least recently used ones are released: they keep all their properties
+    and reopen the file the next time a frame is requested.
+    Clips that cannot be released at that time (displayed in a monitor, used in the timeline, ...) are refused by the release callback and kept open.
+    This class is thread safe, releases are always performed in the thread of the object.
+ */
+class ProducerLifecycle : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @param release called to release the producer of a bin clip, must return false if the producer was not released */
+    explicit ProducerLifecycle(std::function<bool(const QString &binId)> release, QObject *parent = nullptr);
+    /** @brief Mark the producer of a clip as open and recently used
+        @param memory the estimated memory used by the open producer, in bytes */
+    void touch(const QString &binId, qint64 memory);
+    /** @brief Forget a clip, for example when it is deleted */
+    void remove(const QString &binId);
+    /** @brief Forget all clips and reset the counters */
+    void clear();
+    /** @brief Set the maximum number of open producers, 0 disables the limit */
+    void setBudget(int maxOpen);
+    /** @brief Release the least recently used producers until the budget is respected. Returns the number of released producers */
+    int enforceBudget();
+    /** @returns True if the producer of this clip is considered open */
+    bool isOpen(const QString &binId) const;
+    /** @returns The number of open producers */
+    int openCount() const;
+    /** @returns The estimated memory used by the open producers, in bytes */
+    qint64 openMemory() const;
+    /** @returns The number of producers released since the last clear */
+    int releaseCount() const;
+    /** @returns The number of released producers that were used again since the last clear */
+    int reopenCount() const;
+    /** @brief Rough estimate of the memory used by an open media producer (demuxer, decoder context and frame buffers) */
+    static qint64 estimateMemory(int width, int height, bool hasVideo);
+
+private:
+    struct Entry
+    {
+        /** Value of the usage clock when the producer was last used */
+        quint64 lastUsed;
+        qint64 memory;
+    };
+    std::function<bool(const QString &binId)> m_release;
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_open;
+    QSet<QString> m_released;
+    quint64 m_clock{0};
+    qint64 m_memory{0};
+    int m_budget{0};
+    int m_releaseCount{0};
+    int m_reopenCount{0};
+    /** Delays releases to the event loop, so that a producer is never released while its caller uses it */
+    QTimer m_budgetTimer;
+};
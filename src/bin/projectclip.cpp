@@ -25,10 +25,12 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "model/markerlistmodel.hpp"
 #include "model/markersortmodel.h"
 #include "project/projectmanager.h"
+#include "producerlifecycle.hpp"
 #include "projectfolder.h"
 #include "projectitemmodel.h"
 #include "projectsubclip.h"
 #include "timeline2/model/timelineitemmodel.hpp"
+#include "utils/filefingerprintcache.hpp"
 #include "utils/thumbnailcache.hpp"
 #include "utils/timecode.h"
 
@@ -48,6 +50,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QPainter>
 #include <QProcess>
 #include <QtMath>
+#include <mlt++/MltChain.h>
+#include <mutex>
 #include <timeline2/view/qml/timelinewaveform.h>
 
 #ifdef CRASH_AUTO_TEST
@@ -593,6 +597,7 @@ bool ProjectClip::setProducer(std::shared_ptr<Mlt::Producer> producer, bool gene
     bool replacingProducer = m_masterProducer != nullptr;
     updateProducer(producer);
     producer.reset();
+    markProducerUsed();
     if (replacingProducer) {
         // Abort thumbnail tasks if any
         pCore->taskManager.discardJobs(ObjectId(KdenliveObjectType::BinClip, m_binId.toInt(), QUuid()), AbstractTask::THUMBJOB);
@@ -864,6 +869,23 @@ std::unique_ptr<Mlt::Producer> ProjectClip::getThumbProducer(const QUuid &)
     return thumbProd;
 }
 
+QByteArray ProjectClip::thumbProducerSource()
+{
+    if (m_clipType == ClipType::Timeline || m_clipType == ClipType::Playlist || m_clipStatus == FileStatus::StatusWaiting ||
+        m_clipStatus == FileStatus::StatusMissing) {
+        return QByteArray();
+    }
+    if (!m_thumbMutex.tryLock(50)) {
+        return QByteArray();
+    }
+    QByteArray source = m_thumbXml;
+    m_thumbMutex.unlock();
+    if (!source.isEmpty()) {
+        source.append(hashForThumbs().toUtf8());
+    }
+    return source;
+}
+
 void ProjectClip::createDisabledMasterProducer()
 {
     if (!m_disabledProducer) {
@@ -968,6 +990,8 @@ std::shared_ptr<Mlt::Producer> ProjectClip::getTimelineProducer(int trackId, int
     if (!m_masterProducer) {
         return nullptr;
     }
+    // Timeline playback reads frames from the master chain, which reopens a released media file
+    markProducerUsed();
     if (qFuzzyCompare(speed, 1.0) && !timeremapInfo.enableRemap) {
         // we are requesting a normal speed producer
         bool byPassTrackProducer = false;
@@ -1691,28 +1715,8 @@ const QString ProjectClip::getFileHash()
 
 const QPair<QByteArray, qint64> ProjectClip::calculateHash(const QString &path)
 {
-    QFile file(path);
-    QByteArray fileHash;
-    qint64 fSize = 0;
-    if (file.open(QIODevice::ReadOnly)) { // write size and hash only if resource points to a file
-        /*
-         * 1 MB = 1 second per 450 files (or faster)
-         * 10 MB = 9 seconds per 450 files (or faster)
-         */
-        QByteArray fileData;
-        fSize = file.size();
-        if (fSize > 2000000) {
-            fileData = file.read(1000000);
-            if (file.seek(file.size() - 1000000)) {
-                fileData.append(file.readAll());
-            }
-        } else {
-            fileData = file.readAll();
-        }
-        file.close();
-        fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-    }
-    return {fileHash, fSize};
+    // Unchanged files are not read again
+    return FileFingerprintCache::get()->fingerprint(path);
 }
 
 double ProjectClip::getOriginalFps() const
@@ -2134,6 +2138,7 @@ void ProjectClip::discardAudioThumb(bool recreate)
             audioThumbPath = getAudioThumbPath(st);
             if (!audioThumbPath.isEmpty()) {
                 QFile::remove(audioThumbPath);
+                QFile::remove(getAudioEnvelopePath(st));
             }
         }
         // Clear audio cache
@@ -2183,6 +2188,17 @@ const QString ProjectClip::getAudioThumbPath(int stream)
     return audioPath;
 }
 
+const QString ProjectClip::getAudioEnvelopePath(int stream)
+{
+    QString envelopePath = getAudioThumbPath(stream);
+    if (!envelopePath.isEmpty()) {
+        // Replace the "_audio.dat" suffix
+        envelopePath.chop(10);
+        envelopePath.append(QStringLiteral("_envelope.dat"));
+    }
+    return envelopePath;
+}
+
 QStringList ProjectClip::updatedAnalysisData(const QString &name, const QString &data, int offset)
 {
     if (data.isEmpty()) {
@@ -2616,6 +2632,55 @@ bool ProjectClip::isIncludedInTimeline()
     return !m_registeredClipsByUuid.isEmpty();
 }
 
+void ProjectClip::markProducerUsed()
+{
+    if (m_masterProducer == nullptr || m_masterProducer->type() != mlt_service_chain_type) {
+        // Only media files keep a demuxer open
+        return;
+    }
+    if (auto ptr = m_model.lock()) {
+        const qint64 memory = ProducerLifecycle::estimateMemory(getProducerIntProperty(QStringLiteral("meta.media.width")),
+                                                                getProducerIntProperty(QStringLiteral("meta.media.height")), m_clipType != ClipType::Audio);
+        std::static_pointer_cast<ProjectItemModel>(ptr)->producerLifecycle()->touch(m_binId, memory);
+    }
+}
+
+bool ProjectClip::releaseMasterProducer()
+{
+    if (!statusReady() || isReloading || isIncludedInTimeline() || pCore->taskManager.displayedClip == m_binId.toInt()) {
+        return false;
+    }
+    if (pCore->taskManager.hasPendingJob(ObjectId(KdenliveObjectType::BinClip, m_binId.toInt(), QUuid()))) {
+        return false;
+    }
+    std::unique_lock<QMutex> locker(m_producerMutex, std::try_to_lock);
+    if (!locker.owns_lock() || m_masterProducer == nullptr || m_masterProducer->type() != mlt_service_chain_type) {
+        return false;
+    }
+    QWriteLocker lock(&m_producerLock);
+    Mlt::Chain chain(*m_masterProducer.get());
+    Mlt::Producer source = chain.get_source();
+    if (!source.is_valid() || !QString(source.get("mlt_service")).startsWith(QLatin1String("avformat"))) {
+        return false;
+    }
+    // A new source that only opens its file when a frame is requested, the old one is closed when replaced
+    Mlt::Producer freshSource(pCore->getProjectProfile(), "avformat-novalidate", source.get("resource"));
+    if (!freshSource.is_valid()) {
+        return false;
+    }
+    for (int i = 0; i < m_masterProducer->count(); ++i) {
+        const char *name = m_masterProducer->get_name(i);
+        const char *value = m_masterProducer->get(i);
+        if (name == nullptr || value == nullptr || name[0] == '_' || strcmp(name, "mlt_service") == 0 || strcmp(name, "mlt_type") == 0) {
+            continue;
+        }
+        freshSource.set(name, value);
+    }
+    freshSource.set("mlt_service", source.get("mlt_service"));
+    chain.set_source(freshSource);
+    return true;
+}
+
 bool ProjectClip::isIncludedInSequence(const QUuid &seqUuid)
 {
     if (m_registeredClipsByUuid.size() == 0) {
@@ -2828,6 +2893,15 @@ QVector<int16_t> ProjectClip::audioFrameCache(const int streamIdx) const
     return {};
 }
 
+AudioLevelsPyramid ProjectClip::audioLevelsPyramid(const int streamIdx) const
+{
+    const QString key = QStringLiteral("_kdenlive:audiopyramid%1").arg(streamIdx);
+    if (m_masterProducer->get_data(key.toUtf8().constData())) {
+        return *static_cast<AudioLevelsPyramid *>(m_masterProducer->get_data(key.toUtf8().constData()));
+    }
+    return {};
+}
+
 void ProjectClip::setClipStatus(FileStatus::ClipStatus status)
 {
     if (status == FileStatus::StatusMissing && hasProxy()) {
@@ -10,6 +10,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstractprojectitem.h"
 #include "definitions.h"
+#include "jobs/audiolevels/audiolevelspyramid.h"
 #include "mltcontroller/clipcontroller.h"
 #include "timeline2/model/clipmodel.hpp"
 #include "timeline2/model/timelinemodel.hpp"
@@ -181,6 +182,9 @@ public:
 
     /** @brief Returns this clip's producer. */
     std::unique_ptr<Mlt::Producer> getThumbProducer(const QUuid &uuid = QUuid()) override;
+    /** @brief Returns the description of the current thumbnail producer, used to reuse thumbnail producers while the clip is unchanged.
+     *  Empty if the thumbnail producers of this clip cannot be reused. */
+    QByteArray thumbProducerSource();
 
     /** @brief Recursively disable/enable bin effects. */
     void setBinEffectsEnabled(bool enabled) override;
@@ -216,6 +220,8 @@ public:
     void discardVideoThumbs();
     /** @brief Get path for this clip's audio thumbnail */
     const QString getAudioThumbPath(int stream);
+    /** @brief Get path for this clip's cached audio envelope, used for audio alignment */
+    const QString getAudioEnvelopePath(int stream);
     /** @brief Returns true if this producer has audio and can be splitted on timeline*/
     bool isSplittable() const;
 
@@ -223,6 +229,11 @@ public:
         Note that this function does not account for children, use TreeItem::accumulate if you want to get that information as well.
     */
     bool isIncludedInTimeline() override;
+    /** @brief Mark the master producer as recently used, so that it is not released by the ProducerLifecycle */
+    void markProducerUsed();
+    /** @brief Close the media file of the master producer if it is idle. Its properties are kept and the file is reopened on the next frame request.
+        @returns false if the producer is in use and was not released */
+    bool releaseMasterProducer();
     /** @brief Returns true if a clip corresponding to this bin is inserted in the timeline with UUid uuid.
      */
     bool isIncludedInSequence(const QUuid &seqUuid);
@@ -261,6 +272,9 @@ public:
     /** @brief Return audio cache for a stream
      */
     QVector<int16_t> audioFrameCache(int streamIdx) const;
+    /** @brief Return the multi-resolution audio levels for a stream, empty if not generated yet
+     */
+    AudioLevelsPyramid audioLevelsPyramid(int streamIdx) const;
     /** @brief Return FFmpeg's audio stream index for an MLT audio stream index
      */
     int getAudioStreamFfmpegIndex(int mltStream);
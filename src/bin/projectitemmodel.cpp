@@ -21,12 +21,14 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "macros.hpp"
 #include "playlistclip.h"
 #include "playlistsubclip.h"
+#include "producerlifecycle.hpp"
 #include "profiles/profilemodel.hpp"
 #include "project/projectmanager.h"
 #include "projectclip.h"
 #include "projectfolder.h"
 #include "projectsubclip.h"
 #include "sequenceclip.h"
+#include "thumbnailproducerpool.hpp"
 #include "utils/thumbnailcache.hpp"
 #include "xml/xml.hpp"
 
@@ -52,6 +54,16 @@ ProjectItemModel::ProjectItemModel(QObject *parent)
     , m_lock(QReadWriteLock::Recursive)
     , m_binPlaylist(nullptr)
     , m_fileWatcher(new FileWatcher())
+    , m_producerLifecycle(new ProducerLifecycle([this](const QString &binId) {
+        std::shared_ptr<ProjectClip> clip = getClipByBinID(binId);
+        if (clip == nullptr || !clip->releaseMasterProducer()) {
+            return false;
+        }
+        // Also close the files kept open for thumbnails
+        m_thumbProducerPool->remove(binId);
+        return true;
+    }))
+    , m_thumbProducerPool(new ThumbnailProducerPool())
     , m_nextId(1)
     , m_blankThumb()
     , m_dragType(PlaylistState::Disabled)
@@ -64,6 +76,7 @@ ProjectItemModel::ProjectItemModel(QObject *parent)
     connect(m_fileWatcher.get(), &FileWatcher::binClipModified, this, &ProjectItemModel::reloadClip);
     connect(m_fileWatcher.get(), &FileWatcher::binClipWaiting, this, &ProjectItemModel::setClipWaiting);
     connect(m_fileWatcher.get(), &FileWatcher::binClipMissing, this, &ProjectItemModel::setClipInvalid);
+    m_producerLifecycle->setBudget(KdenliveSettings::maxopenproducers());
     missingClipTimer.setInterval(500);
     missingClipTimer.setSingleShot(true);
     connect(&missingClipTimer, &QTimer::timeout, this, &ProjectItemModel::slotUpdateInvalidCount);
@@ -506,6 +519,16 @@ std::shared_ptr<ProjectClip> ProjectItemModel::getClipByBinID(const QString &bin
     return nullptr;
 }
 
+ProducerLifecycle *ProjectItemModel::producerLifecycle() const
+{
+    return m_producerLifecycle.get();
+}
+
+ThumbnailProducerPool *ProjectItemModel::thumbProducerPool() const
+{
+    return m_thumbProducerPool.get();
+}
+
 const QVector<MaskInfo> ProjectItemModel::getClipMasks(const QString &binId) const
 {
     std::shared_ptr<ProjectClip> clip = getClipByBinID(binId);
@@ -555,6 +578,16 @@ const QVector<int16_t> ProjectItemModel::getAudioLevelsByBinID(const QString &bi
     return {};
 }
 
+AudioLevelsPyramid ProjectItemModel::getAudioLevelsPyramidByBinID(const QString &binId, int stream)
+{
+    READ_LOCK();
+    auto search = m_allClipItems.find(binId.toInt());
+    if (search != m_allClipItems.end()) {
+        return search->second->audioLevelsPyramid(stream);
+    }
+    return {};
+}
+
 int16_t ProjectItemModel::getAudioMaxLevel(const QString &binId, int stream)
 {
     READ_LOCK();
@@ -672,6 +705,9 @@ void ProjectItemModel::clean(bool quit)
         buildPlaylist(m_uuid);
     }
     ThumbnailCache::get()->clearCache();
+    m_producerLifecycle->clear();
+    m_thumbProducerPool->clear();
+    m_producerLifecycle->setBudget(KdenliveSettings::maxopenproducers());
 }
 
 std::shared_ptr<ProjectFolder> ProjectItemModel::getRootFolder() const
@@ -876,6 +912,8 @@ void ProjectItemModel::deregisterItem(int id, TreeItem *item)
     auto clip = static_cast<AbstractProjectItem *>(item);
     m_allIds.removeAll(clip->clipId().toInt());
     m_allClipItems.erase(clip->clipId().toInt());
+    m_producerLifecycle->remove(clip->clipId());
+    m_thumbProducerPool->remove(clip->clipId());
     m_binPlaylist->manageBinItemDeletion(clip);
     // TODO : here, we should suspend jobs belonging to the item we delete. They can be restarted if the item is reinserted by undo
     AbstractTreeModel::deregisterItem(id, item);
@@ -12,6 +12,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "abstractmodel/abstracttreemodel.hpp"
 #include "bin/abstractprojectitem.h"
 #include "definitions.h"
+#include "jobs/audiolevels/audiolevelspyramid.h"
 #include "undohelper.hpp"
 #include <QDomElement>
 #include <QFileInfo>
@@ -24,6 +25,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 class BinPlaylist;
 class FileWatcher;
 class MarkerListModel;
+class ProducerLifecycle;
+class ThumbnailProducerPool;
 class ProjectClip;
 class ProjectFolder;
 class EffectStackModel;
@@ -64,10 +67,16 @@ public:
 
     /** @brief Returns a clip from the hierarchy, given its id */
     std::shared_ptr<ProjectClip> getClipByBinID(const QString &binId) const;
+    /** @brief Returns the object managing the open media producers of the bin clips */
+    ProducerLifecycle *producerLifecycle() const;
+    /** @brief Returns the pool of thumbnail producers of the bin clips */
+    ThumbnailProducerPool *thumbProducerPool() const;
     /** @brief Returns existing masks for a clip */
     const QVector<MaskInfo> getClipMasks(const QString &binId) const;
     /** @brief Returns audio levels for a clip from its id */
     const QVector<int16_t> getAudioLevelsByBinID(const QString &binId, int stream);
+    /** @brief Returns the multi-resolution audio levels for a clip from its id */
+    AudioLevelsPyramid getAudioLevelsPyramidByBinID(const QString &binId, int stream);
     int16_t getAudioMaxLevel(const QString &binId, int stream);
 
     /** @brief Returns a list of clips using the given url */
@@ -325,6 +334,8 @@ private:
     std::unique_ptr<BinPlaylist> m_binPlaylist;
 
     std::unique_ptr<FileWatcher> m_fileWatcher;
+    std::unique_ptr<ProducerLifecycle> m_producerLifecycle;
+    std::unique_ptr<ThumbnailProducerPool> m_thumbProducerPool;
     std::unordered_map<QString, std::shared_ptr<Mlt::Tractor>> m_extraPlaylists;
     std::shared_ptr<Mlt::Tractor> m_projectTractor;
     std::map<int, std::shared_ptr<ProjectClip>> m_allClipItems;
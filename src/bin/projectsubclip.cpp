@@ -64,6 +64,7 @@ ProjectSubClip::~ProjectSubClip()
 
 void ProjectSubClip::reloadThumb()
 {
+    m_approximateThumbs.clear();
     ClipLoadTask::start(ObjectId(KdenliveObjectType::BinClip, m_parentClipId.toInt(), QUuid()), QDomElement(), true, m_inPoint, m_outPoint, this);
 }
 
@@ -72,6 +73,11 @@ const QString ProjectSubClip::cutClipId() const
     return QStringLiteral("%1/%2/%3").arg(m_parentClipId).arg(m_inPoint).arg(m_outPoint);
 }
 
+void ProjectSubClip::gotApproximateThumb(int pos, const QImage &img)
+{
+    m_approximateThumbs.insert(pos, img);
+}
+
 void ProjectSubClip::gotThumb(int pos, const QImage &img)
 {
     if (pos == m_inPoint) {
@@ -201,9 +207,11 @@ void ProjectSubClip::getThumbFromPercent(int percent)
     framePos -= framePos % steps;
     if (ThumbnailCache::get()->hasThumbnail(m_parentClipId, m_inPoint + framePos)) {
         setThumbnail(ThumbnailCache::get()->getThumbnail(m_parentClipId, m_inPoint + framePos));
+    } else if (m_approximateThumbs.contains(m_inPoint + framePos)) {
+        setThumbnail(m_approximateThumbs.value(m_inPoint + framePos));
     } else {
         // Generate percent thumbs
-        CacheTask::start(ObjectId(KdenliveObjectType::BinClip, m_parentClipId.toInt(), QUuid()), 30, m_inPoint, m_outPoint, this);
+        CacheTask::start(ObjectId(KdenliveObjectType::BinClip, m_parentClipId.toInt(), QUuid()), 30, m_inPoint, m_outPoint, this, false, false);
     }
 }
 
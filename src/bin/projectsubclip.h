@@ -9,6 +9,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstractprojectitem.h"
 #include "definitions.h"
+#include <QHash>
+#include <QImage>
 #include <memory>
 
 class ProjectFolder;
@@ -82,7 +84,11 @@ public:
 private:
     std::shared_ptr<ProjectClip> m_masterClip;
     QString m_parentClipId;
+    /** @brief Seeking thumbnails showing the keyframe nearest to their position, by position in the parent clip */
+    QHash<int, QImage> m_approximateThumbs;
 
 private Q_SLOTS:
     void gotThumb(int pos, const QImage &img);
+    /** @brief Receives a seeking thumbnail decoded from the nearest keyframe, which is not stored in the thumbnail cache */
+    void gotApproximateThumb(int pos, const QImage &img);
 };
@@ -0,0 +1,144 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "thumbnailproducerpool.hpp"
+
+#include <QMutexLocker>
+#include <cstdlib>
+#include <mlt++/MltProducer.h>
+#include <utility>
+
+ThumbnailProducerPool::ThumbnailProducerPool(int maxProducers, int maxPerClip)
+    : m_maxProducers(qMax(1, maxProducers))
+    , m_maxPerClip(qMax(1, maxPerClip))
+{
+}
+
+ThumbnailProducerPool::~ThumbnailProducerPool() = default;
+
+std::unique_ptr<Mlt::Producer> ThumbnailProducerPool::take(const QString &binId, const QByteArray &source, int frame)
+{
+    if (source.isEmpty()) {
+        return nullptr;
+    }
+    QMutexLocker lock(&m_mutex);
+    auto it = m_pools.find(binId);
+    if (it == m_pools.end()) {
+        m_pools[binId].source = source;
+        return nullptr;
+    }
+    ClipPool &pool = it->second;
+    if (pool.source != source) {
+        // The clip changed, its producers are outdated
+        m_idleCount -= int(pool.idle.size());
+        pool.idle.clear();
+        pool.source = source;
+        return nullptr;
+    }
+    if (pool.idle.empty()) {
+        return nullptr;
+    }
+    // Prefer the producer that stopped closest before the requested frame, then the closest one
+    auto best = pool.idle.end();
+    for (auto idle = pool.idle.begin(); idle != pool.idle.end(); ++idle) {
+        if (best == pool.idle.end()) {
+            best = idle;
+            continue;
+        }
+        const bool before = idle->frame <= frame;
+        const bool bestBefore = best->frame <= frame;
+        if (before != bestBefore) {
+            if (before) {
+                best = idle;
+            }
+        } else if (std::abs(frame - idle->frame) < std::abs(frame - best->frame)) {
+            best = idle;
+        }
+    }
+    std::unique_ptr<Mlt::Producer> producer = std::move(best->producer);
+    pool.idle.erase(best);
+    m_idleCount--;
+    m_reuseCount++;
+    return producer;
+}
+
+void ThumbnailProducerPool::release(const QString &binId, const QByteArray &source, std::unique_ptr<Mlt::Producer> producer, int frame)
+{
+    if (!producer || source.isEmpty()) {
+        return;
+    }
+    QMutexLocker lock(&m_mutex);
+    ClipPool &pool = m_pools[binId];
+    if (pool.source.isEmpty()) {
+        pool.source = source;
+    } else if (pool.source != source) {
+        // Created before the clip changed
+        return;
+    }
+    if (int(pool.idle.size()) >= m_maxPerClip) {
+        // Close the least recently used producer of this clip
+        auto oldest = pool.idle.begin();
+        for (auto idle = pool.idle.begin(); idle != pool.idle.end(); ++idle) {
+            if (idle->lastUsed < oldest->lastUsed) {
+                oldest = idle;
+            }
+        }
+        pool.idle.erase(oldest);
+        m_idleCount--;
+    }
+    pool.idle.push_back({std::move(producer), frame, ++m_clock});
+    m_idleCount++;
+    while (m_idleCount > m_maxProducers) {
+        evictOldest();
+    }
+}
+
+void ThumbnailProducerPool::evictOldest()
+{
+    auto oldestPool = m_pools.end();
+    std::vector<Idle>::iterator oldest;
+    for (auto it = m_pools.begin(); it != m_pools.end(); ++it) {
+        for (auto idle = it->second.idle.begin(); idle != it->second.idle.end(); ++idle) {
+            if (oldestPool == m_pools.end() || idle->lastUsed < oldest->lastUsed) {
+                oldestPool = it;
+                oldest = idle;
+            }
+        }
+    }
+    if (oldestPool != m_pools.end()) {
+        oldestPool->second.idle.erase(oldest);
+        m_idleCount--;
+    }
+}
+
+void ThumbnailProducerPool::remove(const QString &binId)
+{
+    QMutexLocker lock(&m_mutex);
+    auto it = m_pools.find(binId);
+    if (it != m_pools.end()) {
+        m_idleCount -= int(it->second.idle.size());
+        m_pools.erase(it);
+    }
+}
+
+void ThumbnailProducerPool::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_pools.clear();
+    m_idleCount = 0;
+    m_reuseCount = 0;
+}
+
+int ThumbnailProducerPool::idleCount() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_idleCount;
+}
+
+int ThumbnailProducerPool::reuseCount() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_reuseCount;
+}
@@ -0,0 +1,73 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Mlt {
+class Producer;
+}
+
+/** @class ThumbnailProducerPool
+    @brief This class keeps the thumbnail producers of the bin clips (with their filters attached) after a thumbnail was extracted,
+    so that the next request for the same clip doesn't have to open and probe the file again.
+    A producer is taken from the pool while it is used, so it is never shared between threads.
+    Each clip has its own pool, identified by a source (the description of the thumbnail producer): when the clip changes,
+    the producers created from its previous source are discarded.
+    The total number of idle producers is bounded, the least recently used ones are closed first.
+    This class is thread safe.
+ */
+class ThumbnailProducerPool
+{
+public:
+    /** @param maxProducers the maximum number of idle producers kept for all clips
+        @param maxPerClip the maximum number of idle producers kept for one clip */
+    explicit ThumbnailProducerPool(int maxProducers = 16, int maxPerClip = 3);
+    ~ThumbnailProducerPool();
+    /** @brief Take an idle producer of a clip to extract @param frame, or nullptr if there is none for this @param source
+        The producer whose last extracted frame is closest before the requested one is returned, so that it can decode forward instead of seeking */
+    std::unique_ptr<Mlt::Producer> take(const QString &binId, const QByteArray &source, int frame);
+    /** @brief Give back a producer after extracting @param frame. It is discarded if the clip source changed since it was taken */
+    void release(const QString &binId, const QByteArray &source, std::unique_ptr<Mlt::Producer> producer, int frame);
+    /** @brief Close the idle producers of a clip */
+    void remove(const QString &binId);
+    /** @brief Close all idle producers */
+    void clear();
+    /** @returns The number of idle producers */
+    int idleCount() const;
+    /** @returns The number of producers that were reused since the last clear */
+    int reuseCount() const;
+
+private:
+    struct Idle
+    {
+        std::unique_ptr<Mlt::Producer> producer;
+        /** The last frame extracted with this producer */
+        int frame;
+        /** Value of the usage clock when the producer was released */
+        quint64 lastUsed;
+    };
+    struct ClipPool
+    {
+        QByteArray source;
+        std::vector<Idle> idle;
+    };
+    mutable QMutex m_mutex;
+    std::unordered_map<QString, ClipPool> m_pools;
+    int m_maxProducers;
+    int m_maxPerClip;
+    int m_idleCount{0};
+    int m_reuseCount{0};
+    quint64 m_clock{0};
+
+    /** @brief Close the least recently used idle producer. Must be called with the mutex locked */
+    void evictOldest();
+};
@@ -453,6 +453,11 @@ RenderWidget::RenderWidget(bool enableProxy, QWidget *parent)
     });
     connect(m_view.export_meta, &QCheckBox::checkStateChanged, this, &RenderWidget::refreshParams);
     connect(m_view.checkTwoPass, &QCheckBox::checkStateChanged, this, &RenderWidget::refreshParams);
+    m_view.render_segments->setToolTip(i18nc("Explanation for the segmented rendering feature",
+                                             "Render the video in several segments encoded in parallel, then join them without re-encoding.\nFaster on "
+                                             "computers with many cores. Not used with 2 pass, image sequences, subtitle embedding or audio per track export."));
+    m_view.render_segments->setValue(KdenliveSettings::rendersegments());
+    connect(m_view.render_segments, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KdenliveSettings::setRendersegments);
     connect(m_view.buttonRender, &QAbstractButton::clicked, this, [&]() { slotPrepareExport(); });
     connect(m_view.buttonGenerateScript, &QAbstractButton::clicked, this, [&]() { slotPrepareExport(true); });
     updateMetadataToolTip();
@@ -993,6 +998,7 @@ void RenderWidget::slotPrepareExport2(bool delayedRendering)
     request.setProxyRendering(m_view.proxy_render->isChecked());
     request.setEmbedSubtitles(m_view.embed_subtitles->isEnabled() && m_view.embed_subtitles->isChecked());
     request.setTwoPass(m_view.checkTwoPass->isChecked());
+    request.setSegmentCount(m_view.render_segments->value());
     request.setAudioFilePerTrack(m_view.stemAudioExport->isChecked() && m_view.stemAudioExport->isEnabled());
 
     bool guideMultiExport = m_view.guide_multi_box->isChecked();
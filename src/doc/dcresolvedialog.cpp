@@ -50,6 +50,7 @@ DCResolveDialog::DCResolveDialog(std::vector<DocumentChecker::DocumentResource>
     connect(recursiveSearch, &QPushButton::clicked, this, [&]() { slotRecursiveSearch(); });
 
     connect(searchProxies, &QPushButton::clicked, this, [&]() { slotRecursiveProxySearch(); });
+    connect(abortSearch, &QToolButton::clicked, this, [&]() { m_model->abortSearch(); });
 
     connect(m_model.get(), &DocumentCheckerTreeModel::searchProgress, this, [&](int current, int total) {
         setEnableChangeItems(false);
@@ -67,6 +68,7 @@ DCResolveDialog::DCResolveDialog(std::vector<DocumentChecker::DocumentResource>
         infoLabel->setMessageType(KMessageWidget::MessageType::Positive);
         infoLabel->animatedShow();
         infoLabel->setCloseButtonVisible(true);
+        checkStatus();
     });
 
     QItemSelectionModel *selectionModel = treeView->selectionModel();
@@ -247,7 +249,6 @@ void DCResolveDialog::slotRecursiveSearch()
     }
     m_searchTimer.start();
     m_model->slotSearchRecursively(newpath);
-    checkStatus();
 }
 
 void DCResolveDialog::slotRecursiveProxySearch()
@@ -259,7 +260,6 @@ void DCResolveDialog::slotRecursiveProxySearch()
     }
     m_searchTimer.start();
     m_model->slotSearchProxyRecursively(newpath);
-    checkStatus();
 }
 
 void DCResolveDialog::checkStatus()
@@ -313,6 +313,7 @@ void DCResolveDialog::checkStatus()
 void DCResolveDialog::setEnableChangeItems(bool enabled)
 {
     recursiveSearch->setEnabled(enabled);
+    searchProxies->setEnabled(enabled);
     manualSearch->setEnabled(enabled);
     removeSelected->setEnabled(enabled);
     usePlaceholders->setEnabled(enabled);
@@ -11,13 +11,13 @@
 #include "kdenlivesettings.h"
 #include "titler/titlewidget.h"
 #include "transitions/transitionsrepository.hpp"
+#include "utils/filefingerprintcache.hpp"
 #include "xml/xml.hpp"
 
 #include <KLocalizedString>
 #include <KUrlRequester>
 #include <KUrlRequesterDialog>
 
-#include <QCryptographicHash>
 #include <QStandardPaths>
 
 QDebug operator<<(QDebug qd, const DocumentChecker::DocumentResource &item)
@@ -402,6 +402,10 @@ bool DocumentChecker::hasErrorInProject()
         m_doc.documentElement().setAttribute(QStringLiteral("modified"), 1);
     }
 
+    // Hash the bin clip files in parallel, the checks below will then get the result from the fingerprint cache
+    prefetchFileHashes(documentProducers);
+    prefetchFileHashes(documentChains);
+
     QStringList verifiedPaths;
     max = documentProducers.count();
     for (int i = 0; i < max; ++i) {
@@ -415,6 +419,7 @@ bool DocumentChecker::hasErrorInProject()
         verifiedPaths << getMissingProducers(e, entries, storageFolder);
         Q_EMIT pCore->loadingMessageIncrease();
     }
+    FileFingerprintCache::get()->save();
     max = documentTractors.count();
     for (int i = 0; i < max; ++i) {
         QDomElement e = documentTractors.item(i).toElement();
@@ -912,6 +917,30 @@ bool DocumentChecker::ensureControlIdForItem(QDomElement &e, bool isBinClip)
     return true;
 }
 
+void DocumentChecker::prefetchFileHashes(const QDomNodeList &producers)
+{
+    const QStringList checkHashForService = {QLatin1String("qimage"), QLatin1String("pixbuf"), QLatin1String("glaxnimate")};
+    QStringList files;
+    int max = producers.count();
+    for (int i = 0; i < max; ++i) {
+        QDomElement e = producers.item(i).toElement();
+        if (!m_binIds.contains(e.attribute(QLatin1String("id"))) || !Xml::hasXmlProperty(e, QStringLiteral("kdenlive:file_hash"))) {
+            continue;
+        }
+        const QString service = Xml::getXmlProperty(e, QStringLiteral("mlt_service"));
+        if (!service.startsWith(QLatin1String("avformat")) && !checkHashForService.contains(service)) {
+            continue;
+        }
+        const QString resource = getProducerResource(e);
+        if (resource.isEmpty() || isSlideshow(resource)) {
+            // Slideshows only hash a few files of their folder
+            continue;
+        }
+        files << resource;
+    }
+    FileFingerprintCache::get()->prefetch(files);
+}
+
 QString DocumentChecker::getMissingProducers(QDomElement &e, const QDomNodeList &entries, const QString &storageFolder)
 {
     bool isBinClip = m_binIds.contains(e.attribute(QLatin1String("id")));
@@ -1328,7 +1357,6 @@ QString DocumentChecker::searchFileRecursively(const QDir &dir, const QString &m
         return searchPathRecursively(dir, QUrl::fromLocalFile(fileName).fileName());
     }
     QString foundFileName;
-    QByteArray fileData;
     QByteArray fileHash;
     QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
     for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
@@ -1338,24 +1366,9 @@ QString DocumentChecker::searchFileRecursively(const QDir &dir, const QString &m
         }*/
         QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
         if (QString::number(file.size()) == matchSize) {
-            if (file.open(QIODevice::ReadOnly)) {
-                /*
-                 * 1 MB = 1 second per 450 files (or faster)
-                 * 10 MB = 9 seconds per 450 files (or faster)
-                 */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                }
+            fileHash = ProjectClip::calculateHash(file.fileName()).first;
+            if (!fileHash.isEmpty() && QString::fromLatin1(fileHash.toHex()) == matchHash) {
+                return file.fileName();
             }
         }
     }
@@ -101,6 +101,8 @@ private:
      */
     bool ensureProducerIsNotPlaceholder(QDomElement &producer);
 
+    /** @brief Compute the file hash of the existing bin clips in parallel, so that their change check does not read them one by one */
+    void prefetchFileHashes(const QDomNodeList &producers);
     /** @brief Check for various missing elements */
     QString getMissingProducers(QDomElement &e, const QDomNodeList &entries, const QString &storageFolder);
     /** @brief Check if images and fonts in this clip exists, returns a list of images that do exist so we don't check twice. */
@@ -6,13 +6,32 @@
 #include "documentcheckertreemodel.h"
 
 #include "abstractmodel/treeitem.hpp"
+#include "doc/documentsearchindex.h"
 
 #include <KColorScheme>
+#include <QtConcurrent/QtConcurrentRun>
 
 DocumentCheckerTreeModel::DocumentCheckerTreeModel(QObject *parent)
     : AbstractTreeModel{parent}
     , m_resourceItems()
 {
+    connect(&m_searchWatcher, &QFutureWatcher<QMap<int, QString>>::finished, this, [this]() {
+        const QMap<int, QString> fixedMap = m_searchWatcher.result();
+        QMapIterator<int, QString> j(fixedMap);
+        while (j.hasNext()) {
+            j.next();
+            setItemsNewFilePath(getIndexFromId(j.key()), j.value(), DocumentChecker::MissingStatus::Fixed, false);
+        }
+        Q_EMIT dataChanged(QModelIndex(), QModelIndex());
+        Q_EMIT searchDone();
+    });
+}
+
+DocumentCheckerTreeModel::~DocumentCheckerTreeModel()
+{
+    // The search thread emits progress through this object
+    m_abortSearch = true;
+    m_searchWatcher.waitForFinished();
 }
 
 Qt::ItemFlags DocumentCheckerTreeModel::flags(const QModelIndex &index) const
@@ -60,79 +79,115 @@ void DocumentCheckerTreeModel::removeItem(const QModelIndex &ix)
 
 void DocumentCheckerTreeModel::slotSearchRecursively(const QString &newpath)
 {
-    QDir searchDir(newpath);
-    QMap<QModelIndex, QString> fixedMap;
-    QMapIterator<int, DocumentChecker::DocumentResource> i(m_resourceItems);
-    int counter = 1;
-    while (i.hasNext()) {
-        i.next();
-        Q_EMIT searchProgress(counter, m_resourceItems.count());
-        counter++;
-        if (i.value().status != DocumentChecker::MissingStatus::Missing && i.value().status != DocumentChecker::MissingStatus::MissingButProxy) {
-            continue;
-        }
-        QString newPath;
-        if (i.value().type == DocumentChecker::MissingType::Clip) {
-            ClipType::ProducerType type = i.value().clipType;
-            if (type == ClipType::SlideShow) {
-                // Slideshows cannot be found with hash / size
-                newPath = DocumentChecker::searchDirRecursively(searchDir, i.value().hash, i.value().originalFilePath);
-            } else {
-                newPath = DocumentChecker::searchFileRecursively(searchDir, i.value().fileSize, i.value().hash, i.value().originalFilePath);
-            }
-            if (newPath.isEmpty()) {
-                newPath = DocumentChecker::searchPathRecursively(searchDir, QUrl::fromLocalFile(i.value().originalFilePath).fileName(), type);
-            }
-        } else if (i.value().type == DocumentChecker::MissingType::Luma) {
-            newPath = DocumentChecker::searchLuma(searchDir, i.value().originalFilePath);
+    startSearch(newpath, false);
+}
+
+void DocumentCheckerTreeModel::slotSearchProxyRecursively(const QString &newpath)
+{
+    startSearch(newpath, true);
+}
+
+void DocumentCheckerTreeModel::abortSearch()
+{
+    m_abortSearch = true;
+}
+
+bool DocumentCheckerTreeModel::isSearching() const
+{
+    return m_searchWatcher.isRunning();
+}
 
-        } else if (i.value().type == DocumentChecker::MissingType::AssetFile) {
-            newPath = DocumentChecker::searchPathRecursively(searchDir, QFileInfo(i.value().originalFilePath).fileName());
+void DocumentCheckerTreeModel::startSearch(const QString &folder, bool proxies)
+{
+    if (m_searchWatcher.isRunning()) {
+        return;
+    }
+    m_abortSearch = false;
+    const QMap<int, DocumentChecker::DocumentResource> items = m_resourceItems;
+    m_searchWatcher.setFuture(QtConcurrent::run([this, folder, items, proxies]() { return searchMissingItems(folder, items, proxies); }));
+}
 
-        } else if (i.value().type == DocumentChecker::MissingType::TitleImage) {
-            newPath = DocumentChecker::searchPathRecursively(searchDir, QFileInfo(i.value().originalFilePath).fileName());
+QMap<int, QString> DocumentCheckerTreeModel::searchMissingItems(const QString &folder, const QMap<int, DocumentChecker::DocumentResource> &items,
+                                                                bool proxies)
+{
+    QMap<int, QString> fixedMap;
+    QList<int> missingIds;
+    QVector<qint64> hashedSizes;
+    for (auto i = items.cbegin(); i != items.cend(); ++i) {
+        const DocumentChecker::DocumentResource &item = i.value();
+        if (proxies) {
+            if (item.status == DocumentChecker::MissingStatus::Missing && item.type == DocumentChecker::MissingType::Proxy) {
+                missingIds << i.key();
+            }
+            continue;
         }
-        if (!newPath.isEmpty()) {
-            fixedMap.insert(getIndexFromId(i.key()), newPath);
+        if (item.status != DocumentChecker::MissingStatus::Missing && item.status != DocumentChecker::MissingStatus::MissingButProxy) {
+            continue;
+        }
+        missingIds << i.key();
+        if (item.type == DocumentChecker::MissingType::Clip && item.clipType != ClipType::SlideShow && !item.hash.isEmpty()) {
+            bool ok = false;
+            const qint64 size = item.fileSize.toLongLong(&ok);
+            if (ok) {
+                hashedSizes << size;
+            }
         }
     }
-    QMapIterator<QModelIndex, QString> j(fixedMap);
-    while (j.hasNext()) {
-        j.next();
-        setItemsNewFilePath(j.key(), j.value(), DocumentChecker::MissingStatus::Fixed, false);
+    if (missingIds.isEmpty()) {
+        return fixedMap;
     }
-    Q_EMIT dataChanged(QModelIndex(), QModelIndex());
-    Q_EMIT searchDone();
-}
 
-void DocumentCheckerTreeModel::slotSearchProxyRecursively(const QString &newpath)
-{
-    QDir searchDir(newpath);
-    QMap<QModelIndex, QString> fixedMap;
-    QMapIterator<int, DocumentChecker::DocumentResource> i(m_resourceItems);
+    // Scan the folder tree once for all items
+    Q_EMIT searchProgress(0, 0);
+    DocumentSearchIndex index(folder);
+    if (!index.build(m_abortSearch)) {
+        return fixedMap;
+    }
+    qDebug() << "::: Indexed" << index.fileCount() << "files in" << index.folderCount() << "folders for missing items search";
+    // Hash all the files that could match a missing clip in parallel
+    index.prefetchHashes(hashedSizes);
+
     int counter = 1;
-    while (i.hasNext()) {
-        i.next();
-        Q_EMIT searchProgress(counter, m_resourceItems.count());
-        counter++;
-        if (i.value().status != DocumentChecker::MissingStatus::Missing) {
-            continue;
+    for (int id : std::as_const(missingIds)) {
+        if (m_abortSearch) {
+            break;
         }
+        Q_EMIT searchProgress(counter, missingIds.count());
+        counter++;
+        const DocumentChecker::DocumentResource &item = items.value(id);
+        const QString fileName = QFileInfo(item.originalFilePath).fileName();
         QString newPath;
-        if (i.value().type == DocumentChecker::MissingType::Proxy) {
-            newPath = DocumentChecker::searchPathRecursively(searchDir, QUrl::fromLocalFile(i.value().originalFilePath).fileName());
+        if (item.type == DocumentChecker::MissingType::Clip) {
+            if (item.clipType == ClipType::SlideShow) {
+                // Slideshows cannot be found with hash / size
+                newPath = index.findSlideshowByHash(item.originalFilePath, item.hash, m_abortSearch);
+                if (newPath.isEmpty()) {
+                    newPath = index.findSlideshowByName(item.originalFilePath);
+                }
+            } else {
+                bool ok = false;
+                const qint64 size = item.fileSize.toLongLong(&ok);
+                if (ok) {
+                    newPath = index.findFileByHash(size, item.hash);
+                }
+                if (newPath.isEmpty()) {
+                    newPath = index.findFileByName(fileName);
+                }
+            }
+        } else if (item.type == DocumentChecker::MissingType::Luma) {
+            newPath = DocumentChecker::fixLumaPath(item.originalFilePath);
+            if (newPath.isEmpty()) {
+                newPath = index.findFileByName(fileName);
+            }
+        } else if (item.type == DocumentChecker::MissingType::AssetFile || item.type == DocumentChecker::MissingType::TitleImage ||
+                   item.type == DocumentChecker::MissingType::Proxy) {
+            newPath = index.findFileByName(fileName);
         }
         if (!newPath.isEmpty()) {
-            fixedMap.insert(getIndexFromId(i.key()), newPath);
+            fixedMap.insert(id, newPath);
         }
     }
-    QMapIterator<QModelIndex, QString> j(fixedMap);
-    while (j.hasNext()) {
-        j.next();
-        setItemsNewFilePath(j.key(), j.value(), DocumentChecker::MissingStatus::Fixed, false);
-    }
-    Q_EMIT dataChanged(QModelIndex(), QModelIndex());
-    Q_EMIT searchDone();
+    return fixedMap;
 }
 
 void DocumentCheckerTreeModel::usePlaceholdersForMissing()
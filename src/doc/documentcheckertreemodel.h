@@ -9,6 +9,8 @@
 
 #include "doc/documentchecker.h"
 
+#include <QFutureWatcher>
+#include <atomic>
 #include <vector>
 
 class DocumentCheckerTreeModel : public AbstractTreeModel
@@ -20,10 +22,16 @@ protected:
 
 public:
     static std::shared_ptr<DocumentCheckerTreeModel> construct(const std::vector<DocumentChecker::DocumentResource> &items, QObject *parent = nullptr);
+    ~DocumentCheckerTreeModel() override;
 
     void removeItem(const QModelIndex &ix);
+    /** @brief Start searching the missing items in a folder, searchDone is emitted when finished */
     void slotSearchRecursively(const QString &newpath);
+    /** @brief Start searching the missing proxies in a folder, searchDone is emitted when finished */
     void slotSearchProxyRecursively(const QString &newpath);
+    /** @brief Stop the running search, keeping the items found so far */
+    void abortSearch();
+    bool isSearching() const;
     void usePlaceholdersForMissing();
     void setItemsNewFilePath(const QModelIndex &ix, const QString &url, DocumentChecker::MissingStatus status, bool refresh = true);
     void setItemsFileHash(const QModelIndex &index, const QString &hash);
@@ -39,6 +47,13 @@ public:
 
 private:
     QMap<int, DocumentChecker::DocumentResource> m_resourceItems;
+    QFutureWatcher<QMap<int, QString>> m_searchWatcher;
+    std::atomic<bool> m_abortSearch{false};
+
+    void startSearch(const QString &folder, bool proxies);
+    /** @brief Index the folder and look for the missing items in it, runs in a worker thread.
+        Returns the new path of the items found */
+    QMap<int, QString> searchMissingItems(const QString &folder, const QMap<int, DocumentChecker::DocumentResource> &items, bool proxies);
 
 Q_SIGNALS:
     void searchProgress(int current, int total);
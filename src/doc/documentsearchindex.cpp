@@ -0,0 +1,195 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "documentsearchindex.h"
+#include "bin/projectclip.h"
+#include "utils/filefingerprintcache.hpp"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+
+namespace {
+struct FolderListing
+{
+    QString path;
+    QStringList fileNames;
+    QStringList filePaths;
+    QVector<qint64> fileSizes;
+    QStringList subFolders;
+};
+
+FolderListing listFolder(const QString &path)
+{
+    FolderListing listing;
+    listing.path = path;
+    const QFileInfoList entries = QDir(path).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable);
+    for (const QFileInfo &info : entries) {
+        if (info.isDir()) {
+            if (!info.isExecutable()) {
+                continue;
+            }
+            // Resolve linked folders so that loops can be detected
+            const QString folder = info.isSymLink() ? info.canonicalFilePath() : info.absoluteFilePath();
+            if (!folder.isEmpty()) {
+                listing.subFolders << folder;
+            }
+        } else {
+            listing.fileNames << info.fileName();
+            listing.filePaths << info.absoluteFilePath();
+            listing.fileSizes << info.size();
+        }
+    }
+    return listing;
+}
+} // namespace
+
+DocumentSearchIndex::DocumentSearchIndex(const QString &folder)
+    : m_folder(folder)
+{
+}
+
+bool DocumentSearchIndex::build(const std::atomic<bool> &abort)
+{
+    m_files.clear();
+    m_dirs.clear();
+    m_filesByName.clear();
+    m_filesBySize.clear();
+    m_dirsByName.clear();
+    const QString root = QFileInfo(m_folder).canonicalFilePath();
+    if (root.isEmpty()) {
+        return true;
+    }
+    QSet<QString> visited = {root};
+    QStringList level = {root};
+    // Walk one level at a time, so that entries are sorted by depth
+    while (!level.isEmpty()) {
+        if (abort) {
+            return false;
+        }
+        const QList<FolderListing> listings = QtConcurrent::blockingMapped<QList<FolderListing>>(level, listFolder);
+        QStringList nextLevel;
+        for (const FolderListing &listing : listings) {
+            m_dirsByName[QFileInfo(listing.path).fileName().toLower()].append(int(m_dirs.size()));
+            m_dirs.push_back({listing.path, listing.fileNames});
+            for (int i = 0; i < listing.fileNames.size(); ++i) {
+                const int ix = int(m_files.size());
+                m_files.push_back({listing.filePaths.at(i), listing.fileSizes.at(i)});
+                m_filesByName[listing.fileNames.at(i).toLower()].append(ix);
+                m_filesBySize[listing.fileSizes.at(i)].append(ix);
+            }
+            for (const QString &folder : listing.subFolders) {
+                if (!visited.contains(folder)) {
+                    visited.insert(folder);
+                    nextLevel << folder;
+                }
+            }
+        }
+        level = nextLevel;
+    }
+    return true;
+}
+
+QString DocumentSearchIndex::findFileByName(const QString &fileName) const
+{
+    const QVector<int> matches = m_filesByName.value(fileName.toLower());
+    if (matches.isEmpty()) {
+        return QString();
+    }
+    return m_files.at(size_t(matches.first())).path;
+}
+
+void DocumentSearchIndex::prefetchHashes(const QVector<qint64> &sizes) const
+{
+    QStringList paths;
+    for (qint64 size : sizes) {
+        const QVector<int> matches = m_filesBySize.value(size);
+        for (int ix : matches) {
+            paths << m_files.at(size_t(ix)).path;
+        }
+    }
+    FileFingerprintCache::get()->prefetch(paths);
+}
+
+QString DocumentSearchIndex::findFileByHash(qint64 size, const QString &hash) const
+{
+    if (hash.isEmpty()) {
+        return QString();
+    }
+    const QVector<int> matches = m_filesBySize.value(size);
+    for (int ix : matches) {
+        const QString &path = m_files.at(size_t(ix)).path;
+        if (QString::fromLatin1(FileFingerprintCache::get()->fingerprint(path).first.toHex()) == hash) {
+            return path;
+        }
+    }
+    return QString();
+}
+
+QString DocumentSearchIndex::findSlideshowByHash(const QString &originalPath, const QString &hash, const std::atomic<bool> &abort) const
+{
+    if (hash.isEmpty()) {
+        return QString();
+    }
+    const QString fileName = QFileInfo(originalPath).fileName();
+    QVector<int> candidates;
+    for (size_t ix = 0; ix < m_dirs.size(); ++ix) {
+        if (!m_dirs.at(ix).files.isEmpty()) {
+            candidates << int(ix);
+        }
+    }
+    // Hash folders in batches, the closest folders are checked first and we stop at the first match
+    const int batchSize = 4 * QThread::idealThreadCount();
+    for (int start = 0; start < candidates.size(); start += batchSize) {
+        if (abort) {
+            return QString();
+        }
+        const QVector<int> batch = candidates.mid(start, batchSize);
+        const QList<bool> matches = QtConcurrent::blockingMapped<QList<bool>>(batch, [this, &fileName, &hash](int ix) {
+            return QString::fromLatin1(ProjectClip::getFolderHash(QDir(m_dirs.at(size_t(ix)).path), fileName).toHex()) == hash;
+        });
+        for (int i = 0; i < matches.size(); ++i) {
+            if (matches.at(i)) {
+                return QDir(m_dirs.at(size_t(batch.at(i))).path).absoluteFilePath(fileName);
+            }
+        }
+    }
+    return QString();
+}
+
+QString DocumentSearchIndex::findSlideshowByName(const QString &originalPath) const
+{
+    const QString fileName = QFileInfo(originalPath).fileName();
+    if (fileName.contains(QLatin1Char('%'))) {
+        // Pattern slideshow, look for a folder containing files with the same prefix
+        const QString prefix = fileName.section(QLatin1Char('%'), 0, -2);
+        for (const DirEntry &dir : m_dirs) {
+            for (const QString &file : dir.files) {
+                if (file.startsWith(prefix, Qt::CaseInsensitive)) {
+                    return QDir(dir.path).absoluteFilePath(fileName);
+                }
+            }
+        }
+        return QString();
+    }
+    // Mime type slideshow, look for a folder with the same name
+    const QVector<int> matches = m_dirsByName.value(QFileInfo(originalPath).dir().dirName().toLower());
+    if (matches.isEmpty()) {
+        return QString();
+    }
+    return QDir(m_dirs.at(size_t(matches.first())).path).absoluteFilePath(fileName);
+}
+
+int DocumentSearchIndex::fileCount() const
+{
+    return int(m_files.size());
+}
+
+int DocumentSearchIndex::folderCount() const
+{
+    return int(m_dirs.size());
+}
@@ -0,0 +1,64 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <vector>
+
+/** @class DocumentSearchIndex
+    @brief An index of the files and folders found below a search folder, used to relocate the missing items of a project.
+    The folder tree is walked only once (one directory level at a time, with the directories of a level listed in parallel),
+    then all missing items are resolved against the index.
+    Lookups return the match closest to the search folder, so the result does not depend on the walking order.
+    The index is immutable once built and can be queried from any thread.
+ */
+class DocumentSearchIndex
+{
+public:
+    explicit DocumentSearchIndex(const QString &folder);
+
+    /** @brief Walk the search folder. Returns false if the walk was aborted */
+    bool build(const std::atomic<bool> &abort);
+
+    /** @brief Returns the path of a file with this name (case insensitive), or an empty string */
+    QString findFileByName(const QString &fileName) const;
+    /** @brief Returns the path of a file with this size and file hash (as stored in kdenlive:file_hash), or an empty string */
+    QString findFileByHash(qint64 size, const QString &hash) const;
+    /** @brief Compute the hash of all the files having one of these sizes in parallel, so that findFileByHash is served from the fingerprint cache */
+    void prefetchHashes(const QVector<qint64> &sizes) const;
+    /** @brief Returns the new path of a slideshow whose folder has this folder hash, or an empty string
+        @param originalPath the slideshow resource (folder and file pattern) */
+    QString findSlideshowByHash(const QString &originalPath, const QString &hash, const std::atomic<bool> &abort) const;
+    /** @brief Returns the new path of a slideshow, looking for files matching its pattern or for a folder with the same name */
+    QString findSlideshowByName(const QString &originalPath) const;
+
+    int fileCount() const;
+    int folderCount() const;
+
+private:
+    struct FileEntry
+    {
+        QString path;
+        qint64 size;
+    };
+    struct DirEntry
+    {
+        QString path;
+        /** File names, in the directory listing order */
+        QStringList files;
+    };
+    QString m_folder;
+    /** Entries are sorted by depth, so that the first match is the closest to the search folder */
+    std::vector<FileEntry> m_files;
+    std::vector<DirEntry> m_dirs;
+    QHash<QString, QVector<int>> m_filesByName;
+    QHash<qint64, QVector<int>> m_filesBySize;
+    QHash<QString, QVector<int>> m_dirsByName;
+};
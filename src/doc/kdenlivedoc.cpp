@@ -582,26 +582,19 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
            (width < 0 || width > m_documentProperties.value(QStringLiteral("proxyimageminsize")).toInt());
 }
 
-void KdenliveDoc::slotAutoSave(const QString &scene)
+bool KdenliveDoc::writeAutoSave(const QByteArray &scene)
 {
-    if (m_autosave != nullptr) {
-        if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
-            // show error: could not open the autosave file
-            qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
-            pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
-            return;
-        }
-        if (scene.isEmpty()) {
-            // Make sure we don't save if scenelist is corrupted
-            KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
-            return;
-        }
-        m_autosave->resize(0);
-        if (m_autosave->write(scene.toUtf8()) < 0) {
-            pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
-        }
-        m_autosave->flush();
+    if (m_autosave == nullptr) {
+        return true;
+    }
+    if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
+        qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
+        return false;
     }
+    m_autosave->resize(0);
+    bool result = m_autosave->write(scene) == scene.size();
+    m_autosave->flush();
+    return result;
 }
 
 void KdenliveDoc::setZoom(const QUuid &uuid, int horizontal, int vertical)
@@ -388,7 +388,7 @@ public Q_SLOTS:
 
     /** @brief Sets the document as modified or up to date.
      *
-     * If crash recovery is turned on, a timer calls KdenliveDoc::slotAutoSave() \n
+     * If crash recovery is turned on, a timer calls ProjectManager::slotAutoSave() \n
      * Emits docModified connected to MainWindow::slotUpdateDocumentState \n
      *
      * @param mod (optional) true if the document has to be saved */
@@ -398,8 +398,10 @@ public Q_SLOTS:
                               QUndoCommand *masterCommand = nullptr);
     /** @brief Saves the current project at the autosave location.
      *
-     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/ */
-    void slotAutoSave(const QString &scene);
+     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/ \n
+     * This does not interact with the GUI and can be called from a worker thread, the caller reports errors.
+     * @returns false if the autosave file could not be written */
+    bool writeAutoSave(const QByteArray &scene);
     void switchProfile(ProfileParam* pf, const QString &clipName);
 
 private Q_SLOTS:
@@ -252,6 +252,11 @@ QString EffectsRepository::assetPreferredListPath() const
 {
     return QStringLiteral(":data/preferred_effects.txt");
 }
+
+QString EffectsRepository::assetCacheName() const
+{
+    return QStringLiteral("effects.dat");
+}
 std::unique_ptr<Mlt::Filter> EffectsRepository::getEffect(const QString &effectId) const
 {
     Q_ASSERT(exists(effectId));
@@ -300,7 +305,7 @@ QPair<QString, QString> EffectsRepository::reloadCustom(const QString &path)
 bool EffectsRepository::isGroup(const QString &assetId) const
 {
     if (m_assets.count(assetId) > 0) {
-        QDomElement xml = m_assets.at(assetId).xml;
+        QDomElement xml = assetXml(m_assets.at(assetId));
         if (xml.tagName() == QLatin1String("effectgroup")) {
             return true;
         }
@@ -67,6 +67,8 @@ protected:
     /** @brief Returns the path to the effects' preferred list*/
     QString assetPreferredListPath() const override;
 
+    QString assetCacheName() const override;
+
     QStringList assetDirs() const override;
 
     void parseType(Mlt::Properties *metadata, Info &res) override;
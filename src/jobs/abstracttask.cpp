@@ -62,6 +62,16 @@ AbstractTask::AbstractTask(const ObjectId &owner, JOBTYPE type, QObject *object)
         m_priority = 5;
         break;
     }
+    switch (type) {
+    case AbstractTask::AUDIOTHUMBJOB:
+    case AbstractTask::CACHEJOB:
+        m_defaultPriorityClass = BACKGROUND;
+        break;
+    default:
+        m_defaultPriorityClass = FOREGROUND;
+        break;
+    }
+    m_priorityClass = m_defaultPriorityClass;
 }
 
 bool AbstractTask::isCanceled() const
@@ -98,6 +108,11 @@ void AbstractTask::run()
     qDebug() << "============0\n\nABSTRACT TASKSTARTRING\n\n==================";
 }
 
+void AbstractTask::yieldToPriorityTasks()
+{
+    pCore->taskManager.yieldTask(this);
+}
+
 // Background tasks should not slow down the main UI too much. Unless the user
 // has opted out, lower the priority of proxy and transcode tasks.
 void AbstractTask::setPreferredPriority(qint64 pid)
@@ -125,6 +140,13 @@ void AbstractTask::setPreferredPriority(qint64 pid)
 #endif
 }
 
+AbstractTaskDone::AbstractTaskDone(int cid, AbstractTask *task)
+    : m_cid(cid)
+    , m_task(task)
+{
+    pCore->taskManager.taskStarted(m_task);
+}
+
 AbstractTaskDone::~AbstractTaskDone() {
     pCore->taskManager.taskDone(m_cid, m_task);
 }
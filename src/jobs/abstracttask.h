@@ -37,6 +37,15 @@ public:
         MASKJOB = 12,
         MELTJOB = 13
     };
+    /** @brief Scheduling classes, tasks of a higher class are started first */
+    enum PRIORITYCLASS {
+        /** Tasks nobody is waiting for (audio thumbnails, thumbnail cache) */
+        BACKGROUND = 0,
+        /** Tasks requested by the user (clip loading, transcoding, ...) */
+        FOREGROUND = 1,
+        /** Tasks of the clip the user is currently working on */
+        INTERACTIVE = 2
+    };
     AbstractTask(const ObjectId &owner, JOBTYPE type, QObject* object);
     ~AbstractTask() override;
     static void closeAll();
@@ -58,11 +67,23 @@ protected:
     QUuid m_uuid;
     void run() override;
     void cleanup();
+    /** @brief Long background tasks should call this regularly: it pauses the task while tasks of a higher priority class are waiting for a thread */
+    void yieldToPriorityTasks();
 
 private:
     //QString cacheKey();
     JOBTYPE m_type;
     int m_priority;
+    /** The scheduling class of this job type, see PRIORITYCLASS */
+    PRIORITYCLASS m_defaultPriorityClass;
+    /** The current scheduling class */
+    QAtomicInt m_priorityClass;
+    /** The class the task was started with, -1 if not started */
+    int m_runningClass{-1};
+    /** True when the task was pushed on a thread pool (waiting or running) */
+    bool m_submitted{false};
+    /** True when the task is waiting for a thread in the task pool */
+    QAtomicInt m_queued;
     bool cancelJob(bool softDelete = false);
     bool isCanceled() const;
 
@@ -75,9 +96,7 @@ Q_SIGNALS:
  */
 class AbstractTaskDone {
 public:
-    AbstractTaskDone(int cid, AbstractTask *task)
-        : m_cid(cid)
-        , m_task(task) {}
+    AbstractTaskDone(int cid, AbstractTask *task);
     ~AbstractTaskDone();
 private:
     int m_cid;
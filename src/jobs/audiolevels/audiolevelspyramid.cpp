@@ -0,0 +1,139 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "audiolevelspyramid.h"
+#include "generators.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Identifies the reduced levels following the full resolution ones in the audio levels cache files
+constexpr quint32 pyramidMagic = 0x4b444150; // KDAP
+constexpr quint32 pyramidVersion = 1;
+
+/** @brief Returns the next level, where each point is the maximum of 2 points of @p level */
+QVector<int16_t> reduce(const QVector<int16_t> &level, int channels)
+{
+    const int points = level.size() / channels;
+    QVector<int16_t> reduced(((points + 1) / 2) * channels);
+    const int16_t *in = level.constData();
+    int16_t *out = reduced.data();
+    for (int i = 0; i + 1 < points; i += 2) {
+        for (int ch = 0; ch < channels; ++ch) {
+            *out++ = std::max(in[ch], in[channels + ch]);
+        }
+        in += 2 * channels;
+    }
+    if (points % 2 == 1) {
+        std::copy(in, in + channels, out);
+    }
+    return reduced;
+}
+} // namespace
+
+AudioLevelsPyramid::AudioLevelsPyramid(const QVector<int16_t> &levels, int channels)
+{
+    if (channels <= 0 || levels.isEmpty() || levels.size() % channels != 0) {
+        return;
+    }
+    m_channels = channels;
+    m_levels << levels;
+    while (m_levels.constLast().size() > channels) {
+        m_levels << reduce(m_levels.constLast(), channels);
+    }
+}
+
+bool AudioLevelsPyramid::isEmpty() const
+{
+    return m_levels.isEmpty();
+}
+
+int AudioLevelsPyramid::channels() const
+{
+    return m_channels;
+}
+
+int AudioLevelsPyramid::levelCount() const
+{
+    return m_levels.size();
+}
+
+const QVector<int16_t> &AudioLevelsPyramid::level(int k) const
+{
+    return m_levels.at(k);
+}
+
+int AudioLevelsPyramid::pointCount(int k) const
+{
+    return m_levels.at(k).size() / m_channels;
+}
+
+int AudioLevelsPyramid::levelForDensity(double pointsPerPixel) const
+{
+    if (m_levels.isEmpty() || pointsPerPixel < 2) {
+        return 0;
+    }
+    const int k = int(std::floor(std::log2(pointsPerPixel)));
+    return std::min(k, m_levels.size() - 1);
+}
+
+QVector<int16_t> AudioLevelsPyramid::peaks(int first, int count, int outputPoints) const
+{
+    QVector<int16_t> result;
+    if (m_levels.isEmpty() || outputPoints <= 0 || count <= 0 || first < 0 || first >= pointCount(0)) {
+        return result;
+    }
+    const int k = levelForDensity(double(count) / outputPoints);
+    const int start = first >> k;
+    // Include the partially covered block at the end of the range
+    const int end = std::min(pointCount(k), ((first + count - 1) >> k) + 1);
+    result.resize(outputPoints * m_channels);
+    computePeaks(m_levels.at(k).constData() + start * m_channels, result.data(), m_channels, end - start, outputPoints);
+    return result;
+}
+
+void AudioLevelsPyramid::writeReduced(QDataStream &out) const
+{
+    out << pyramidMagic << pyramidVersion << qint32(m_channels) << qint32(std::max(0, int(m_levels.size()) - 1));
+    for (int k = 1; k < m_levels.size(); ++k) {
+        out << m_levels.at(k);
+    }
+}
+
+bool AudioLevelsPyramid::readReduced(QDataStream &in, const QVector<int16_t> &levels)
+{
+    m_channels = 0;
+    m_levels.clear();
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 channels = 0;
+    qint32 count = 0;
+    in >> magic >> version >> channels >> count;
+    if (in.status() != QDataStream::Ok || magic != pyramidMagic || version != pyramidVersion || channels <= 0 || count < 0 || levels.isEmpty() ||
+        levels.size() % channels != 0) {
+        return false;
+    }
+    QVector<QVector<int16_t>> result;
+    result.reserve(count + 1);
+    result << levels;
+    for (int k = 1; k <= count; ++k) {
+        QVector<int16_t> level;
+        in >> level;
+        // Each level must have half the points of the previous one
+        const int expectedPoints = (result.constLast().size() / channels + 1) / 2;
+        if (in.status() != QDataStream::Ok || level.size() != expectedPoints * channels) {
+            return false;
+        }
+        result << level;
+    }
+    if (result.constLast().size() > channels) {
+        // Incomplete pyramid
+        return false;
+    }
+    m_channels = channels;
+    m_levels = result;
+    return true;
+}
@@ -0,0 +1,47 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDataStream>
+#include <QVector>
+
+/** @class AudioLevelsPyramid
+    @brief Multi-resolution representation of the audio levels of a stream, used to draw waveforms at any zoom level
+    without walking all the full resolution levels.
+    Level 0 is the full resolution interleaved levels (AUDIOLEVELS_POINTS_PER_FRAME points per frame) and each point of level k
+    is the maximum of 2^k points of level 0, for each channel. The full resolution levels are shared, not copied.
+ */
+class AudioLevelsPyramid
+{
+public:
+    AudioLevelsPyramid() = default;
+    /** @brief Build the pyramid of full resolution interleaved levels */
+    AudioLevelsPyramid(const QVector<int16_t> &levels, int channels);
+
+    bool isEmpty() const;
+    int channels() const;
+    /** @brief Number of levels, including the full resolution one */
+    int levelCount() const;
+    /** @brief Interleaved points of level k */
+    const QVector<int16_t> &level(int k) const;
+    /** @brief Number of points per channel of level k */
+    int pointCount(int k) const;
+    /** @brief Returns the coarsest level where a point covers at most @p pointsPerPixel full resolution points */
+    int levelForDensity(double pointsPerPixel) const;
+    /** @brief Returns the peaks of the full resolution points [first, first + count[ downsampled to @p outputPoints points per channel,
+        reading the coarsest level that keeps at least one point per output point */
+    QVector<int16_t> peaks(int first, int count, int outputPoints) const;
+
+    /** @brief Write the levels above the full resolution one (which is stored separately) */
+    void writeReduced(QDataStream &out) const;
+    /** @brief Read the levels written by writeReduced for these full resolution levels.
+        Returns false (and leaves the pyramid empty) if the data is missing or does not match */
+    bool readReduced(QDataStream &in, const QVector<int16_t> &levels);
+
+private:
+    int m_channels{0};
+    QVector<QVector<int16_t>> m_levels;
+};
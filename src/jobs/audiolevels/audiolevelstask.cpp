@@ -56,6 +56,18 @@ void AudioLevelsTask::storeLevels(const std::shared_ptr<ProjectClip> &binClip, c
     producer->unlock();
 }
 
+void AudioLevelsTask::storePyramid(const std::shared_ptr<ProjectClip> &binClip, const int stream, const AudioLevelsPyramid &pyramid)
+{
+    const auto producer = binClip->originalProducer();
+    producer->lock();
+
+    auto *pyramidCopy = new AudioLevelsPyramid(pyramid);
+    producer->set(QStringLiteral("_kdenlive:audiopyramid%1").arg(stream).toUtf8().constData(), pyramidCopy, 0,
+                  [](void *ptr) { delete static_cast<AudioLevelsPyramid *>(ptr); });
+
+    producer->unlock();
+}
+
 void AudioLevelsTask::storeMax(const std::shared_ptr<ProjectClip> &binClip, const int stream, const QVector<int16_t> &levels)
 {
     const auto max = *std::max_element(levels.constBegin(), levels.constEnd());
@@ -66,7 +78,7 @@ void AudioLevelsTask::storeMax(const std::shared_ptr<ProjectClip> &binClip, cons
     producer->unlock();
 }
 
-QVector<int16_t> AudioLevelsTask::getLevelsFromCache(const QString &cachePath)
+QVector<int16_t> AudioLevelsTask::getLevelsFromCache(const QString &cachePath, AudioLevelsPyramid *pyramid)
 {
     qDebug() << "Loading audio levels from cache" << cachePath;
     QFile file(cachePath);
@@ -74,18 +86,25 @@ QVector<int16_t> AudioLevelsTask::getLevelsFromCache(const QString &cachePath)
     if (file.open(QIODevice::ReadOnly)) {
         QDataStream in(&file);
         in >> levels;
+        // Older cache files only contain the full resolution levels
+        if (pyramid != nullptr && !in.atEnd()) {
+            pyramid->readReduced(in, levels);
+        }
         file.close();
     }
     return levels;
 }
 
-void AudioLevelsTask::saveLevelsToCache(const QString &cachePath, const QVector<int16_t> &levels)
+void AudioLevelsTask::saveLevelsToCache(const QString &cachePath, const QVector<int16_t> &levels, const AudioLevelsPyramid &pyramid)
 {
     qDebug() << "Saving audio levels to cache" << cachePath;
     QFile file(cachePath);
     if (file.open(QIODevice::WriteOnly)) {
         QDataStream out(&file);
         out << levels;
+        if (!pyramid.isEmpty()) {
+            pyramid.writeReduced(out);
+        }
         file.close();
     } else {
         qWarning() << "Could not write to audiothumb file: " << cachePath;
@@ -158,7 +177,29 @@ void AudioLevelsTask::run()
     }
 
     const QMap<int, QString> streams = binClip->audioInfo()->streams();
+    // When several streams of a media file need to be generated, decode them all in a single pass over the file
+    QList<int> libavStreams;
+    QMap<int, QVector<int16_t>> libavLevels;
+    if (service == QStringLiteral("avformat")) {
+        for (auto streamIdx = streams.cbegin(), end = streams.cend(); streamIdx != end; ++streamIdx) {
+            const QString cachePath = binClip->getAudioThumbPath(streamIdx.key());
+            if (m_isForce || cachePath.isEmpty() || !QFile::exists(cachePath)) {
+                libavStreams << streamIdx.key();
+            }
+        }
+        if (libavStreams.size() > 1 && !m_isCanceled) {
+            auto clbk = [this, binClip](const int streamIdx, const int progress, const QVector<int16_t> &levels) {
+                progressCallback(binClip, levels, streamIdx, progress);
+            };
+            const QString res = QString::fromUtf8(producer->get("resource"));
+            libavLevels = generateLibavStreams(libavStreams, res, lengthInFrames, producer->get_fps(), clbk, m_isCanceled, pCore->taskManager.availableThreads());
+        } else {
+            libavStreams.clear();
+        }
+    }
     for (auto streamIdx = streams.cbegin(), end = streams.cend(); streamIdx != end; ++streamIdx) {
+        // Let the tasks of the clip displayed in monitor run first
+        yieldToPriorityTasks();
         if (m_isCanceled) {
             break;
         }
@@ -169,10 +210,11 @@ void AudioLevelsTask::run()
 
         const QString cachePath = binClip->getAudioThumbPath(streamIdx.key());
         QVector<int16_t> levels;
+        AudioLevelsPyramid pyramid;
         bool skipSaving = cachePath.isEmpty();
         if (!m_isCanceled && !m_isForce && !cachePath.isEmpty() && QFile::exists(cachePath)) {
             // load from cache
-            levels = getLevelsFromCache(cachePath);
+            levels = getLevelsFromCache(cachePath, &pyramid);
             skipSaving = true;
         }
 
@@ -180,7 +222,12 @@ void AudioLevelsTask::run()
             // if the resource is a media file, we can use libav for speed
             const auto fps = producer->get_fps();
             const QString res = qstrdup(producer->get("resource"));
-            levels = generateLibav(streamIdx.key(), res, lengthInFrames, fps, clbk, m_isCanceled);
+            if (libavStreams.contains(streamIdx.key())) {
+                // Already processed with the other streams
+                levels = libavLevels.take(streamIdx.key());
+            } else {
+                levels = generateLibav(streamIdx.key(), res, lengthInFrames, fps, clbk, m_isCanceled, pCore->taskManager.availableThreads());
+            }
         }
 
         if (!m_isCanceled && levels.empty()) {
@@ -204,10 +251,15 @@ void AudioLevelsTask::run()
         }
 
         if (!m_isCanceled && !levels.empty()) {
+            if (pyramid.isEmpty()) {
+                // Build the reduced levels once, so that drawing zoomed out waveforms does not have to process all the levels
+                pyramid = AudioLevelsPyramid(levels, binClip->audioInfo()->channelsForStream(streamIdx.key()));
+            }
             storeLevels(binClip, streamIdx.key(), levels);
+            storePyramid(binClip, streamIdx.key(), pyramid);
             storeMax(binClip, streamIdx.key(), levels);
             if (!skipSaving && !isTimeline) {
-                saveLevelsToCache(cachePath, levels);
+                saveLevelsToCache(cachePath, levels, pyramid);
             }
             m_progress = 100;
             QMetaObject::invokeMethod(m_object, "updateJobProgress");
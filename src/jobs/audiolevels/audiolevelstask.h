@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "audiolevelspyramid.h"
 #include "jobs/abstracttask.h"
 
 #include <QElapsedTimer>
@@ -21,14 +22,17 @@ class AudioLevelsTask : public AbstractTask
 public:
     AudioLevelsTask(const ObjectId &owner, QObject *object);
     static void start(const ObjectId &owner, QObject *object, bool force = false);
-    static QVector<int16_t> getLevelsFromCache(const QString &cachePath);
-    static void saveLevelsToCache(const QString &cachePath, const QVector<int16_t> &levels);
+    /** @brief Read the levels from a cache file. If @p pyramid is set, it is filled with the reduced levels stored in the file, if any */
+    static QVector<int16_t> getLevelsFromCache(const QString &cachePath, AudioLevelsPyramid *pyramid = nullptr);
+    /** @brief Write the levels to a cache file, followed by the reduced levels of the pyramid if it is not empty */
+    static void saveLevelsToCache(const QString &cachePath, const QVector<int16_t> &levels, const AudioLevelsPyramid &pyramid = AudioLevelsPyramid());
 
 protected:
     void run() override;
 
 private:
     static void storeLevels(const std::shared_ptr<ProjectClip> &binClip, int stream, const QVector<int16_t> &levels);
+    static void storePyramid(const std::shared_ptr<ProjectClip> &binClip, int stream, const AudioLevelsPyramid &pyramid);
     static void storeMax(const std::shared_ptr<ProjectClip> &binClip, int stream, const QVector<int16_t> &levels);
     void progressCallback(const std::shared_ptr<ProjectClip> &binClip, const QVector<int16_t> &levels, int streamIdx, int progress);
     QElapsedTimer m_timer;
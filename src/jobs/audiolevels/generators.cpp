@@ -12,7 +12,19 @@
 #include <KMessageWidget>
 #include <QDebug>
 #include <QElapsedTimer>
+#include <QMutex>
+#include <QThreadPool>
 #include <QVector>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include <mlt++/MltFilter.h>
 #include <mlt++/MltFrame.h>
@@ -38,6 +50,101 @@ av_always_inline QString av_err2string(int errnum)
 #define av_err2str(err) av_err2string(err).toLatin1().constData();
 #endif // av_err2str
 
+namespace {
+// Maximum number of SIMD vectors needed to cover a whole number of interleaved sample frames
+constexpr size_t maxBlockVectors = 8;
+
+/** @brief Absolute value of a sample, -32768 is clipped to 32767 */
+inline int16_t absSample(int16_t value)
+{
+    return value == INT16_MIN ? INT16_MAX : static_cast<int16_t>(std::abs(value));
+}
+
+/** @brief Returns the window of input samples [start, end[ used for an output sample. A window always has at least one sample */
+inline void peakWindow(size_t outIdx, float scale, size_t nSamplesIn, size_t &start, size_t &end)
+{
+    start = outIdx * scale;
+    end = (outIdx + 1) * scale;
+    if (end > nSamplesIn) end = nSamplesIn;
+    if (end <= start) end = start + 1;
+    Q_ASSERT(start < nSamplesIn);
+}
+
+/** @brief Updates the peak of each channel with @p count interleaved sample frames */
+void interleavedPeaks(const int16_t *in, size_t count, size_t nChannels, int16_t *peaks)
+{
+    size_t done = 0;
+#ifdef __SSE2__
+    // Process blocks of vectors covering a whole number of sample frames, so that each lane always sees the same channel
+    constexpr size_t lanes = 8;
+    size_t a = nChannels, b = lanes;
+    while (b != 0) {
+        const size_t r = a % b;
+        a = b;
+        b = r;
+    }
+    const size_t blockVectors = nChannels / a;
+    const size_t blockFrames = blockVectors * lanes / nChannels;
+    const size_t blocks = count / blockFrames;
+    if (blockVectors <= maxBlockVectors && blocks > 0) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i maxima[maxBlockVectors];
+        for (size_t v = 0; v < blockVectors; ++v) {
+            maxima[v] = zero;
+        }
+        const int16_t *pIn = in;
+        for (size_t block = 0; block < blocks; ++block) {
+            for (size_t v = 0; v < blockVectors; ++v, pIn += lanes) {
+                const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pIn));
+                // Saturating negation, so that -32768 gives 32767
+                const __m128i absolute = _mm_max_epi16(samples, _mm_subs_epi16(zero, samples));
+                maxima[v] = _mm_max_epi16(maxima[v], absolute);
+            }
+        }
+        int16_t values[lanes];
+        for (size_t v = 0; v < blockVectors; ++v) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(values), maxima[v]);
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                int16_t &peak = peaks[(v * lanes + lane) % nChannels];
+                peak = std::max(peak, values[lane]);
+            }
+        }
+        done = blocks * blockFrames;
+    }
+#endif
+    for (size_t frame = done; frame < count; ++frame) {
+        const int16_t *pIn = in + frame * nChannels;
+        for (size_t ch = 0; ch < nChannels; ++ch) {
+            peaks[ch] = std::max(peaks[ch], absSample(pIn[ch]));
+        }
+    }
+}
+
+/** @brief Returns the maximum absolute value of @p count samples of a channel */
+float planarPeak(const float *in, size_t count)
+{
+    float peak = 0.f;
+    size_t done = 0;
+#ifdef __SSE2__
+    constexpr size_t lanes = 4;
+    if (count >= lanes) {
+        const __m128 signMask = _mm_set1_ps(-0.f);
+        __m128 maxima = _mm_setzero_ps();
+        for (; done + lanes <= count; done += lanes) {
+            maxima = _mm_max_ps(maxima, _mm_andnot_ps(signMask, _mm_loadu_ps(in + done)));
+        }
+        float values[lanes];
+        _mm_storeu_ps(values, maxima);
+        peak = std::max(std::max(values[0], values[1]), std::max(values[2], values[3]));
+    }
+#endif
+    for (; done < count; ++done) {
+        peak = std::max(peak, std::fabs(in[done]));
+    }
+    return peak;
+}
+} // namespace
+
 void computePeaks(const int16_t *in, int16_t *out, const size_t nChannels, const size_t nSamplesIn, const size_t nSamplesOut)
 {
     Q_ASSERT(in != nullptr);
@@ -48,24 +155,33 @@ void computePeaks(const int16_t *in, int16_t *out, const size_t nChannels, const
 
     const float scale = static_cast<float>(nSamplesIn) / nSamplesOut;
 
-    for (size_t ch = 0; ch < nChannels; ++ch) {
-        const auto *pIn = in + ch; // Pointer to the start of the current channel in the input
-        auto *pOut = out + ch;     // Pointer to the start of the current channel in the output
+    // All the channels are processed in a single pass over each window
+    for (size_t outIdx = 0; outIdx < nSamplesOut; ++outIdx) {
+        size_t start, end;
+        peakWindow(outIdx, scale, nSamplesIn, start, end);
+        int16_t *peaks = out + outIdx * nChannels;
+        std::fill(peaks, peaks + nChannels, 0);
+        interleavedPeaks(in + start * nChannels, end - start, nChannels, peaks);
+    }
+}
 
-        for (size_t outIdx = 0; outIdx < nSamplesOut; ++outIdx) {
-            // [start, end] is a sliding window over the input samples
-            const size_t start = outIdx * scale;
-            size_t end = (outIdx + 1) * scale;
-            if (end > nSamplesIn) end = nSamplesIn;
+void computePeaks(const float *const *in, int16_t *out, const size_t nChannels, const size_t nSamplesIn, const size_t nSamplesOut)
+{
+    Q_ASSERT(in != nullptr);
+    Q_ASSERT(out != nullptr);
+    Q_ASSERT(nSamplesOut > 0);
+    Q_ASSERT(nSamplesIn > 0);
+    Q_ASSERT(nChannels > 0);
 
-            Q_ASSERT(start < nSamplesIn);
-            Q_ASSERT(outIdx < nSamplesOut);
+    const float scale = static_cast<float>(nSamplesIn) / nSamplesOut;
 
-            int16_t maxValue = std::abs(pIn[start * nChannels]);
-            for (size_t inIdx = start; inIdx < end; ++inIdx) {
-                maxValue = std::max(maxValue, static_cast<int16_t>(std::abs(pIn[inIdx * nChannels])));
-            }
-            pOut[outIdx * nChannels] = maxValue;
+    for (size_t outIdx = 0; outIdx < nSamplesOut; ++outIdx) {
+        size_t start, end;
+        peakWindow(outIdx, scale, nSamplesIn, start, end);
+        for (size_t ch = 0; ch < nChannels; ++ch) {
+            // Same rounding as the float to s16 conversion of libswresample, clipped to 32767 like the absolute value of 16 bit samples
+            const float peak = planarPeak(in[ch] + start, end - start);
+            out[outIdx * nChannels + ch] = peak >= 1.f ? INT16_MAX : static_cast<int16_t>(std::min(lrintf(peak * 32768.f), long(INT16_MAX)));
         }
     }
 }
@@ -131,230 +247,576 @@ QVector<int16_t> generateMLT(const size_t streamIdx, const QString &service, con
     return levels;
 }
 
-QVector<int16_t> generateLibav(const size_t streamIdx, const QString &uri, const size_t MLTlengthInFrames, const double MLTfps,
-                               const std::function<void(int progress, const QVector<int16_t> &levels)> &progressCallback, const QAtomicInt &isCanceled)
-{
-    qDebug() << "Generating audio levels for stream" << streamIdx << "of" << uri << "using libav";
-    QElapsedTimer timer;
-    timer.start();
-
-    int ret = 0;
-    size_t MLTFrameCount = 0;
+namespace {
+// Number of packets demuxed before they are dispatched to the stream decoders
+constexpr int packetsPerBatch = 256;
+// Chunks shorter than this (in MLT frames) are not worth the cost of opening the file again
+constexpr size_t minChunkFrames = 1500;
+// Decoding starts this long (in seconds) before a chunk, so that the decoder is primed when reaching the chunk
+constexpr int chunkPreroll = 1;
 
+/** @brief Opens a media file and reads its streams information. Returns nullptr on error */
+AVFormatContext *openMediaFile(const QString &uri)
+{
     AVFormatContext *fmt_ctx = nullptr;
-    const AVCodec *codec = nullptr;
-    AVPacket *packet = av_packet_alloc();
-    AVFrame *frame = av_frame_alloc();
-    const AVStream *stream = nullptr;
-    AVCodecContext *codec_ctx = nullptr;
-    QVector<int16_t> levels;
-    SwrContext *swr_ctx = nullptr;
-
-    uint8_t **buf = nullptr;
-    int buf_nbsamples = 0, max_buf_nbsamples = 0;
-    int src_rate, dst_rate;
-    int src_nb_channels, dst_nb_channels;
-    int dst_linesize;
-    int dst_nb_samples = 0;
-    int samplesPerMLTFrame = 0;
-    AVSampleFormat src_sample_fmt, dst_sample_fmt;
-    AVChannelLayout *src_ch_layout, *dst_ch_layout;
-    AVAudioFifo *fifo = nullptr;
-
-    // Open file
-    ret = avformat_open_input(&fmt_ctx, uri.toLocal8Bit().data(), nullptr, nullptr);
+    int ret = avformat_open_input(&fmt_ctx, uri.toLocal8Bit().data(), nullptr, nullptr);
     if (ret < 0) {
         qWarning() << "Could not open input file" << uri << ":" << av_err2string(ret);
-        goto cleanup;
+        return nullptr;
     }
     ret = avformat_find_stream_info(fmt_ctx, nullptr);
     if (ret < 0) {
         qWarning() << "Could not find stream information:" << av_err2string(ret);
-        goto cleanup;
+        avformat_close_input(&fmt_ctx);
+        return nullptr;
     }
+    return fmt_ctx;
+}
 
+/** @brief Returns true if the audio stream can be processed with libav */
+bool isSupportedStream(const AVFormatContext *fmt_ctx, size_t streamIdx)
+{
     if (streamIdx >= fmt_ctx->nb_streams) {
         qWarning() << "Invalid stream index" << streamIdx;
-        goto cleanup;
+        return false;
     }
-
-    // Find and open codec for requested stream
-    stream = fmt_ctx->streams[streamIdx];
-
     // check for delay
-    if (stream->start_time > 0) {
+    if (fmt_ctx->streams[streamIdx]->start_time > 0) {
         // TODO: Handle delay in our libav code
         // Stream with a delay, not currently handled in our avformat code, switch to MLT
         qWarning() << "Stream with delay, switching to MLT" << streamIdx;
-        goto cleanup;
+        return false;
     }
+    return true;
+}
 
-    // Set discard flag for all streams except our target audio stream to reduce unnecessary I/O operations
+/** @brief Set discard flag for all streams except our target audio streams to reduce unnecessary I/O operations */
+void discardOtherStreams(AVFormatContext *fmt_ctx, const std::vector<size_t> &streams)
+{
     for (unsigned int i = 0; i < fmt_ctx->nb_streams; i++) {
-        if (i != streamIdx) {
+        if (std::find(streams.begin(), streams.end(), size_t(i)) == streams.end()) {
             fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
         }
     }
+}
 
-    codec = avcodec_find_decoder(stream->codecpar->codec_id);
-    if (!codec) {
-        qWarning() << "No suitable decoder found for" << avcodec_get_name(stream->codecpar->codec_id);
-        goto cleanup;
-    }
-
-    codec_ctx = avcodec_alloc_context3(codec);
-    if (!codec_ctx) {
-        qWarning() << "Failed to allocate codec context";
-        goto cleanup;
+/** @class LevelsDecoder
+    @brief Decodes the packets of an audio stream and computes the levels of a range of MLT frames.
+    By default, the range starts with the first decoded sample and extends up to the end of the stream.
+ */
+class LevelsDecoder
+{
+public:
+    /** @param firstFrame first MLT frame of the range. If it is not 0, the samples are positioned from their timestamp relative to @p origin
+        @param endFrame MLT frame following the range, or 0 to process the stream up to its end */
+    LevelsDecoder(size_t MLTlengthInFrames, double MLTfps, size_t firstFrame = 0, size_t endFrame = 0, int64_t origin = 0)
+        : m_lengthInFrames(MLTlengthInFrames)
+        , m_fps(MLTfps)
+        , m_firstFrame(firstFrame)
+        , m_endFrame(endFrame)
+        , m_origin(origin)
+        , m_frameCount(firstFrame)
+    {
     }
-
-    ret = avcodec_parameters_to_context(codec_ctx, stream->codecpar);
-    if (ret < 0) {
-        qWarning() << "Failed to copy codec parameters to codec:" << av_err2string(ret);
-        goto cleanup;
+    ~LevelsDecoder()
+    {
+        if (m_buf) {
+            av_freep(&m_buf[0]);
+        }
+        av_freep(&m_buf);
+        av_audio_fifo_free(m_fifo);
+        av_frame_free(&m_frame);
+        avcodec_free_context(&m_codecCtx);
+        swr_free(&m_swrCtx);
     }
 
-    // Request s16 to codec, if possible
-    codec_ctx->request_sample_fmt = AV_SAMPLE_FMT_S16; // == interleaved uint16_t
-
-    ret = avcodec_open2(codec_ctx, codec, nullptr);
-    if (ret < 0) {
-        qWarning() << "Failed to open codec:" << av_err2string(ret);
-        goto cleanup;
-    }
+    /** @brief Open the decoder for this stream. Returns false on error */
+    bool open(const AVStream *stream)
+    {
+        m_timeBase = stream->time_base;
+        const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+        if (!codec) {
+            qWarning() << "No suitable decoder found for" << avcodec_get_name(stream->codecpar->codec_id);
+            return false;
+        }
+        m_codecCtx = avcodec_alloc_context3(codec);
+        m_frame = av_frame_alloc();
+        if (!m_codecCtx || !m_frame) {
+            qWarning() << "Failed to allocate codec context";
+            return false;
+        }
+        int ret = avcodec_parameters_to_context(m_codecCtx, stream->codecpar);
+        if (ret < 0) {
+            qWarning() << "Failed to copy codec parameters to codec:" << av_err2string(ret);
+            return false;
+        }
+        // Request s16 to codec, if possible
+        m_codecCtx->request_sample_fmt = AV_SAMPLE_FMT_S16; // == interleaved uint16_t
+        ret = avcodec_open2(m_codecCtx, codec, nullptr);
+        if (ret < 0) {
+            qWarning() << "Failed to open codec:" << av_err2string(ret);
+            return false;
+        }
 
-    // Add a sample format converter (will no-op if the codec is able to directly output s16)
-    src_ch_layout = &codec_ctx->ch_layout;
-    dst_ch_layout = src_ch_layout;
-    src_nb_channels = codec_ctx->ch_layout.nb_channels;
-    dst_nb_channels = src_nb_channels;
-    src_sample_fmt = codec_ctx->sample_fmt;
-    dst_sample_fmt = AV_SAMPLE_FMT_S16;
-    src_rate = codec_ctx->sample_rate;
-    dst_rate = src_rate;
+        m_channels = m_codecCtx->ch_layout.nb_channels;
+        m_rate = m_codecCtx->sample_rate;
+        const AVSampleFormat src_sample_fmt = m_codecCtx->sample_fmt;
+        // Interleaved s16 and planar float (the native format of most lossy codecs) can be processed directly
+        m_nativeFormat = src_sample_fmt == AV_SAMPLE_FMT_S16 || src_sample_fmt == AV_SAMPLE_FMT_FLTP;
+        if (m_nativeFormat) {
+            m_sampleFmt = src_sample_fmt;
+        } else {
+            // Add a sample format converter
+            m_sampleFmt = AV_SAMPLE_FMT_S16;
+            ret = swr_alloc_set_opts2(&m_swrCtx, &m_codecCtx->ch_layout, m_sampleFmt, m_rate, &m_codecCtx->ch_layout, src_sample_fmt, m_rate, 0, nullptr);
+            if (ret < 0) {
+                qWarning() << "Failed to set SwrContext options:" << av_err2string(ret);
+                return false;
+            }
+            if ((ret = swr_init(m_swrCtx)) < 0) {
+                qWarning() << "Failed to initialize SwrContext:" << av_err2string(ret);
+                return false;
+            }
+        }
 
-    ret = swr_alloc_set_opts2(&swr_ctx, dst_ch_layout, dst_sample_fmt, dst_rate, src_ch_layout, src_sample_fmt, src_rate, 0, nullptr);
-    if (ret < 0) {
-        qWarning() << "Failed to set SwrContext options:" << av_err2string(ret);
-        goto cleanup;
-    }
+        // Allocate fifo with a bit of space (will be grown automatically)
+        m_samplesPerMLTFrame = mlt_audio_calculate_frame_samples(m_fps, m_rate, m_frameCount);
+        m_fifo = av_audio_fifo_alloc(m_sampleFmt, m_channels, 2 * m_samplesPerMLTFrame);
 
-    if ((ret = swr_init(swr_ctx)) < 0) {
-        qWarning() << "Failed to initialize SwrContext:" << av_err2string(ret);
-        goto cleanup;
+        // Allocate levels
+        m_levels.resize(((m_endFrame > 0 ? m_endFrame : m_lengthInFrames) - m_firstFrame) * AUDIOLEVELS_POINTS_PER_FRAME * m_channels);
+        m_interval = qMax(1, static_cast<int>(m_lengthInFrames / 100));
+        return true;
     }
 
-    // Allocate fifo with a bit of space (will be grown automatically)
-    samplesPerMLTFrame = mlt_audio_calculate_frame_samples(MLTfps, dst_rate, 0);
-    fifo = av_audio_fifo_alloc(dst_sample_fmt, dst_nb_channels, 2 * samplesPerMLTFrame);
-
-    // Allocate levels
-    levels.resize(MLTlengthInFrames * AUDIOLEVELS_POINTS_PER_FRAME * dst_nb_channels);
-
-    // /!\ libav frames != MLT frames !
-    // Read each packet in the stream
-    while (av_read_frame(fmt_ctx, packet) >= 0) {
-        if (isCanceled) {
-            levels.clear();
-            break;
-        }
-
-        if (packet->stream_index != streamIdx) {
-            av_packet_unref(packet);
-            continue;
-        }
+    /** @brief Set a function called 100 times during the processing */
+    void setProgressCallback(const std::function<void(int progress, const QVector<int16_t> &levels)> &progressCallback) { m_progressCallback = progressCallback; }
 
+    /** @brief Send a packet to the decoder and compute the levels of the completed MLT frames. Returns false on error */
+    bool decode(const AVPacket *packet)
+    {
         // Send encoded packet to the decoder .....
-        if ((ret = avcodec_send_packet(codec_ctx, packet)) < 0) {
+        int ret = avcodec_send_packet(m_codecCtx, packet);
+        if (ret < 0) {
             qWarning() << "Error sending packet for decoding: " << av_err2string(ret);
-            levels.clear();
-            break;
+            return false;
         }
-        int interval = qMax(1, static_cast<int>(MLTlengthInFrames / 100));
-
         // .... which can output more than 1 audio frame per packet
-        while (ret >= 0) {
-            ret = avcodec_receive_frame(codec_ctx, frame);
+        while (!isComplete()) {
+            ret = avcodec_receive_frame(m_codecCtx, m_frame);
             if (ret == AVERROR(EAGAIN)) {
                 break; // we're done with this packet
             }
             if (ret < 0) {
                 qWarning() << "Error during decoding: " << av_err2string(ret);
-                levels.clear();
-                goto cleanup;
+                return false;
             }
+            if (m_firstTimestamp == AV_NOPTS_VALUE) {
+                m_firstTimestamp = m_frame->best_effort_timestamp;
+            }
+            if (!processFrame()) {
+                return false;
+            }
+        }
+        return true;
+    }
 
-            // Grow the output buffer (only if needed) to be able to store either the output from swr, or a full MLT frame's worth of data.
-            dst_nb_samples = swr_get_out_samples(swr_ctx, frame->nb_samples);
-            buf_nbsamples = std::max(dst_nb_samples, samplesPerMLTFrame);
-            if (buf_nbsamples > max_buf_nbsamples) {
-                if (buf) {
-                    av_freep(&buf[0]);
-                }
-                av_freep(&buf);
-                ret = av_samples_alloc_array_and_samples(&buf, &dst_linesize, dst_nb_channels, buf_nbsamples, dst_sample_fmt, 0);
-                if (ret < 0) {
-                    qWarning() << "Failed to allocate output buffer:" << av_err2string(ret);
-                    levels.clear();
-                    goto cleanup;
-                }
-                max_buf_nbsamples = buf_nbsamples;
+    /** @brief True when all the frames of a bounded range were computed */
+    bool isComplete() const { return m_endFrame > 0 && m_frameCount >= m_endFrame; }
+    /** @brief Number of MLT frames computed */
+    size_t computedFrames() const { return m_frameCount - m_firstFrame; }
+    /** @brief Timestamp of the first decoded audio frame, or AV_NOPTS_VALUE if no frame was decoded yet */
+    int64_t firstTimestamp() const { return m_firstTimestamp; }
+    const QVector<int16_t> &levels() const { return m_levels; }
+
+private:
+    /** @brief Queue the samples of the decoded frame and compute the levels of the completed MLT frames */
+    bool processFrame()
+    {
+        // Grow the output buffer (only if needed) to be able to store either the output from swr, or a full MLT frame's worth of data.
+        const int dst_nb_samples = m_nativeFormat ? m_frame->nb_samples : swr_get_out_samples(m_swrCtx, m_frame->nb_samples);
+        const int buf_nbsamples = std::max(dst_nb_samples, m_samplesPerMLTFrame);
+        int ret;
+        if (buf_nbsamples > m_maxBufSamples) {
+            if (m_buf) {
+                av_freep(&m_buf[0]);
             }
+            av_freep(&m_buf);
+            int dst_linesize;
+            ret = av_samples_alloc_array_and_samples(&m_buf, &dst_linesize, m_channels, buf_nbsamples, m_sampleFmt, 0);
+            if (ret < 0) {
+                qWarning() << "Failed to allocate output buffer:" << av_err2string(ret);
+                return false;
+            }
+            m_maxBufSamples = buf_nbsamples;
+        }
 
+        if (m_nativeFormat) {
+            // Write the decoded samples into the fifo (grows automatically if needed)
+            ret = av_audio_fifo_write(m_fifo, reinterpret_cast<void **>(m_frame->extended_data), m_frame->nb_samples);
+        } else {
             // Convert sample format, put data into buffer
-            ret = swr_convert(swr_ctx, buf, dst_nb_samples, const_cast<const uint8_t **>(frame->extended_data), frame->nb_samples);
+            ret = swr_convert(m_swrCtx, m_buf, dst_nb_samples, const_cast<const uint8_t **>(m_frame->extended_data), m_frame->nb_samples);
             if (ret <= 0) {
                 qWarning() << "Failed to convert samples:" << av_err2string(ret);
-                levels.clear();
-                goto cleanup;
+                return false;
             }
-
             // Write the buffer into the fifo (grows automatically if needed)
-            ret = av_audio_fifo_write(fifo, reinterpret_cast<void **>(buf), dst_nb_samples);
-            if (ret < 0) {
-                qWarning() << "Failed to write samples to audio fifo:" << av_err2string(ret);
-                levels.clear();
-                goto cleanup;
-            }
+            ret = av_audio_fifo_write(m_fifo, reinterpret_cast<void **>(m_buf), dst_nb_samples);
+        }
+        if (ret < 0) {
+            qWarning() << "Failed to write samples to audio fifo:" << av_err2string(ret);
+            return false;
+        }
 
-            // If there is enough samples for one MLT frame in the fifo, compute the peaks and advance one MLT frame !
-            while (av_audio_fifo_size(fifo) >= samplesPerMLTFrame) {
-                av_audio_fifo_read(fifo, reinterpret_cast<void **>(buf), samplesPerMLTFrame);
-                const size_t requiredSize = (MLTFrameCount + 1) * AUDIOLEVELS_POINTS_PER_FRAME * dst_nb_channels;
-                if (requiredSize > levels.size()) {
-                    levels.resize(requiredSize);
+        if (!m_started) {
+            if (m_firstFrame == 0) {
+                m_started = true;
+            } else {
+                // Drop the samples preceding the first frame of the range
+                if (m_frame->best_effort_timestamp == AV_NOPTS_VALUE) {
+                    qWarning() << "Audio frame without timestamp, cannot position samples";
+                    return false;
                 }
-                computePeaks(reinterpret_cast<const int16_t *>(buf[0]), levels.data() + MLTFrameCount * AUDIOLEVELS_POINTS_PER_FRAME * dst_nb_channels,
-                             dst_nb_channels, samplesPerMLTFrame, AUDIOLEVELS_POINTS_PER_FRAME);
-
-                if (MLTFrameCount % interval == 0) {
-                    progressCallback(100.0 * MLTFrameCount / MLTlengthInFrames, levels);
+                const int64_t position = av_rescale_q(m_frame->best_effort_timestamp - m_origin, m_timeBase, AVRational{1, m_rate});
+                const int64_t firstSample = mlt_audio_calculate_samples_to_position(m_fps, m_rate, int64_t(m_firstFrame));
+                if (position > firstSample) {
+                    qWarning() << "Decoding started after MLT frame" << m_firstFrame;
+                    return false;
                 }
+                av_audio_fifo_drain(m_fifo, int(std::min<int64_t>(av_audio_fifo_size(m_fifo), firstSample - position)));
+                m_started = av_audio_fifo_size(m_fifo) > 0;
+            }
+        }
 
-                MLTFrameCount++;
-                if (MLTFrameCount > MLTlengthInFrames) {
-                    qWarning() << "MLT frame" << MLTFrameCount << "of" << MLTlengthInFrames << "is beyond the MLT length !!!";
-                    levels.clear();
-                    goto cleanup;
-                }
-                samplesPerMLTFrame = mlt_audio_calculate_frame_samples(MLTfps, dst_rate, MLTFrameCount);
+        // If there is enough samples for one MLT frame in the fifo, compute the peaks and advance one MLT frame !
+        while (m_started && !isComplete() && av_audio_fifo_size(m_fifo) >= m_samplesPerMLTFrame) {
+            av_audio_fifo_read(m_fifo, reinterpret_cast<void **>(m_buf), m_samplesPerMLTFrame);
+            const size_t offset = computedFrames() * AUDIOLEVELS_POINTS_PER_FRAME * m_channels;
+            const size_t requiredSize = offset + AUDIOLEVELS_POINTS_PER_FRAME * m_channels;
+            if (requiredSize > size_t(m_levels.size())) {
+                m_levels.resize(requiredSize);
+            }
+            if (m_sampleFmt == AV_SAMPLE_FMT_FLTP) {
+                computePeaks(reinterpret_cast<const float *const *>(m_buf), m_levels.data() + offset, m_channels, m_samplesPerMLTFrame,
+                             AUDIOLEVELS_POINTS_PER_FRAME);
+            } else {
+                computePeaks(reinterpret_cast<const int16_t *>(m_buf[0]), m_levels.data() + offset, m_channels, m_samplesPerMLTFrame,
+                             AUDIOLEVELS_POINTS_PER_FRAME);
+            }
+
+            if (m_progressCallback && m_frameCount % m_interval == 0) {
+                m_progressCallback(100.0 * m_frameCount / m_lengthInFrames, m_levels);
             }
+
+            m_frameCount++;
+            if (m_frameCount > m_lengthInFrames) {
+                qWarning() << "MLT frame" << m_frameCount << "of" << m_lengthInFrames << "is beyond the MLT length !!!";
+                return false;
+            }
+            m_samplesPerMLTFrame = mlt_audio_calculate_frame_samples(m_fps, m_rate, m_frameCount);
         }
+        return true;
+    }
 
+    const size_t m_lengthInFrames;
+    const double m_fps;
+    const size_t m_firstFrame;
+    const size_t m_endFrame;
+    const int64_t m_origin;
+    /** Index of the next MLT frame to compute */
+    size_t m_frameCount;
+    /** True once the first sample of the range was reached */
+    bool m_started{false};
+    int64_t m_firstTimestamp{AV_NOPTS_VALUE};
+    AVRational m_timeBase{1, 1};
+    AVCodecContext *m_codecCtx{nullptr};
+    AVFrame *m_frame{nullptr};
+    SwrContext *m_swrCtx{nullptr};
+    AVAudioFifo *m_fifo{nullptr};
+    uint8_t **m_buf{nullptr};
+    int m_maxBufSamples{0};
+    int m_channels{0};
+    int m_rate{0};
+    int m_samplesPerMLTFrame{0};
+    int m_interval{1};
+    // True if the decoded samples can be used without conversion
+    bool m_nativeFormat{false};
+    AVSampleFormat m_sampleFmt{AV_SAMPLE_FMT_S16};
+    QVector<int16_t> m_levels;
+    std::function<void(int progress, const QVector<int16_t> &levels)> m_progressCallback;
+};
+
+/** @brief Computes the levels of the MLT frames [firstFrame, endFrame[ of a stream, starting from a seek in the file.
+    Returns an empty vector on error, or if the range could not be fully decoded */
+QVector<int16_t> generateLibavChunk(const size_t streamIdx, const QString &uri, const size_t MLTlengthInFrames, const double MLTfps, size_t firstFrame,
+                                    size_t endFrame, int64_t origin, const QAtomicInt &isCanceled, QAtomicInt &computedFrames)
+{
+    AVFormatContext *fmt_ctx = openMediaFile(uri);
+    if (fmt_ctx == nullptr) {
+        return {};
+    }
+    QVector<int16_t> levels;
+    AVPacket *packet = av_packet_alloc();
+    const AVStream *stream = fmt_ctx->streams[streamIdx];
+    LevelsDecoder decoder(MLTlengthInFrames, MLTfps, firstFrame, endFrame == MLTlengthInFrames ? 0 : endFrame, origin);
+    discardOtherStreams(fmt_ctx, {streamIdx});
+    bool ok = decoder.open(stream);
+    if (ok && firstFrame > 0) {
+        const int rate = stream->codecpar->sample_rate;
+        const int64_t sample = std::max<int64_t>(0, mlt_audio_calculate_samples_to_position(MLTfps, rate, int64_t(firstFrame)) - chunkPreroll * rate);
+        const int64_t timestamp = origin + av_rescale_q(sample, AVRational{1, rate}, stream->time_base);
+        const int ret = av_seek_frame(fmt_ctx, int(streamIdx), timestamp, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            qWarning() << "Could not seek stream" << streamIdx << "of" << uri << ":" << av_err2string(ret);
+            ok = false;
+        }
+    }
+    size_t reported = 0;
+    while (ok && !decoder.isComplete() && av_read_frame(fmt_ctx, packet) >= 0) {
+        if (isCanceled) {
+            ok = false;
+        } else if (packet->stream_index == int(streamIdx)) {
+            ok = decoder.decode(packet);
+            computedFrames.fetchAndAddRelaxed(int(decoder.computedFrames() - reported));
+            reported = decoder.computedFrames();
+        }
         av_packet_unref(packet);
     }
-cleanup:
-    if (buf) {
-        av_freep(&buf[0]);
+    // A chunk ending before the end of the file must be complete to be stitched with the next one
+    if (ok && (endFrame == MLTlengthInFrames || decoder.isComplete())) {
+        levels = decoder.levels();
     }
-    av_freep(&buf);
-    av_audio_fifo_free(fifo);
-    av_frame_free(&frame);
     av_packet_free(&packet);
-    avcodec_free_context(&codec_ctx);
-    swr_free(&swr_ctx);
     avformat_close_input(&fmt_ctx);
+    return levels;
+}
+
+/** @brief Computes the audio levels of a stream by decoding chunks of the file in parallel.
+    Returns an empty vector if the file cannot be processed this way */
+QVector<int16_t> generateLibavChunked(const size_t streamIdx, const QString &uri, const size_t MLTlengthInFrames, const double MLTfps, int chunks,
+                                      const std::function<void(int progress, const QVector<int16_t> &levels)> &progressCallback, const QAtomicInt &isCanceled)
+{
+    AVFormatContext *fmt_ctx = openMediaFile(uri);
+    if (fmt_ctx == nullptr) {
+        return {};
+    }
+    // Decode the beginning of the stream to find the timestamp of the first sample, used to position the chunks
+    int64_t origin = AV_NOPTS_VALUE;
+    const bool seekable = fmt_ctx->pb != nullptr && (fmt_ctx->pb->seekable & AVIO_SEEKABLE_NORMAL) != 0;
+    if (seekable && isSupportedStream(fmt_ctx, streamIdx)) {
+        discardOtherStreams(fmt_ctx, {streamIdx});
+        LevelsDecoder probe(MLTlengthInFrames, MLTfps, 0, 1);
+        if (probe.open(fmt_ctx->streams[streamIdx])) {
+            AVPacket *packet = av_packet_alloc();
+            bool ok = true;
+            while (ok && probe.firstTimestamp() == AV_NOPTS_VALUE && av_read_frame(fmt_ctx, packet) >= 0) {
+                if (packet->stream_index == int(streamIdx)) {
+                    ok = probe.decode(packet);
+                }
+                av_packet_unref(packet);
+            }
+            av_packet_free(&packet);
+            origin = probe.firstTimestamp();
+        }
+    }
+    avformat_close_input(&fmt_ctx);
+    if (origin == AV_NOPTS_VALUE) {
+        return {};
+    }
+
+    // Chunks are decoded in parallel, each one by its own demuxer and decoder
+    struct Chunk
+    {
+        size_t firstFrame;
+        size_t endFrame;
+        QVector<int16_t> levels;
+        bool done{false};
+    };
+    std::vector<Chunk> chunkList(size_t(chunks));
+    for (size_t i = 0; i < chunkList.size(); ++i) {
+        chunkList[i].firstFrame = MLTlengthInFrames * i / chunkList.size();
+        chunkList[i].endFrame = MLTlengthInFrames * (i + 1) / chunkList.size();
+    }
+    QAtomicInt computedFrames;
+    QMutex chunkMutex;
+    QWaitCondition chunkDone;
+    QThreadPool pool;
+    pool.setMaxThreadCount(chunks);
+    QFuture<void> future = QtConcurrent::map(&pool, chunkList, [&](Chunk &chunk) {
+        QVector<int16_t> chunkLevels =
+            generateLibavChunk(streamIdx, uri, MLTlengthInFrames, MLTfps, chunk.firstFrame, chunk.endFrame, origin, isCanceled, computedFrames);
+        QMutexLocker lock(&chunkMutex);
+        chunk.levels = std::move(chunkLevels);
+        chunk.done = true;
+        chunkDone.wakeAll();
+    });
+
+    // Stitch the chunks as they are completed
+    QVector<int16_t> levels;
+    size_t stitched = 0;
+    bool ok = true;
+    QMutexLocker lock(&chunkMutex);
+    while (ok && stitched < chunkList.size()) {
+        if (!chunkList[stitched].done) {
+            // Woken up as soon as a chunk is done, the timeout only paces the progress reports
+            chunkDone.wait(&chunkMutex, 100);
+            lock.unlock();
+            progressCallback(100.0 * computedFrames.loadRelaxed() / MLTlengthInFrames, levels);
+            lock.relock();
+            continue;
+        }
+        ok = !chunkList[stitched].levels.isEmpty();
+        levels.append(chunkList[stitched].levels);
+        chunkList[stitched].levels.clear();
+        stitched++;
+    }
+    lock.unlock();
+    future.waitForFinished();
+    if (!ok) {
+        qDebug() << "Could not decode stream" << streamIdx << "of" << uri << "in chunks";
+        levels.clear();
+    }
+    return levels;
+}
+} // namespace
+
+QVector<int16_t> generateLibav(const size_t streamIdx, const QString &uri, const size_t MLTlengthInFrames, const double MLTfps,
+                               const std::function<void(int progress, const QVector<int16_t> &levels)> &progressCallback, const QAtomicInt &isCanceled,
+                               int threads)
+{
+    qDebug() << "Generating audio levels for stream" << streamIdx << "of" << uri << "using libav";
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<int16_t> levels;
+    const int chunks = int(std::min<size_t>(size_t(std::max(threads, 1)), MLTlengthInFrames / minChunkFrames));
+    if (chunks > 1) {
+        levels = generateLibavChunked(streamIdx, uri, MLTlengthInFrames, MLTfps, chunks, progressCallback, isCanceled);
+        if (isCanceled) {
+            levels.clear();
+        }
+    }
+
+    if (levels.isEmpty() && !isCanceled) {
+        AVFormatContext *fmt_ctx = openMediaFile(uri);
+        if (fmt_ctx != nullptr && isSupportedStream(fmt_ctx, streamIdx)) {
+            discardOtherStreams(fmt_ctx, {streamIdx});
+            LevelsDecoder decoder(MLTlengthInFrames, MLTfps);
+            decoder.setProgressCallback(progressCallback);
+            bool ok = decoder.open(fmt_ctx->streams[streamIdx]);
+            AVPacket *packet = av_packet_alloc();
+            // /!\ libav frames != MLT frames !
+            // Read each packet in the stream
+            while (ok && av_read_frame(fmt_ctx, packet) >= 0) {
+                if (isCanceled) {
+                    ok = false;
+                } else if (packet->stream_index == int(streamIdx)) {
+                    ok = decoder.decode(packet);
+                }
+                av_packet_unref(packet);
+            }
+            av_packet_free(&packet);
+            if (ok) {
+                levels = decoder.levels();
+            }
+        }
+        avformat_close_input(&fmt_ctx);
+    }
 
     qDebug() << "Audio levels generation took" << timer.elapsed() / 1000.0 << "s (" << MLTlengthInFrames / (timer.elapsed() / 1000.0) << "frames/s)";
     return levels;
 }
+
+QMap<int, QVector<int16_t>> generateLibavStreams(const QList<int> &streams, const QString &uri, const size_t MLTlengthInFrames, const double MLTfps,
+                                                 const std::function<void(int streamIdx, int progress, const QVector<int16_t> &levels)> &progressCallback,
+                                                 const QAtomicInt &isCanceled, int threads)
+{
+    qDebug() << "Generating audio levels for streams" << streams << "of" << uri << "using libav";
+    QElapsedTimer timer;
+    timer.start();
+
+    QMap<int, QVector<int16_t>> result;
+    AVFormatContext *fmt_ctx = openMediaFile(uri);
+    if (fmt_ctx == nullptr) {
+        return result;
+    }
+
+    // One decoder per stream, fed with the packets of a single demuxer
+    struct StreamDecoder
+    {
+        int streamIdx;
+        std::unique_ptr<LevelsDecoder> decoder;
+        std::vector<AVPacket *> packets;
+        bool failed{false};
+    };
+    std::vector<StreamDecoder> decoders;
+    std::vector<size_t> indexes;
+    for (int streamIdx : streams) {
+        if (streamIdx < 0 || !isSupportedStream(fmt_ctx, size_t(streamIdx))) {
+            continue;
+        }
+        std::unique_ptr<LevelsDecoder> decoder(new LevelsDecoder(MLTlengthInFrames, MLTfps));
+        if (decoder->open(fmt_ctx->streams[streamIdx])) {
+            decoders.push_back({streamIdx, std::move(decoder), {}, false});
+            indexes.push_back(size_t(streamIdx));
+        }
+    }
+    discardOtherStreams(fmt_ctx, indexes);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, threads));
+    AVPacket *packet = av_packet_alloc();
+    bool endOfFile = decoders.empty();
+    while (!endOfFile && !isCanceled) {
+        // Demux a batch of packets
+        for (int count = 0; count < packetsPerBatch;) {
+            if (av_read_frame(fmt_ctx, packet) < 0) {
+                endOfFile = true;
+                break;
+            }
+            auto it = std::find_if(decoders.begin(), decoders.end(), [&packet](const StreamDecoder &d) { return d.streamIdx == packet->stream_index; });
+            if (it != decoders.end() && !it->failed) {
+                AVPacket *queued = av_packet_alloc();
+                av_packet_move_ref(queued, packet);
+                it->packets.push_back(queued);
+                count++;
+            }
+            av_packet_unref(packet);
+        }
+        // Decode the batch of each stream in parallel
+        QtConcurrent::blockingMap(&pool, decoders, [](StreamDecoder &d) {
+            for (AVPacket *queued : d.packets) {
+                if (!d.failed && !d.decoder->decode(queued)) {
+                    d.failed = true;
+                }
+                av_packet_free(&queued);
+            }
+            d.packets.clear();
+        });
+        bool allFailed = true;
+        for (const auto &d : decoders) {
+            if (!d.failed) {
+                allFailed = false;
+                progressCallback(d.streamIdx, 100.0 * d.decoder->computedFrames() / MLTlengthInFrames, d.decoder->levels());
+            }
+        }
+        if (allFailed) {
+            break;
+        }
+    }
+    av_packet_free(&packet);
+
+    if (!isCanceled) {
+        for (auto &d : decoders) {
+            if (!d.failed) {
+                result.insert(d.streamIdx, d.decoder->levels());
+            }
+        }
+    }
+    decoders.clear();
+    avformat_close_input(&fmt_ctx);
+
+    qDebug() << "Audio levels generation for" << streams.size() << "streams took" << timer.elapsed() / 1000.0 << "s";
+    return result;
+}
@@ -5,6 +5,8 @@
 */
 
 #pragma once
+#include <QList>
+#include <QMap>
 #include <QString>
 #include <QVector>
 
@@ -23,6 +25,20 @@
  */
 void computePeaks(const int16_t *in, int16_t *out, size_t nChannels, size_t nSamplesIn, size_t nSamplesOut);
 
+/**
+ * @brief Computes peaks on planar float audio data.
+ *
+ * This gives the same result as converting the samples to 16 bit with libswresample, then calling computePeaks on
+ * the interleaved result, without the conversion cost.
+ *
+ * @param in Array of nChannels pointers to the nSamplesIn samples of each channel.
+ * @param out Pointer to the output buffer of size nChannels * nOut (interleaved format).
+ * @param nChannels Number of audio channels in the input and output buffers.
+ * @param nSamplesIn Number of input samples.
+ * @param nSamplesOut Number of output samples.
+ */
+void computePeaks(const float *const *in, int16_t *out, size_t nChannels, size_t nSamplesIn, size_t nSamplesOut);
+
 /** @brief Computes the audio levels using MLT to access the resource.
  *
  * This function computes the audio levels using MLT to access the resource. As such, it works with media files and all other MLT sources.
@@ -43,6 +59,7 @@ QVector<int16_t> generateMLT(size_t streamIdx, const QString &service, const QSt
 /** @brief Computes the audio levels using libav.
  *
  * This function computes the audio levels of a media file using libav directly, to avoid the speed penalty of MLT.
+ * When several threads are allowed and the file is long enough and seekable, it is split in chunks decoded concurrently.
  *
  * @param streamIdx audio stream index
  * @param uri URI of the media file to process
@@ -50,7 +67,26 @@ QVector<int16_t> generateMLT(size_t streamIdx, const QString &service, const QSt
  * @param MLTfps frames per second
  * @param progressCallback process callback function
  * @param isCanceled task cancelled semaphore, 0 = not cancelled, 1 = cancelled
+ * @param threads maximum number of threads to use
  * @return the computed audio levels
  */
 QVector<int16_t> generateLibav(size_t streamIdx, const QString &uri, size_t MLTlengthInFrames, double MLTfps,
-                               const std::function<void(int progress, const QVector<int16_t> &levels)> &progressCallback, const QAtomicInt &isCanceled);
+                               const std::function<void(int progress, const QVector<int16_t> &levels)> &progressCallback, const QAtomicInt &isCanceled,
+                               int threads = 1);
+
+/** @brief Computes the audio levels of several streams using libav.
+ *
+ * The file is demuxed once and the packets of each stream are decoded in parallel.
+ *
+ * @param streams audio stream indexes
+ * @param uri URI of the media file to process
+ * @param MLTlengthInFrames duration of the file in MLT frames
+ * @param MLTfps frames per second
+ * @param progressCallback process callback function, called for each stream
+ * @param isCanceled task cancelled semaphore, 0 = not cancelled, 1 = cancelled
+ * @param threads maximum number of threads to use
+ * @return the computed audio levels of each stream. Streams that could not be processed are missing
+ */
+QMap<int, QVector<int16_t>> generateLibavStreams(const QList<int> &streams, const QString &uri, size_t MLTlengthInFrames, double MLTfps,
+                                                 const std::function<void(int streamIdx, int progress, const QVector<int16_t> &levels)> &progressCallback,
+                                                 const QAtomicInt &isCanceled, int threads);
@@ -20,8 +20,19 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QImage>
 #include <QString>
 #include <QtMath>
+#include <algorithm>
+#include <iterator>
 #include <set>
 
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace {
+// The avformat producer decodes forward (instead of seeking to the previous keyframe) when a requested position is less than 12 frames ahead
+constexpr int maxForwardStep = 10;
+} // namespace
+
 CacheTask::CacheTask(const ObjectId &owner, std::set<int> frames, int thumbsCount, int in, int out, QObject *object)
     : AbstractTask(owner, AbstractTask::CACHEJOB, object)
     , m_fullWidth(qFuzzyCompare(pCore->getCurrentSar(), 1.0) ? 0 : qRound(pCore->thumbProfile().height() * pCore->getCurrentDar()))
@@ -38,7 +49,7 @@ CacheTask::CacheTask(const ObjectId &owner, std::set<int> frames, int thumbsCoun
 
 CacheTask::~CacheTask() {}
 
-void CacheTask::start(const ObjectId &owner, std::set<int> frames, QObject *object, bool force)
+void CacheTask::start(const ObjectId &owner, std::set<int> frames, QObject *object, bool force, bool exactFrames)
 {
     if (pCore->taskManager.hasPendingJob(owner, AbstractTask::CACHEJOB)) {
         return;
@@ -46,10 +57,11 @@ void CacheTask::start(const ObjectId &owner, std::set<int> frames, QObject *obje
     CacheTask *task = new CacheTask(owner, frames, 0, 0, 0, object);
     // Otherwise, start a new audio levels generation thread.
     task->m_isForce = force;
+    task->m_exactFrames = exactFrames;
     pCore->taskManager.startTask(owner.itemId, task);
 }
 
-void CacheTask::start(const ObjectId &owner, int thumbsCount, int in, int out, QObject *object, bool force)
+void CacheTask::start(const ObjectId &owner, int thumbsCount, int in, int out, QObject *object, bool force, bool exactFrames)
 {
     if (pCore->taskManager.hasPendingJob(owner, AbstractTask::CACHEJOB)) {
         return;
@@ -57,9 +69,82 @@ void CacheTask::start(const ObjectId &owner, int thumbsCount, int in, int out, Q
     CacheTask *task = new CacheTask(owner, {}, thumbsCount, in, out, object);
     // Otherwise, start a new audio levels generation thread.
     task->m_isForce = force;
+    task->m_exactFrames = exactFrames;
     pCore->taskManager.startTask(owner.itemId, task);
 }
 
+// static
+std::vector<int> CacheTask::keyframePositions(const QString &resource, int videoIndex, double fps)
+{
+    std::vector<int> positions;
+    AVFormatContext *fmt_ctx = nullptr;
+    if (avformat_open_input(&fmt_ctx, resource.toLocal8Bit().constData(), nullptr, nullptr) < 0) {
+        return positions;
+    }
+    if (avformat_find_stream_info(fmt_ctx, nullptr) >= 0) {
+        if (videoIndex < 0 || videoIndex >= int(fmt_ctx->nb_streams) || fmt_ctx->streams[videoIndex]->codecpar->codec_type != AVMEDIA_TYPE_VIDEO) {
+            videoIndex = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        }
+        if (videoIndex >= 0) {
+            AVStream *stream = fmt_ctx->streams[videoIndex];
+            const int64_t startTime = stream->start_time == AV_NOPTS_VALUE ? 0 : stream->start_time;
+            const double timeBase = av_q2d(stream->time_base);
+            // Index timestamps are decoding timestamps, which precede the presentation ones by the reordering delay when there are B-frames.
+            // Measure this delay on the first keyframe, encoders use the same GOP structure for the whole stream.
+            int64_t ptsOffset = 0;
+            AVPacket *packet = av_packet_alloc();
+            for (int read = 0; packet != nullptr && read < 100 && av_read_frame(fmt_ctx, packet) >= 0; ++read) {
+                const bool found = packet->stream_index == videoIndex && (packet->flags & AV_PKT_FLAG_KEY) != 0;
+                if (found && packet->pts != AV_NOPTS_VALUE && packet->dts != AV_NOPTS_VALUE) {
+                    ptsOffset = packet->pts - packet->dts;
+                }
+                av_packet_unref(packet);
+                if (found) {
+                    break;
+                }
+            }
+            av_packet_free(&packet);
+            // The index is read from the container header (mp4, mov) or cues (mkv), it does not require to scan the file
+            const int entries = avformat_index_get_entries_count(stream);
+            for (int i = 0; i < entries; ++i) {
+                const AVIndexEntry *entry = avformat_index_get_entry(stream, i);
+                if (entry != nullptr && (entry->flags & AVINDEX_KEYFRAME) != 0) {
+                    positions.push_back(qRound(double(entry->timestamp + ptsOffset - startTime) * timeBase * fps));
+                }
+            }
+        }
+    }
+    avformat_close_input(&fmt_ctx);
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    if (positions.size() < 2) {
+        // A single entry does not tell anything about the GOP structure
+        positions.clear();
+    }
+    return positions;
+}
+
+// static
+std::map<int, std::vector<int>> CacheTask::decodeTargets(const std::vector<int> &frames, const std::vector<int> &keyframes, bool exactFrames)
+{
+    std::map<int, std::vector<int>> targets;
+    for (int pos : frames) {
+        int target = pos;
+        if (!exactFrames && !keyframes.empty()) {
+            auto next = std::lower_bound(keyframes.begin(), keyframes.end(), pos);
+            if (next == keyframes.end()) {
+                target = keyframes.back();
+            } else if (next == keyframes.begin() || *next - pos < pos - *std::prev(next)) {
+                target = *next;
+            } else {
+                target = *std::prev(next);
+            }
+        }
+        targets[target].push_back(pos);
+    }
+    return targets;
+}
+
 void CacheTask::generateThumbnail(std::shared_ptr<ProjectClip> binClip)
 {
     // Fetch thumbnail
@@ -74,21 +159,64 @@ void CacheTask::generateThumbnail(std::shared_ptr<ProjectClip> binClip)
                 pos = m_in + (steps * i);
             }
         }
-        int size = int(m_frames.size());
+        const QString clipId = QString::number(m_owner.itemId);
+        // Requested frames that are not cached yet
+        std::vector<int> missing;
+        for (int i : m_frames) {
+            if (!ThumbnailCache::get()->hasThumbnail(clipId, i)) {
+                missing.push_back(i);
+            }
+        }
+        if (missing.empty()) {
+            return;
+        }
+        // Keyframes of the source, used to decode the frames of a GOP in one forward pass
+        std::vector<int> keyframes;
+        const QString service = binClip->getProducerProperty(QStringLiteral("mlt_service"));
+        if (missing.size() > 1 && service.startsWith(QLatin1String("avformat"))) {
+            keyframes = keyframePositions(binClip->getProducerProperty(QStringLiteral("resource")),
+                                          binClip->getProducerIntProperty(QStringLiteral("video_index")), pCore->getCurrentFps());
+        }
+        // Returns the index of the GOP containing a frame, -1 if unknown
+        auto gopIndex = [&keyframes](int pos) {
+            return keyframes.empty() ? -1 : int(std::upper_bound(keyframes.begin(), keyframes.end(), pos) - keyframes.begin()) - 1;
+        };
+        std::map<int, std::vector<int>> targets = decodeTargets(missing, keyframes, m_exactFrames);
+        // Let the requester show an approximate thumbnail for the requested frames
+        auto sendApproximate = [this](int target, const std::vector<int> &requested, const QImage &img) {
+            if (m_object == nullptr) {
+                return;
+            }
+            for (int i : requested) {
+                if (i != target) {
+                    QMetaObject::invokeMethod(m_object, "gotApproximateThumb", Qt::QueuedConnection, Q_ARG(int, i), Q_ARG(QImage, img));
+                }
+            }
+        };
+        for (auto it = targets.begin(); it != targets.end();) {
+            if (ThumbnailCache::get()->hasThumbnail(clipId, it->first)) {
+                // The keyframe was already decoded
+                sendApproximate(it->first, it->second, ThumbnailCache::get()->getThumbnail(clipId, it->first));
+                it = targets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        int size = int(targets.size());
         int count = 0;
         int imageHeight = pCore->thumbProfile().height();
         int imageWidth = pCore->thumbProfile().width();
         int fullWidth = qRound(imageHeight * pCore->getCurrentDar());
-        const QString clipId = QString::number(m_owner.itemId);
-        for (int i : m_frames) {
+        // Position of the last frame decoded by the thumb producer, -1 if none
+        int decoded = -1;
+        for (const auto &[target, requested] : targets) {
             int val = qMax(1, 100 * count / size);
             count++;
+            yieldToPriorityTasks();
             if (m_isCanceled || pCore->taskManager.isBlocked()) {
                 break;
             }
-            if (ThumbnailCache::get()->hasThumbnail(clipId, i)) {
-                continue;
-            }
             if (thumbProd == nullptr) {
                 thumbProd = binClip->getThumbProducer();
             }
@@ -96,16 +224,34 @@ void CacheTask::generateThumbnail(std::shared_ptr<ProjectClip> binClip)
                 // Thumb producer not available
                 break;
             }
-            thumbProd->seek(i);
+            if (decoded >= 0 && gopIndex(target) >= 0 && gopIndex(target) == gopIndex(decoded)) {
+                // Same GOP as the previous frame: walk forward instead of letting the producer seek back to the keyframe.
+                // The producer only decodes forward for small position jumps, so pull a frame at intermediate positions.
+                for (int pos = decoded + maxForwardStep; pos < target; pos += maxForwardStep) {
+                    thumbProd->seek(pos);
+                    QScopedPointer<Mlt::Frame> frame(thumbProd->get_frame());
+                    if (frame != nullptr && frame->is_valid()) {
+                        mlt_image_format format = mlt_image_yuv422;
+                        int width = imageWidth;
+                        int height = imageHeight;
+                        frame->get_image(format, width, height);
+                    }
+                }
+            }
+            thumbProd->seek(target);
+            QImage result;
             QScopedPointer<Mlt::Frame> frame(thumbProd->get_frame());
             if (frame != nullptr && frame->is_valid()) {
                 frame->set("consumer.deinterlacer", "onefield");
                 frame->set("consumer.top_field_first", -1);
                 frame->set("consumer.rescale", "nearest");
-                const QImage result = KThumb::getFrame(frame.get(), imageWidth, imageHeight, fullWidth);
-                if (!result.isNull() && !m_isCanceled) {
-                    ThumbnailCache::get()->storeThumbnail(clipId, i, result, true);
-                }
+                result = KThumb::getFrame(frame.get(), imageWidth, imageHeight, fullWidth);
+            }
+            decoded = target;
+            if (!result.isNull() && !m_isCanceled) {
+                // The cache is shared with the timeline and monitors, a keyframe image is only stored at its own position
+                ThumbnailCache::get()->storeThumbnail(clipId, target, result, true);
+                sendApproximate(target, requested, result);
             }
             if (m_progress != val) {
                 m_progress = val;
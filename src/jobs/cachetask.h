@@ -14,19 +14,26 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QList>
 #include <QObject>
 #include <QRunnable>
+#include <map>
 #include <set>
+#include <vector>
 
 class ProjectClip;
 
 class CacheTask : public AbstractTask
 {
+    friend class KdenliveTests;
+
 public:
     CacheTask(const ObjectId &owner, std::set<int> frames, int thumbsCount, int in, int out, QObject *object);
     ~CacheTask() override;
-    /** @brief Method to generate a fix number of thumbnails spread over the clip's duration */
-    static void start(const ObjectId &owner, int thumbsCount = 30, int in = 0, int out = 0, QObject *object = nullptr, bool force = false);
+    /** @brief Method to generate a fix number of thumbnails spread over the clip's duration
+     *  @param exactFrames if false, the nearest keyframe of the requested frames is decoded, which is much faster. Its thumbnail is cached at the keyframe
+     *  position and sent to the gotApproximateThumb(int, QImage) slot of @param object for the requested frame */
+    static void start(const ObjectId &owner, int thumbsCount = 30, int in = 0, int out = 0, QObject *object = nullptr, bool force = false,
+                      bool exactFrames = true);
     /** @brief Method to generate thumbnails for a specific list of frames */
-    static void start(const ObjectId &owner, std::set<int> frames, QObject *object = nullptr, bool force = false);
+    static void start(const ObjectId &owner, std::set<int> frames, QObject *object = nullptr, bool force = false, bool exactFrames = true);
 
 protected:
     void run() override;
@@ -39,5 +46,11 @@ private:
     std::function<void()> m_readyCallBack;
     std::set<int> m_frames;
     QString m_errorMessage;
+    bool m_exactFrames{true};
     void generateThumbnail(std::shared_ptr<ProjectClip>binClip);
+    /** @brief Returns the keyframe positions of the clip's video stream found in the container index, empty if unknown */
+    static std::vector<int> keyframePositions(const QString &resource, int videoIndex, double fps);
+    /** @brief Returns the frames to decode in increasing order, with the requested frames they stand for.
+     *  Unless @param exactFrames is true, the requested frames are snapped to their nearest keyframe and share its decoding */
+    static std::map<int, std::vector<int>> decodeTargets(const std::vector<int> &frames, const std::vector<int> &keyframes, bool exactFrames);
 };
@@ -18,6 +18,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "monitor/monitor.h"
 #include "project/dialogs/slideshowclip.h"
 #include "project/transcodeseek.h"
+#include "utils/filefingerprintcache.hpp"
+#include "utils/mediaprobecache.hpp"
 #include "utils/thumbnailcache.hpp"
 
 #include <mlt++/MltFilter.h>
@@ -38,6 +40,30 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QUuid>
 #include <QVariantList>
 
+namespace {
+// Producer properties that are not copied from the project xml
+const QStringList &internalProperties()
+{
+    static const QStringList properties = {QStringLiteral("bypassDuplicate"), QStringLiteral("resource"),    QStringLiteral("mlt_service"),
+                                           QStringLiteral("audio_index"),     QStringLiteral("astream"),     QStringLiteral("vstream"),
+                                           QStringLiteral("video_index"),     QStringLiteral("mlt_type"),    QStringLiteral("length")};
+    return properties;
+}
+
+// The property nodes of the producer in the project xml
+QDomNodeList producerPropertyNodes(const QDomElement &xml)
+{
+    if (xml.tagName() == QLatin1String("producer") || xml.tagName() == QLatin1String("chain")) {
+        return xml.childNodes();
+    }
+    QDomElement elem = xml.firstChildElement(QStringLiteral("chain"));
+    if (elem.isNull()) {
+        elem = xml.firstChildElement(QStringLiteral("producer"));
+    }
+    return elem.childNodes();
+}
+} // namespace
+
 ClipLoadTask::ClipLoadTask(const ObjectId &owner, const QDomElement &xml, bool thumbOnly, int in, int out, QObject *object)
     : AbstractTask(owner, thumbOnly ? AbstractTask::THUMBJOB : AbstractTask::LOADJOB, object)
     , m_xml(xml)
@@ -123,27 +149,14 @@ void ClipLoadTask::processProducerProperties(const std::shared_ptr<Mlt::Producer
 {
     // TODO: there is some duplication with clipcontroller > updateproducer that also copies properties
     QString value;
-    QStringList internalProperties;
-    internalProperties << QStringLiteral("bypassDuplicate") << QStringLiteral("resource") << QStringLiteral("mlt_service") << QStringLiteral("audio_index")
-                       << QStringLiteral("astream") << QStringLiteral("vstream") << QStringLiteral("video_index") << QStringLiteral("mlt_type")
-                       << QStringLiteral("length");
-    QDomNodeList props;
-
-    if (xml.tagName() == QLatin1String("producer") || xml.tagName() == QLatin1String("chain")) {
-        props = xml.childNodes();
-    } else {
-        QDomElement elem = xml.firstChildElement(QStringLiteral("chain"));
-        if (elem.isNull()) {
-            elem = xml.firstChildElement(QStringLiteral("producer"));
-        }
-        props = elem.childNodes();
-    }
+    const QStringList &internal = internalProperties();
+    const QDomNodeList props = producerPropertyNodes(xml);
     for (int i = 0; i < props.count(); ++i) {
         if (props.at(i).toElement().tagName() != QStringLiteral("property")) {
             continue;
         }
         QString propertyName = props.at(i).toElement().attribute(QStringLiteral("name"));
-        if (!internalProperties.contains(propertyName) && !propertyName.startsWith(QLatin1Char('_'))) {
+        if (!internal.contains(propertyName) && !propertyName.startsWith(QLatin1Char('_'))) {
             value = props.at(i).firstChild().nodeValue();
             if (propertyName.startsWith(QLatin1String("kdenlive-force."))) {
                 // this is a special forced property, pass it
@@ -154,6 +167,64 @@ void ClipLoadTask::processProducerProperties(const std::shared_ptr<Mlt::Producer
     }
 }
 
+QString ClipLoadTask::probeCacheKey(const QString &resource, const QString &service) const
+{
+    if (!KdenliveSettings::cachemediaprobes() || service != QLatin1String("avformat:") || pCore->currentDoc()->useExternalProxy() ||
+        !QFileInfo(resource).isFile()) {
+        return QString();
+    }
+    const QPair<QByteArray, qint64> fingerprint = FileFingerprintCache::get()->fingerprint(resource);
+    if (fingerprint.first.isEmpty()) {
+        return QString();
+    }
+    // Durations are expressed in frames of the project profile
+    const Mlt::Profile &profile = pCore->getProjectProfile();
+    const QString context = QStringLiteral("%1/%2;%3").arg(profile.frame_rate_num()).arg(profile.frame_rate_den()).arg(mlt_version_get_string());
+    return MediaProbeCache::key(fingerprint.first, fingerprint.second, context);
+}
+
+std::shared_ptr<Mlt::Producer> ClipLoadTask::producerFromProbeCache(const QString &resource, const MediaProbeCache::Properties &properties)
+{
+    // The file did not change since it was probed, don't open it until its frames are requested.
+    // The avformat-novalidate service is kept, so that reloading the producer from its xml does not open the file either
+    QString url = resource;
+    url.prepend(QStringLiteral("avformat-novalidate:"));
+    auto producer = std::make_shared<Mlt::Producer>(pCore->getProjectProfile(), nullptr, url.toUtf8().constData());
+    if (!producer->is_valid()) {
+        return producer;
+    }
+    for (const auto &property : properties) {
+        producer->set(property.first.constData(), property.second.constData());
+    }
+    producer->set("out", producer->get_length() - 1);
+    return producer;
+}
+
+MediaProbeCache::Properties ClipLoadTask::probedProperties(const std::shared_ptr<Mlt::Producer> &prod) const
+{
+    // Properties coming from the project are applied on each load, only keep the ones found when opening the file
+    QStringList projectProperties;
+    const QDomNodeList props = producerPropertyNodes(m_xml);
+    for (int i = 0; i < props.count(); ++i) {
+        const QString propertyName = props.at(i).toElement().attribute(QStringLiteral("name"));
+        if (!internalProperties().contains(propertyName)) {
+            projectProperties << propertyName;
+        }
+    }
+    MediaProbeCache::Properties result;
+    for (int i = 0; i < prod->count(); ++i) {
+        const QByteArray name(prod->get_name(i));
+        const char *value = prod->get(i);
+        if (name.isEmpty() || value == nullptr || name.startsWith('_') || (name.startsWith("kdenlive:") && name != "kdenlive:clip_type") ||
+            name == "resource" || name == "mlt_service" || name == "mlt_type" || name == "in" || name == "out" ||
+            projectProperties.contains(QString::fromUtf8(name))) {
+            continue;
+        }
+        result.append({name, QByteArray(value)});
+    }
+    return result;
+}
+
 void ClipLoadTask::processSlideShow(std::shared_ptr<Mlt::Producer> producer)
 {
     int ttl = Xml::getXmlProperty(m_xml, QStringLiteral("ttl")).toInt();
@@ -332,6 +403,9 @@ void ClipLoadTask::run()
         service.clear();
     }
     std::shared_ptr<Mlt::Producer> producer;
+    // Key of the file in the media probe cache, empty if the clip cannot be cached
+    QString probeKey;
+    bool fromProbeCache = false;
     switch (type) {
     case ClipType::Color:
         producer = loadResource(resource, QStringLiteral("color:"));
@@ -469,7 +543,14 @@ void ClipLoadTask::run()
             if (service == QLatin1String("avformat-novalidate:")) {
                 service = QStringLiteral("avformat:");
             }
-            producer = loadResource(resource, service);
+            probeKey = probeCacheKey(resource, service);
+            MediaProbeCache::Properties cachedProperties;
+            if (!probeKey.isEmpty() && MediaProbeCache::get()->lookup(probeKey, cachedProperties)) {
+                producer = producerFromProbeCache(resource, cachedProperties);
+                fromProbeCache = true;
+            } else {
+                producer = loadResource(resource, service);
+            }
         } else {
             producer = std::make_shared<Mlt::Producer>(pCore->getProjectProfile(), nullptr, resource.toUtf8().constData());
         }
@@ -705,8 +786,10 @@ void ClipLoadTask::run()
                 vindex = -1;
             }
         }
-        // Check audio / video
-        producer->probe();
+        // Check audio / video. On a probe cache hit, the stream properties are already set and probing would open the file
+        if (!fromProbeCache) {
+            producer->probe();
+        }
         hasAudio = producer->get_int("audio_index") > -1;
         hasVideo = producer->get_int("video_index") > -1;
         if (hasAudio) {
@@ -791,6 +874,9 @@ void ClipLoadTask::run()
             producer->set("video_index", -1);
         }
     }
+    if (!probeKey.isEmpty() && !fromProbeCache && seekable && !isVariableFrameRate && !m_isCanceled.loadAcquire()) {
+        MediaProbeCache::get()->store(probeKey, probedProperties(producer));
+    }
     if (!m_isCanceled.loadAcquire()) {
         auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(m_owner.itemId));
         if (binClip) {
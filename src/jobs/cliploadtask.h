@@ -9,6 +9,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstracttask.h"
 #include "definitions.h"
+#include "utils/mediaprobecache.hpp"
 
 #include <QRunnable>
 #include <QDomElement>
@@ -29,6 +30,8 @@ public:
     ~ClipLoadTask() override;
     static void start(const ObjectId &owner, const QDomElement &xml, bool thumbOnly, int in, int out, QObject* object, bool force = false, const std::function<void()> &readyCallBack = []() {});
     static ClipType::ProducerType getTypeForService(const QString &id, const QString &path);
+    /** @brief Create an avformat producer from the properties stored in the media probe cache, without opening the file */
+    static std::shared_ptr<Mlt::Producer> producerFromProbeCache(const QString &resource, const MediaProbeCache::Properties &properties);
     std::shared_ptr<Mlt::Producer> loadResource(QString resource, const QString &type);
     std::shared_ptr<Mlt::Producer> loadPlaylist(QString &resource);
     void processProducerProperties(const std::shared_ptr<Mlt::Producer> &prod, const QDomElement &xml);
@@ -47,6 +50,10 @@ private:
     QString m_errorMessage;
     void generateThumbnail(std::shared_ptr<ProjectClip>binClip, std::shared_ptr<Mlt::Producer> producer);
     void abort();
+    /** @brief Returns the key of the resource in the media probe cache, or an empty string if the clip cannot use the cache */
+    QString probeCacheKey(const QString &resource, const QString &service) const;
+    /** @brief The producer properties found when opening the file, excluding the ones set from the project */
+    MediaProbeCache::Properties probedProperties(const std::shared_ptr<Mlt::Producer> &prod) const;
 
 Q_SIGNALS:
     void taskDone();
@@ -21,6 +21,11 @@ TaskManager::TaskManager(QObject *parent)
     int maxThreads = qMin(4, QThread::idealThreadCount() - 1);
     m_taskPool.setMaxThreadCount(qMax(maxThreads, 1));
     m_transcodePool.setMaxThreadCount(KdenliveSettings::proxythreads());
+    // Audio thumbnails use several threads each and are mostly limited by disk access, don't let them occupy all threads
+    m_concurrencyLimits[AbstractTask::AUDIOTHUMBJOB] = qMax(1, m_taskPool.maxThreadCount() / 2);
+    m_concurrencyLimits[AbstractTask::CACHEJOB] = qMax(1, m_taskPool.maxThreadCount() / 2);
+    // Segmentation models usually run on the GPU
+    m_concurrencyLimits[AbstractTask::MASKJOB] = 1;
 }
 
 TaskManager::~TaskManager()
@@ -38,6 +43,12 @@ void TaskManager::updateConcurrency()
     m_transcodePool.setMaxThreadCount(KdenliveSettings::proxythreads());
 }
 
+int TaskManager::availableThreads() const
+{
+    // The calling task already occupies one of the active threads
+    return qMax(1, m_taskPool.maxThreadCount() - m_taskPool.activeThreadCount() + 1);
+}
+
 void TaskManager::discardJobsByType(AbstractTask::JOBTYPE jobType)
 {
     if (m_blockUpdates) {
@@ -57,7 +68,7 @@ void TaskManager::discardJobsByType(AbstractTask::JOBTYPE jobType)
                 ix--;
                 continue;
             }
-            if (m_taskPool.tryTake(t)) {
+            if (takePendingTask(t)) {
                 // Task was not started yet, we can simply delete
                 m_taskList[task.first].erase(std::remove(m_taskList[task.first].begin(), m_taskList[task.first].end(), t), m_taskList[task.first].end());
                 delete t;
@@ -103,24 +114,12 @@ void TaskManager::discardJobs(const ObjectId &owner, AbstractTask::JOBTYPE type,
             ix--;
             continue;
         }
-        if (taskType != AbstractTask::TRANSCODEJOB && taskType != AbstractTask::PROXYJOB) {
-            if (m_taskPool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t),
-                                               m_taskList[owner.itemId].end());
-                delete t;
-                ix--;
-                continue;
-            }
-        } else {
-            if (m_transcodePool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t),
-                                               m_taskList[owner.itemId].end());
-                delete t;
-                ix--;
-                continue;
-            }
+        if (takePendingTask(t)) {
+            // Task was not started yet, we can simply delete
+            m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t), m_taskList[owner.itemId].end());
+            delete t;
+            ix--;
+            continue;
         }
         if (t->cancelJob(softDelete)) {
             // Block until the task is finished
@@ -153,24 +152,12 @@ void TaskManager::discardJob(const ObjectId &owner, const QUuid &uuid)
             ix--;
             continue;
         }
-        if (taskType != AbstractTask::TRANSCODEJOB && taskType != AbstractTask::PROXYJOB) {
-            if (m_taskPool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t),
-                                               m_taskList[owner.itemId].end());
-                delete t;
-                ix--;
-                continue;
-            }
-        } else {
-            if (m_transcodePool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t),
-                                               m_taskList[owner.itemId].end());
-                delete t;
-                ix--;
-                continue;
-            }
+        if (takePendingTask(t)) {
+            // Task was not started yet, we can simply delete
+            m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t), m_taskList[owner.itemId].end());
+            delete t;
+            ix--;
+            continue;
         }
         if (t->cancelJob()) {
             m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t), m_taskList[owner.itemId].end());
@@ -221,11 +208,20 @@ TaskManagerStatus TaskManager::jobStatus(const ObjectId &owner) const
 void TaskManager::taskDone(int cid, AbstractTask *task)
 {
     // This will be executed in the QRunnable job thread
+    task->m_runningClass = -1;
+    m_tasksListLock.lockForWrite();
+    if (task->m_submitted) {
+        // Always release the submission slot, tasks excluded from a cancel keep running and the limit must still hold afterwards
+        task->m_submitted = false;
+        m_submittedTasks[task->m_type]--;
+        submitDeferredTasks();
+    }
     if (m_blockUpdates) {
         // We are closing, tasks will be handled on close
+        m_tasksListLock.unlock();
+        m_yieldCondition.wakeAll();
         return;
     }
-    m_tasksListLock.lockForWrite();
     if (!m_taskList.empty() && m_taskList.find(cid) != m_taskList.end()) {
         m_taskList[cid].erase(std::remove(m_taskList[cid].begin(), m_taskList[cid].end(), task), m_taskList[cid].end());
         if (m_taskList[cid].size() == 0) {
@@ -237,6 +233,8 @@ void TaskManager::taskDone(int cid, AbstractTask *task)
         count += task.second.size();
     }
     m_tasksListLock.unlock();
+    // Wake up the tasks waiting for higher priority tasks
+    m_yieldCondition.wakeAll();
     // Set jobs count
     Q_EMIT jobCount(count);
     task->deleteLater();
@@ -262,23 +260,13 @@ void TaskManager::slotCancelJobs(bool leaveBlocked, const QVector<AbstractTask::
                 ix--;
                 continue;
             }
-            if (taskType != AbstractTask::TRANSCODEJOB && taskType != AbstractTask::PROXYJOB) {
-                if (m_taskPool.tryTake(t)) {
-                    // Task was not started yet, we can simply delete
-                    qDebug() << "** DELETED  1 TASK from task pool: " << taskType;
-                    m_taskList[task.first].erase(std::remove(m_taskList[task.first].begin(), m_taskList[task.first].end(), t), m_taskList[task.first].end());
-                    delete t;
-                    ix--;
-                    continue;
-                }
-            } else {
-                if (m_transcodePool.tryTake(t)) {
-                    // Task was not started yet, we can simply delete
-                    m_taskList[task.first].erase(std::remove(m_taskList[task.first].begin(), m_taskList[task.first].end(), t), m_taskList[task.first].end());
-                    delete t;
-                    ix--;
-                    continue;
-                }
+            if (takePendingTask(t)) {
+                // Task was not started yet, we can simply delete
+                qDebug() << "** DELETED  1 TASK from task pool: " << taskType;
+                m_taskList[task.first].erase(std::remove(m_taskList[task.first].begin(), m_taskList[task.first].end(), t), m_taskList[task.first].end());
+                delete t;
+                ix--;
+                continue;
             }
             if (m_taskList.find(task.first) != m_taskList.end()) {
                 // If so, then just add ourselves to be notified upon completion.
@@ -305,17 +293,22 @@ void TaskManager::slotCancelJobs(bool leaveBlocked, const QVector<AbstractTask::
         QWriteLocker lock(&m_tasksListLock);
         m_taskList.clear();
         m_taskPool.clear();
+        m_deferredTasks.clear();
+        m_submittedTasks.clear();
     }
     if (!leaveBlocked) {
         // Set jobs count
         Q_EMIT jobCount(0);
-        m_blockUpdates = false;
+        unBlock();
     }
 }
 
 void TaskManager::unBlock()
 {
+    QWriteLocker lock(&m_tasksListLock);
     m_blockUpdates = false;
+    // Start the tasks that were deferred while updates were blocked
+    submitDeferredTasks();
 }
 
 void TaskManager::startTask(int ownerId, AbstractTask *task)
@@ -338,13 +331,184 @@ void TaskManager::startTask(int ownerId, AbstractTask *task)
     }
     // Set jobs count
     Q_EMIT jobCount(count);
+    if (isPrioritized(ownerId)) {
+        task->m_priorityClass = AbstractTask::INTERACTIVE;
+    }
+    submitTask(task);
+    m_tasksListLock.unlock();
+}
+
+QThreadPool &TaskManager::taskPool(const AbstractTask *task)
+{
     if (task->m_type == AbstractTask::TRANSCODEJOB || task->m_type == AbstractTask::PROXYJOB) {
         // We only want a limited concurrent jobs for those as for example GPU usually only accept 2 concurrent encoding jobs
-        m_transcodePool.start(task, task->m_priority);
-    } else {
-        m_taskPool.start(task, task->m_priority);
+        return m_transcodePool;
     }
-    m_tasksListLock.unlock();
+    return m_taskPool;
+}
+
+void TaskManager::submitTask(AbstractTask *task)
+{
+    const int limit = m_concurrencyLimits[task->m_type];
+    if (limit > 0 && m_submittedTasks[task->m_type] >= limit) {
+        m_deferredTasks.push_back(task);
+        return;
+    }
+    QThreadPool &pool = taskPool(task);
+    task->m_submitted = true;
+    m_submittedTasks[task->m_type]++;
+    if (&pool == &m_taskPool) {
+        task->m_queued = 1;
+        m_waitingTasks[task->m_priorityClass.loadRelaxed()].ref();
+    }
+    // The priority class comes first, then the job type priority
+    pool.start(task, task->m_priorityClass.loadRelaxed() * 100 + task->m_priority);
+}
+
+void TaskManager::submitDeferredTasks()
+{
+    if (m_blockUpdates) {
+        // Canceling, the remaining deferred tasks are submitted when updates are unblocked
+        return;
+    }
+    while (!m_deferredTasks.empty()) {
+        // Find the task with the highest priority allowed by its type's limit, oldest first
+        auto best = m_deferredTasks.end();
+        for (auto it = m_deferredTasks.begin(); it != m_deferredTasks.end(); ++it) {
+            const int limit = m_concurrencyLimits[(*it)->m_type];
+            if (limit > 0 && m_submittedTasks[(*it)->m_type] >= limit) {
+                continue;
+            }
+            if (best == m_deferredTasks.end() || (*it)->m_priorityClass.loadRelaxed() * 100 + (*it)->m_priority >
+                                                     (*best)->m_priorityClass.loadRelaxed() * 100 + (*best)->m_priority) {
+                best = it;
+            }
+        }
+        if (best == m_deferredTasks.end()) {
+            return;
+        }
+        AbstractTask *task = *best;
+        m_deferredTasks.erase(best);
+        submitTask(task);
+    }
+}
+
+bool TaskManager::takePendingTask(AbstractTask *task)
+{
+    auto deferred = std::find(m_deferredTasks.begin(), m_deferredTasks.end(), task);
+    if (deferred != m_deferredTasks.end()) {
+        m_deferredTasks.erase(deferred);
+        return true;
+    }
+    if (!task->m_submitted || !taskPool(task).tryTake(task)) {
+        return false;
+    }
+    task->m_submitted = false;
+    m_submittedTasks[task->m_type]--;
+    if (task->m_queued.testAndSetRelaxed(1, 0)) {
+        m_waitingTasks[task->m_priorityClass.loadRelaxed()].deref();
+    }
+    submitDeferredTasks();
+    return true;
+}
+
+void TaskManager::prioritizeClip(int clipId)
+{
+    QWriteLocker lk(&m_tasksListLock);
+    if (clipId == m_prioritizedClip) {
+        return;
+    }
+    const int previousClip = m_prioritizedClip;
+    m_prioritizedClip = clipId;
+    updatePriorityClass({previousClip, clipId});
+}
+
+void TaskManager::prioritizeVisibleClips(const QSet<int> &clipIds)
+{
+    QWriteLocker lk(&m_tasksListLock);
+    if (clipIds == m_visibleClips) {
+        return;
+    }
+    // Only the clips entering or leaving the visible region change class
+    QSet<int> changed = clipIds;
+    changed.unite(m_visibleClips);
+    changed.subtract(clipIds & m_visibleClips);
+    m_visibleClips = clipIds;
+    updatePriorityClass(changed);
+}
+
+bool TaskManager::isPrioritized(int clipId) const
+{
+    return clipId >= 0 && (clipId == m_prioritizedClip || m_visibleClips.contains(clipId));
+}
+
+void TaskManager::updatePriorityClass(const QSet<int> &clipIds)
+{
+    if (m_blockUpdates) {
+        return;
+    }
+    for (int cid : clipIds) {
+        auto tasks = m_taskList.find(cid);
+        if (cid < 0 || tasks == m_taskList.end()) {
+            continue;
+        }
+        const bool prioritized = isPrioritized(cid);
+        for (AbstractTask *t : tasks->second) {
+            // Only tasks that are not running yet can be moved in the queue
+            if (t->isCanceled() || !takePendingTask(t)) {
+                continue;
+            }
+            t->m_priorityClass = prioritized ? AbstractTask::INTERACTIVE : t->m_defaultPriorityClass;
+            submitTask(t);
+        }
+    }
+}
+
+void TaskManager::setConcurrencyLimit(AbstractTask::JOBTYPE type, int limit)
+{
+    QWriteLocker lk(&m_tasksListLock);
+    m_concurrencyLimits[type] = limit;
+    submitDeferredTasks();
+}
+
+void TaskManager::taskStarted(AbstractTask *task)
+{
+    // This will be executed in the QRunnable job thread
+    const int priorityClass = task->m_priorityClass.loadRelaxed();
+    if (task->m_queued.testAndSetRelaxed(1, 0)) {
+        m_waitingTasks[priorityClass].deref();
+        // Yielding tasks of a lower class may resume
+        m_yieldCondition.wakeAll();
+    }
+    task->m_runningClass = priorityClass;
+}
+
+void TaskManager::yieldTask(AbstractTask *task)
+{
+    const int priorityClass = task->m_runningClass;
+    if (priorityClass < 0) {
+        return;
+    }
+    // Only tasks waiting in the task pool count: running tasks, including transcoding jobs of the other pool, don't need our thread
+    auto higherPriorityTasks = [this, priorityClass]() {
+        int count = 0;
+        for (int c = priorityClass + 1; c <= AbstractTask::INTERACTIVE; ++c) {
+            count += m_waitingTasks[c].loadRelaxed();
+        }
+        return count;
+    };
+    if (higherPriorityTasks() == 0 || m_taskPool.activeThreadCount() < m_taskPool.maxThreadCount()) {
+        // Nobody is waiting for our thread
+        return;
+    }
+    // Let the pool start another task in place of this one while we wait
+    m_taskPool.releaseThread();
+    QMutexLocker lock(&m_yieldMutex);
+    while (higherPriorityTasks() > 0 && !task->isCanceled() && !m_blockUpdates) {
+        m_yieldCondition.wait(&m_yieldMutex, 200);
+    }
+    lock.unlock();
+    m_taskPool.reserveThread();
 }
 
 int TaskManager::getJobProgressForClip(const ObjectId &owner)
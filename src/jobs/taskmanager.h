@@ -13,10 +13,13 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include <QAbstractListModel>
 #include <QFutureWatcher>
+#include <QMutex>
 #include <QObject>
 #include <QReadWriteLock>
+#include <QSet>
 #include <QThreadPool>
 #include <QUuid>
+#include <QWaitCondition>
 #include <unordered_map>
 #include <vector>
 
@@ -27,10 +30,14 @@ Q_DECLARE_METATYPE(TaskManagerStatus)
 
 /** @class TaskManager
     @brief This class is responsible for clip jobs management.
+    Tasks are scheduled by priority class (see AbstractTask::PRIORITYCLASS), then by job type priority. The tasks of the clip
+    displayed in Clip Monitor or visible in the timeline are moved to the interactive class. Job types can have a concurrency limit: tasks exceeding it are kept
+    aside until a task of the same type is done. Long background tasks can yield their thread to higher priority tasks.
  */
 class TaskManager : public QObject
 {
     Q_OBJECT
+    friend class KdenliveTests;
 
 public:
     explicit TaskManager(QObject *parent);
@@ -64,6 +71,27 @@ public:
     /** @brief Update the number of concurrent jobs allowed */
     void updateConcurrency();
 
+    /** @brief Returns the number of threads a running task can use for its own work without exceeding the allowed concurrent jobs (at least 1) */
+    int availableThreads() const;
+
+    /** @brief Move the pending tasks of a clip to the interactive priority class, and restore the default class of the previously prioritized clip.
+     *  @param clipId the clip id, or -1 to only restore the previous clip */
+    void prioritizeClip(int clipId);
+
+    /** @brief Move the pending tasks of the clips visible in the timeline to the interactive priority class, and restore the default
+     *  class of the clips that are not visible anymore.
+     *  @param clipIds the bin ids of the visible clips */
+    void prioritizeVisibleClips(const QSet<int> &clipIds);
+
+    /** @brief Set the maximum number of tasks of a type waiting or running in a thread pool at the same time, 0 for no limit */
+    void setConcurrencyLimit(AbstractTask::JOBTYPE type, int limit);
+
+    /** @brief Called by a task when its thread starts running it */
+    void taskStarted(AbstractTask *task);
+
+    /** @brief Pause a running task while tasks of a higher priority class are waiting for a thread */
+    void yieldTask(AbstractTask *task);
+
     /** @brief We are aborting all tasks and don't want them to send any updates */
     bool isBlocked() const;
 
@@ -80,6 +108,31 @@ public Q_SLOTS:
 private:
     QThreadPool m_taskPool;
     QThreadPool m_transcodePool;
+    /** @brief Tasks that could not be pushed on a thread pool because of their type's concurrency limit */
+    std::vector<AbstractTask *> m_deferredTasks;
+    /** @brief Number of tasks waiting or running in a thread pool, by job type */
+    std::unordered_map<int, int> m_submittedTasks;
+    /** @brief Concurrency limit by job type */
+    std::unordered_map<int, int> m_concurrencyLimits;
+    int m_prioritizedClip{-1};
+    /** @brief Bin ids of the clips in the visible region of the timeline */
+    QSet<int> m_visibleClips;
+    /** @brief Number of tasks waiting for a thread in the task pool, by priority class */
+    QAtomicInt m_waitingTasks[AbstractTask::INTERACTIVE + 1];
+    QMutex m_yieldMutex;
+    QWaitCondition m_yieldCondition;
+    /** @brief Returns the pool in which the task is run */
+    QThreadPool &taskPool(const AbstractTask *task);
+    /** @brief Push the task on its thread pool, or keep it aside if its type reached its concurrency limit. The tasks list lock must be held */
+    void submitTask(AbstractTask *task);
+    /** @brief Push the deferred tasks allowed by the concurrency limits, unless updates are blocked. The tasks list lock must be held */
+    void submitDeferredTasks();
+    /** @brief Returns true if the tasks of this clip belong to the interactive class (Clip Monitor or visible in the timeline) */
+    bool isPrioritized(int clipId) const;
+    /** @brief Move the pending tasks of these clips to the class matching their current priority. The tasks list lock must be held */
+    void updatePriorityClass(const QSet<int> &clipIds);
+    /** @brief Remove a task that was not started yet from the queues. Returns false if the task is already running. The tasks list lock must be held */
+    bool takePendingTask(AbstractTask *task);
     /** @brief List of created tasks, in the form {owner clip id, {tasks}} */
     std::unordered_map<int, std::vector<AbstractTask*> > m_taskList;
     mutable QReadWriteLock m_tasksListLock;
@@ -9,6 +9,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlive_debug.h"
 #include "klocalizedstring.h"
 #include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -22,6 +24,11 @@ AudioCorrelation::AudioCorrelation(std::unique_ptr<AudioEnvelope> mainTrackEnvel
 
 AudioCorrelation::~AudioCorrelation()
 {
+    for (const auto &pending : m_pendingCorrelations) {
+        pending.first->waitForFinished();
+        delete pending.first->result();
+        delete pending.second;
+    }
     for (AudioEnvelope *envelope : std::as_const(m_children)) {
         delete envelope;
     }
@@ -50,32 +57,42 @@ void AudioCorrelation::addChild(AudioEnvelope *envelope)
 void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
 {
     // Note that at this point the computation of the envelope of the
-    // main track might not be finished. envelope() will block until
-    // the computation is done.
-    const size_t sizeMain = m_mainTrackEnvelope->envelope().size();
-    const size_t sizeSub = envelope->envelope().size();
+    // main track might not be finished. envelope() will block the worker
+    // thread until the computation is done.
+    auto *watcher = new QFutureWatcher<AudioCorrelationInfo *>(this);
+    m_pendingCorrelations.emplace_back(watcher, envelope);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, envelope]() {
+        m_pendingCorrelations.erase(std::remove(m_pendingCorrelations.begin(), m_pendingCorrelations.end(), std::make_pair(watcher, envelope)),
+                                    m_pendingCorrelations.end());
+        m_children.append(envelope);
+        m_correlations.append(watcher->result());
+        watcher->deleteLater();
+
+        Q_ASSERT(m_correlations.size() == m_children.size());
+        int index = m_children.indexOf(envelope);
+        int shift = getShift(index);
+        Q_EMIT gotAudioAlignData(envelope->clipId(), shift);
+    });
+    AudioEnvelope *mainEnvelope = m_mainTrackEnvelope.get();
+    watcher->setFuture(QtConcurrent::run([mainEnvelope, envelope]() { return correlateEnvelopes(mainEnvelope->envelope(), envelope->envelope()); }));
+}
+
+AudioCorrelationInfo *AudioCorrelation::correlateEnvelopes(const std::vector<qint64> &envMain, const std::vector<qint64> &envSub)
+{
+    const size_t sizeMain = envMain.size();
+    const size_t sizeSub = envSub.size();
 
     auto *info = new AudioCorrelationInfo(sizeMain, sizeSub);
     qint64 *correlation = info->correlationVector();
-
-    const std::vector<qint64> &envMain = m_mainTrackEnvelope->envelope();
-    const std::vector<qint64> &envSub = envelope->envelope();
     qint64 max = 0;
 
     if (sizeSub > 200) {
-        FFTCorrelation::correlate(&envMain[0], sizeMain, &envSub[0], sizeSub, correlation);
+        FFTCorrelation::correlate(envMain.data(), sizeMain, envSub.data(), sizeSub, correlation);
     } else {
-        correlate(&envMain[0], sizeMain, &envSub[0], sizeSub, correlation, &max);
+        correlate(envMain.data(), sizeMain, envSub.data(), sizeSub, correlation, &max);
         info->setMax(max);
     }
-
-    m_children.append(envelope);
-    m_correlations.append(info);
-
-    Q_ASSERT(m_correlations.size() == m_children.size());
-    int index = m_children.indexOf(envelope);
-    int shift = getShift(index);
-    Q_EMIT gotAudioAlignData(envelope->clipId(), shift);
+    return info;
 }
 
 int AudioCorrelation::getShift(int childIndex) const
@@ -125,16 +142,17 @@ void AudioCorrelation::correlate(const qint64 *envMain, size_t sizeMain, const q
 
     QElapsedTimer t;
     t.start();
-    for (size_t shift = -sizeSub; shift <= sizeMain; ++shift) {
+    // The shift must be signed, the sub envelope can start before the main one
+    for (qint64 shift = -qint64(sizeSub); shift <= qint64(sizeMain); ++shift) {
 
-        if (shift == 0) {
+        if (shift <= 0) {
             left = envSub - shift;
             right = envMain;
-            size = std::min(sizeSub + shift, sizeMain);
+            size = std::min(size_t(qint64(sizeSub) + shift), sizeMain);
         } else {
             left = envSub;
             right = envMain + shift;
-            size = std::min(sizeSub, sizeMain - shift);
+            size = std::min(sizeSub, sizeMain - size_t(shift));
         }
 
         sum = 0;
@@ -143,7 +161,7 @@ void AudioCorrelation::correlate(const qint64 *envMain, size_t sizeMain, const q
             left++;
             right++;
         }
-        correlation[sizeSub + shift] = qAbs(sum);
+        correlation[qint64(sizeSub) + shift] = qAbs(sum);
 
         if (sum > max) {
             max = sum;
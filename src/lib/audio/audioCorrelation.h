@@ -10,14 +10,17 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "audioCorrelationInfo.h"
 #include "audioEnvelope.h"
 #include "definitions.h"
+#include <QFutureWatcher>
 #include <QList>
+#include <vector>
 
 /**
   This class does the correlation between two tracks
   in order to synchronize (align) them.
 
   It uses one main track (used in the initializer); further tracks will be
-  aligned relative to this main track.
+  aligned relative to this main track. The envelopes of all children and
+  their correlations are computed concurrently.
   */
 class AudioCorrelation : public QObject
 {
@@ -58,17 +61,25 @@ public:
       */
     static void correlate(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, qint64 *correlation, qint64 *out_max = nullptr);
 
+    /**
+      Correlates a child envelope with the main envelope, using FFT for long envelopes.
+      The caller takes ownership of the returned object.
+      */
+    static AudioCorrelationInfo *correlateEnvelopes(const std::vector<qint64> &envMain, const std::vector<qint64> &envSub);
+
 private:
     std::unique_ptr<AudioEnvelope> m_mainTrackEnvelope;
 
     QList<AudioEnvelope *> m_children;
     QList<AudioCorrelationInfo *> m_correlations;
+    /** Correlations being computed, with their child envelope */
+    std::vector<std::pair<QFutureWatcher<AudioCorrelationInfo *> *, AudioEnvelope *>> m_pendingCorrelations;
 
 private Q_SLOTS:
     /**
      This is invoked when the child envelope is computed. This
-     triggers the actual computations of the cross-correlation for
-     aligning the envelope to the reference envelope.
+     starts the computation of the cross-correlation for aligning
+     the envelope to the reference envelope in a worker thread.
 
      Takes ownership of @p envelope.
    */
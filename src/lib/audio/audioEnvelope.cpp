@@ -10,14 +10,23 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "bin/bin.h"
 #include "bin/projectclip.h"
 #include "core.h"
+#include "definitions.h"
 #include "kdenlive_debug.h"
 #include <KLocalizedString>
+#include <QDataStream>
 #include <QElapsedTimer>
+#include <QFile>
 #include <QImage>
+#include <QSaveFile>
 #include <QtConcurrent/QtConcurrentRun>
 #include <algorithm>
 #include <cmath>
 
+namespace {
+constexpr quint32 envelopeMagic = 0x4b444145; // KDAE
+constexpr quint32 envelopeVersion = 1;
+} // namespace
+
 AudioEnvelope::AudioEnvelope(const QString &binId, int clipId, std::pair<int, int> stream, size_t offset, size_t length, size_t startPos)
     : m_offset(offset)
     , m_clipId(clipId)
@@ -25,12 +34,25 @@ AudioEnvelope::AudioEnvelope(const QString &binId, int clipId, std::pair<int, in
 {
     std::shared_ptr<ProjectClip> clip = pCore->bin()->getBinClip(binId);
     m_producer = clip->cloneProducer();
+    m_clipLength = size_t(m_producer->get_playtime());
     if (length > 2000) {
         // Analyze on timeline clip zone only
         m_offset = 0;
+        m_firstFrame = offset;
         m_producer->set_in_and_out(int(offset), int(offset + length));
     }
     m_envelopeSize = size_t(m_producer->get_playtime());
+    const int streamIndex = stream.first > -1 ? stream.first : clip->getProducerIntProperty(QStringLiteral("audio_index"));
+    if (clip->audioThumbCreated() && clip->audioInfo()) {
+        // Reuse the audio levels computed for the audio thumbnail
+        m_levelsChannels = clip->audioInfo()->channelsForStream(streamIndex);
+        if (m_levelsChannels > 0) {
+            m_levels = clip->audioFrameCache(streamIndex);
+        }
+    }
+    if (m_levels.isEmpty()) {
+        m_cachePath = clip->getAudioEnvelopePath(streamIndex);
+    }
 
     m_producer->set("set.test_image", 1);
     if (stream.first > -1) {
@@ -95,34 +117,125 @@ const std::vector<qint64> &AudioEnvelope::envelope()
     return audioSummary().audioAmplitudes;
 }
 
-AudioEnvelope::AudioSummary AudioEnvelope::loadAndNormalizeEnvelope() const
+std::vector<qint64> AudioEnvelope::envelopeFromLevels(const QVector<int16_t> &levels, int channels, size_t first, size_t count)
 {
-    qCDebug(KDENLIVE_LOG) << "Loading envelope …";
-    AudioSummary summary(m_envelopeSize);
-    if (!m_info || m_info->size() < 1) {
-        return summary;
+    std::vector<qint64> envelope(count, 0);
+    if (channels <= 0) {
+        return envelope;
+    }
+    const size_t pointsPerFrame = size_t(AUDIOLEVELS_POINTS_PER_FRAME * channels);
+    const size_t levelFrames = size_t(levels.size()) / pointsPerFrame;
+    const int16_t *data = levels.constData();
+    for (size_t i = 0; i < count && first + i < levelFrames; ++i) {
+        const int16_t *point = data + (first + i) * pointsPerFrame;
+        qint64 sum = 0;
+        for (size_t k = 0; k < pointsPerFrame; ++k) {
+            sum += qAbs(point[k]);
+        }
+        envelope[i] = sum;
     }
+    return envelope;
+}
+
+bool AudioEnvelope::saveEnvelope(const QString &path, const std::vector<qint64> &envelope)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write envelope cache" << path;
+        return false;
+    }
+    QDataStream out(&file);
+    out << envelopeMagic << envelopeVersion << quint64(envelope.size());
+    out.writeRawData(reinterpret_cast<const char *>(envelope.data()), int(envelope.size() * sizeof(qint64)));
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+std::vector<qint64> AudioEnvelope::loadEnvelope(const QString &path)
+{
+    std::vector<qint64> envelope;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return envelope;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint64 size = 0;
+    in >> magic >> version >> size;
+    const qint64 dataSize = qint64(size * sizeof(qint64));
+    if (in.status() != QDataStream::Ok || magic != envelopeMagic || version != envelopeVersion || file.bytesAvailable() != dataSize) {
+        qCDebug(KDENLIVE_LOG) << "Discarding invalid envelope cache" << path;
+        return envelope;
+    }
+    envelope.resize(size);
+    if (in.readRawData(reinterpret_cast<char *>(envelope.data()), int(dataSize)) != dataSize) {
+        envelope.clear();
+    }
+    return envelope;
+}
+
+std::vector<qint64> AudioEnvelope::decodeEnvelope() const
+{
+    const size_t count = m_envelopeSize;
+    std::vector<qint64> envelope(count, 0);
     int samplingRate = m_info->info(0)->samplingRate();
     mlt_audio_format format_s16 = mlt_audio_s16;
     int channels = 1;
-
-    QElapsedTimer t;
-    t.start();
     m_producer->seek(0);
-    size_t max = summary.audioAmplitudes.size();
-    for (size_t i = 0; i < max; ++i) {
+    for (size_t i = 0; i < count; ++i) {
         std::unique_ptr<Mlt::Frame> frame(m_producer->get_frame(int(i)));
         qint64 position = mlt_frame_get_position(frame->get_frame());
         int samples = mlt_audio_calculate_frame_samples(float(m_producer->get_fps()), samplingRate, position);
         auto *data = static_cast<qint16 *>(frame->get_audio(format_s16, samplingRate, channels, samples));
 
-        summary.audioAmplitudes[i] = 0;
         for (int k = 0; k < samples; ++k) {
-            summary.audioAmplitudes[i] += abs(data[k]);
+            envelope[i] += abs(data[k]);
         }
-        pCore->displayMessage(i18n("Processing data analysis"), ProcessingJobMessage, int(100 * i / max));
+        pCore->displayMessage(i18n("Processing data analysis"), ProcessingJobMessage, int(100 * i / count));
+    }
+    return envelope;
+}
+
+AudioEnvelope::AudioSummary AudioEnvelope::loadAndNormalizeEnvelope() const
+{
+    qCDebug(KDENLIVE_LOG) << "Loading envelope …";
+    AudioSummary summary;
+    if (!m_info || m_info->size() < 1) {
+        summary.audioAmplitudes.resize(m_envelopeSize);
+        return summary;
+    }
+
+    QElapsedTimer t;
+    t.start();
+    if (!m_levels.isEmpty()) {
+        summary.audioAmplitudes = envelopeFromLevels(m_levels, m_levelsChannels, m_firstFrame, m_envelopeSize);
+        qCDebug(KDENLIVE_LOG) << "Envelope built from audio levels (" << m_envelopeSize << " frames) in " << t.elapsed() << " ms.";
+    } else {
+        std::vector<qint64> clipEnvelope;
+        if (!m_cachePath.isEmpty()) {
+            clipEnvelope = loadEnvelope(m_cachePath);
+            if (clipEnvelope.size() != m_clipLength) {
+                clipEnvelope.clear();
+            }
+        }
+        if (!clipEnvelope.empty()) {
+            qCDebug(KDENLIVE_LOG) << "Envelope loaded from cache (" << m_envelopeSize << " frames) in " << t.elapsed() << " ms.";
+            const auto first = clipEnvelope.cbegin() + qint64(std::min(m_firstFrame, clipEnvelope.size()));
+            summary.audioAmplitudes.assign(first, first + qint64(std::min(m_envelopeSize, size_t(clipEnvelope.cend() - first))));
+            summary.audioAmplitudes.resize(m_envelopeSize, 0);
+        } else {
+            summary.audioAmplitudes = decodeEnvelope();
+            qCDebug(KDENLIVE_LOG) << "Calculating the envelope (" << m_envelopeSize << " frames) took " << t.elapsed() << " ms.";
+            if (!m_cachePath.isEmpty() && m_firstFrame == 0 && m_envelopeSize == m_clipLength) {
+                // Only the envelope of the whole clip is cached, zones are extracted from it
+                saveEnvelope(m_cachePath, summary.audioAmplitudes);
+            }
+        }
+    }
+    size_t max = summary.audioAmplitudes.size();
+    if (max == 0) {
+        return summary;
     }
-    qCDebug(KDENLIVE_LOG) << "Calculating the envelope (" << m_envelopeSize << " frames) took " << t.elapsed() << " ms.";
     qCDebug(KDENLIVE_LOG) << "Normalizing envelope …";
     const qint64 meanBeforeNormalization =
         std::accumulate(summary.audioAmplitudes.begin(), summary.audioAmplitudes.end(), 0LL) / qint64(summary.audioAmplitudes.size());
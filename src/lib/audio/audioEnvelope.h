@@ -10,6 +10,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "audioInfo.h"
 #include <QFutureWatcher>
 #include <QObject>
+#include <QVector>
 #include <memory>
 #include <mlt++/Mlt.h>
 #include <vector>
@@ -22,6 +23,11 @@ class QImage;
   of the absolute values of all samples in the current frame.
 
   See also: http://web.archive.org/web/20180626235917/http://bemasc.net/wordpress/2011/07/26/an-auto-aligner-for-pitivi/
+
+  To make repeated alignments cheap, the envelope is built from the audio
+  levels of the clip when they were already computed. Otherwise the audio
+  is decoded and the envelope of the whole clip is saved in the project
+  cache folder.
   */
 class AudioEnvelope : public QObject
 {
@@ -58,6 +64,20 @@ public:
     int clipId() const;
     size_t startPos() const;
 
+    /**
+       Builds an envelope from audio levels, one entry per frame being the
+       sum of the level points of all channels for this frame.
+       @param levels the interleaved audio levels (AUDIOLEVELS_POINTS_PER_FRAME points per frame)
+       @param first the first frame of the envelope
+       @param count the number of frames of the envelope, frames outside of the levels are 0
+    */
+    static std::vector<qint64> envelopeFromLevels(const QVector<int16_t> &levels, int channels, size_t first, size_t count);
+
+    /** @brief Save a raw (not normalized) envelope to a cache file. Returns false on error */
+    static bool saveEnvelope(const QString &path, const std::vector<qint64> &envelope);
+    /** @brief Load an envelope saved with saveEnvelope(). Returns an empty vector if the file is missing or invalid */
+    static std::vector<qint64> loadEnvelope(const QString &path);
+
 private:
     struct AudioSummary
     {
@@ -84,8 +104,21 @@ private:
      Actually computes the envelope data, synchronously.
     */
     AudioSummary loadAndNormalizeEnvelope() const;
+    /**
+     Decodes the audio of the analyzed zone to compute the envelope, synchronously.
+    */
+    std::vector<qint64> decodeEnvelope() const;
 
     std::shared_ptr<Mlt::Producer> m_producer;
+    /** Audio levels of the clip stream, if available */
+    QVector<int16_t> m_levels;
+    int m_levelsChannels{0};
+    /** Path of the envelope cache file for the whole clip, empty if the cache folder is not available */
+    QString m_cachePath;
+    /** First frame of the clip used by the envelope */
+    size_t m_firstFrame{0};
+    /** Number of frames in the clip */
+    size_t m_clipLength{0};
     std::unique_ptr<AudioInfo> m_info;
     QFutureWatcher<AudioSummary> m_watcher;
     QFuture<AudioSummary> m_audioSummary;
@@ -2138,6 +2138,7 @@ bool Monitor::slotOpenClip(const std::shared_ptr<ProjectClip> &controller, int i
     } else if (controller == nullptr) {
         // Nothing to do
         pCore->taskManager.displayedClip = -1;
+        pCore->taskManager.prioritizeClip(-1);
         m_displayedUuid = QUuid();
         m_dirty = false;
         return true;
@@ -2164,6 +2165,7 @@ bool Monitor::slotOpenClip(const std::shared_ptr<ProjectClip> &controller, int i
     if (m_controller == nullptr) {
         // We had another clip displayed, reset
         pCore->taskManager.displayedClip = -1;
+        pCore->taskManager.prioritizeClip(-1);
         m_markerModel = nullptr;
         loadQmlScene(SceneType::MonitorSceneDefault);
         m_glMonitor->setProducer(nullptr, isActive(), -1);
@@ -2186,6 +2188,8 @@ bool Monitor::slotOpenClip(const std::shared_ptr<ProjectClip> &controller, int i
         return true;
     } else {
         pCore->taskManager.displayedClip = m_controller->clipId().toInt();
+        pCore->taskManager.prioritizeClip(pCore->taskManager.displayedClip);
+        m_controller->markProducerUsed();
         if (m_controller->clipType() == ClipType::Timeline) {
             if (m_displayedUuid != m_controller->getSequenceUuid()) {
                 m_dirty = false;
@@ -11,6 +11,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "doc/kdenlivedoc.h"
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
+#include "utils/thumbnailcache.hpp"
 
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -505,6 +506,8 @@ void TemporaryData::deleteThumbs()
         return;
     }
     if (dir.dirName() == QLatin1String("videothumbs")) {
+        // Close the thumbnail packs before deleting them
+        ThumbnailCache::get()->clearCache();
         dir.removeRecursively();
         dir.mkpath(QStringLiteral("."));
         updateDataInfo();
@@ -23,6 +23,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "project/dialogs/projectsettings.h"
 #include "timeline2/model/timelinefunctions.hpp"
 #include "timeline2/model/timelineitemmodel.hpp"
+#include "utils/filefingerprintcache.hpp"
+#include "utils/mediaprobecache.hpp"
 #include "utils/qstringutils.h"
 #include "utils/thumbnailcache.hpp"
 #include "xml/xml.hpp"
@@ -64,6 +66,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QSaveFile>
 #include <QTimeZone>
 #include <QUndoGroup>
+#include <QtConcurrent/QtConcurrentRun>
 
 static QString getProjectNameFilters(bool ark = true)
 {
@@ -85,7 +88,10 @@ ProjectManager::ProjectManager(QObject *parent)
     dir.mkdir(QStringLiteral("titles"));
 }
 
-ProjectManager::~ProjectManager() = default;
+ProjectManager::~ProjectManager()
+{
+    m_autoSaveFuture.waitForFinished();
+}
 
 void ProjectManager::slotLoadOnOpen()
 {
@@ -421,6 +427,7 @@ bool ProjectManager::closeCurrentDocument(bool saveChanges, bool quit)
     // Disable autosave
     m_autoSaveTimer.stop();
     m_autoSaveChangeCount = 0;
+    m_autoSaveFuture.waitForFinished();
     if ((m_project != nullptr) && m_project->isModified() && saveChanges && !m_project->loading) {
         QString message;
         if (m_project->url().isEmpty()) {
@@ -516,6 +523,7 @@ bool ProjectManager::saveFileAs(const QString &outputFileName, bool saveOverExis
     // Disable autosave while saving
     m_autoSaveTimer.stop();
     m_autoSaveChangeCount = 0;
+    m_autoSaveFuture.waitForFinished();
     pCore->monitorManager()->pauseActiveMonitor();
     QString oldProjectFolder =
         m_project->url().isEmpty() ? QString() : QFileInfo(m_project->url().toLocalFile()).absolutePath() + QStringLiteral("/cachefiles");
@@ -560,12 +568,15 @@ bool ProjectManager::saveFileAs(const QString &outputFileName, bool saveOverExis
     }
     ThumbnailCache::get()->saveCachedThumbs(thumbKeys);
     pCore->bin()->saveSequenceAudioThumb();
+    // Keep the probed media properties in case the application does not exit cleanly
+    FileFingerprintCache::get()->save();
+    MediaProbeCache::get()->save();
     if (!saveACopy) {
         m_project->setUrl(url);
         // setting up autosave file in ~/.kde/data/stalefiles/kdenlive/
         // saved under file name
-        // actual saving by KdenliveDoc::slotAutoSave() called by a timer 3 seconds after the document has been edited
-        // This timer is set by KdenliveDoc::setModified()
+        // actual saving by ProjectManager::slotAutoSave() called by m_autoSaveTimer after the document has been edited
+        // This timer is started by ProjectManager::slotStartAutoSave(), on KdenliveDoc::startAutoSave()
         const QString projectId = QCryptographicHash::hash(url.fileName().toUtf8(), QCryptographicHash::Md5).toHex();
         QUrl autosaveUrl = QUrl::fromLocalFile(QFileInfo(outputFileName).absoluteDir().absoluteFilePath(projectId));
         if (m_project->m_autosave == nullptr) {
@@ -1309,26 +1320,104 @@ void ProjectManager::slotAutoSave()
         m_autoSaveChangeCount = KdenliveSettings::autosave_ops();
         return;
     }
+    if (m_autoSaveFuture.isRunning() || pCore->monitorManager()->isMultiTrack() || pCore->monitorManager()->isTrimming()) {
+        // Previous autosave is still being written, or the user is in a temporary timeline mode, retry later
+        m_autoSaveTimer.start();
+        return;
+    }
     Q_EMIT pCore->startAutoSave();
     m_lastSave.invalidate();
     prepareSave();
-    QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
-    QString scene = projectSceneList(saveFolder).first;
-    if (!m_replacementPattern.isEmpty()) {
-        QMapIterator<QString, QString> i(m_replacementPattern);
+    runAutoSave();
+    m_autoSaveChangeCount = 0;
+    m_lastSave.start();
+}
+
+void ProjectManager::testAutoSave()
+{
+    runAutoSave();
+    m_autoSaveFuture.waitForFinished();
+}
+
+void ProjectManager::runAutoSave()
+{
+    const QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
+    // The preview track and the audio monitoring must not be part of the saved scene, restore them once the scene is built
+    std::shared_ptr<TimelineItemModel> previewModel;
+    if (pCore->window() && pCore->window()->getCurrentTimeline()->controller()->hasPreviewTrack()) {
+        previewModel = pCore->window()->getCurrentTimeline()->model();
+        previewModel->updatePreviewConnection(false);
+    }
+    if (pCore->mixer()) {
+        pCore->mixer()->pauseMonitoring(true);
+    }
+    int duration = pCore->window() ? pCore->window()->getCurrentTimeline()->controller()->duration() : m_activeTimelineModel->duration();
+    std::vector<std::shared_ptr<TimelineItemModel>> timelines;
+    const QList<QUuid> uuids = m_project->getTimelinesUuids();
+    for (const QUuid &uuid : uuids) {
+        timelines.push_back(m_project->getTimeline(uuid));
+    }
+    KdenliveDoc *project = m_project;
+    std::shared_ptr<TimelineItemModel> activeModel = m_activeTimelineModel;
+    const QMap<QString, QString> replacementPattern = m_replacementPattern;
+    m_autoSaveFuture = QtConcurrent::run([this, project, timelines, activeModel, previewModel, saveFolder, duration, replacementPattern]() {
+        // Timeline operations wait until the scene is built so that it matches a single state of the project. Give up if a sequence
+        // stays busy instead of waiting with its lock held, the GUI thread might be waiting for another sequence.
+        std::vector<QReadWriteLock *> locked;
+        for (const auto &timeline : timelines) {
+            if (!timeline->m_lock.tryLockForRead(100)) {
+                break;
+            }
+            locked.push_back(&timeline->m_lock);
+        }
+        QString scene;
+        if (locked.size() == timelines.size()) {
+            scene = pCore->projectItemModel()->sceneList(saveFolder, QString(), activeModel->tractor(), duration).first;
+        }
+        for (QReadWriteLock *lock : locked) {
+            lock->unlock();
+        }
+        const bool sceneBuilt = !scene.isEmpty();
+        QMetaObject::invokeMethod(
+            this,
+            [this, previewModel, sceneBuilt]() {
+                if (pCore->mixer()) {
+                    pCore->mixer()->pauseMonitoring(false);
+                }
+                if (previewModel) {
+                    previewModel->updatePreviewConnection(true);
+                }
+                if (!sceneBuilt) {
+                    // A sequence was being edited, retry later
+                    m_autoSaveTimer.start();
+                }
+            },
+            Qt::QueuedConnection);
+        if (!sceneBuilt) {
+            return;
+        }
+        QMapIterator<QString, QString> i(replacementPattern);
         while (i.hasNext()) {
             i.next();
             scene.replace(i.key(), i.value());
         }
-    }
-    if (!scene.contains(QLatin1String("<track "))) {
-        // In some unexplained cases, the MLT playlist is corrupted and all tracks are deleted. Don't save in that case.
-        pCore->displayMessage(i18n("Project was corrupted, cannot backup. Please close and reopen your project file to recover last backup"), ErrorMessage);
-        return;
-    }
-    m_project->slotAutoSave(scene);
-    m_autoSaveChangeCount = 0;
-    m_lastSave.start();
+        if (!scene.contains(QLatin1String("<track "))) {
+            // In some unexplained cases, the MLT playlist is corrupted and all tracks are deleted. Don't save in that case.
+            QMetaObject::invokeMethod(
+                this,
+                []() {
+                    pCore->displayMessage(i18n("Project was corrupted, cannot backup. Please close and reopen your project file to recover last backup"),
+                                          ErrorMessage);
+                },
+                Qt::QueuedConnection);
+            return;
+        }
+        if (!project->writeAutoSave(scene.toUtf8())) {
+            const QString fileName = project->m_autosave->fileName();
+            QMetaObject::invokeMethod(
+                this, [fileName]() { pCore->displayMessage(i18n("Cannot create autosave file %1", fileName), ErrorMessage); }, Qt::QueuedConnection);
+        }
+    });
 }
 
 std::pair<QString, QString> ProjectManager::projectSceneList(const QString &outputFolder, bool timelineProducerOnly, const QString &overlayData,
@@ -8,6 +8,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <KRecentFilesAction>
 #include <QDir>
 #include <QElapsedTimer>
+#include <QFuture>
 #include <QObject>
 #include <QTime>
 #include <QTimer>
@@ -112,6 +113,9 @@ public:
     /** @brief This method is only there for tests, do not use in real app.
      */
     bool testSaveFileAs(const QString &outputFileName);
+    /** @brief This method is only there for tests, do not use in real app.
+     */
+    void testAutoSave();
     /** @brief Retrieve the current timeline (mostly used for testing.
      */
     std::shared_ptr<TimelineItemModel> getTimeline();
@@ -190,7 +194,7 @@ public Q_SLOTS:
     /** @brief Set properties to match outputFileName and save the document.
      * Creates an autosave version of the output file too (only if not in copymode), at
      * ~/.kde/data/stalefiles/kdenlive/ \n
-     * that will be actually written in KdenliveDoc::slotAutoSave()
+     * that will be actually written by ProjectManager::slotAutoSave()
      * @param outputFileName The URL to save to / The document's URL.
      * @param saveACopy Default is false. If true, the file will be saved but isn’t opened afterwards. Besides no autosave version will be created
      * @return Whether we had success. */
@@ -263,7 +267,7 @@ private Q_SLOTS:
     void updateSequenceDuration(const QUuid &uuid);
     /** @brief Open the project's backupdialog. */
     bool slotOpenBackup(const QUrl &url = QUrl());
-    /** @brief Start autosaving the document. */
+    /** @brief Start autosaving the document, unless a temporary timeline mode (multitrack view, trimming) is active. */
     void slotAutoSave();
     /** @brief Report progress of folder move operation. */
     void slotMoveProgress(KJob *, unsigned long progress);
@@ -281,6 +285,10 @@ private:
 
     /** @brief checks if autoback files exists, recovers from it if user says yes, returns true if files were recovered. */
     bool checkForBackupFile(const QUrl &url, bool newFile = false);
+    /** @brief Build the scene and write the autosave file in a worker thread.
+     *
+     * The scene is built while holding the sequences' model locks, timeline operations started meanwhile wait for it. */
+    void runAutoSave();
     /** @brief Update the sequence producer stored in the project model. */
     void updateSequenceProducer(const QUuid &uuid, std::shared_ptr<Mlt::Producer> prod);
 
@@ -288,6 +296,8 @@ private:
     QElapsedTimer m_lastSave;
     QTimer m_autoSaveTimer;
     int m_autoSaveChangeCount{0};
+    /** @brief The autosave being written, must be finished before touching the autosave file */
+    QFuture<void> m_autoSaveFuture;
     QUrl m_startUrl;
     QStringList m_loadClipsOnOpen;
     QMap<QString, QString> m_replacementPattern;
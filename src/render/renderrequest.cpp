@@ -25,6 +25,16 @@
 
 QStringList RenderRequest::argsByJob(const RenderJob &job, bool addPid)
 {
+    if (!job.segmentPlaylists.isEmpty()) {
+        QStringList args = {QStringLiteral("segments"), KdenliveSettings::meltpath(), job.playlistPath};
+        args << job.segmentPlaylists;
+        args << QStringLiteral("--output") << job.outputFile;
+        if (addPid) {
+            args << QStringLiteral("--pid");
+            args << QString::number(QCoreApplication::applicationPid());
+        }
+        return args;
+    }
     QStringList args = {QStringLiteral("delivery"), KdenliveSettings::meltpath(), job.playlistPath};
     if (addPid) {
         args << QStringLiteral("--pid");
@@ -102,6 +112,11 @@ void RenderRequest::setTwoPass(bool enabled)
     m_twoPass = enabled;
 }
 
+void RenderRequest::setSegmentCount(int count)
+{
+    m_segmentCount = qMax(1, count);
+}
+
 void RenderRequest::setAudioFilePerTrack(bool enabled)
 {
     m_audioFilePerTrack = enabled;
@@ -249,6 +264,18 @@ std::vector<RenderRequest::RenderJob> RenderRequest::process()
 
         // set parameters
         setDocGeneralParams(sectionDoc, section.in, section.out);
+        if (sections.size() == 1 && m_segmentCount > 1) {
+            if (canRenderSegments()) {
+                const std::vector<RenderSection> segments = getSegments(section.in, section.out);
+                if (segments.size() > 1) {
+                    qDebug() << "::: CREATED SEGMENTED JOB WITH OUTPUT: " << outputPath << ", SEGMENTS: " << segments.size();
+                    createSegmentJobs(jobs, sectionDoc, newPlaylistPath, outputPath, segments);
+                    continue;
+                }
+            } else {
+                qDebug() << "::: Render parameters are not compatible with segmented rendering, using a single process";
+            }
+        }
         qDebug() << "::: CREATED JOB WITH OUTPUT: " << outputPath;
         createRenderJobs(jobs, sectionDoc, newPlaylistPath, outputPath, subtitleFile, currentUuid);
     }
@@ -328,6 +355,105 @@ void RenderRequest::createRenderJobs(std::vector<RenderJob> &jobs, const QDomDoc
     }
 }
 
+bool RenderRequest::canRenderSegments()
+{
+    // Segments are joined without re-encoding, so each one must be a self contained video stream with the final encoding.
+    // Two pass, image sequences, separate audio files and subtitle embedding already post process the output in their own way.
+    if (m_twoPass || m_delayedRendering || m_audioFilePerTrack || m_embedSubtitles || m_presetParams.isImageSequence()) {
+        return false;
+    }
+    for (const auto &param : {QStringLiteral("vn"), QStringLiteral("video_off"), QStringLiteral("an"), QStringLiteral("audio_off")}) {
+        if (m_presetParams.contains(param)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<RenderRequest::RenderSection> RenderRequest::getSegments(int in, int out)
+{
+    std::vector<RenderSection> segments;
+    const int duration = out - in + 1;
+    // Segments shorter than 10 seconds are not worth starting another encoder
+    const int minimumDuration = qMax(1, int(10 * pCore->getCurrentFps()));
+    const int count = qBound(1, m_segmentCount, duration / minimumDuration);
+    QList<int> guides;
+    if (auto ptr = m_guidesModel.lock()) {
+        double fps = pCore->getCurrentFps();
+        const QList<CommentedTime> markers = ptr->getAllMarkers();
+        for (const auto &marker : markers) {
+            guides << marker.time().frames(fps);
+        }
+    }
+    // A split point can move by a quarter of the segment length to fall on a guide, which is usually a scene change
+    const int tolerance = duration / count / 4;
+    int start = in;
+    for (int i = 1; i <= count; i++) {
+        RenderSection segment;
+        segment.in = start;
+        segment.out = out;
+        if (i < count) {
+            int split = in + int(qint64(duration) * i / count);
+            int distance = tolerance + 1;
+            for (int guide : std::as_const(guides)) {
+                if (guide > start && guide <= out && qAbs(guide - split) < distance) {
+                    distance = qAbs(guide - split);
+                    split = guide;
+                }
+            }
+            segment.out = split - 1;
+        }
+        segments.push_back(segment);
+        start = segment.out + 1;
+    }
+    return segments;
+}
+
+void RenderRequest::createSegmentJobs(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistPath, const QString &outputPath,
+                                      const std::vector<RenderSection> &segments)
+{
+    RenderJob job;
+    job.outputPath = outputPath;
+    job.outputFile = outputPath;
+
+    // Audio is rendered in one pass over the whole range, so that there is no gap or encoder priming at the joins.
+    // It keeps the muxer parameters of the preset, they are reused when joining the parts.
+    job.playlistPath = QStringUtils::appendToFilename(playlistPath, QStringLiteral("-audio"));
+    QDomDocument audioDoc = doc.cloneNode(true).toDocument();
+    QDomElement consumer = audioDoc.documentElement().firstChildElement(QStringLiteral("consumer"));
+    consumer.setAttribute(QStringLiteral("vn"), 1);
+    consumer.setAttribute(QStringLiteral("video_off"), 1);
+    consumer.setAttribute(QStringLiteral("target"), QStringUtils::appendToFilename(outputPath, QStringLiteral("-audio")));
+    if (!Xml::docContentToFile(audioDoc, job.playlistPath)) {
+        addErrorMessage(i18n("Cannot write to file %1", job.playlistPath));
+        return;
+    }
+
+    // Each video segment is an independent encode, so it starts with a keyframe and no frame references another part.
+    // Parts are stored in Matroska, which can hold any codec and is reliably joined by the concat demuxer.
+    const QFileInfo output(outputPath);
+    for (size_t i = 0; i < segments.size(); i++) {
+        const QString suffix = QStringLiteral("-part%1").arg(i + 1, 2, 10, QLatin1Char('0'));
+        const QString segmentPlaylist = QStringUtils::appendToFilename(playlistPath, suffix);
+        QDomDocument segmentDoc = doc.cloneNode(true).toDocument();
+        QDomElement segmentConsumer = segmentDoc.documentElement().firstChildElement(QStringLiteral("consumer"));
+        segmentConsumer.setAttribute(QStringLiteral("in"), segments.at(i).in);
+        segmentConsumer.setAttribute(QStringLiteral("out"), segments.at(i).out);
+        segmentConsumer.setAttribute(QStringLiteral("an"), 1);
+        segmentConsumer.setAttribute(QStringLiteral("audio_off"), 1);
+        segmentConsumer.setAttribute(QStringLiteral("f"), QStringLiteral("matroska"));
+        segmentConsumer.removeAttribute(QStringLiteral("movflags"));
+        const QString segmentFile = output.absoluteDir().absoluteFilePath(output.completeBaseName() + suffix + QStringLiteral(".mkv"));
+        segmentConsumer.setAttribute(QStringLiteral("target"), segmentFile);
+        if (!Xml::docContentToFile(segmentDoc, segmentPlaylist)) {
+            addErrorMessage(i18n("Cannot write to file %1", segmentPlaylist));
+            return;
+        }
+        job.segmentPlaylists << segmentPlaylist;
+    }
+    jobs.push_back(job);
+}
+
 QString RenderRequest::createEmptyTempFile(const QString &extension)
 {
     QTemporaryFile tmp(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.%1").arg(extension)));
@@ -516,6 +642,16 @@ QVector<std::pair<int, int>> RenderRequest::getSectionsInOut()
     return results;
 }
 
+QVector<std::pair<int, int>> RenderRequest::getSegmentsInOut()
+{
+    QVector<std::pair<int, int>> results;
+    const std::vector<RenderRequest::RenderSection> segments = getSegments(m_boundingIn, m_boundingOut);
+    for (const auto &segment : segments) {
+        results.append({segment.in, segment.out});
+    }
+    return results;
+}
+
 QStringList RenderRequest::getSectionsNames()
 {
     QStringList names;
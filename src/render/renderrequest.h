@@ -25,6 +25,9 @@ public:
         QString outputFile;
         /** @brief The path to the subtitle file used on rendering */
         QString subtitlePath;
+        /** @brief The playlists of the video segments rendered in parallel when using segmented rendering.
+         *  In that case playlistPath renders the audio in one continuous pass, and the parts are joined into outputFile */
+        QStringList segmentPlaylists;
     };
 
     /** @brief Set frame range that should be rendered
@@ -40,6 +43,8 @@ public:
     void setProxyRendering(bool enabled);
     void setEmbedSubtitles(bool enabled);
     void setTwoPass(bool enabled);
+    /** @brief Split the video in @param count segments rendered in parallel, 1 disables segmented rendering */
+    void setSegmentCount(int count);
     void setAspectRatio(const QString &aspectRatio);
     void setAudioFilePerTrack(bool enabled);
     void setGuideParams(std::weak_ptr<MarkerListModel> model, bool enableMultiExport, int filterCategory);
@@ -55,6 +60,7 @@ public:
     int guideSectionsCount();
     QVector<std::pair<int, int>> getSectionsInOut();
     QStringList getSectionsNames();
+    QVector<std::pair<int, int>> getSegmentsInOut();
 
 protected:
     int m_boundingIn;
@@ -80,12 +86,17 @@ private:
     bool m_guideMultiExport = false;
     int m_guideCategory = -1; /// category used as filter if @variable guideMultiExport is @value true
     bool m_twoPass = false;
+    int m_segmentCount = 1;
 
     QStringList m_errors;
 
     void setDocGeneralParams(QDomDocument doc, int in, int out);
     void setDocTwoPassParams(int pass, QDomDocument &doc, const QString &outputFile);
     std::vector<RenderSection> getGuideSections();
+    /** @brief Split a range in segments of similar length, moving the split points to a close guide when there is one */
+    std::vector<RenderSection> getSegments(int in, int out);
+    /** @brief Returns true if the current parameters allow rendering the video in parallel segments */
+    bool canRenderSegments();
 
     static void prepareMultiAudioFiles(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistFile, const QString &targetFile,
                                        const QUuid &uuid);
@@ -105,5 +116,9 @@ private:
     void createRenderJobs(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistPath, QString outputPath, const QString &subtitlePath,
                           const QUuid &uuid);
 
+    /** @brief Create a segmented render job: one playlist per video segment, and a playlist rendering the whole audio */
+    void createSegmentJobs(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistPath, const QString &outputPath,
+                           const std::vector<RenderSection> &segments);
+
     void addErrorMessage(const QString &error);
 };
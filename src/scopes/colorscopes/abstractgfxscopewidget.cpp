@@ -22,10 +22,21 @@ AbstractGfxScopeWidget::AbstractGfxScopeWidget(bool trackMouse, QWidget *parent)
 
 AbstractGfxScopeWidget::~AbstractGfxScopeWidget() = default;
 
+int AbstractGfxScopeWidget::requiredPlanes() const
+{
+    return 0;
+}
+
 QImage AbstractGfxScopeWidget::renderScope(uint accelerationFactor)
 {
     QMutexLocker lock(&m_mutex);
-    return renderGfxScope(accelerationFactor, m_scopeImage);
+    // The frame is not modified once analysed, so new frames can be received while rendering
+    std::shared_ptr<const ScopeFrame> frame = m_scopeFrame;
+    lock.unlock();
+    if (!frame) {
+        return renderGfxScope(accelerationFactor, ScopeFrame(QImage()));
+    }
+    return renderGfxScope(accelerationFactor, *frame.get());
 }
 
 void AbstractGfxScopeWidget::mouseReleaseEvent(QMouseEvent *event)
@@ -36,10 +47,11 @@ void AbstractGfxScopeWidget::mouseReleaseEvent(QMouseEvent *event)
 
 ///// Slots /////
 
-void AbstractGfxScopeWidget::slotRenderZoneUpdated(const QImage &frame)
+void AbstractGfxScopeWidget::slotRenderZoneUpdated(const std::shared_ptr<const ScopeFrame> &frame)
 {
     QMutexLocker lock(&m_mutex);
-    m_scopeImage = frame;
+    m_scopeFrame = frame;
+    lock.unlock();
     AbstractScopeWidget::slotRenderZoneUpdated();
 }
 
@@ -8,9 +8,11 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #pragma once
 
 #include "../abstractscopewidget.h"
+#include "scopeframe.h"
 
 #include <QString>
 #include <QWidget>
+#include <memory>
 
 /**
 * @brief Abstract class for scopes analyzing image frames.
@@ -23,27 +25,31 @@ public:
     explicit AbstractGfxScopeWidget(bool trackMouse = false, QWidget *parent = nullptr);
     ~AbstractGfxScopeWidget() override; // Must be virtual because of inheritance, to avoid memory leaks
 
+    /** @brief Returns the OR-ed ScopeFrame::Plane flags this scope will use with its current settings,
+     *  so that they can be computed once for all scopes when a frame is analysed. */
+    virtual int requiredPlanes() const;
+
 protected:
     ///// Variables /////
 
     /** @brief Scope renderer. Must emit signalScopeRenderingFinished()
      *  when calculation has finished, to allow multi-threading.
      *  accelerationFactor hints how much faster than usual the calculation should be accomplished, if possible. */
-    virtual QImage renderGfxScope(uint accelerationFactor, const QImage &) = 0;
+    virtual QImage renderGfxScope(uint accelerationFactor, const ScopeFrame &) = 0;
 
     QImage renderScope(uint accelerationFactor) override;
 
     void mouseReleaseEvent(QMouseEvent *) override;
 
 private:
-    QImage m_scopeImage;
+    std::shared_ptr<const ScopeFrame> m_scopeFrame;
     QMutex m_mutex;
 
 public Q_SLOTS:
     /** @brief Must be called when the active monitor has shown a new frame.
      * This slot must be connected in the implementing class, it is *not*
      * done in this abstract class. */
-    void slotRenderZoneUpdated(const QImage &);
+    void slotRenderZoneUpdated(const std::shared_ptr<const ScopeFrame> &frame);
 
 protected Q_SLOTS:
     virtual void slotAutoRefreshToggled(bool autoRefresh);
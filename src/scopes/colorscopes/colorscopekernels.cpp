@@ -0,0 +1,95 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "colorscopekernels.h"
+
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Below this, the cost of starting a thread is higher than the analysis itself
+constexpr int minRowsPerBand = 32;
+} // namespace
+
+QImage ColorScopeKernels::rgbImage(const QImage &image)
+{
+    switch (image.format()) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        // Scanlines can be read directly
+        return image;
+    default:
+        break;
+    }
+    if (image.pixelFormat().premultiplied() == QPixelFormat::Premultiplied) {
+        return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    return image.convertToFormat(QImage::Format_ARGB32);
+}
+
+int ColorScopeKernels::bandCount(int rows, qint64 samples, qint64 binsPerBand)
+{
+    qint64 bands = std::min(QThread::idealThreadCount(), rows / minRowsPerBand);
+    if (binsPerBand > 0) {
+        // Each band clears and merges its own bins, don't split if this costs more than the analysis
+        bands = std::min(bands, samples / (2 * binsPerBand));
+    }
+    return int(std::max<qint64>(1, bands));
+}
+
+void ColorScopeKernels::runBands(int rows, int bands, const std::function<void(int, int, int)> &function)
+{
+    if (bands <= 1) {
+        function(0, 0, rows);
+        return;
+    }
+    std::vector<int> indexes(size_t(bands), 0);
+    std::iota(indexes.begin(), indexes.end(), 0);
+    // The calling thread takes part in the processing, so this is safe from a thread pool worker
+    QtConcurrent::blockingMap(indexes, [rows, bands, &function](int &band) {
+        const int firstRow = int(qint64(rows) * band / bands);
+        const int endRow = int(qint64(rows) * (band + 1) / bands);
+        function(band, firstRow, endRow);
+    });
+}
+
+int ColorScopeKernels::computeLuma(const QRgb *line, int width, int firstColumn, uint step, ITURec rec, float *luma)
+{
+    const float wR = rec == ITURec::Rec_601 ? REC_601_R : REC_709_R;
+    const float wG = rec == ITURec::Rec_601 ? REC_601_G : REC_709_G;
+    const float wB = rec == ITURec::Rec_601 ? REC_601_B : REC_709_B;
+    int count = 0;
+    int x = firstColumn;
+#ifdef __SSE2__
+    if (step == 1) {
+        // Process 4 pixels at once, using the same operations in the same order as the scalar code
+        const __m128i mask = _mm_set1_epi32(0xff);
+        const __m128 vR = _mm_set1_ps(wR);
+        const __m128 vG = _mm_set1_ps(wG);
+        const __m128 vB = _mm_set1_ps(wB);
+        for (; x + 4 <= width; x += 4, count += 4) {
+            const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + x));
+            const __m128 r = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 16), mask));
+            const __m128 g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 8), mask));
+            const __m128 b = _mm_cvtepi32_ps(_mm_and_si128(px, mask));
+            const __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vR, r), _mm_mul_ps(vG, g)), _mm_mul_ps(vB, b));
+            _mm_storeu_ps(luma + count, y);
+        }
+    }
+#endif
+    for (; x < width; x += int(step), ++count) {
+        const QRgb pixel = line[x];
+        luma[count] = wR * qRed(pixel) + wG * qGreen(pixel) + wB * qBlue(pixel);
+    }
+    return count;
+}
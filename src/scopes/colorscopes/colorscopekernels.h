@@ -0,0 +1,51 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "colorconstants.h"
+#include <QImage>
+#include <functional>
+
+/**
+ * Helpers shared by the color scope generators to analyse a frame.
+ *
+ * The generators read the frame row by row through scanlines instead of QImage::pixel(),
+ * and split the rows into bands that are analysed in parallel, each band accumulating
+ * into its own bins. The bins are then merged in band order, so that the result
+ * does not depend on the number of threads.
+ */
+namespace ColorScopeKernels {
+
+/** @brief Returns @p image in a 32 bit format whose scanlines contain the values returned by QImage::pixel().
+    The image is only converted if required. */
+QImage rgbImage(const QImage &image);
+
+/** @brief Returns the number of row bands to use to analyse an image.
+    @param rows the image height
+    @param samples the number of pixels that will be analysed
+    @param binsPerBand the number of bins each band has to clear and merge */
+int bandCount(int rows, qint64 samples, qint64 binsPerBand);
+
+/** @brief Calls @p function(band, firstRow, endRow) for each band of rows, in parallel if there is more than one band.
+    Returns when all the bands have been processed. */
+void runBands(int rows, int bands, const std::function<void(int, int, int)> &function);
+
+/** @brief Returns the first column of @p row that is sampled when stepping through all the image pixels with @p accelFactor */
+inline int firstSampledColumn(int row, int width, uint accelFactor)
+{
+    return int((accelFactor - (qint64(row) * width) % accelFactor) % accelFactor);
+}
+
+/** @brief Computes the luma of the pixels of a scanline, the same way as the scalar REC_601 / REC_709 formula.
+    @param line the scanline
+    @param width the number of pixels in the line
+    @param firstColumn the first pixel to process
+    @param step the distance between two processed pixels
+    @param luma receives the luma of each processed pixel, on [0,255]
+    @return the number of processed pixels */
+int computeLuma(const QRgb *line, int width, int firstColumn, uint step, ITURec rec, float *luma);
+
+} // namespace ColorScopeKernels
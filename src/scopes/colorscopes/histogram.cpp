@@ -183,6 +183,14 @@ QString Histogram::widgetName() const
     return QStringLiteral("Histogram");
 }
 
+int Histogram::requiredPlanes() const
+{
+    if ((m_components & HistogramGenerator::ComponentY) == 0) {
+        return 0;
+    }
+    return ScopeFrame::lumaPlane(m_aRec601->isChecked() ? ITURec::Rec_601 : ITURec::Rec_709);
+}
+
 bool Histogram::isHUDDependingOnInput() const
 {
     return false;
@@ -207,7 +215,7 @@ QImage Histogram::renderHUD(uint)
     Q_EMIT signalHUDRenderingFinished(0, 1);
     return QImage();
 }
-QImage Histogram::renderGfxScope(uint accelFactor, const QImage &qimage)
+QImage Histogram::renderGfxScope(uint accelFactor, const ScopeFrame &frame)
 {
     QElapsedTimer timer;
     timer.start();
@@ -215,7 +223,7 @@ QImage Histogram::renderGfxScope(uint accelFactor, const QImage &qimage)
     ITURec rec = m_aRec601->isChecked() ? ITURec::Rec_601 : ITURec::Rec_709;
 
     qreal scalingFactor = devicePixelRatioF();
-    QImage histogram = m_histogramGenerator->calculateHistogram(m_scopeRect.size(), scalingFactor, qimage, m_components, rec, m_aUnscaled->isChecked(),
+    QImage histogram = m_histogramGenerator->calculateHistogram(m_scopeRect.size(), scalingFactor, frame, m_components, rec, m_aUnscaled->isChecked(),
                                                                 m_logScale, accelFactor, palette());
 
     Q_EMIT signalScopeRenderingFinished(uint(timer.elapsed()), accelFactor);
@@ -23,6 +23,7 @@ public:
     explicit Histogram(QWidget *parent = nullptr);
     ~Histogram() override;
     QString widgetName() const override;
+    int requiredPlanes() const override;
 
 protected:
     void readConfig() override;
@@ -64,7 +65,7 @@ private:
     bool isScopeDependingOnInput() const override;
     bool isBackgroundDependingOnInput() const override;
     QImage renderHUD(uint accelerationFactor) override;
-    QImage renderGfxScope(uint accelerationFactor, const QImage &) override;
+    QImage renderGfxScope(uint accelerationFactor, const ScopeFrame &frame) override;
     QImage renderBackground(uint accelerationFactor) override;
     Ui::Histogram_UI *m_ui;
 
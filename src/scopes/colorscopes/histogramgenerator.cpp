@@ -6,6 +6,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "histogramgenerator.h"
+#include "colorscopekernels.h"
+#include "scopeframe.h"
 
 #include "klocalizedstring.h"
 #include <QDebug>
@@ -13,12 +15,20 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QPainter>
 #include <algorithm>
 #include <cmath>
+#include <vector>
 
 HistogramGenerator::HistogramGenerator() = default;
 
 QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, qreal scalingFactor, const QImage &image, const int &components, ITURec rec,
                                               bool unscaled, bool logScale, uint accelFactor, const QPalette &palette) const
 {
+    return calculateHistogram(paradeSize, scalingFactor, ScopeFrame(image), components, rec, unscaled, logScale, accelFactor, palette);
+}
+
+QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, qreal scalingFactor, const ScopeFrame &frame, const int &components, ITURec rec,
+                                              bool unscaled, bool logScale, uint accelFactor, const QPalette &palette) const
+{
+    const QImage &image = frame.image();
     if (paradeSize.height() <= 0 || paradeSize.width() <= 0 || image.width() <= 0 || image.height() <= 0) {
         return QImage();
     }
@@ -29,43 +39,73 @@ QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, qreal sca
     bool drawB = (components & HistogramGenerator::ComponentB) != 0;
     bool drawSum = (components & HistogramGenerator::ComponentSum) != 0;
 
-    int r[256], g[256], b[256], y[256], s[766];
-    // Initialize the values to zero
-    std::fill(r, r + 256, 0);
-    std::fill(g, g + 256, 0);
-    std::fill(b, b + 256, 0);
-    std::fill(y, y + 256, 0);
-    std::fill(s, s + 766, 0);
+    // Bins of a band of rows
+    struct Bins
+    {
+        int r[256] = {};
+        int g[256] = {};
+        int b[256] = {};
+        int y[256] = {};
+        int s[766] = {};
+    };
 
     const int ww = paradeSize.width();
     const int wh = paradeSize.height();
 
     // Read the stats from the input image
-    for (int Y = 0; Y < image.height(); ++Y) {
-        for (int X = 0; X < image.width(); X += accelFactor) {
-
-            QRgb col = image.pixel(X, Y);
-            r[qRed(col)]++;
-            g[qGreen(col)]++;
-            b[qBlue(col)]++;
+    const int iw = image.width();
+    // Only compute the luma if Y is enabled
+    const float *luma = drawY ? frame.luma(rec) : nullptr;
+    const int bands = ColorScopeKernels::bandCount(image.height(), qint64(image.height()) * iw / accelFactor, 0);
+    std::vector<Bins> bandBins(size_t(bands));
+    ColorScopeKernels::runBands(image.height(), bands, [&](int band, int firstRow, int endRow) {
+        Bins &bins = bandBins[size_t(band)];
+        for (int Y = firstRow; Y < endRow; ++Y) {
+            const auto *line = reinterpret_cast<const QRgb *>(image.constScanLine(Y));
+            for (int X = 0; X < iw; X += accelFactor) {
+                const QRgb col = line[X];
+                bins.r[qRed(col)]++;
+                bins.g[qGreen(col)]++;
+                bins.b[qBlue(col)]++;
+            }
 
             if (drawY) {
-                // Use if branch to avoid expensive multiplication if Y disabled
-                if (rec == ITURec::Rec_601) {
-                    y[int(REC_601_R * qRed(col) + REC_601_G * qGreen(col) + REC_601_B * qBlue(col))]++;
-                } else {
-                    y[int(REC_709_R * qRed(col) + REC_709_G * qGreen(col) + REC_709_B * qBlue(col))]++;
+                const float *lumaLine = luma + size_t(Y) * size_t(iw);
+                for (int X = 0; X < iw; X += accelFactor) {
+                    bins.y[int(lumaLine[X])]++;
                 }
             }
 
             if (drawSum) {
-                // Use an if branch here because the sum takes more operations than rgb
-                s[qRed(col)]++;
-                s[qGreen(col)]++;
-                s[qBlue(col)]++;
+                // The sum takes more operations than rgb
+                for (int X = 0; X < iw; X += accelFactor) {
+                    const QRgb col = line[X];
+                    bins.s[qRed(col)]++;
+                    bins.s[qGreen(col)]++;
+                    bins.s[qBlue(col)]++;
+                }
             }
         }
+    });
+
+    Bins &bins = bandBins.front();
+    for (size_t band = 1; band < bandBins.size(); ++band) {
+        const Bins &other = bandBins[band];
+        for (int i = 0; i < 256; ++i) {
+            bins.r[i] += other.r[i];
+            bins.g[i] += other.g[i];
+            bins.b[i] += other.b[i];
+            bins.y[i] += other.y[i];
+        }
+        for (int i = 0; i < 766; ++i) {
+            bins.s[i] += other.s[i];
+        }
     }
+    const int *r = bins.r;
+    const int *g = bins.g;
+    const int *b = bins.b;
+    const int *y = bins.y;
+    const int *s = bins.s;
 
     const int nParts = (drawY ? 1 : 0) + (drawR ? 1 : 0) + (drawG ? 1 : 0) + (drawB ? 1 : 0) + (drawSum ? 1 : 0);
     if (nParts == 0) {
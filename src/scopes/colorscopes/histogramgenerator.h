@@ -16,6 +16,7 @@ class QImage;
 class QPainter;
 class QRect;
 class QSize;
+class ScopeFrame;
 
 class HistogramGenerator : public QObject
 {
@@ -37,6 +38,9 @@ public:
      */
     QImage calculateHistogram(const QSize &paradeSize, qreal scalingFactor, const QImage &image, const int &components, const ITURec rec, bool unscaled,
                               bool logScale, uint accelFactor = 1, const QPalette &palette = QPalette()) const;
+    /** @brief Calculates the histogram of a frame prepared for the scopes, using its shared luma plane */
+    QImage calculateHistogram(const QSize &paradeSize, qreal scalingFactor, const ScopeFrame &frame, const int &components, const ITURec rec, bool unscaled,
+                              bool logScale, uint accelFactor = 1, const QPalette &palette = QPalette()) const;
 
     /**
      * Draws the histogram of a single component.
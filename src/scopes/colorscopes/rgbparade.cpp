@@ -229,12 +229,12 @@ QImage RGBParade::renderHUD(uint)
     return hud;
 }
 
-QImage RGBParade::renderGfxScope(uint accelerationFactor, const QImage &qimage)
+QImage RGBParade::renderGfxScope(uint accelerationFactor, const ScopeFrame &frame)
 {
     QElapsedTimer timer;
     timer.start();
 
-    QImage parade = m_rgbParadeGenerator->calculateRGBParade(m_scopeRect.size(), devicePixelRatioF(), qimage, RGBParadeGenerator::PaintMode(m_iPaintMode),
+    QImage parade = m_rgbParadeGenerator->calculateRGBParade(m_scopeRect.size(), devicePixelRatioF(), frame, RGBParadeGenerator::PaintMode(m_iPaintMode),
                                                              m_aAxis->isChecked(), m_aGradRef->isChecked(), accelerationFactor, palette());
     Q_EMIT signalScopeRenderingFinished(uint(timer.elapsed()), accelerationFactor);
     return parade;
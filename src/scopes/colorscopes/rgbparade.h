@@ -54,7 +54,7 @@ private:
     bool isBackgroundDependingOnInput() const override;
 
     QImage renderHUD(uint accelerationFactor) override;
-    QImage renderGfxScope(uint accelerationFactor, const QImage &) override;
+    QImage renderGfxScope(uint accelerationFactor, const ScopeFrame &frame) override;
     QImage renderBackground(uint accelerationFactor) override;
 
 private Q_SLOTS:
@@ -6,10 +6,14 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "rgbparadegenerator.h"
+#include "colorscopekernels.h"
+#include "scopeframe.h"
 #include "klocalizedstring.h"
 #include <QColor>
 #include <QDebug>
 #include <QPainter>
+#include <algorithm>
+#include <vector>
 
 #define CHOP255(a) ((255) < (a) ? (255) : int(a))
 #define CHOP1255(a) ((a) < (1) ? (1) : ((a) > (255) ? (255) : (a)))
@@ -18,18 +22,19 @@ const uchar RGBParadeGenerator::distRight(31);
 const uchar RGBParadeGenerator::distBottom(40);
 const uchar RGBParadeGenerator::distBorder(2);
 
-struct StructRGB
-{
-    uint r;
-    uint g;
-    uint b;
-};
-
 RGBParadeGenerator::RGBParadeGenerator() = default;
 
 QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, qreal scalingFactor, const QImage &image, const RGBParadeGenerator::PaintMode paintMode,
                                               bool drawAxis, bool drawGradientRef, uint accelFactor, const QPalette &palette)
 {
+    return calculateRGBParade(paradeSize, scalingFactor, ScopeFrame(image), paintMode, drawAxis, drawGradientRef, accelFactor, palette);
+}
+
+QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, qreal scalingFactor, const ScopeFrame &frame,
+                                              const RGBParadeGenerator::PaintMode paintMode, bool drawAxis, bool drawGradientRef, uint accelFactor,
+                                              const QPalette &palette)
+{
+    const QImage &image = frame.image();
     Q_ASSERT(accelFactor >= 1);
 
     if (paradeSize.width() <= 0 || paradeSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
@@ -55,9 +60,6 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, qreal sca
     const uint partW = (ww - 2 * offset - distRight - 2 * distBorder) / 3;
     const uint partH = wh - distBottom - 2 * distBorder;
 
-    // Statistics
-    uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0;
-
     // Number of input pixels that will fall on one scope pixel.
     // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
     const float pixelDepth = float((iw * ih) / accelFactor) / (partW * 255);
@@ -69,41 +71,71 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, qreal sca
 
     const float wPrediv = float(partW - 1) / (iw - 1);
 
-    std::vector<std::vector<StructRGB>> paradeVals(partW, std::vector<StructRGB>(256, {0, 0, 0}));
-
-    const auto totalPixels = image.width() * image.height();
-    for (int i = 0; i < totalPixels; i += accelFactor) {
-        const auto x = i % image.width();
-        const QRgb pixel = image.pixel(x, i / image.width());
-        auto r = uchar(qRed(pixel));
-        auto g = uchar(qGreen(pixel));
-        auto b = uchar(qBlue(pixel));
-
+    // Bins of a band of rows. Values are stored per channel, then per value, then per scope column
+    // so that painting a row of the parade walks them linearly
+    struct BandStats
+    {
+        std::vector<uint> values;
+        uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0;
+    };
+    const size_t channelBins = size_t(partW) * 256;
+
+    // Scope column of each image column
+    std::vector<uint> columnBins(iw);
+    for (uint x = 0; x < iw; ++x) {
         double dx = x * double(wPrediv);
+        columnBins[x] = uint(dx);
+    }
 
-        paradeVals[size_t(dx)][r].r++;
-        paradeVals[size_t(dx)][g].g++;
-        paradeVals[size_t(dx)][b].b++;
-
-        if (r < minR) {
-            minR = r;
-        }
-        if (g < minG) {
-            minG = g;
-        }
-        if (b < minB) {
-            minB = b;
-        }
-        if (r > maxR) {
-            maxR = r;
-        }
-        if (g > maxG) {
-            maxG = g;
+    const int bands = ColorScopeKernels::bandCount(int(ih), qint64(iw) * ih / accelFactor, qint64(3 * channelBins));
+    std::vector<BandStats> bandStats(size_t(bands));
+    ColorScopeKernels::runBands(int(ih), bands, [&](int band, int firstRow, int endRow) {
+        BandStats &stats = bandStats[size_t(band)];
+        stats.values.assign(3 * channelBins, 0);
+        uint *valuesR = stats.values.data();
+        uint *valuesG = valuesR + channelBins;
+        uint *valuesB = valuesG + channelBins;
+        for (int y = firstRow; y < endRow; ++y) {
+            const auto *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+            for (uint x = uint(ColorScopeKernels::firstSampledColumn(y, int(iw), accelFactor)); x < iw; x += accelFactor) {
+                const QRgb pixel = line[x];
+                auto r = uchar(qRed(pixel));
+                auto g = uchar(qGreen(pixel));
+                auto b = uchar(qBlue(pixel));
+
+                const uint column = columnBins[x];
+                valuesR[r * partW + column]++;
+                valuesG[g * partW + column]++;
+                valuesB[b * partW + column]++;
+
+                stats.minR = std::min(stats.minR, r);
+                stats.minG = std::min(stats.minG, g);
+                stats.minB = std::min(stats.minB, b);
+                stats.maxR = std::max(stats.maxR, r);
+                stats.maxG = std::max(stats.maxG, g);
+                stats.maxB = std::max(stats.maxB, b);
+            }
         }
-        if (b > maxB) {
-            maxB = b;
+    });
+
+    BandStats &paradeStats = bandStats.front();
+    for (size_t band = 1; band < bandStats.size(); ++band) {
+        const BandStats &stats = bandStats[band];
+        for (size_t i = 0; i < stats.values.size(); ++i) {
+            paradeStats.values[i] += stats.values[i];
         }
+        paradeStats.minR = std::min(paradeStats.minR, stats.minR);
+        paradeStats.minG = std::min(paradeStats.minG, stats.minG);
+        paradeStats.minB = std::min(paradeStats.minB, stats.minB);
+        paradeStats.maxR = std::max(paradeStats.maxR, stats.maxR);
+        paradeStats.maxG = std::max(paradeStats.maxG, stats.maxG);
+        paradeStats.maxB = std::max(paradeStats.maxB, stats.maxB);
     }
+    const uchar minR = paradeStats.minR, minG = paradeStats.minG, minB = paradeStats.minB;
+    const uchar maxR = paradeStats.maxR, maxG = paradeStats.maxG, maxB = paradeStats.maxB;
+    const uint *paradeR = paradeStats.values.data();
+    const uint *paradeG = paradeR + channelBins;
+    const uint *paradeB = paradeG + channelBins;
 
     const int offset1 = int(partW + offset);
     const int offset2 = int(2 * partW + 2 * offset);
@@ -120,25 +152,23 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, qreal sca
     davinci.fillRect(QRect(offset1 + distBorder, distBorder, partW, partH), darkParadeBackground);
     davinci.fillRect(QRect(offset2 + distBorder, distBorder, partW, partH), darkParadeBackground);
 
-    switch (paintMode) {
-    case PaintMode_RGB:
-        for (int i = 0; i < int(partW); ++i) {
-            for (int j = 0; j < 256; ++j) {
-                unscaled.setPixel(i, j, qRgba(255, 10, 10, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].r))));
-                unscaled.setPixel(i + offset1, j, qRgba(10, 255, 10, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].g))));
-                unscaled.setPixel(i + offset2, j, qRgba(10, 10, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].b))));
-            }
-        }
-        break;
-    default:
+    // Paint the colors of the three parts at once, one row of the unscaled parade per value
+    QRgb colorR = qRgba(255, 10, 10, 0);
+    QRgb colorG = qRgba(10, 255, 10, 0);
+    QRgb colorB = qRgba(10, 10, 255, 0);
+    if (paintMode != PaintMode_RGB) {
+        colorR = colorG = colorB = qRgba(255, 255, 255, 0);
+    }
+    for (int j = 0; j < 256; ++j) {
+        auto *line = reinterpret_cast<QRgb *>(unscaled.scanLine(j));
+        const uint *valuesR = paradeR + size_t(j) * partW;
+        const uint *valuesG = paradeG + size_t(j) * partW;
+        const uint *valuesB = paradeB + size_t(j) * partW;
         for (int i = 0; i < int(partW); ++i) {
-            for (int j = 0; j < 256; ++j) {
-                unscaled.setPixel(i, j, qRgba(255, 255, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].r))));
-                unscaled.setPixel(i + offset1, j, qRgba(255, 255, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].g))));
-                unscaled.setPixel(i + offset2, j, qRgba(255, 255, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].b))));
-            }
+            line[i] = qRgba(qRed(colorR), qGreen(colorR), qBlue(colorR), CHOP255(gain * float(valuesR[i])));
+            line[i + offset1] = qRgba(qRed(colorG), qGreen(colorG), qBlue(colorG), CHOP255(gain * float(valuesG[i])));
+            line[i + offset2] = qRgba(qRed(colorB), qGreen(colorB), qBlue(colorB), CHOP255(gain * float(valuesB[i])));
         }
-        break;
     }
 
     // Scale the image to the target height. Scaling is not accomplished before because
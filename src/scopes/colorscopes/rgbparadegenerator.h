@@ -13,6 +13,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 class QColor;
 class QImage;
 class QSize;
+class ScopeFrame;
 class RGBParadeGenerator : public QObject
 {
     Q_OBJECT
@@ -22,6 +23,9 @@ public:
     RGBParadeGenerator();
     QImage calculateRGBParade(const QSize &paradeSize, qreal scalingFactor, const QImage &image, const RGBParadeGenerator::PaintMode paintMode, bool drawAxis,
                               bool drawGradientRef, uint accelFactor = 1, const QPalette &palette = QPalette());
+    /** @brief Calculates the RGB parade of a frame prepared for the scopes */
+    QImage calculateRGBParade(const QSize &paradeSize, qreal scalingFactor, const ScopeFrame &frame, const RGBParadeGenerator::PaintMode paintMode,
+                              bool drawAxis, bool drawGradientRef, uint accelFactor = 1, const QPalette &palette = QPalette());
 
     static const uchar distRight;
     static const uchar distBottom;
@@ -0,0 +1,76 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "scopeframe.h"
+#include "colorscopekernels.h"
+
+#include <QElapsedTimer>
+
+ScopeFrame::ScopeFrame(const QImage &image, int maxPixels)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QImage frame = image;
+    if (maxPixels > 0 && !image.isNull()) {
+        int step = 1;
+        while (qint64((image.width() + step - 1) / step) * ((image.height() + step - 1) / step) > maxPixels) {
+            step++;
+        }
+        if (step > 1) {
+            // Keep real pixel values (no filtering), so that the minimum and maximum values remain meaningful
+            frame = image.scaled((image.width() + step - 1) / step, (image.height() + step - 1) / step, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+        }
+    }
+    m_image = ColorScopeKernels::rgbImage(frame);
+    m_analysisTime.fetchAndAddRelaxed(timer.nsecsElapsed() / 1000);
+}
+
+const QImage &ScopeFrame::image() const
+{
+    return m_image;
+}
+
+// static
+ScopeFrame::Plane ScopeFrame::lumaPlane(ITURec rec)
+{
+    return rec == ITURec::Rec_601 ? Plane_LumaRec601 : Plane_LumaRec709;
+}
+
+void ScopeFrame::computePlanes(int planes)
+{
+    if (planes & Plane_LumaRec601) {
+        luma(ITURec::Rec_601);
+    }
+    if (planes & Plane_LumaRec709) {
+        luma(ITURec::Rec_709);
+    }
+}
+
+const float *ScopeFrame::luma(ITURec rec) const
+{
+    const int index = rec == ITURec::Rec_601 ? 0 : 1;
+    std::call_once(m_lumaComputed[index], [this, rec, index]() {
+        QElapsedTimer timer;
+        timer.start();
+        const int width = m_image.width();
+        const int height = m_image.height();
+        std::vector<float> &plane = m_luma[index];
+        plane.resize(size_t(width) * size_t(height));
+        const int bands = ColorScopeKernels::bandCount(height, qint64(width) * height, 0);
+        ColorScopeKernels::runBands(height, bands, [&](int, int firstRow, int endRow) {
+            for (int y = firstRow; y < endRow; ++y) {
+                const auto *line = reinterpret_cast<const QRgb *>(m_image.constScanLine(y));
+                ColorScopeKernels::computeLuma(line, width, 0, 1, rec, plane.data() + size_t(y) * size_t(width));
+            }
+        });
+        m_analysisTime.fetchAndAddRelaxed(timer.nsecsElapsed() / 1000);
+    });
+    return m_luma[index].data();
+}
+
+qint64 ScopeFrame::analysisTime() const
+{
+    return m_analysisTime.loadRelaxed();
+}
@@ -0,0 +1,51 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "colorconstants.h"
+#include <QAtomicInteger>
+#include <QImage>
+#include <mutex>
+#include <vector>
+
+/** @class ScopeFrame
+    @brief A frame prepared once for all the color scopes.
+    The frame is decimated if it is larger than needed, converted to a 32 bit format that can be read by scanline,
+    and planes derived from it (like the luma) are computed once and shared by all the scopes that need them.
+    Planes can be computed in advance with computePlanes(), otherwise they are computed on first use.
+    This class is thread safe.
+ */
+class ScopeFrame
+{
+public:
+    enum Plane { Plane_LumaRec601 = 1 << 0, Plane_LumaRec709 = 1 << 1 };
+
+    /** @brief Prepare a frame for analysis
+        @param image the frame
+        @param maxPixels if the frame has more pixels than this, only one pixel out of n in each direction is kept. 0 keeps the whole frame */
+    explicit ScopeFrame(const QImage &image, int maxPixels = 0);
+
+    /** @brief The frame to analyse, as a Format_RGB32, Format_ARGB32 or Format_ARGB32_Premultiplied image */
+    const QImage &image() const;
+
+    /** @brief Compute the given OR-ed planes now */
+    void computePlanes(int planes);
+
+    /** @brief Returns the luma plane (one value on [0,255] per image pixel, row by row), computing it if required */
+    const float *luma(ITURec rec) const;
+
+    /** @brief Returns the plane required for the luma of the given recommendation */
+    static Plane lumaPlane(ITURec rec);
+
+    /** @brief Time spent to prepare the frame and compute its planes, in microseconds */
+    qint64 analysisTime() const;
+
+private:
+    QImage m_image;
+    mutable std::vector<float> m_luma[2];
+    mutable std::once_flag m_lumaComputed[2];
+    mutable QAtomicInteger<qint64> m_analysisTime{0};
+};
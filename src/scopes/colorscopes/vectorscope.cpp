@@ -441,7 +441,7 @@ QImage Vectorscope::renderHUD(uint)
     return hud;
 }
 
-QImage Vectorscope::renderGfxScope(uint accelerationFactor, const QImage &qimage)
+QImage Vectorscope::renderGfxScope(uint accelerationFactor, const ScopeFrame &frame)
 {
     QElapsedTimer timer;
     timer.start();
@@ -455,7 +455,7 @@ QImage Vectorscope::renderGfxScope(uint accelerationFactor, const QImage &qimage
             m_aColorSpace_YPbPr->isChecked() ? VectorscopeGenerator::ColorSpace_YPbPr : VectorscopeGenerator::ColorSpace_YUV;
         VectorscopeGenerator::PaintMode paintMode = VectorscopeGenerator::PaintMode(m_iPaintMode);
         qreal dpr = devicePixelRatioF();
-        scope = m_vectorscopeGenerator->calculateVectorscope(m_scopeRect.size() * dpr, dpr, qimage, m_gain, paintMode, colorSpace, m_aAxisEnabled->isChecked(),
+        scope = m_vectorscopeGenerator->calculateVectorscope(m_scopeRect.size() * dpr, dpr, frame, m_gain, paintMode, colorSpace, m_aAxisEnabled->isChecked(),
                                                              accelerationFactor);
     }
     Q_EMIT signalScopeRenderingFinished(uint(timer.elapsed()), accelerationFactor);
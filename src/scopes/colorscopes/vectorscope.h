@@ -36,7 +36,7 @@ protected:
     ///// Implemented methods /////
     QRect scopeRect() override;
     QImage renderHUD(uint accelerationFactor) override;
-    QImage renderGfxScope(uint accelerationFactor, const QImage &) override;
+    QImage renderGfxScope(uint accelerationFactor, const ScopeFrame &frame) override;
     QImage renderBackground(uint accelerationFactor) override;
     bool isHUDDependingOnInput() const override;
     bool isScopeDependingOnInput() const override;
@@ -61,7 +61,10 @@ mRgb2YPbPr =                        r =
  */
 
 #include "vectorscopegenerator.h"
+#include "colorscopekernels.h"
+#include "scopeframe.h"
 #include <cmath>
+#include <vector>
 
 // The maximum distance from the center for any RGB color is 0.63, so
 // no need to make the circle bigger than required.
@@ -105,9 +108,17 @@ QPoint VectorscopeGenerator::mapToCircle(const QSize &targetSize, const QPointF
 }
 
 QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize, qreal scalingFactor, const QImage &image, const float &gain,
+                                                  const VectorscopeGenerator::PaintMode &paintMode, const VectorscopeGenerator::ColorSpace &colorSpace,
+                                                  bool drawAxis, uint accelFactor) const
+{
+    return calculateVectorscope(vectorscopeSize, scalingFactor, ScopeFrame(image), gain, paintMode, colorSpace, drawAxis, accelFactor);
+}
+
+QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize, qreal scalingFactor, const ScopeFrame &frame, const float &gain,
                                                   const VectorscopeGenerator::PaintMode &paintMode, const VectorscopeGenerator::ColorSpace &colorSpace, bool,
                                                   uint accelFactor) const
 {
+    const QImage &image = frame.image();
     if (vectorscopeSize.width() <= 0 || vectorscopeSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
         // Invalid size
         return QImage();
@@ -122,139 +133,207 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
     baseScope.setDevicePixelRatio(scalingFactor);
     baseScope.fill(qRgba(0, 0, 0, 0));
 
-    double dy, dr, dg, db, dmax;
-    double /*y,*/ u, v;
-    QPoint pt;
-    QRgb px;
-
     // Just an average for the number of image pixels per scope pixel.
     // NOTE: byteCount() has to be replaced by (img.bytesPerLine()*img.height()) for Qt 4.5 to compile, see:
     // https://doc.qt.io/qt-5/qimage.html#bytesPerLine
     double avgPxPerPx =
         double(image.depth()) / 8 * (image.bytesPerLine() * image.height()) / baseScope.size().width() / baseScope.size().height() / accelFactor;
 
-    const auto totalPixels = image.width() * image.height();
-    for (int i = 0; i < totalPixels; i += accelFactor) {
-        const QRgb pixel = image.pixel(i % image.width(), i / image.width());
-        const int r = qRed(pixel);
-        const int g = qGreen(pixel);
-        const int b = qBlue(pixel);
-
-        switch (colorSpace) {
-        case VectorscopeGenerator::ColorSpace_YUV:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = -0.0005781 * r - 0.001135 * g + 0.001713 * b;
-            v = 0.002411 * r - 0.002019 * g - 0.0003921 * b;
-            break;
-        case VectorscopeGenerator::ColorSpace_YPbPr:
-        default:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = -0.0006671 * r - 0.001299 * g + 0.0019608 * b;
-            v = 0.001961 * r - 0.001642 * g - 0.0003189 * b;
-            break;
-        }
-
-        pt = mapToCircle(vectorscopeSize, QPointF(SCALING * u, SCALING * v));
-
-        if (pt.x() >= baseScope.width() || pt.x() < 0 || pt.y() >= baseScope.height() || pt.y() < 0) {
-            // Point lies outside, don't plot it
+    // The Green, Green2 and Black modes brighten a scope pixel each time an image pixel falls on it, so only the number of hits matters.
+    // The other modes paint the color of the last image pixel falling on the scope pixel.
+    const bool countHits = paintMode == PaintMode_Green || paintMode == PaintMode_Green2 || paintMode == PaintMode_Black;
+
+    // Scope pixels hit by a band of rows
+    struct BandHits
+    {
+        std::vector<uint> counts;
+        std::vector<QRgb> colors;
+        std::vector<uchar> painted;
+    };
+    const size_t scopePixels = size_t(cw) * size_t(cw);
+    const int iw = image.width();
+    const auto totalPixels = qint64(iw) * image.height();
+    const int bands = ColorScopeKernels::bandCount(image.height(), totalPixels / accelFactor, qint64(scopePixels));
+    std::vector<BandHits> bandHits(size_t(bands));
+    ColorScopeKernels::runBands(image.height(), bands, [&](int band, int firstRow, int endRow) {
+        BandHits &hits = bandHits[size_t(band)];
+        if (countHits) {
+            hits.counts.assign(scopePixels, 0);
         } else {
-            // Draw the pixel using the chosen draw mode.
-            switch (paintMode) {
-            case PaintMode_YUV:
-                // see yuvColorWheel
-                dy = 128; // Default Y value. Lower = darker.
+            hits.colors.assign(scopePixels, 0);
+            hits.painted.assign(scopePixels, 0);
+        }
+        double dy, dr, dg, db, dmax;
+        double /*y,*/ u, v;
+        QPoint pt;
+        for (int row = firstRow; row < endRow; ++row) {
+            const auto *line = reinterpret_cast<const QRgb *>(image.constScanLine(row));
+            for (int x = ColorScopeKernels::firstSampledColumn(row, iw, accelFactor); x < iw; x += int(accelFactor)) {
+                const QRgb pixel = line[x];
+                const int r = qRed(pixel);
+                const int g = qGreen(pixel);
+                const int b = qBlue(pixel);
 
-                // Calculate the RGB values from YUV/YPbPr
                 switch (colorSpace) {
                 case VectorscopeGenerator::ColorSpace_YUV:
-                    dr = dy + 290.8 * v;
-                    dg = dy - 100.6 * u - 148 * v;
-                    db = dy + 517.2 * u;
+                    //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
+                    u = -0.0005781 * r - 0.001135 * g + 0.001713 * b;
+                    v = 0.002411 * r - 0.002019 * g - 0.0003921 * b;
                     break;
                 case VectorscopeGenerator::ColorSpace_YPbPr:
                 default:
-                    dr = dy + 357.5 * v;
-                    dg = dy - 87.75 * u - 182 * v;
-                    db = dy + 451.9 * u;
+                    //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
+                    u = -0.0006671 * r - 0.001299 * g + 0.0019608 * b;
+                    v = 0.001961 * r - 0.001642 * g - 0.0003189 * b;
                     break;
                 }
 
-                if (dr < 0) {
-                    dr = 0;
-                }
-                if (dg < 0) {
-                    dg = 0;
-                }
-                if (db < 0) {
-                    db = 0;
-                }
-                if (dr > 255) {
-                    dr = 255;
-                }
-                if (dg > 255) {
-                    dg = 255;
+                pt = mapToCircle(vectorscopeSize, QPointF(SCALING * u, SCALING * v));
+
+                if (pt.x() >= cw || pt.x() < 0 || pt.y() >= cw || pt.y() < 0) {
+                    // Point lies outside, don't plot it
+                    continue;
                 }
-                if (db > 255) {
-                    db = 255;
+                const size_t index = size_t(pt.y()) * size_t(cw) + size_t(pt.x());
+                if (countHits) {
+                    hits.counts[index]++;
+                    continue;
                 }
+                // Compute the color using the chosen draw mode.
+                QRgb color;
+                switch (paintMode) {
+                case PaintMode_YUV:
+                    // see yuvColorWheel
+                    dy = 128; // Default Y value. Lower = darker.
+
+                    // Calculate the RGB values from YUV/YPbPr
+                    switch (colorSpace) {
+                    case VectorscopeGenerator::ColorSpace_YUV:
+                        dr = dy + 290.8 * v;
+                        dg = dy - 100.6 * u - 148 * v;
+                        db = dy + 517.2 * u;
+                        break;
+                    case VectorscopeGenerator::ColorSpace_YPbPr:
+                    default:
+                        dr = dy + 357.5 * v;
+                        dg = dy - 87.75 * u - 182 * v;
+                        db = dy + 451.9 * u;
+                        break;
+                    }
+
+                    if (dr < 0) {
+                        dr = 0;
+                    }
+                    if (dg < 0) {
+                        dg = 0;
+                    }
+                    if (db < 0) {
+                        db = 0;
+                    }
+                    if (dr > 255) {
+                        dr = 255;
+                    }
+                    if (dg > 255) {
+                        dg = 255;
+                    }
+                    if (db > 255) {
+                        db = 255;
+                    }
+
+                    color = qRgba(int(dr), int(dg), int(db), 255);
+                    break;
 
-                baseScope.setPixel(pt, qRgba(int(dr), int(dg), int(db), 255));
-                break;
-
-            case PaintMode_Chroma:
-                dy = 200; // Default Y value. Lower = darker.
-
-                // Calculate the RGB values from YUV/YPbPr
-                switch (colorSpace) {
-                case VectorscopeGenerator::ColorSpace_YUV:
-                    dr = dy + 290.8 * v;
-                    dg = dy - 100.6 * u - 148 * v;
-                    db = dy + 517.2 * u;
+                case PaintMode_Chroma:
+                    dy = 200; // Default Y value. Lower = darker.
+
+                    // Calculate the RGB values from YUV/YPbPr
+                    switch (colorSpace) {
+                    case VectorscopeGenerator::ColorSpace_YUV:
+                        dr = dy + 290.8 * v;
+                        dg = dy - 100.6 * u - 148 * v;
+                        db = dy + 517.2 * u;
+                        break;
+                    case VectorscopeGenerator::ColorSpace_YPbPr:
+                    default:
+                        dr = dy + 357.5 * v;
+                        dg = dy - 87.75 * u - 182 * v;
+                        db = dy + 451.9 * u;
+                        break;
+                    }
+
+                    // Scale the RGB values back to max 255
+                    dmax = dr;
+                    if (dg > dmax) {
+                        dmax = dg;
+                    }
+                    if (db > dmax) {
+                        dmax = db;
+                    }
+                    dmax = 255 / dmax;
+
+                    dr *= dmax;
+                    dg *= dmax;
+                    db *= dmax;
+
+                    color = qRgba(int(dr), int(dg), int(db), 255);
                     break;
-                case VectorscopeGenerator::ColorSpace_YPbPr:
+                case PaintMode_Original:
                 default:
-                    dr = dy + 357.5 * v;
-                    dg = dy - 87.75 * u - 182 * v;
-                    db = dy + 451.9 * u;
+                    color = pixel;
                     break;
                 }
+                hits.colors[index] = color;
+                hits.painted[index] = 1;
+            }
+        }
+    });
+
+    // Merge the bands in image order, so that the last painted pixel wins as when scanning the image in one pass
+    BandHits &scopeHits = bandHits.front();
+    for (size_t band = 1; band < bandHits.size(); ++band) {
+        const BandHits &hits = bandHits[band];
+        for (size_t i = 0; i < scopePixels; ++i) {
+            if (countHits) {
+                scopeHits.counts[i] += hits.counts[i];
+            } else if (hits.painted[i] != 0) {
+                scopeHits.colors[i] = hits.colors[i];
+                scopeHits.painted[i] = 1;
+            }
+        }
+    }
 
-                // Scale the RGB values back to max 255
-                dmax = dr;
-                if (dg > dmax) {
-                    dmax = dg;
-                }
-                if (db > dmax) {
-                    dmax = db;
+    // Brighten a pixel once per hit
+    const auto brighten = [paintMode, avgPxPerPx](QRgb px) {
+        switch (paintMode) {
+        case PaintMode_Green:
+            return qRgba(qRed(px) + int((255 - qRed(px)) / (3 * avgPxPerPx)), qGreen(px) + int(20 * (255 - qGreen(px)) / (avgPxPerPx)),
+                         qBlue(px) + int((255 - qBlue(px)) / (avgPxPerPx)), qAlpha(px) + int((255 - qAlpha(px)) / (avgPxPerPx)));
+        case PaintMode_Green2:
+            return qRgba(qRed(px) + int(ceil((255 - qRed(px)) / (4 * avgPxPerPx))), 255, qBlue(px) + int(ceil((255 - qBlue(px)) / (avgPxPerPx))),
+                         qAlpha(px) + int(ceil((255 - qAlpha(px)) / (avgPxPerPx))));
+        case PaintMode_Black:
+        default:
+            return qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20);
+        }
+    };
+
+    for (int j = 0; j < cw; ++j) {
+        auto *line = reinterpret_cast<QRgb *>(baseScope.scanLine(j));
+        for (int i = 0; i < cw; ++i) {
+            const size_t index = size_t(j) * size_t(cw) + size_t(i);
+            if (countHits) {
+                QRgb px = line[i];
+                for (uint hit = 0; hit < scopeHits.counts[index]; ++hit) {
+                    const QRgb next = brighten(px);
+                    if (next == px) {
+                        // Saturated, further hits don't change the pixel
+                        break;
+                    }
+                    px = next;
                 }
-                dmax = 255 / dmax;
-
-                dr *= dmax;
-                dg *= dmax;
-                db *= dmax;
-
-                baseScope.setPixel(pt, qRgba(int(dr), int(dg), int(db), 255));
-                break;
-            case PaintMode_Original:
-                baseScope.setPixel(pt, pixel);
-                break;
-            case PaintMode_Green:
-                px = baseScope.pixel(pt);
-                baseScope.setPixel(pt, qRgba(qRed(px) + int((255 - qRed(px)) / (3 * avgPxPerPx)), qGreen(px) + int(20 * (255 - qGreen(px)) / (avgPxPerPx)),
-                                             qBlue(px) + int((255 - qBlue(px)) / (avgPxPerPx)), qAlpha(px) + int((255 - qAlpha(px)) / (avgPxPerPx))));
-                break;
-            case PaintMode_Green2:
-                px = baseScope.pixel(pt);
-                baseScope.setPixel(pt,
-                                   qRgba(qRed(px) + int(ceil((255 - qRed(px)) / (4 * avgPxPerPx))), 255,
-                                         qBlue(px) + int(ceil((255 - qBlue(px)) / (avgPxPerPx))), qAlpha(px) + int(ceil((255 - qAlpha(px)) / (avgPxPerPx)))));
-                break;
-            case PaintMode_Black:
-            default:
-                px = baseScope.pixel(pt);
-                baseScope.setPixel(pt, qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20));
-                break;
+                line[i] = px;
+            } else if (scopeHits.painted[index] != 0) {
+                line[i] = scopeHits.colors[index];
             }
         }
     }
@@ -169,6 +169,12 @@ QString Waveform::widgetName() const
 {
     return QStringLiteral("Waveform");
 }
+
+int Waveform::requiredPlanes() const
+{
+    return ScopeFrame::lumaPlane(m_aRec601->isChecked() ? ITURec::Rec_601 : ITURec::Rec_709);
+}
+
 bool Waveform::isHUDDependingOnInput() const
 {
     return false;
@@ -289,7 +295,7 @@ QImage Waveform::renderHUD(uint)
     return hud;
 }
 
-QImage Waveform::renderGfxScope(uint accelFactor, const QImage &qimage)
+QImage Waveform::renderGfxScope(uint accelFactor, const ScopeFrame &frame)
 {
     QElapsedTimer timer;
     timer.start();
@@ -297,7 +303,7 @@ QImage Waveform::renderGfxScope(uint accelFactor, const QImage &qimage)
     ITURec rec = m_aRec601->isChecked() ? ITURec::Rec_601 : ITURec::Rec_709;
     qreal scalingFactor = devicePixelRatioF();
     QImage wave = m_waveformGenerator->calculateWaveform((scopeRect().size() - QSize(m_textWidth + 2 * offset, 0) - QSize(0, m_paddingBottom)), scalingFactor,
-                                                         qimage, WaveformGenerator::PaintMode(m_iPaintMode), true, rec, accelFactor);
+                                                         frame, WaveformGenerator::PaintMode(m_iPaintMode), true, rec, accelFactor);
 
     Q_EMIT signalScopeRenderingFinished(uint(timer.elapsed()), 1);
     return wave;
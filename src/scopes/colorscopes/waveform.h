@@ -28,6 +28,7 @@ public:
     ~Waveform() override;
 
     QString widgetName() const override;
+    int requiredPlanes() const override;
 
 protected:
     void readConfig() override;
@@ -62,7 +63,7 @@ private:
     /// Implemented methods ///
     QRect scopeRect() override;
     QImage renderHUD(uint) override;
-    QImage renderGfxScope(uint, const QImage &) override;
+    QImage renderGfxScope(uint, const ScopeFrame &frame) override;
     QImage renderBackground(uint) override;
     bool isHUDDependingOnInput() const override;
     bool isScopeDependingOnInput() const override;
@@ -6,6 +6,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "waveformgenerator.h"
+#include "colorscopekernels.h"
+#include "scopeframe.h"
 
 #include <cmath>
 
@@ -28,6 +30,13 @@ WaveformGenerator::~WaveformGenerator() = default;
 QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, qreal scalingFactor, const QImage &image, const WaveformGenerator::PaintMode paintMode,
                                             bool drawAxis, ITURec rec, uint accelFactor)
 {
+    return calculateWaveform(waveformSize, scalingFactor, ScopeFrame(image), paintMode, drawAxis, rec, accelFactor);
+}
+
+QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, qreal scalingFactor, const ScopeFrame &frame,
+                                            const WaveformGenerator::PaintMode paintMode, bool drawAxis, ITURec rec, uint accelFactor)
+{
+    const QImage &image = frame.image();
     Q_ASSERT(accelFactor >= 1);
 
     // QTime time;
@@ -59,8 +68,6 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, qreal sca
     const uint scopeWLogicalPixels = waveformSize.width() - 2 * distBorder;
     const uint scopeHLogicalPixels = waveformSize.height() - 2 * distBorder;
 
-    std::vector<std::vector<uint>> waveValues(size_t(scopeW), std::vector<uint>(size_t(scopeH), 0));
-
     // Number of input pixels that will fall on one scope pixel.
     // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
     const float pixelDepth = float(totalPixels / accelFactor) / (scopeW * scopeH);
@@ -71,24 +78,35 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, qreal sca
     const float hPrediv = (scopeH - 1) / 255.f;
     const float wPrediv = (scopeW - 1) / float(iw - 1);
 
-    for (int i = 0; i < totalPixels; i += accelFactor) {
-        const int x = i % image.width();
-        const QRgb pixel = image.pixel(x, i / image.width());
-
-        float dY, dx, dy;
+    // Scope column of each image column
+    std::vector<uint> columnBins(iw);
+    for (uint x = 0; x < iw; ++x) {
+        columnBins[x] = uint(x * wPrediv);
+    }
 
-        if (rec == ITURec::Rec_601) {
-            // CIE 601 Luminance
-            dY = REC_601_R * qRed(pixel) + REC_601_G * qGreen(pixel) + REC_601_B * qBlue(pixel);
-        } else {
-            // CIE 709 Luminance
-            dY = REC_709_R * qRed(pixel) + REC_709_G * qGreen(pixel) + REC_709_B * qBlue(pixel);
+    // Bins are stored by luma row, then scope column, so that painting walks them linearly
+    const size_t binCount = size_t(scopeW) * scopeH;
+    const float *luma = frame.luma(rec);
+    const int bands = ColorScopeKernels::bandCount(image.height(), totalPixels / accelFactor, qint64(binCount));
+    std::vector<std::vector<uint>> bandValues(size_t(bands));
+    ColorScopeKernels::runBands(image.height(), bands, [&](int band, int firstRow, int endRow) {
+        std::vector<uint> &values = bandValues[size_t(band)];
+        values.assign(binCount, 0);
+        for (int y = firstRow; y < endRow; ++y) {
+            const float *line = luma + size_t(y) * iw;
+            // Luma is on [0,255].
+            for (uint x = uint(ColorScopeKernels::firstSampledColumn(y, int(iw), accelFactor)); x < iw; x += accelFactor) {
+                const float dy = line[x] * hPrediv;
+                values[size_t(dy) * scopeW + columnBins[x]]++;
+            }
+        }
+    });
+    std::vector<uint> &waveValues = bandValues.front();
+    for (size_t band = 1; band < bandValues.size(); ++band) {
+        const std::vector<uint> &values = bandValues[band];
+        for (size_t i = 0; i < binCount; ++i) {
+            waveValues[i] += values[i];
         }
-        // dY is on [0,255] now.
-
-        dy = dY * hPrediv;
-        dx = x * wPrediv;
-        waveValues[size_t(dx)][size_t(dy)]++;
     }
 
     // Fill background of the parade with "dark2" color from AbstractScopeWidget instead of themes base color as the different paint modes are optimized
@@ -106,10 +124,12 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, qreal sca
 
     switch (paintMode) {
     case PaintMode_Green:
-        for (int i = 0; i < int(scopeW); ++i) {
-            for (int j = 0; j < int(scopeH); ++j) {
+        for (int j = 0; j < int(scopeH); ++j) {
+            const uint *values = waveValues.data() + size_t(j) * scopeW;
+            auto *line = reinterpret_cast<QRgb *>(wave.scanLine(int(scopeH + distBorder) - j - 1)) + distBorder;
+            for (int i = 0; i < int(scopeW); ++i) {
                 // Logarithmic scale. Needs fine tuning by hand, but looks great.
-                float value = gain * float(waveValues[size_t(i)][size_t(j)]);
+                float value = gain * float(values[i]);
                 float logValue = value > 0.0f ? logf(value) : 0.0f;
 
                 float rValue = 0.1f * value;
@@ -122,34 +142,35 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, qreal sca
 
                 int alpha = CHOP255(64 * logValue);
                 int inv_alpha = 255 - alpha;
-                wave.setPixel(i + distBorder, int(scopeH + distBorder) - j - 1,
-                              qRgba(CHOP255((qRed(darkBackgroundRgb) * inv_alpha + 52 * logR * alpha) / 255),
-                                    CHOP255((qGreen(darkBackgroundRgb) * inv_alpha + 52 * logG * alpha) / 255),
-                                    CHOP255((qBlue(darkBackgroundRgb) * inv_alpha + 52 * logB * alpha) / 255), 255));
+                line[i] = qRgba(CHOP255((qRed(darkBackgroundRgb) * inv_alpha + 52 * logR * alpha) / 255),
+                                CHOP255((qGreen(darkBackgroundRgb) * inv_alpha + 52 * logG * alpha) / 255),
+                                CHOP255((qBlue(darkBackgroundRgb) * inv_alpha + 52 * logB * alpha) / 255), 255);
             }
         }
         break;
     case PaintMode_Yellow:
-        for (int i = 0; i < int(scopeW); ++i) {
-            for (int j = 0; j < int(scopeH); ++j) {
-                int alpha = CHOP255(gain * float(waveValues[size_t(i)][size_t(j)]));
+        for (int j = 0; j < int(scopeH); ++j) {
+            const uint *values = waveValues.data() + size_t(j) * scopeW;
+            auto *line = reinterpret_cast<QRgb *>(wave.scanLine(int(scopeH + distBorder) - j - 1)) + distBorder;
+            for (int i = 0; i < int(scopeW); ++i) {
+                int alpha = CHOP255(gain * float(values[i]));
                 int inv_alpha = 255 - alpha;
-                wave.setPixel(i + distBorder, int(scopeH + distBorder) - j - 1,
-                              qRgba(CHOP255((qRed(darkBackgroundRgb) * inv_alpha + 255 * alpha) / 255),
-                                    CHOP255((qGreen(darkBackgroundRgb) * inv_alpha + 242 * alpha) / 255),
-                                    CHOP255((qBlue(darkBackgroundRgb) * inv_alpha + 0 * alpha) / 255), 255));
+                line[i] = qRgba(CHOP255((qRed(darkBackgroundRgb) * inv_alpha + 255 * alpha) / 255),
+                                CHOP255((qGreen(darkBackgroundRgb) * inv_alpha + 242 * alpha) / 255),
+                                CHOP255((qBlue(darkBackgroundRgb) * inv_alpha + 0 * alpha) / 255), 255);
             }
         }
         break;
     default: // White mode
-        for (int i = 0; i < int(scopeW); ++i) {
-            for (int j = 0; j < int(scopeH); ++j) {
-                int alpha = CHOP255(2.f * gain * float(waveValues[size_t(i)][size_t(j)]));
+        for (int j = 0; j < int(scopeH); ++j) {
+            const uint *values = waveValues.data() + size_t(j) * scopeW;
+            auto *line = reinterpret_cast<QRgb *>(wave.scanLine(int(scopeH + distBorder) - j - 1)) + distBorder;
+            for (int i = 0; i < int(scopeW); ++i) {
+                int alpha = CHOP255(2.f * gain * float(values[i]));
                 int inv_alpha = 255 - alpha;
-                wave.setPixel(i + distBorder, int(scopeH + distBorder) - j - 1,
-                              qRgba(CHOP255((qRed(darkBackgroundRgb) * inv_alpha + 255 * alpha) / 255),
-                                    CHOP255((qGreen(darkBackgroundRgb) * inv_alpha + 255 * alpha) / 255),
-                                    CHOP255((qBlue(darkBackgroundRgb) * inv_alpha + 255 * alpha) / 255), 255));
+                line[i] = qRgba(CHOP255((qRed(darkBackgroundRgb) * inv_alpha + 255 * alpha) / 255),
+                                CHOP255((qGreen(darkBackgroundRgb) * inv_alpha + 255 * alpha) / 255),
+                                CHOP255((qBlue(darkBackgroundRgb) * inv_alpha + 255 * alpha) / 255), 255);
             }
         }
         break;
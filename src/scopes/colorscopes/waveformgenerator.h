@@ -13,6 +13,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 class QImage;
 class QSize;
+class ScopeFrame;
 
 class WaveformGenerator : public QObject
 {
@@ -26,5 +27,8 @@ public:
 
     QImage calculateWaveform(const QSize &waveformSize, qreal scalingFactor, const QImage &image, const WaveformGenerator::PaintMode paintMode, bool drawAxis,
                              const ITURec rec, uint accelFactor = 1);
+    /** @brief Calculates the waveform of a frame prepared for the scopes, using its shared luma plane */
+    QImage calculateWaveform(const QSize &waveformSize, qreal scalingFactor, const ScopeFrame &frame, const WaveformGenerator::PaintMode paintMode,
+                             bool drawAxis, const ITURec rec, uint accelFactor = 1);
     static const uchar distBorder;
 };
@@ -12,6 +12,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "colorscopes/waveform.h"
 #include "core.h"
 #include "definitions.h"
+#include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
 #include "monitor/monitormanager.h"
@@ -19,12 +20,20 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "klocalizedstring.h"
 #include <QDockWidget>
 #include <QSignalMapper>
+#include <QtConcurrent/QtConcurrentRun>
 
 //#define DEBUG_SM
 #ifdef DEBUG_SM
 #include <QDebug>
 #endif
 
+namespace {
+// Larger frames are decimated before being analysed, the scopes are not precise enough to make use of more pixels
+constexpr int maxAnalysisPixels = 1920 * 1080;
+// Number of analysed frames between two logs of the render times
+constexpr int renderTimesLogInterval = 250;
+} // namespace
+
 ScopeManager::ScopeManager(QObject *parent)
     : QObject(parent)
 
@@ -32,6 +41,7 @@ ScopeManager::ScopeManager(QObject *parent)
     connect(pCore->monitorManager(), &MonitorManager::checkColorScopes, this, &ScopeManager::slotUpdateActiveRenderer);
     connect(pCore->monitorManager(), &MonitorManager::clearScopes, this, &ScopeManager::slotClearColorScopes);
     connect(pCore->monitorManager(), &MonitorManager::checkScopes, this, &ScopeManager::slotCheckActiveScopes);
+    connect(&m_frameAnalysis, &QFutureWatcher<std::shared_ptr<const ScopeFrame>>::finished, this, &ScopeManager::slotFrameAnalysed);
 
     slotUpdateActiveRenderer();
 
@@ -90,6 +100,11 @@ bool ScopeManager::addScope(AbstractGfxScopeWidget *colorScope, KDDockWidgets::Q
 
         connect(colorScope, &AbstractGfxScopeWidget::signalFrameRequest, this, &ScopeManager::slotRequestFrame);
         connect(colorScope, &AbstractScopeWidget::signalScopeRenderingFinished, this, &ScopeManager::slotScopeReady);
+        connect(colorScope, &AbstractScopeWidget::signalScopeRenderingFinished, this, [this, colorScope](uint mseconds, uint) {
+            RenderTime &time = m_scopeTimes[colorScope->widgetName()];
+            time.total += mseconds;
+            time.count++;
+        });
         if (colorScopeWidget != nullptr) {
             connect(colorScopeWidget, &KDDockWidgets::QtWidgets::DockWidget::isOpenChanged, this, &ScopeManager::slotCheckActiveScopes);
             connect(colorScopeWidget, &KDDockWidgets::QtWidgets::DockWidget::isOpenChanged, this,
@@ -121,12 +136,67 @@ void ScopeManager::slotDistributeFrame(const QImage &image)
 #ifdef DEBUG_SM
     qCDebug(KDENLIVE_LOG) << "ScopeManager: Starting to distribute frame.";
 #endif
+    if (m_analysingFrame) {
+        // Only keep the last frame, the scopes would skip the others anyway
+        m_pendingFrame = image;
+        return;
+    }
+    analyseFrame(image);
+    // checkActiveColourScopes();
+}
+
+void ScopeManager::analyseFrame(const QImage &image)
+{
+    int planes = 0;
     for (auto &m_colorScope : m_colorScopes) {
         if (!m_colorScope.scope->visibleRegion().isEmpty()) {
-            m_colorScope.scope->slotRenderZoneUpdated(image);
+            planes |= m_colorScope.scope->requiredPlanes();
         }
     }
-    // checkActiveColourScopes();
+    m_analysingFrame = true;
+    m_frameAnalysis.setFuture(QtConcurrent::run([image, planes]() {
+        auto frame = std::make_shared<ScopeFrame>(image, maxAnalysisPixels);
+        frame->computePlanes(planes);
+        return std::shared_ptr<const ScopeFrame>(frame);
+    }));
+}
+
+void ScopeManager::slotFrameAnalysed()
+{
+    m_analysingFrame = false;
+    const std::shared_ptr<const ScopeFrame> frame = m_frameAnalysis.result();
+    m_analysisTime.total += frame->analysisTime();
+    m_analysisTime.count++;
+    for (auto &m_colorScope : m_colorScopes) {
+        if (!m_colorScope.scope->visibleRegion().isEmpty()) {
+            m_colorScope.scope->slotRenderZoneUpdated(frame);
+        }
+    }
+    if (m_analysisTime.count % renderTimesLogInterval == 0) {
+        const QMap<QString, double> times = averageRenderTimes();
+        for (auto it = times.cbegin(); it != times.cend(); ++it) {
+            qCDebug(KDENLIVE_LOG) << "Scope average render time" << (it.key().isEmpty() ? QStringLiteral("(shared analysis)") : it.key()) << it.value() << "ms";
+        }
+    }
+    if (!m_pendingFrame.isNull()) {
+        const QImage image = m_pendingFrame;
+        m_pendingFrame = QImage();
+        analyseFrame(image);
+    }
+}
+
+QMap<QString, double> ScopeManager::averageRenderTimes() const
+{
+    QMap<QString, double> times;
+    if (m_analysisTime.count > 0) {
+        times.insert(QString(), m_analysisTime.total / 1000. / m_analysisTime.count);
+    }
+    for (auto it = m_scopeTimes.cbegin(); it != m_scopeTimes.cend(); ++it) {
+        if (it.value().count > 0) {
+            times.insert(it.key(), double(it.value().total) / it.value().count);
+        }
+    }
+    return times;
 }
 
 void ScopeManager::slotScopeReady()
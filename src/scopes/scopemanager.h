@@ -10,8 +10,11 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "audioscopes/abstractaudioscopewidget.h"
 #include "colorscopes/abstractgfxscopewidget.h"
 
+#include <QFutureWatcher>
 #include <QList>
+#include <QMap>
 #include <kddockwidgets/DockWidget.h>
+#include <memory>
 
 class AbstractMonitor;
 class QSignalMapper;
@@ -23,6 +26,10 @@ class QSignalMapper;
     all scopes that have been registered via ScopeManager::addScope(AbstractAudioScopeWidget, QDockWidget)
     or ScopeManager::addScope(AbstractGfxScopeWidget, QDockWidget). It checks whether the renderer really
     needs to send data (it does not, for example, if no scopes are visible).
+
+    Frames are analysed once on a worker thread (see ScopeFrame) before being sent to all
+    the visible color scopes, so that the frame conversion and the planes shared by several
+    scopes are only computed once per frame.
   */
 class ScopeManager : public QObject
 {
@@ -66,7 +73,16 @@ public:
 
     const QStringList getScopesNames() const;
 
+    /** @brief Returns the average time in milliseconds spent in each color scope rendering, keyed by scope name.
+        The time spent in the shared frame analysis is stored with an empty key. */
+    QMap<QString, double> averageRenderTimes() const;
+
 private:
+    struct RenderTime
+    {
+        qint64 total{0};
+        int count{0};
+    };
     QList<AudioScopeData> m_audioScopes;
     QList<GfxScopeData> m_colorScopes;
 
@@ -76,6 +92,18 @@ private:
     /** @brief a list of all scopes dock object names */
     QStringList m_scopeNames;
 
+    /** @brief The analysis of the last received frame */
+    QFutureWatcher<std::shared_ptr<const ScopeFrame>> m_frameAnalysis;
+    bool m_analysingFrame{false};
+    /** @brief Frame received while the previous one was still being analysed */
+    QImage m_pendingFrame;
+    /** @brief Time spent in the shared frame analysis (microseconds) and in each scope rendering (milliseconds), keyed by scope name */
+    RenderTime m_analysisTime;
+    QMap<QString, RenderTime> m_scopeTimes;
+
+    /** @brief Start the shared analysis of a frame for the visible color scopes */
+    void analyseFrame(const QImage &image);
+
     /**
       Checks whether there is any scope accepting audio data, or if all of them are hidden
       or if auto refresh is disabled.
@@ -129,6 +157,8 @@ private Q_SLOTS:
     void checkActiveColourScopes();
 
     void slotDistributeFrame(const QImage &image);
+    /** @brief The shared analysis of a frame is finished, send it to the visible color scopes */
+    void slotFrameAnalysed();
     void slotDistributeAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples);
     /**
       Allows a scope to explicitly request a new frame, even if the scope's autoRefresh is disabled.
@@ -1260,6 +1260,14 @@ void ClipModel::setInOut(int in, int out)
 {
     MoveableItem::setInOut(in, out);
     m_clipMarkerModel->updateSnapModelInOut({in, out, qMax(0, m_mixDuration - m_mixCutPos)});
+    if (m_currentTrackId > -1) {
+        // Keep the track range index in sync with our new duration
+        if (auto ptr = m_parent.lock()) {
+            if (ptr->isTrack(m_currentTrackId)) {
+                ptr->getTrackById(m_currentTrackId)->updateClipIndex(m_id);
+            }
+        }
+    }
 }
 
 void ClipModel::setCurrentTrackId(int tid, bool finalMove)
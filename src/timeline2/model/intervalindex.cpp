@@ -0,0 +1,193 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "intervalindex.hpp"
+
+#include <algorithm>
+#include <climits>
+
+struct IntervalIndex::Node
+{
+    Node(int itemId, int itemStart, int itemEnd, unsigned itemPriority)
+        : id(itemId)
+        , start(itemStart)
+        , end(itemEnd)
+        , maxEnd(itemEnd)
+        , priority(itemPriority)
+    {
+    }
+    int id;
+    int start;
+    /** Last frame covered by the item */
+    int end;
+    /** Largest end of the subtree rooted at this node */
+    int maxEnd;
+    unsigned priority;
+    std::unique_ptr<Node> left;
+    std::unique_ptr<Node> right;
+};
+
+IntervalIndex::IntervalIndex() = default;
+
+IntervalIndex::~IntervalIndex() = default;
+
+void IntervalIndex::updateNode(Node *node)
+{
+    node->maxEnd = node->end;
+    if (node->left) {
+        node->maxEnd = std::max(node->maxEnd, node->left->maxEnd);
+    }
+    if (node->right) {
+        node->maxEnd = std::max(node->maxEnd, node->right->maxEnd);
+    }
+}
+
+void IntervalIndex::split(std::unique_ptr<Node> root, const Key &key, std::unique_ptr<Node> &left, std::unique_ptr<Node> &right)
+{
+    if (!root) {
+        left.reset();
+        right.reset();
+        return;
+    }
+    std::unique_ptr<Node> l;
+    std::unique_ptr<Node> r;
+    if (Key(root->start, root->id) < key) {
+        split(std::move(root->right), key, l, r);
+        root->right = std::move(l);
+        updateNode(root.get());
+        left = std::move(root);
+        right = std::move(r);
+    } else {
+        split(std::move(root->left), key, l, r);
+        root->left = std::move(r);
+        updateNode(root.get());
+        left = std::move(l);
+        right = std::move(root);
+    }
+}
+
+std::unique_ptr<IntervalIndex::Node> IntervalIndex::merge(std::unique_ptr<Node> left, std::unique_ptr<Node> right)
+{
+    if (!left) {
+        return right;
+    }
+    if (!right) {
+        return left;
+    }
+    if (left->priority > right->priority) {
+        left->right = merge(std::move(left->right), std::move(right));
+        updateNode(left.get());
+        return left;
+    }
+    right->left = merge(std::move(left), std::move(right->left));
+    updateNode(right.get());
+    return right;
+}
+
+void IntervalIndex::erase(std::unique_ptr<Node> &root, const Key &key)
+{
+    if (!root) {
+        return;
+    }
+    const Key current(root->start, root->id);
+    if (current == key) {
+        root = merge(std::move(root->left), std::move(root->right));
+        return;
+    }
+    if (key < current) {
+        erase(root->left, key);
+    } else {
+        erase(root->right, key);
+    }
+    updateNode(root.get());
+}
+
+void IntervalIndex::insert(int id, int position, int playtime)
+{
+    auto existing = m_items.find(id);
+    if (existing != m_items.end()) {
+        if (existing->second.first == position && existing->second.second == playtime) {
+            return;
+        }
+        erase(m_root, Key(existing->second.first, id));
+    }
+    m_items[id] = {position, playtime};
+    // An item always covers at least its start frame, this matches the behavior of the former linear scans
+    std::unique_ptr<Node> node(new Node(id, position, std::max(position, position + playtime - 1), unsigned(m_random())));
+    std::unique_ptr<Node> left;
+    std::unique_ptr<Node> right;
+    split(std::move(m_root), Key(position, id), left, right);
+    m_root = merge(merge(std::move(left), std::move(node)), std::move(right));
+}
+
+void IntervalIndex::remove(int id)
+{
+    auto existing = m_items.find(id);
+    if (existing == m_items.end()) {
+        return;
+    }
+    erase(m_root, Key(existing->second.first, id));
+    m_items.erase(existing);
+}
+
+void IntervalIndex::clear()
+{
+    m_root.reset();
+    m_items.clear();
+}
+
+bool IntervalIndex::contains(int id) const
+{
+    return m_items.count(id) > 0;
+}
+
+int IntervalIndex::count() const
+{
+    return int(m_items.size());
+}
+
+void IntervalIndex::collect(const Node *node, int position, int end, std::unordered_set<int> &result)
+{
+    if (node == nullptr || node->maxEnd < position) {
+        // Nothing in this subtree reaches the requested range
+        return;
+    }
+    collect(node->left.get(), position, end, result);
+    if (end > -1 && node->start >= end) {
+        // This node and its right subtree start after the range
+        return;
+    }
+    if (node->end >= position) {
+        result.insert(node->id);
+    }
+    collect(node->right.get(), position, end, result);
+}
+
+std::unordered_set<int> IntervalIndex::itemsInRange(int position, int end) const
+{
+    std::unordered_set<int> result;
+    collect(m_root.get(), position, end, result);
+    return result;
+}
+
+int IntervalIndex::itemStartingAt(int position) const
+{
+    const Key key(position, INT_MIN);
+    const Node *node = m_root.get();
+    const Node *candidate = nullptr;
+    // Find the first item whose start is >= position
+    while (node != nullptr) {
+        if (Key(node->start, node->id) < key) {
+            node = node->right.get();
+        } else {
+            candidate = node;
+            node = node->left.get();
+        }
+    }
+    if (candidate != nullptr && candidate->start == position) {
+        return candidate->id;
+    }
+    return -1;
+}
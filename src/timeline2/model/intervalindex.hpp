@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+/** @class IntervalIndex
+    @brief This class stores the frame range covered by timeline items (identified by their id) in a treap ordered by start position,
+    where each node is augmented with the maximum end position of its subtree.
+    This allows to retrieve all the items intersecting a range in O(log n + k) instead of walking all the items of a track.
+    The index does not know anything about the items, so its owner is responsible for keeping it in sync on insert / move / resize / delete.
+ */
+class IntervalIndex
+{
+public:
+    IntervalIndex();
+    ~IntervalIndex();
+
+    /** @brief Inserts the item @p id covering the frames [position, position + playtime - 1]. If the item is already indexed, its range is updated */
+    void insert(int id, int position, int playtime);
+
+    /** @brief Removes the item @p id from the index. Does nothing if the item is not indexed */
+    void remove(int id);
+
+    /** @brief Removes all items */
+    void clear();
+
+    /** @brief Returns true if the item is indexed */
+    bool contains(int id) const;
+
+    /** @brief Returns the number of indexed items */
+    int count() const;
+
+    /** @brief Returns the ids of the items intersecting the range [position, end[.
+       @param end is the end of the range (excluded). If it is -1, the range extends up to the end of the track
+     */
+    std::unordered_set<int> itemsInRange(int position, int end = -1) const;
+
+    /** @brief Returns the id of an item starting exactly at position, or -1 if there is none */
+    int itemStartingAt(int position) const;
+
+private:
+    struct Node;
+    using Key = std::pair<int, int>;
+
+    static void updateNode(Node *node);
+    static void split(std::unique_ptr<Node> root, const Key &key, std::unique_ptr<Node> &left, std::unique_ptr<Node> &right);
+    static std::unique_ptr<Node> merge(std::unique_ptr<Node> left, std::unique_ptr<Node> right);
+    static void erase(std::unique_ptr<Node> &root, const Key &key);
+    static void collect(const Node *node, int position, int end, std::unordered_set<int> &result);
+
+    std::unique_ptr<Node> m_root;
+    /** Position and playtime of each indexed item, used to find its node when it is moved or removed */
+    std::unordered_map<int, std::pair<int, int>> m_items;
+    std::minstd_rand m_random;
+};
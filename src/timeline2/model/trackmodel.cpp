@@ -114,6 +114,7 @@ TrackModel::~TrackModel()
         field->unblock();
         m_sameCompositions.clear();
         m_allClips.clear();
+        m_clipIndex.clear();
         m_allCompositions.clear();
         m_track->remove_track(1);
         m_track->remove_track(0);
@@ -198,6 +199,7 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
             m_allClips[clip->getId()] = clip; // store clip
             // update clip position and track
             clip->setPosition(position);
+            m_clipIndex.insert(clipId, position, clip->getPlaytime());
             if (finalMove) {
                 clip->setSubPlaylistIndex(subPlaylist, m_id);
             }
@@ -381,6 +383,7 @@ void TrackModel::temporaryReplugClip(int cid)
         m_playlists[target_track].insert_at(clip_position, *clip, 1);
     }
     m_playlists[target_track].unlock();
+    updateClipIndex(cid);
 }
 
 void TrackModel::replugClip(int clipId)
@@ -411,6 +414,7 @@ void TrackModel::replugClip(int clipId)
     }
     m_playlists[target_track].consolidate_blanks();
     m_playlists[target_track].unlock();
+    updateClipIndex(clipId);
 }
 
 Fun TrackModel::requestClipDeletion_lambda(int clipId, bool updateView, bool finalMove, bool groupMove, bool finalDeletion)
@@ -450,6 +454,7 @@ Fun TrackModel::requestClipDeletion_lambda(int clipId, bool updateView, bool fin
             m_allClips[clipId]->setCurrentTrackId(-1);
             // m_allClips[clipId]->setSubPlaylistIndex(-1);
             m_allClips.erase(clipId);
+            m_clipIndex.remove(clipId);
             delete prod;
             m_playlists[target_track].unlock();
             field->unblock();
@@ -729,6 +734,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
             m_playlists[target_track].consolidate_blanks();
             m_playlists[target_track].unlock();
             if (err == 0) {
+                updateClipIndex(clipId);
                 update_snaps(m_allClips[clipId]->getPosition(), m_allClips[clipId]->getPosition() + out - in + 1);
                 if (right && finalMove && m_playlists[target_track].count() - 1 == target_clip_mutable) {
                     // deleted last clip in playlist
@@ -765,6 +771,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
                 }
                 int err = m_playlists[target_track].resize_clip(target_clip, in, out);
                 if (err == 0) {
+                    updateClipIndex(clipId);
                     update_snaps(m_allClips[clipId]->getPosition(), m_allClips[clipId]->getPosition() + out - in + 1);
                 }
                 m_playlists[target_track].consolidate_blanks();
@@ -822,6 +829,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
                     m_allClips[clipId]->setPosition(m_playlists[target_track].clip_start(target_clip_mutable));
                 }
                 if (err == 0) {
+                    updateClipIndex(clipId);
                     update_snaps(m_allClips[clipId]->getPosition(), m_allClips[clipId]->getPosition() + out - in + 1);
                 }
                 m_playlists[target_track].consolidate_blanks();
@@ -845,12 +853,7 @@ int TrackModel::getId() const
 int TrackModel::getClipByStartPosition(int position) const
 {
     READ_LOCK();
-    for (auto &clip : m_allClips) {
-        if (clip.second->getPosition() == position) {
-            return clip.second->getId();
-        }
-    }
-    return -1;
+    return m_clipIndex.itemStartingAt(position);
 }
 
 int TrackModel::getClipByPosition(int position, int playlist)
@@ -926,18 +929,18 @@ int TrackModel::getClipByRow(int row) const
 std::unordered_set<int> TrackModel::getClipsInRange(int position, int end)
 {
     READ_LOCK();
-    std::unordered_set<int> ids;
-    for (const auto &clp : m_allClips) {
-        int pos = clp.second->getPosition();
-        int length = clp.second->getPlaytime();
-        if (end > -1 && pos >= end) {
-            continue;
-        }
-        if (pos >= position || pos + length - 1 >= position) {
-            ids.insert(clp.first);
-        }
+    return m_clipIndex.itemsInRange(position, end);
+}
+
+void TrackModel::updateClipIndex(int clipId)
+{
+    QWriteLocker locker(&m_lock);
+    auto it = m_allClips.find(clipId);
+    if (it == m_allClips.end()) {
+        // Clip is not (yet) inserted in this track
+        return;
     }
-    return ids;
+    m_clipIndex.insert(clipId, it->second->getPosition(), it->second->getPlaytime());
 }
 
 int TrackModel::getRowfromClip(int clipId) const
@@ -951,17 +954,22 @@ std::unordered_set<int> TrackModel::getCompositionsInRange(int position, int end
 {
     READ_LOCK();
     // TODO: this function doesn't take into accounts the fact that there are two tracks
+    // Compositions on a track never overlap (see hasIntersectingComposition), so m_compoPos is also ordered by end position.
+    // Only the composition starting before position can reach into the range, all others start inside it.
     std::unordered_set<int> ids;
-    for (const auto &compo : m_allCompositions) {
-        int pos = compo.second->getPosition();
-        int length = compo.second->getPlaytime();
-        if (end > -1 && pos >= end) {
-            continue;
+    auto it = m_compoPos.lower_bound(position);
+    if (it != m_compoPos.begin()) {
+        auto previous = std::prev(it);
+        int length = m_allCompositions.at(previous->second)->getPlaytime();
+        if (previous->first + length - 1 >= position && (end == -1 || previous->first < end)) {
+            ids.insert(previous->second);
         }
-        if (pos >= position || pos + length - 1 >= position) {
-
-            ids.insert(compo.first);
+    }
+    for (; it != m_compoPos.end(); ++it) {
+        if (end > -1 && it->first >= end) {
+            break;
         }
+        ids.insert(it->second);
     }
     return ids;
 }
@@ -1021,6 +1029,19 @@ bool TrackModel::checkConsistency()
         clips.emplace_back(c.second->getPosition(), c.first);
     }
     std::sort(clips.begin(), clips.end());
+    if (m_clipIndex.count() != int(m_allClips.size())) {
+        qDebug() << "Error: range index has" << m_clipIndex.count() << "clips instead of" << m_allClips.size();
+        return false;
+    }
+    for (const auto &c : m_allClips) {
+        int pos = c.second->getPosition();
+        int end = pos + c.second->getPlaytime() - 1;
+        if (m_clipIndex.itemsInRange(pos, pos + 1).count(c.first) == 0 || m_clipIndex.itemsInRange(end, end + 1).count(c.first) == 0 ||
+            m_clipIndex.itemsInRange(end + 1, end + 2).count(c.first) > 0) {
+            qDebug() << "Error: range index is out of sync for clip" << c.first;
+            return false;
+        }
+    }
     int last_out = 0;
     for (size_t i = 0; i < clips.size(); ++i) {
         auto cur_clip = m_allClips[clips[i].second];
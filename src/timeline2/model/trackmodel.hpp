@@ -6,6 +6,7 @@
 #pragma once
 
 #include "definitions.h"
+#include "intervalindex.hpp"
 #include "undohelper.hpp"
 #include <QReadWriteLock>
 #include <QSharedPointer>
@@ -320,6 +321,8 @@ protected:
 
     /** @brief Returns the list of the ids of the clips that intersect the given range */
     std::unordered_set<int> getClipsInRange(int position, int end = -1);
+    /** @brief Updates the position and duration of a clip in the range index. Must be called each time a clip of this track is moved or resized */
+    void updateClipIndex(int clipId);
     /** @brief Returns the list of the ids of the compositions that intersect the given range */
     std::unordered_set<int> getCompositionsInRange(int position, int end);
 
@@ -365,6 +368,8 @@ private:
 
     /** This is important to keep an ordered structure to store the clips, since we use their ids order as row order*/
     std::map<int, std::shared_ptr<ClipModel>> m_allClips;
+    /** Frame ranges of the clips in m_allClips, used for fast range and collision queries */
+    IntervalIndex m_clipIndex;
     /** This is important to keep an ordered structure to store the compositions, since we use their ids order as row order*/
     std::map<int, std::shared_ptr<CompositionModel>> m_allCompositions;
 
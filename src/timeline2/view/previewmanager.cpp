@@ -18,10 +18,12 @@
 #include <KLocalizedString>
 #include <KMessageBox>
 #include <QCollator>
+#include <QThread>
 #include <QCryptographicHash>
 #include <QMutexLocker>
 #include <QSaveFile>
 #include <QStandardPaths>
+#include <kmemoryinfo.h>
 
 PreviewManager::PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *parent)
     : QObject(parent)
@@ -36,7 +38,6 @@ PreviewManager::PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *paren
 {
     m_previewGatherTimer.setSingleShot(true);
     m_previewGatherTimer.setInterval(200);
-    QObject::connect(&m_previewProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &PreviewManager::processEnded);
 
     if (KdenliveSettings::kdenliverendererpath().isEmpty() || !QFileInfo::exists(KdenliveSettings::kdenliverendererpath())) {
         KdenliveSettings::setKdenliverendererpath(QString());
@@ -47,8 +48,7 @@ PreviewManager::PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *paren
         }
     }
 
-    connect(this, &PreviewManager::abortPreview, &m_previewProcess, &QProcess::kill, Qt::DirectConnection);
-    connect(&m_previewProcess, &QProcess::readyReadStandardError, this, &PreviewManager::receivedStderr);
+    connect(this, &PreviewManager::abortPreview, this, &PreviewManager::killWorkers, Qt::DirectConnection);
 }
 
 PreviewManager::~PreviewManager()
@@ -522,7 +522,7 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
     }
     if (add) {
         Q_EMIT dirtyChunksChanged();
-        if (m_previewProcess.state() == QProcess::NotRunning && KdenliveSettings::autopreview()) {
+        if (!workersRunning() && KdenliveSettings::autopreview()) {
             m_previewTimer.start();
         }
     } else {
@@ -531,7 +531,7 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
             // Nothing to do, abort
             return;
         }
-        bool isRendering = m_previewProcess.state() != QProcess::NotRunning;
+        bool isRendering = workersRunning();
         Fun undo = [this, dirty = toRemove]() {
             for (int ix : std::as_const(dirty)) {
                 m_dirtyChunks << ix;
@@ -580,21 +580,69 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
 
 void PreviewManager::abortRendering()
 {
-    if (m_previewProcess.state() == QProcess::NotRunning) {
+    if (!workersRunning()) {
         return;
     }
     // Don't display error message on voluntary abort
     m_warnOnCrash = false;
+    m_chunkQueue.clear();
     Q_EMIT abortPreview();
-    m_previewProcess.waitForFinished();
-    if (m_previewProcess.state() != QProcess::NotRunning) {
-        m_previewProcess.kill();
-        m_previewProcess.waitForFinished();
+    // processEnded() may delete the workers while we wait
+    const QList<QProcess *> workers = m_previewWorkers;
+    for (QProcess *worker : workers) {
+        worker->waitForFinished();
+        if (worker->state() != QProcess::NotRunning) {
+            worker->kill();
+            worker->waitForFinished();
+        }
     }
     // Re-init time estimation
     Q_EMIT previewRender(-1, QString(), 1000);
 }
 
+bool PreviewManager::workersRunning() const
+{
+    for (const QProcess *worker : m_previewWorkers) {
+        if (worker->state() != QProcess::NotRunning) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PreviewManager::killWorkers()
+{
+    for (QProcess *worker : std::as_const(m_previewWorkers)) {
+        worker->kill();
+    }
+}
+
+int PreviewManager::previewWorkerCount()
+{
+    int workers = KdenliveSettings::previewworkers();
+    if (workers > 0) {
+        return workers;
+    }
+    // Each renderer already uses several threads for decoding and encoding
+    workers = qMax(1, QThread::idealThreadCount() / 4);
+    KMemoryInfo memInfo;
+    if (!memInfo.isNull()) {
+        // Each renderer loads the whole project, keep about 1GB of memory for each one
+        workers = qMin(workers, int(memInfo.availablePhysical() / 1024 / 1024 / 1024));
+    }
+    return qMax(1, workers);
+}
+
+void PreviewManager::feedWorker(QProcess *worker)
+{
+    if (m_chunkQueue.isEmpty()) {
+        // Nothing left to render, the worker will exit
+        worker->closeWriteChannel();
+        return;
+    }
+    worker->write(QByteArray::number(m_chunkQueue.takeFirst()) + '\n');
+}
+
 bool PreviewManager::hasDefinedRange() const
 {
     return (!m_renderedChunks.isEmpty() || !m_dirtyChunks.isEmpty());
@@ -629,15 +677,28 @@ void PreviewManager::startPreviewRender()
 
 void PreviewManager::receivedStderr()
 {
-    QStringList resultList = QString::fromLocal8Bit(m_previewProcess.readAllStandardError()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    auto *worker = qobject_cast<QProcess *>(sender());
+    if (worker == nullptr) {
+        return;
+    }
+    QStringList resultList = QString::fromLocal8Bit(worker->readAllStandardError()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
     for (auto &result : resultList) {
         if (result.startsWith(QLatin1String("START:"))) {
-            if (m_previewProcess.state() == QProcess::Running) {
+            if (worker->state() == QProcess::Running) {
                 workingPreview = result.section(QLatin1String("START:"), 1).simplified().toInt();
+                m_workerChunks.insert(worker, workingPreview);
                 Q_EMIT workingPreviewChanged();
             }
         } else if (result.startsWith(QLatin1String("DONE:"))) {
             int chunk = result.section(QLatin1String("DONE:"), 1).simplified().toInt();
+            m_workerChunks.remove(worker);
+            if (workingPreview == chunk) {
+                // Show another chunk in progress, if any
+                workingPreview = m_workerChunks.isEmpty() ? -1 : m_workerChunks.constBegin().value();
+                Q_EMIT workingPreviewChanged();
+            }
+            // Give the next chunk to the worker before processing the rendered one
+            feedWorker(worker);
             m_processedChunks++;
             QString fileName = QStringLiteral("%1.%2").arg(chunk).arg(m_extension);
             Q_EMIT previewRender(chunk, m_cacheDir.absoluteFilePath(fileName), 1000 * m_processedChunks / m_chunksToRender);
@@ -654,16 +715,24 @@ void PreviewManager::doPreviewRender(const QString &scene)
         return;
     }
     QMutexLocker lock(&m_dirtyMutex);
-    Q_ASSERT(m_previewProcess.state() == QProcess::NotRunning);
+    Q_ASSERT(!workersRunning());
     std::sort(m_dirtyChunks.begin(), m_dirtyChunks.end(), chunkSort);
-    const QStringList dirtyChunks = getCompressedList(m_dirtyChunks);
-    m_chunksToRender = m_dirtyChunks.count();
+    // Render the chunks closest to the playhead first
+    const int position = pCore->getMonitorPosition();
+    m_chunkQueue.clear();
+    for (const QVariant &chunk : std::as_const(m_dirtyChunks)) {
+        m_chunkQueue << chunk.toInt();
+    }
+    std::stable_sort(m_chunkQueue.begin(), m_chunkQueue.end(), [position](int c1, int c2) { return qAbs(c1 - position) < qAbs(c2 - position); });
+    m_chunksToRender = m_chunkQueue.count();
     m_processedChunks = 0;
+    m_workerFailed = false;
     int chunkSize = KdenliveSettings::timelinechunks();
+    // The chunks are given to the workers on their standard input
     QStringList args{QStringLiteral("preview-chunks"),
                      scene,
                      m_cacheDir.absolutePath(),
-                     dirtyChunks.join(QLatin1Char(',')),
+                     QStringLiteral("-"),
                      QString::number(chunkSize - 1),
                      pCore->getCurrentProfilePath(),
                      m_extension,
@@ -672,27 +741,74 @@ void PreviewManager::doPreviewRender(const QString &scene)
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
     if (!KdenliveSettings::hwDecoding().isEmpty()) {
         env.insert(QLatin1String("MLT_AVFORMAT_HWACCEL"), KdenliveSettings::hwDecoding());
-        m_previewProcess.setProcessEnvironment(env);
     }
-    m_previewProcess.start(KdenliveSettings::kdenliverendererpath(), args);
-    if (m_previewProcess.waitForStarted()) {
-        qDebug() << " -  - -STARTING PREVIEW JOBS . . . STARTED: " << args;
+    const int workers = qMin(previewWorkerCount(), m_chunksToRender);
+    for (int i = 0; i < workers; ++i) {
+        auto *worker = new QProcess(this);
+        worker->setProcessEnvironment(env);
+        connect(worker, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &PreviewManager::processEnded);
+        connect(worker, &QProcess::readyReadStandardError, this, &PreviewManager::receivedStderr);
+        m_previewWorkers << worker;
+        worker->start(KdenliveSettings::kdenliverendererpath(), args);
+        if (worker->waitForStarted()) {
+            feedWorker(worker);
+        } else {
+            // A process that failed to start never emits finished
+            qWarning() << "Cannot start preview worker" << KdenliveSettings::kdenliverendererpath() << worker->errorString();
+            m_errorLog.append(worker->errorString() + QLatin1Char('\n'));
+            m_previewWorkers.removeAll(worker);
+            worker->deleteLater();
+        }
+    }
+    qDebug() << " -  - -STARTING PREVIEW JOBS . . . STARTED: " << m_previewWorkers.count() << "workers," << args;
+    if (m_previewWorkers.isEmpty()) {
+        m_workerFailed = true;
+        m_chunkQueue.clear();
+        Q_EMIT previewRender(0, m_errorLog, -1);
+        endPreviewRender();
     }
 }
 
 void PreviewManager::processEnded(int exitCode, QProcess::ExitStatus status)
 {
-    const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
-    QFile::remove(sceneList);
+    auto *worker = qobject_cast<QProcess *>(sender());
+    if (worker == nullptr) {
+        return;
+    }
+    const int workerChunk = m_workerChunks.value(worker, -1);
+    m_workerChunks.remove(worker);
+    m_previewWorkers.removeAll(worker);
+    worker->deleteLater();
     if (pCore->window() && (status == QProcess::QProcess::CrashExit || exitCode != 0)) {
-        Q_EMIT previewRender(0, m_errorLog, -1);
-        if (workingPreview >= 0) {
-            const QString fileName = QStringLiteral("%1.%2").arg(workingPreview).arg(m_extension);
+        if (!m_workerFailed) {
+            // Stop giving chunks to the other workers, they will exit after their current chunk
+            m_workerFailed = true;
+            m_chunkQueue.clear();
+            Q_EMIT previewRender(0, m_errorLog, -1);
+        }
+        if (workerChunk >= 0 && m_workerChunks.key(workerChunk, nullptr) == nullptr) {
+            const QString fileName = QStringLiteral("%1.%2").arg(workerChunk).arg(m_extension);
             if (m_cacheDir.exists(fileName)) {
                 m_cacheDir.remove(fileName);
             }
         }
-    } else {
+    }
+    if (!m_previewWorkers.isEmpty()) {
+        // Other workers are still rendering
+        if (workingPreview == workerChunk) {
+            workingPreview = m_workerChunks.isEmpty() ? -1 : m_workerChunks.constBegin().value();
+            Q_EMIT workingPreviewChanged();
+        }
+        return;
+    }
+    endPreviewRender();
+}
+
+void PreviewManager::endPreviewRender()
+{
+    const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
+    QFile::remove(sceneList);
+    if (!m_workerFailed) {
         // Normal exit and exit code 0: everything okay
         pCore->currentDoc()->previewProgress(1000);
     }
@@ -741,7 +857,7 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
     int end = endFrame - endFrame % chunkSize;
     bool timerWasRunning = m_previewGatherTimer.isActive();
     m_previewGatherTimer.stop();
-    bool previewWasRunning = m_previewProcess.state() == QProcess::Running;
+    bool previewWasRunning = workersRunning();
     bool alreadyRendered = false;
     bool wasInDirtyZone = false;
     if (!m_renderedChunks.isEmpty()) {
@@ -749,8 +865,13 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
         std::sort(m_renderedChunks.begin(), m_renderedChunks.end(), chunkSort);
         if (start <= m_renderedChunks.last().toInt() && end >= m_renderedChunks.first().toInt()) {
             alreadyRendered = true;
-        } else if (workingPreview >= start && workingPreview <= end) {
-            alreadyRendered = true;
+        } else {
+            for (int chunk : std::as_const(m_workerChunks)) {
+                if (chunk >= start && chunk <= end) {
+                    alreadyRendered = true;
+                    break;
+                }
+            }
         }
     }
     if (!alreadyRendered && !m_dirtyChunks.isEmpty()) {
@@ -871,8 +992,12 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
 
 void PreviewManager::corruptedChunk(int frame, const QString &fileName)
 {
+    m_chunkQueue.clear();
     Q_EMIT abortPreview();
-    m_previewProcess.waitForFinished();
+    const QList<QProcess *> workers = m_previewWorkers;
+    for (QProcess *worker : workers) {
+        worker->waitForFinished();
+    }
     if (workingPreview >= 0) {
         workingPreview = -1;
         Q_EMIT workingPreviewChanged();
@@ -973,5 +1098,5 @@ int PreviewManager::addedTracks() const
 
 bool PreviewManager::isRunning() const
 {
-    return workingPreview >= 0 || m_previewProcess.state() != QProcess::NotRunning;
+    return workingPreview >= 0 || workersRunning();
 }
@@ -10,6 +10,7 @@
 
 #include <QDir>
 #include <QFuture>
+#include <QHash>
 #include <QMutex>
 #include <QProcess>
 #include <QTimer>
@@ -30,6 +31,8 @@ class Producer;
     This allow us to get a preview with a smooth playback of our project.
     Only the preview zone is rendered. Once defined, a preview zone shows as a red line below
     the timeline ruler. As chunks are rendered, the zone turns to green.
+    Chunks are rendered by several kdenlive_render workers, each loading the project once and
+    receiving a new chunk from the queue as soon as it is done with the previous one.
  */
 class PreviewManager : public QObject
 {
@@ -87,8 +90,14 @@ private:
     Mlt::Playlist *m_overlayTrack;
     bool m_warnOnCrash;
     int m_previewTrackIndex;
-    /** @brief: The kdenlive timeline preview process. */
-    QProcess m_previewProcess;
+    /** @brief: The kdenlive timeline preview processes, each one renders the chunks written on its standard input. */
+    QList<QProcess *> m_previewWorkers;
+    /** @brief: The chunk being rendered by each worker. */
+    QHash<QProcess *, int> m_workerChunks;
+    /** @brief: The chunks waiting for a worker, closest to the playhead first. */
+    QList<int> m_chunkQueue;
+    /** @brief: True if a worker failed during the current preview render. */
+    bool m_workerFailed{false};
     /** @brief: The directory used to store the preview files. */
     QDir m_cacheDir;
     /** @brief: The directory used to store undo history of preview files (child of m_cacheDir). */
@@ -115,6 +124,16 @@ private:
     void corruptedChunk(int workingPreview, const QString &fileName);
     /** @brief: Get a compressed list of chunks, like: "0-500,525,575". */
     const QStringList getCompressedList(const QVariantList items) const;
+    /** @brief: Returns true if at least one preview worker is running. */
+    bool workersRunning() const;
+    /** @brief: The number of preview workers to start, from the settings or the available cores and memory. */
+    static int previewWorkerCount();
+    /** @brief: Send the next chunk of the queue to a worker, or tell it to exit if the queue is empty. */
+    void feedWorker(QProcess *worker);
+    /** @brief: Kill all preview workers. */
+    void killWorkers();
+    /** @brief: Clean up once no preview worker is left. */
+    void endPreviewRender();
 
     /** @brief Compare two chunks for usage by std::sort
      * @returns true if @param c1 is less than @param c2
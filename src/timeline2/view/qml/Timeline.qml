@@ -605,6 +605,15 @@ function getTrackColor(audio, header) {
         }
     }
 
+    Timer {
+        id: visibleRangeTimer
+        interval: 300; running: false; repeat: false
+        onTriggered: root.timeline.setVisibleRange(root.scrollMin, root.scrollMax)
+    }
+
+    onScrollMinChanged: visibleRangeTimer.restart()
+    onScrollMaxChanged: visibleRangeTimer.restart()
+
     //onCurrentTrackChanged: root.timeline.selection = []
 
     onTimeScaleChanged: {
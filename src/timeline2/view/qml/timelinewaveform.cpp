@@ -9,6 +9,7 @@
 #include "timelinewaveform.h"
 #include "bin/projectitemmodel.h"
 #include "core.h"
+#include "jobs/audiolevels/audiolevelspyramid.h"
 #include "jobs/audiolevels/audiolevelstask.h"
 #include "jobs/audiolevels/generators.h"
 #include "kdenlivesettings.h"
@@ -106,6 +107,7 @@ void TimelineWaveform::requestRecompute()
 void TimelineWaveform::compute()
 {
     QVector<int16_t> levels;
+    AudioLevelsPyramid pyramid;
     if (m_binId.isEmpty()) {
         return;
     }
@@ -116,7 +118,10 @@ void TimelineWaveform::compute()
             m_audioLevels.clear();
             return;
         }
+        pyramid = pCore->projectItemModel()->getAudioLevelsPyramidByBinID(m_binId, m_stream);
     }
+    // The pyramid is only stored once the levels are complete, make sure it was built from the current levels
+    const bool usePyramid = !pyramid.isEmpty() && pyramid.channels() == m_channels && pyramid.level(0).constData() == levels.constData();
 
     const auto inPoint = static_cast<int>(m_inPoint);
     const auto clipLength = levels.size() / AUDIOLEVELS_POINTS_PER_FRAME / m_channels;
@@ -131,18 +136,28 @@ void TimelineWaveform::compute()
     const int inputPoints = AUDIOLEVELS_POINTS_PER_FRAME * length;
     const bool reverse = m_speed < 0;
     m_pointsPerPixel = static_cast<double>(AUDIOLEVELS_POINTS_PER_FRAME) / timescale;
+    // First displayed point in the levels. A reversed clip is read from the end of the levels and the result is reversed
+    int firstPoint = inPoint * AUDIOLEVELS_POINTS_PER_FRAME;
     if (reverse) {
-        std::reverse(levels.begin(), levels.end());
+        firstPoint = levels.size() / m_channels - firstPoint - inputPoints;
     }
 
     if (m_pointsPerPixel > 1) {
         // Resample the levels and store them
         const int outputPoints = std::round(length * timescale);
-        m_audioLevels.resize(outputPoints * m_channels);
-        computePeaks(&levels[inPoint * AUDIOLEVELS_POINTS_PER_FRAME * m_channels], m_audioLevels.data(), m_channels, inputPoints, outputPoints);
+        if (usePyramid) {
+            // Read the coarsest reduced levels having enough points, so that the cost depends on the number of pixels instead of the clip length
+            m_audioLevels = pyramid.peaks(firstPoint, inputPoints, outputPoints);
+        } else {
+            m_audioLevels.resize(outputPoints * m_channels);
+            computePeaks(levels.constData() + firstPoint * m_channels, m_audioLevels.data(), m_channels, inputPoints, outputPoints);
+        }
     } else {
         // Just extract the part to be displayed
-        m_audioLevels = levels.mid(inPoint * AUDIOLEVELS_POINTS_PER_FRAME * m_channels, inputPoints * m_channels);
+        m_audioLevels = levels.mid(firstPoint * m_channels, inputPoints * m_channels);
+    }
+    if (reverse) {
+        std::reverse(m_audioLevels.begin(), m_audioLevels.end());
     }
 
     if (!m_separateChannels) {
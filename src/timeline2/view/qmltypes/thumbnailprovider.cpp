@@ -8,6 +8,7 @@
 #include "thumbnailprovider.h"
 #include "bin/projectclip.h"
 #include "bin/projectitemmodel.h"
+#include "bin/thumbnailproducerpool.hpp"
 #include "core.h"
 #include "doc/kthumb.h"
 #include "utils/thumbnailcache.hpp"
@@ -44,9 +45,13 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
                 *size = result.size();
                 return result;
             }
-            std::unique_ptr<Mlt::Producer> prod = binClip->getThumbProducer();
-            if (prod && prod->is_valid()) {
-                if (binClip->clipType() != ClipType::Timeline && binClip->clipType() != ClipType::Playlist) {
+            // Reuse a producer of this clip if one is idle, opening a new one is much slower than decoding a frame
+            ThumbnailProducerPool *pool = pCore->projectItemModel()->thumbProducerPool();
+            QByteArray source = binClip->thumbProducerSource();
+            std::unique_ptr<Mlt::Producer> prod = pool->take(binId, source, frameNumber);
+            if (!prod) {
+                prod = binClip->getThumbProducer();
+                if (prod && prod->is_valid() && binClip->clipType() != ClipType::Timeline && binClip->clipType() != ClipType::Playlist) {
                     Mlt::Profile *prodProfile = &pCore->thumbProfile();
                     Mlt::Filter scaler(*prodProfile, "swscale");
                     Mlt::Filter padder(*prodProfile, "resize");
@@ -55,8 +60,12 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
                     prod->attach(padder);
                     prod->attach(converter);
                 }
-                result = makeThumbnail(std::move(prod), frameNumber, requestedSize);
+                source = binClip->thumbProducerSource();
+            }
+            if (prod && prod->is_valid()) {
+                result = makeThumbnail(*prod.get(), frameNumber, requestedSize);
                 ThumbnailCache::get()->storeThumbnail(binId, frameNumber, result, false);
+                pool->release(binId, source, std::move(prod), frameNumber);
             }
         }
     }
@@ -64,11 +73,11 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
     return result;
 }
 
-QImage ThumbnailProvider::makeThumbnail(std::unique_ptr<Mlt::Producer> producer, int frameNumber, const QSize &requestedSize)
+QImage ThumbnailProvider::makeThumbnail(Mlt::Producer &producer, int frameNumber, const QSize &requestedSize)
 {
     Q_UNUSED(requestedSize)
-    producer->seek(frameNumber);
-    std::unique_ptr<Mlt::Frame> frame(producer->get_frame());
+    producer.seek(frameNumber);
+    std::unique_ptr<Mlt::Frame> frame(producer.get_frame());
     if (frame == nullptr || !frame->is_valid()) {
         return QImage();
     }
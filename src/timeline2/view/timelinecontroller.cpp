@@ -6125,6 +6125,20 @@ void TimelineController::autofitTrackHeight(int timelineHeight, int collapsedHei
     Q_EMIT m_model->dataChanged(modelStart, modelEnd, {TimelineModel::HeightRole});
 }
 
+void TimelineController::setVisibleRange(int start, int end)
+{
+    QSet<int> binIds;
+    auto it = m_model->m_allTracks.cbegin();
+    while (it != m_model->m_allTracks.cend()) {
+        const std::unordered_set<int> clips = (*it)->getClipsInRange(start, end);
+        for (int cid : clips) {
+            binIds.insert(m_model->getClipBinId(cid).toInt());
+        }
+        ++it;
+    }
+    pCore->taskManager.prioritizeVisibleClips(binIds);
+}
+
 QVariantList TimelineController::subtitlesList() const
 {
     QVariantList result;
@@ -790,6 +790,8 @@ public Q_SLOTS:
     void checkClipPosition(const QModelIndex &topLeft, const QModelIndex &, const QVector<int> &roles);
     /** @brief Adjust all tracks height to fit in view. */
     Q_INVOKABLE void autofitTrackHeight(int timelineHeight, int collapsedHeight);
+    /** @brief The visible timeline region changed, give priority to the jobs of the clips it contains. */
+    Q_INVOKABLE void setVisibleRange(int start, int end);
     Q_INVOKABLE void subtitlesMenuActivatedAsync(int ix);
     /** @brief Switch the active subtitle in the list. */
     void subtitlesMenuActivated(int ix);
@@ -186,6 +186,11 @@ QString TransitionsRepository::assetPreferredListPath() const
     return QLatin1String("");
 }
 
+QString TransitionsRepository::assetCacheName() const
+{
+    return QStringLiteral("transitions.dat");
+}
+
 std::unique_ptr<Mlt::Transition> TransitionsRepository::getTransition(const QString &transitionId) const
 {
     qDebug() << "===== QUERYING TRANSITION: " << transitionId;
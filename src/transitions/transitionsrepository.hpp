@@ -73,6 +73,8 @@ protected:
     /** @brief Returns the path to the effects' preferred list*/
     QString assetPreferredListPath() const override;
 
+    QString assetCacheName() const override;
+
     void parseType(Mlt::Properties *metadata, Info &res) override;
 
     /** @brief Returns the metadata associated with the given asset*/
@@ -0,0 +1,253 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "filefingerprintcache.hpp"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace {
+constexpr quint32 cacheMagic = 0x4b444650;
+constexpr quint32 cacheVersion = 1;
+// Entries not used for this long are dropped
+constexpr qint64 expirySeconds = 90 * 24 * 3600;
+// Maximum number of entries kept in the cache file
+constexpr int maxEntries = 50000;
+} // namespace
+
+std::unique_ptr<FileFingerprintCache> FileFingerprintCache::instance;
+std::once_flag FileFingerprintCache::m_onceFlag;
+
+FileFingerprintCache::FileFingerprintCache(const QString &cacheFile)
+    : m_cacheFile(cacheFile)
+{
+}
+
+FileFingerprintCache::~FileFingerprintCache()
+{
+    save();
+}
+
+// static
+std::unique_ptr<FileFingerprintCache> &FileFingerprintCache::get()
+{
+    std::call_once(m_onceFlag, [] {
+        const QString folder = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        instance.reset(new FileFingerprintCache(folder.isEmpty() ? QString() : QDir(folder).absoluteFilePath(QStringLiteral("fingerprints.dat"))));
+    });
+    return instance;
+}
+
+// static
+QPair<QByteArray, qint64> FileFingerprintCache::calculateHash(const QString &path)
+{
+    QFile file(path);
+    QByteArray fileHash;
+    qint64 fSize = 0;
+    if (file.open(QIODevice::ReadOnly)) { // write size and hash only if resource points to a file
+        /*
+         * 1 MB = 1 second per 450 files (or faster)
+         * 10 MB = 9 seconds per 450 files (or faster)
+         */
+        QByteArray fileData;
+        fSize = file.size();
+        if (fSize > 2000000) {
+            fileData = file.read(1000000);
+            if (file.seek(file.size() - 1000000)) {
+                fileData.append(file.readAll());
+            }
+        } else {
+            fileData = file.readAll();
+        }
+        file.close();
+        fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
+    }
+    return {fileHash, fSize};
+}
+
+// static
+bool FileFingerprintCache::fileStat(const QString &path, Entry &entry)
+{
+    const QFileInfo info(path);
+    if (!info.isFile()) {
+        return false;
+    }
+    entry.size = info.size();
+    entry.modified = info.lastModified().toMSecsSinceEpoch();
+    entry.inode = 0;
+#ifdef Q_OS_UNIX
+    // A file replaced by another one with the same size and date (for example restored from a backup) gets a new inode
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) == 0) {
+        entry.inode = quint64(st.st_ino);
+    }
+#endif
+    return true;
+}
+
+void FileFingerprintCache::load()
+{
+    // Must be called with the mutex locked
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+    if (m_cacheFile.isEmpty()) {
+        return;
+    }
+    QFile file(m_cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> count;
+    if (stream.status() != QDataStream::Ok || magic != cacheMagic || version != cacheVersion || count < 0) {
+        qWarning() << "Discarding invalid file fingerprint cache" << m_cacheFile;
+        return;
+    }
+    const qint64 expired = QDateTime::currentSecsSinceEpoch() - expirySeconds;
+    m_entries.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QString path;
+        Entry entry;
+        stream >> path >> entry.size >> entry.modified >> entry.inode >> entry.hash >> entry.lastUsed;
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << "Truncated file fingerprint cache" << m_cacheFile;
+            break;
+        }
+        if (entry.lastUsed < expired) {
+            m_modified = true;
+            continue;
+        }
+        m_entries.insert(path, entry);
+    }
+}
+
+bool FileFingerprintCache::lookup(const QString &path, Entry &entry)
+{
+    if (!fileStat(path, entry)) {
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    load();
+    auto it = m_entries.find(path);
+    if (it == m_entries.end() || it->size != entry.size || it->modified != entry.modified || it->inode != entry.inode) {
+        return false;
+    }
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    // Don't rewrite the cache file only to refresh the usage date
+    if (now - it->lastUsed > 24 * 3600) {
+        it->lastUsed = now;
+        m_modified = true;
+    }
+    entry = it.value();
+    return true;
+}
+
+bool FileFingerprintCache::isCached(const QString &path)
+{
+    Entry entry;
+    return lookup(path, entry);
+}
+
+QPair<QByteArray, qint64> FileFingerprintCache::fingerprint(const QString &path)
+{
+    Entry entry;
+    if (lookup(path, entry)) {
+        return {entry.hash, entry.size};
+    }
+    if (entry.size < 0) {
+        // Not a regular file, don't cache anything
+        return calculateHash(path);
+    }
+    // Read the file outside of the lock so that several files can be hashed in parallel
+    const QPair<QByteArray, qint64> result = calculateHash(path);
+    if (result.first.isEmpty() || result.second != entry.size) {
+        // Unreadable, or modified while we were reading it
+        return result;
+    }
+    entry.hash = result.first;
+    entry.lastUsed = QDateTime::currentSecsSinceEpoch();
+    QMutexLocker locker(&m_mutex);
+    load();
+    m_entries.insert(path, entry);
+    m_modified = true;
+    return result;
+}
+
+void FileFingerprintCache::prefetch(const QStringList &paths)
+{
+    QStringList pending;
+    for (const QString &path : paths) {
+        if (!pending.contains(path) && !isCached(path)) {
+            pending << path;
+        }
+    }
+    if (pending.isEmpty()) {
+        return;
+    }
+    QtConcurrent::blockingMap(pending, [this](const QString &path) { fingerprint(path); });
+}
+
+bool FileFingerprintCache::save()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_modified || m_cacheFile.isEmpty()) {
+        return true;
+    }
+    if (m_entries.size() > maxEntries) {
+        // Drop the least recently used entries
+        std::vector<qint64> usage;
+        usage.reserve(size_t(m_entries.size()));
+        for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+            usage.push_back(it->lastUsed);
+        }
+        auto threshold = usage.begin() + (usage.size() - maxEntries);
+        std::nth_element(usage.begin(), threshold, usage.end());
+        const qint64 oldest = *threshold;
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (it->lastUsed < oldest) {
+                it = m_entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    QDir().mkpath(QFileInfo(m_cacheFile).absolutePath());
+    QSaveFile file(m_cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write file fingerprint cache" << m_cacheFile << file.errorString();
+        return false;
+    }
+    QDataStream stream(&file);
+    stream << cacheMagic << cacheVersion << qint32(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        stream << it.key() << it->size << it->modified << it->inode << it->hash << it->lastUsed;
+    }
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "Cannot write file fingerprint cache" << m_cacheFile << file.errorString();
+        return false;
+    }
+    m_modified = false;
+    return true;
+}
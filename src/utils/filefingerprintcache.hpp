@@ -0,0 +1,72 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <mutex>
+
+/** @class FileFingerprintCache
+    @brief This class caches the content hash of media files, so that unchanged files don't need to be read again to check if they were modified.
+    An entry is identified by the file path and only reused if the file size, modification time and inode did not change.
+    The cache is stored in a single file in the application cache folder and shared between projects.
+    The hash is the one stored in project files as kdenlive:file_hash (MD5 of the first and last MB of the file).
+    This class is thread safe.
+ * Note that this class is a Singleton, but other instances can be created for a given cache file
+ */
+class FileFingerprintCache
+{
+public:
+    /** @brief Create a cache stored in the given file. An empty path creates a memory only cache */
+    explicit FileFingerprintCache(const QString &cacheFile);
+    ~FileFingerprintCache();
+
+    // Returns the application wide instance
+    static std::unique_ptr<FileFingerprintCache> &get();
+
+    /** @brief Returns the hash and size of a file, reading it only if it changed since it was last hashed.
+        The hash is empty if the file cannot be read */
+    QPair<QByteArray, qint64> fingerprint(const QString &path);
+    /** @brief Fingerprint the given files in parallel, so that later calls to fingerprint() are served from the cache */
+    void prefetch(const QStringList &paths);
+    /** @brief Returns true if the cache has an up to date entry for this file */
+    bool isCached(const QString &path);
+
+    /** @brief Read the file and compute its hash and size, without using the cache */
+    static QPair<QByteArray, qint64> calculateHash(const QString &path);
+
+    /** @brief Write the cache file if entries changed. Returns false on write error */
+    bool save();
+
+private:
+    struct Entry
+    {
+        qint64 size{-1};
+        qint64 modified{0};
+        quint64 inode{0};
+        QByteArray hash;
+        /** Last time (in seconds since epoch) the entry was used, to expire old entries */
+        qint64 lastUsed{0};
+    };
+    /** @brief Fill the size, modification time and inode of a file. Returns false if the file does not exist */
+    static bool fileStat(const QString &path, Entry &entry);
+    /** @brief Returns true and the cached entry if the file is unchanged */
+    bool lookup(const QString &path, Entry &entry);
+    void load();
+
+    static std::unique_ptr<FileFingerprintCache> instance;
+    static std::once_flag m_onceFlag;
+    QString m_cacheFile;
+    QHash<QString, Entry> m_entries;
+    bool m_loaded{false};
+    bool m_modified{false};
+    QMutex m_mutex;
+};
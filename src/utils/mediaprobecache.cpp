@@ -0,0 +1,180 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "mediaprobecache.hpp"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <vector>
+
+namespace {
+constexpr quint32 cacheMagic = 0x4b44504d;
+constexpr quint32 cacheVersion = 1;
+// Entries not used for this long are dropped
+constexpr qint64 expirySeconds = 90 * 24 * 3600;
+// Maximum number of entries kept in the cache file
+constexpr int maxEntries = 20000;
+} // namespace
+
+std::unique_ptr<MediaProbeCache> MediaProbeCache::instance;
+std::once_flag MediaProbeCache::m_onceFlag;
+
+MediaProbeCache::MediaProbeCache(const QString &cacheFile)
+    : m_cacheFile(cacheFile)
+{
+}
+
+MediaProbeCache::~MediaProbeCache()
+{
+    save();
+}
+
+// static
+std::unique_ptr<MediaProbeCache> &MediaProbeCache::get()
+{
+    std::call_once(m_onceFlag, [] {
+        const QString folder = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        instance.reset(new MediaProbeCache(folder.isEmpty() ? QString() : QDir(folder).absoluteFilePath(QStringLiteral("mediaprobe.dat"))));
+    });
+    return instance;
+}
+
+// static
+QString MediaProbeCache::key(const QByteArray &fileHash, qint64 fileSize, const QString &context)
+{
+    return QStringLiteral("%1:%2:%3").arg(QString::fromLatin1(fileHash.toHex()), QString::number(fileSize), context);
+}
+
+void MediaProbeCache::load()
+{
+    // Must be called with the mutex locked
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+    if (m_cacheFile.isEmpty()) {
+        return;
+    }
+    QFile file(m_cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> count;
+    if (stream.status() != QDataStream::Ok || magic != cacheMagic || version != cacheVersion || count < 0) {
+        qWarning() << "Discarding invalid media probe cache" << m_cacheFile;
+        return;
+    }
+    const qint64 expired = QDateTime::currentSecsSinceEpoch() - expirySeconds;
+    for (int i = 0; i < count; ++i) {
+        QString key;
+        Entry entry;
+        stream >> key >> entry.lastUsed >> entry.properties;
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << "Truncated media probe cache" << m_cacheFile;
+            break;
+        }
+        if (entry.lastUsed < expired) {
+            m_modified = true;
+            continue;
+        }
+        m_entries.insert(key, entry);
+    }
+}
+
+bool MediaProbeCache::lookup(const QString &key, Properties &properties)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return false;
+    }
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    // Don't rewrite the cache file only to refresh the usage date
+    if (now - it->lastUsed > 24 * 3600) {
+        it->lastUsed = now;
+        m_modified = true;
+    }
+    properties = it->properties;
+    return true;
+}
+
+void MediaProbeCache::store(const QString &key, const Properties &properties)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+    Entry &entry = m_entries[key];
+    if (entry.properties == properties) {
+        entry.lastUsed = QDateTime::currentSecsSinceEpoch();
+        return;
+    }
+    entry.properties = properties;
+    entry.lastUsed = QDateTime::currentSecsSinceEpoch();
+    m_modified = true;
+}
+
+void MediaProbeCache::remove(const QString &key)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+    if (m_entries.remove(key) > 0) {
+        m_modified = true;
+    }
+}
+
+bool MediaProbeCache::save()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_modified || m_cacheFile.isEmpty()) {
+        return true;
+    }
+    if (m_entries.size() > maxEntries) {
+        // Drop the least recently used entries
+        std::vector<qint64> usage;
+        usage.reserve(size_t(m_entries.size()));
+        for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+            usage.push_back(it->lastUsed);
+        }
+        auto threshold = usage.begin() + (usage.size() - maxEntries);
+        std::nth_element(usage.begin(), threshold, usage.end());
+        const qint64 oldest = *threshold;
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (it->lastUsed < oldest) {
+                it = m_entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    QDir().mkpath(QFileInfo(m_cacheFile).absolutePath());
+    QSaveFile file(m_cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write media probe cache" << m_cacheFile << file.errorString();
+        return false;
+    }
+    QDataStream stream(&file);
+    stream << cacheMagic << cacheVersion << qint32(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        stream << it.key() << it->lastUsed << it->properties;
+    }
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "Cannot write media probe cache" << m_cacheFile << file.errorString();
+        return false;
+    }
+    m_modified = false;
+    return true;
+}
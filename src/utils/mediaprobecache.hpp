@@ -0,0 +1,66 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <memory>
+#include <mutex>
+
+/** @class MediaProbeCache
+    @brief This class stores the producer properties found when probing a media file (streams, duration, frame rate, metadata),
+    so that an unchanged file does not need to be opened again when a project is loaded.
+    Entries are keyed by the file fingerprint (see FileFingerprintCache) and the settings that influence the probe result.
+    The cache is stored in a single file in the application cache folder and shared between projects.
+    This class is thread safe.
+ * Note that this class is a Singleton, but other instances can be created for a given cache file
+ */
+class MediaProbeCache
+{
+public:
+    using Properties = QList<QPair<QByteArray, QByteArray>>;
+
+    /** @brief Create a cache stored in the given file. An empty path creates a memory only cache */
+    explicit MediaProbeCache(const QString &cacheFile);
+    ~MediaProbeCache();
+
+    // Returns the application wide instance
+    static std::unique_ptr<MediaProbeCache> &get();
+
+    /** @brief Build the cache key of a file
+        @param fileHash the file hash as returned by FileFingerprintCache
+        @param context the other parameters affecting the probe (service, profile frame rate, ...) */
+    static QString key(const QByteArray &fileHash, qint64 fileSize, const QString &context);
+
+    /** @brief Returns true and fills the properties if the key is in the cache */
+    bool lookup(const QString &key, Properties &properties);
+    void store(const QString &key, const Properties &properties);
+    void remove(const QString &key);
+
+    /** @brief Write the cache file if entries changed. Returns false on write error */
+    bool save();
+
+private:
+    struct Entry
+    {
+        Properties properties;
+        /** Last time (in seconds since epoch) the entry was used, to expire old entries */
+        qint64 lastUsed{0};
+    };
+    void load();
+
+    static std::unique_ptr<MediaProbeCache> instance;
+    static std::once_flag m_onceFlag;
+    QString m_cacheFile;
+    QHash<QString, Entry> m_entries;
+    bool m_loaded{false};
+    bool m_modified{false};
+    QMutex m_mutex;
+};
@@ -7,100 +7,211 @@
 #include "bin/projectclip.h"
 #include "bin/projectitemmodel.h"
 #include "core.h"
+#include "kdenlivesettings.h"
 #include "project/projectmanager.h"
+#include "thumbnailpack.hpp"
 #include <QDir>
 #include <QMutexLocker>
+#include <array>
+#include <atomic>
 #include <list>
 
 std::unique_ptr<ThumbnailCache> ThumbnailCache::instance;
 std::once_flag ThumbnailCache::m_onceFlag;
 
+namespace {
+// Number of independently locked parts of the volatile cache
+constexpr size_t shardCount = 16;
+// Maximum number of persistent packs kept open, the least recently used idle ones are closed first
+constexpr size_t maxOpenPacks = 64;
+
+// Key of a thumbnail in the volatile cache
+quint64 volatileKey(int binId, int pos)
+{
+    return (quint64(quint32(binId)) << 32) | quint32(pos);
+}
+} // namespace
+
 class ThumbnailCache::Cache_t
 {
 public:
-    Cache_t(int maxCost)
-        : m_maxCost(maxCost)
+    explicit Cache_t(qint64 maxCost) { setMaxCost(maxCost); }
+
+    void setMaxCost(qint64 maxCost)
     {
+        m_shardMaxCost = qMax(qint64(1), maxCost / qint64(shardCount));
+        for (auto &s : m_shards) {
+            QMutexLocker lock(&s.mutex);
+            trim(s);
+        }
     }
 
-    bool contains(const QString &key) const { return m_cache.count(key) > 0; }
+    qint64 maxCost() const { return m_shardMaxCost * qint64(shardCount); }
 
-    void remove(const QString &key)
+    /** @param tag identifies the version of the clip thumbnails, an entry with another tag is outdated */
+    bool contains(quint64 key, size_t tag) const
     {
-        if (!contains(key)) {
-            return;
+        const Shard &s = shard(key);
+        QMutexLocker lock(&s.mutex);
+        auto it = s.index.find(key);
+        return it != s.index.end() && it->second->tag == tag;
+    }
+
+    void remove(quint64 key)
+    {
+        Shard &s = shard(key);
+        QMutexLocker lock(&s.mutex);
+        removeLocked(s, key);
+    }
+
+    /** @brief Remove all the thumbnails of a clip */
+    void removeClip(int binId)
+    {
+        for (auto &s : m_shards) {
+            QMutexLocker lock(&s.mutex);
+            for (auto it = s.data.begin(); it != s.data.end();) {
+                if (int(it->key >> 32) == binId) {
+                    s.cost -= it->cost;
+                    s.index.erase(it->key);
+                    it = s.data.erase(it);
+                } else {
+                    ++it;
+                }
+            }
         }
-        auto it = m_cache.at(key);
-        m_currentCost -= (*it).second.second;
-        // Need to erase reference to iterator before erasing what it points to.
-        // Fixes BUG 463764.
-        m_cache.erase(key);
-        m_data.erase(it);
     }
 
-    void insert(const QString &key, const QImage &img, int cost)
+    void insert(quint64 key, size_t tag, const QImage &img, qint64 cost)
     {
-        if (cost > m_maxCost) {
+        Shard &s = shard(key);
+        QMutexLocker lock(&s.mutex);
+        removeLocked(s, key);
+        if (cost > m_shardMaxCost) {
             return;
         }
-        m_data.push_front({key, {img, cost}});
-        auto it = m_data.begin();
-        m_cache[key] = it;
-        m_currentCost += cost;
-        while (m_currentCost > m_maxCost) {
-            remove(m_data.back().first);
-        }
+        s.data.push_front({key, tag, img, cost});
+        s.index[key] = s.data.begin();
+        s.cost += cost;
+        trim(s);
     }
 
-    QImage get(const QString &key)
+    QImage get(quint64 key, size_t tag)
     {
-        if (!contains(key)) {
+        Shard &s = shard(key);
+        QMutexLocker lock(&s.mutex);
+        auto it = s.index.find(key);
+        if (it == s.index.end() || it->second->tag != tag) {
+            m_misses++;
             return QImage();
         }
-        // when a get operation occurs, we put the corresponding list item in front to remember last access
-        std::pair<QString, std::pair<QImage, int>> data;
-        auto it = m_cache.at(key);
-        std::swap(data, (*it));                                         // take data out without copy
-        QImage result = data.second.first;                              // a copy occurs here
-        m_data.erase(it);                                               // delete old iterator
-        m_cache[key] = m_data.emplace(m_data.begin(), std::move(data)); // reinsert without copy and store iterator
-        return result;
+        m_hits++;
+        // Move the item in front to remember last access, iterators stay valid
+        s.data.splice(s.data.begin(), s.data, it->second);
+        return s.data.front().image;
     }
+
     void clear()
     {
-        m_data.clear();
-        m_cache.clear();
-        m_currentCost = 0;
+        for (auto &s : m_shards) {
+            QMutexLocker lock(&s.mutex);
+            s.data.clear();
+            s.index.clear();
+            s.cost = 0;
+        }
     }
+
     bool checkIntegrity() const
     {
-        if (m_data.size() != m_cache.size()) {
-            // Cache is corrupted
-            return false;
-        }
-        for (const auto &d : m_data) {
-            if (!contains(d.first)) {
+        for (const auto &s : m_shards) {
+            QMutexLocker lock(&s.mutex);
+            if (s.data.size() != s.index.size()) {
+                // Cache is corrupted
+                return false;
+            }
+            qint64 cost = 0;
+            for (const auto &d : s.data) {
+                auto it = s.index.find(d.key);
+                if (it == s.index.end() || &(*it->second) != &d) {
+                    return false;
+                }
+                cost += d.cost;
+            }
+            if (cost != s.cost || cost > m_shardMaxCost) {
                 return false;
             }
         }
         return true;
     }
 
+    ThumbnailCache::CacheStats stats() const
+    {
+        ThumbnailCache::CacheStats result;
+        result.hits = m_hits;
+        result.misses = m_misses;
+        result.evictions = m_evictions;
+        result.budget = maxCost();
+        for (const auto &s : m_shards) {
+            QMutexLocker lock(&s.mutex);
+            result.memory += s.cost;
+            result.count += int(s.data.size());
+        }
+        return result;
+    }
+
 protected:
-    int m_maxCost;
-    int m_currentCost{0};
-
-    // The data is stored as (key,(image, cost)) in a std::list that serves as a
-    // FIFO queue. If m_maxCost is exceeded, elements are removed from the
-    // end of the list until the sum of the costs in the list is less than m_maxCost.
-    std::list<std::pair<QString, std::pair<QImage, int>>> m_data;
-    // m_cache keeps a mapping from the key to an iterator that represents the
-    // item's location in m_data, like a pointer.
-    std::unordered_map<QString, decltype(m_data.begin())> m_cache;
+    struct Item
+    {
+        quint64 key;
+        size_t tag;
+        QImage image;
+        qint64 cost;
+    };
+    // Each shard is a LRU cache: the items are stored in a std::list that serves as a FIFO queue.
+    // If the shard cost exceeds m_shardMaxCost, elements are removed from the end of the list.
+    // The index maps the key to the item location in the list.
+    struct Shard
+    {
+        mutable QMutex mutex;
+        std::list<Item> data;
+        std::unordered_map<quint64, std::list<Item>::iterator> index;
+        qint64 cost{0};
+    };
+    std::array<Shard, shardCount> m_shards;
+    std::atomic<qint64> m_shardMaxCost{0};
+    std::atomic<quint64> m_hits{0};
+    std::atomic<quint64> m_misses{0};
+    std::atomic<quint64> m_evictions{0};
+
+    Shard &shard(quint64 key) { return m_shards[(key * 0x9E3779B97F4A7C15ULL) >> 60]; }
+    const Shard &shard(quint64 key) const { return m_shards[(key * 0x9E3779B97F4A7C15ULL) >> 60]; }
+
+    // Must be called with the shard mutex locked
+    void removeLocked(Shard &s, quint64 key)
+    {
+        auto it = s.index.find(key);
+        if (it == s.index.end()) {
+            return;
+        }
+        auto item = it->second;
+        s.cost -= item->cost;
+        // Need to erase reference to iterator before erasing what it points to.
+        // Fixes BUG 463764.
+        s.index.erase(it);
+        s.data.erase(item);
+    }
+
+    // Must be called with the shard mutex locked
+    void trim(Shard &s)
+    {
+        while (s.cost > m_shardMaxCost && !s.data.empty()) {
+            removeLocked(s, s.data.back().key);
+            m_evictions++;
+        }
+    }
 };
 
 ThumbnailCache::ThumbnailCache()
-    : m_volatileCache(new Cache_t(10000000))
+    : m_volatileCache(new Cache_t(qint64(KdenliveSettings::thumbnailcachesize()) * 1024 * 1024))
 {
 }
 
@@ -112,37 +223,39 @@ std::unique_ptr<ThumbnailCache> &ThumbnailCache::get()
 
 bool ThumbnailCache::hasThumbnail(const QString &binId, int pos, bool volatileOnly) const
 {
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
-    auto key = pos < 0 ? getAudioKey(binId, &ok).constFirst() : getKey(binId, pos, &ok);
-    if (ok && m_volatileCache->contains(key)) {
+    if (pos < 0) {
+        // Audio thumbnails are only stored on disk
+        const QString key = getAudioKey(binId, &ok).constFirst();
+        if (!ok || volatileOnly) {
+            return false;
+        }
+        QDir thumbFolder = getDir(true, &ok);
+        return ok && thumbFolder.exists(key);
+    }
+    const QString thumbHash = getThumbHash(binId, &ok);
+    if (!ok) {
+        return false;
+    }
+    if (m_volatileCache->contains(volatileKey(binId.toInt(), pos), qHash(thumbHash))) {
         return true;
     }
-    if (!ok || volatileOnly) {
+    if (volatileOnly) {
         return false;
     }
-    locker.unlock();
-    QDir thumbFolder = getDir(pos < 0, &ok);
-    return ok && thumbFolder.exists(key);
+    std::shared_ptr<ThumbnailPack> pack = getPack(thumbHash);
+    return pack && pack->contains(pos);
 }
 
 QImage ThumbnailCache::getAudioThumbnail(const QString &binId, bool volatileOnly) const
 {
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
     auto key = getAudioKey(binId, &ok).constFirst();
-    if (ok && m_volatileCache->contains(key)) {
-        return m_volatileCache->get(key);
-    }
     if (!ok || volatileOnly) {
         return QImage();
     }
     QDir thumbFolder = getDir(true, &ok);
     if (ok && thumbFolder.exists(key)) {
-        if (std::find(m_storedOnDisk[binId].begin(), m_storedOnDisk[binId].end(), -1) != m_storedOnDisk[binId].end()) {
-            m_storedOnDisk[binId].push_back(-1);
-        }
-        locker.unlock();
         return QImage(thumbFolder.absoluteFilePath(key));
     }
     return QImage();
@@ -169,49 +282,25 @@ QImage ThumbnailCache::getThumbnail(QString hash, const QString &binId, int pos,
     if (hash.isEmpty()) {
         return QImage();
     }
-    hash.append(QStringLiteral("#%1.jpg").arg(pos));
-    QMutexLocker locker(&m_mutex);
-    if (m_volatileCache->contains(hash)) {
-        return m_volatileCache->get(hash);
-    }
-    if (volatileOnly) {
-        return QImage();
+    QImage result = m_volatileCache->get(volatileKey(binId.toInt(), pos), qHash(hash));
+    if (!result.isNull() || volatileOnly) {
+        return result;
     }
-    bool ok = false;
-    QDir thumbFolder = getDir(false, &ok);
-    if (ok && thumbFolder.exists(hash)) {
-        if (m_storedOnDisk.find(binId) == m_storedOnDisk.end() ||
-            std::find(m_storedOnDisk[binId].begin(), m_storedOnDisk[binId].end(), pos) == m_storedOnDisk[binId].end()) {
-            m_storedOnDisk[binId].push_back(pos);
-        }
-        locker.unlock();
-        return QImage(thumbFolder.absoluteFilePath(hash));
+    std::shared_ptr<ThumbnailPack> pack = getPack(hash);
+    if (pack) {
+        return pack->image(pos);
     }
-    locker.unlock();
     return QImage();
 }
 
 QImage ThumbnailCache::getThumbnail(const QString &binId, int pos, bool volatileOnly) const
 {
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
-    auto key = getKey(binId, pos, &ok);
-    if (ok && m_volatileCache->contains(key)) {
-        return m_volatileCache->get(key);
-    }
-    if (!ok || volatileOnly) {
+    const QString thumbHash = getThumbHash(binId, &ok);
+    if (!ok) {
         return QImage();
     }
-    QDir thumbFolder = getDir(false, &ok);
-    if (ok && thumbFolder.exists(key)) {
-        if (m_storedOnDisk.find(binId) == m_storedOnDisk.end() ||
-            std::find(m_storedOnDisk[binId].begin(), m_storedOnDisk[binId].end(), pos) == m_storedOnDisk[binId].end()) {
-            m_storedOnDisk[binId].push_back(pos);
-        }
-        locker.unlock();
-        return QImage(thumbFolder.absoluteFilePath(key));
-    }
-    return QImage();
+    return getThumbnail(thumbHash, binId, pos, volatileOnly);
 }
 
 void ThumbnailCache::storeThumbnail(const QString &binId, int pos, const QImage &img, bool persistent)
@@ -219,153 +308,183 @@ void ThumbnailCache::storeThumbnail(const QString &binId, int pos, const QImage
     if (pCore->projectItemModel()->closing) {
         return;
     }
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
-    const QString key = getKey(binId, pos, &ok);
+    const QString thumbHash = getThumbHash(binId, &ok);
     if (!ok) {
         return;
     }
-    // if volatile cache also contains this entry, update it
-    if (m_volatileCache->contains(key)) {
-        m_volatileCache->remove(key);
-    } else {
-        m_storedVolatile[binId].push_back(pos);
-    }
-    m_volatileCache->insert(key, img, (int)img.sizeInBytes());
+    // if volatile cache also contains this entry, it is replaced
+    m_volatileCache->insert(volatileKey(binId.toInt(), pos), qHash(thumbHash), img, img.sizeInBytes());
     if (persistent) {
-        QDir thumbFolder = getDir(false, &ok);
-        if (ok) {
-            if (m_storedOnDisk.find(binId) == m_storedOnDisk.end() ||
-                std::find(m_storedOnDisk[binId].begin(), m_storedOnDisk[binId].end(), pos) == m_storedOnDisk[binId].end()) {
-                m_storedOnDisk[binId].push_back(pos);
-            }
-            locker.unlock();
-            if (!img.save(thumbFolder.absoluteFilePath(key))) {
-                qDebug() << ".............\n!!!!!!!! ERROR SAVING THUMB in: " << thumbFolder.absoluteFilePath(key);
-            }
+        std::shared_ptr<ThumbnailPack> pack = getPack(thumbHash);
+        if (pack && !pack->store(pos, img)) {
+            qDebug() << ".............\n!!!!!!!! ERROR SAVING THUMB in: " << ThumbnailPack::fileName(thumbHash);
         }
     }
 }
 
+void ThumbnailCache::setVolatileBudget(qint64 bytes)
+{
+    m_volatileCache->setMaxCost(bytes);
+}
+
+ThumbnailCache::CacheStats ThumbnailCache::volatileStats() const
+{
+    return m_volatileCache->stats();
+}
+
 bool ThumbnailCache::checkIntegrity() const
 {
-    return m_volatileCache->checkIntegrity();
+    if (!m_volatileCache->checkIntegrity()) {
+        return false;
+    }
+    std::vector<std::shared_ptr<ThumbnailPack>> packs;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const auto &pack : m_packs) {
+            packs.push_back(pack.second.pack);
+        }
+    }
+    for (const auto &pack : packs) {
+        if (!pack->checkIntegrity()) {
+            return false;
+        }
+    }
+    return true;
 }
 
-void ThumbnailCache::saveCachedThumbs(const std::unordered_map<QString, std::vector<int>> &keys)
+std::shared_ptr<ThumbnailPack> ThumbnailCache::getPack(const QString &thumbHash) const
 {
-    bool ok;
+    if (thumbHash.isEmpty()) {
+        return nullptr;
+    }
+    bool ok = false;
     QDir thumbFolder = getDir(false, &ok);
     if (!ok) {
-        return;
+        return nullptr;
     }
-    QMutexLocker locker(&m_mutex);
+    QStringList legacyFiles;
+    std::shared_ptr<ThumbnailPack> pack;
+    {
+        QMutexLocker locker(&m_mutex);
+        const QString packPath = thumbFolder.absoluteFilePath(ThumbnailPack::fileName(thumbHash));
+        auto it = m_packs.find(packPath);
+        if (it != m_packs.end()) {
+            it->second.lastUsed = ++m_packClock;
+            return it->second.pack;
+        }
+        if (m_legacyScannedFolder != thumbFolder.absolutePath()) {
+            // List the thumbnails stored with the legacy layout (one file per thumbnail) only once per folder
+            m_legacyScannedFolder = thumbFolder.absolutePath();
+            m_legacyThumbs.clear();
+            const QStringList files = thumbFolder.entryList({QStringLiteral("*#*.jpg")}, QDir::Files);
+            for (const QString &file : files) {
+                m_legacyThumbs[file.section(QLatin1Char('#'), 0, 0)] << file;
+            }
+        }
+        legacyFiles = m_legacyThumbs.take(thumbHash);
+        while (m_packs.size() >= maxOpenPacks) {
+            // Close the least recently used pack that is not in use. A pack in use is kept, so that a file is never opened twice
+            auto oldest = m_packs.end();
+            for (auto open = m_packs.begin(); open != m_packs.end(); ++open) {
+                if (open->second.pack.use_count() == 1 && (oldest == m_packs.end() || open->second.lastUsed < oldest->second.lastUsed)) {
+                    oldest = open;
+                }
+            }
+            if (oldest == m_packs.end()) {
+                break;
+            }
+            m_packs.erase(oldest);
+        }
+        pack = std::make_shared<ThumbnailPack>(thumbFolder, thumbHash);
+        m_packs[packPath] = {pack, ++m_packClock};
+    }
+    // Migrate legacy thumbnails of this clip
+    pack->importLegacyFiles(legacyFiles);
+    return pack;
+}
+
+void ThumbnailCache::saveCachedThumbs(const std::unordered_map<QString, std::vector<int>> &keys)
+{
     for (auto &key : keys) {
         bool ok;
+        const QString thumbHash = getThumbHash(key.first, &ok);
+        if (!ok) {
+            continue;
+        }
+        std::shared_ptr<ThumbnailPack> pack = getPack(thumbHash);
+        if (!pack) {
+            // Cache folder is not available
+            return;
+        }
+        const std::vector<int> storedFrames = pack->frames();
+        const std::set<int> stored(storedFrames.begin(), storedFrames.end());
+        std::vector<std::pair<int, QImage>> images;
+        const int binId = key.first.toInt();
+        const size_t tag = qHash(thumbHash);
         for (const auto &pos : key.second) {
-            if (m_storedOnDisk.find(key.first) == m_storedOnDisk.end() ||
-                std::find(m_storedOnDisk[key.first].begin(), m_storedOnDisk[key.first].end(), pos) == m_storedOnDisk[key.first].end()) {
-                const QString thumbKey = getKey(key.first, pos, &ok);
-                if (!ok) {
-                    continue;
-                }
-                if (!thumbFolder.exists(thumbKey) && m_volatileCache->contains(thumbKey)) {
-                    QImage img = m_volatileCache->get(thumbKey);
-                    if (!img.save(thumbFolder.absoluteFilePath(thumbKey))) {
-                        qDebug() << "// Error writing thumbnails to " << thumbFolder.absolutePath();
-                        break;
-                    } else {
-                        m_storedOnDisk[key.first].push_back(pos);
-                    }
-                }
+            if (stored.count(pos) > 0) {
+                continue;
+            }
+            const QImage img = m_volatileCache->get(volatileKey(binId, pos), tag);
+            if (!img.isNull()) {
+                images.emplace_back(pos, img);
             }
         }
+        // Write all the thumbnails of this clip at once
+        if (!images.empty() && !pack->store(images)) {
+            qDebug() << "// Error writing thumbnails to " << ThumbnailPack::fileName(thumbHash);
+            break;
+        }
     }
 }
 
 void ThumbnailCache::invalidateThumbsForClip(const QString &binId, std::set<int> frames)
 {
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
-    if (m_storedVolatile.find(binId) != m_storedVolatile.end()) {
-        if (frames.size() > 0) {
-            // Remove only specified frames
-            auto cachedFrames = m_storedVolatile.at(binId);
-            for (auto &f : frames) {
-                auto it = std::find(cachedFrames.begin(), cachedFrames.end(), f);
-                if (it != cachedFrames.end()) {
-                    auto key = getKey(binId, f, &ok);
-                    if (ok) {
-                        m_volatileCache->remove(key);
-                        cachedFrames.erase(it);
-                    }
-                }
-            }
-            m_storedVolatile[binId] = cachedFrames;
-        } else {
-            // Remove all thumbs
-            for (int pos : m_storedVolatile.at(binId)) {
-                auto key = getKey(binId, pos, &ok);
-                if (ok) {
-                    m_volatileCache->remove(key);
-                }
-            }
-            m_storedVolatile.erase(binId);
+    if (frames.size() > 0) {
+        // Remove only specified frames
+        for (int f : frames) {
+            m_volatileCache->remove(volatileKey(binId.toInt(), f));
         }
+    } else {
+        // Remove all thumbs
+        m_volatileCache->removeClip(binId.toInt());
     }
     // Video thumbs
-    QStringList files;
-    if (m_storedOnDisk.find(binId) != m_storedOnDisk.end()) {
-        // Remove persistent cache
+    const QString thumbHash = getThumbHash(binId, &ok);
+    if (!ok) {
+        return;
+    }
+    std::shared_ptr<ThumbnailPack> pack = getPack(thumbHash);
+    if (pack) {
         if (frames.size() > 0) {
             // Remove only specified frames
-            auto cachedFrames = m_storedOnDisk.at(binId);
-            for (auto &f : frames) {
-                auto it = std::find(cachedFrames.begin(), cachedFrames.end(), f);
-                if (it != cachedFrames.end()) {
-                    auto key = getKey(binId, f, &ok);
-                    if (ok) {
-                        files << key;
-                        cachedFrames.erase(it);
-                    }
-                }
-                m_storedOnDisk[binId] = cachedFrames;
-            }
+            pack->remove(frames);
         } else {
             // Remove all thumbs
-            for (const auto &pos : m_storedOnDisk.at(binId)) {
-                if (pos >= 0) {
-                    auto key = getKey(binId, pos, &ok);
-                    if (ok) {
-                        files << key;
-                    }
-                }
-            }
-            m_storedOnDisk.erase(binId);
-        }
-    }
-    // Release mutex before deleting files
-    locker.unlock();
-    if (!files.isEmpty()) {
-        QDir thumbFolder = getDir(false, &ok);
-        if (ok) {
-            while (!files.isEmpty()) {
-                thumbFolder.remove(files.takeFirst());
-            }
+            pack->removeAll();
         }
     }
 }
 
 void ThumbnailCache::clearCache()
 {
-    QMutexLocker locker(&m_mutex);
+    const CacheStats stats = m_volatileCache->stats();
+    if (stats.hits + stats.misses > 0) {
+        qDebug() << "::: Thumbnail cache:" << stats.count << "thumbnails," << stats.memory / 1024 << "of" << stats.budget / 1024 << "kB, hits:" << stats.hits
+                 << "misses:" << stats.misses << "evictions:" << stats.evictions;
+    }
     m_volatileCache->clear();
-    m_storedVolatile.clear();
-    m_storedOnDisk.clear();
+    m_volatileCache->setMaxCost(qint64(KdenliveSettings::thumbnailcachesize()) * 1024 * 1024);
+    QMutexLocker locker(&m_mutex);
+    m_packs.clear();
+    m_legacyThumbs.clear();
+    m_legacyScannedFolder.clear();
 }
 
 // static
-QString ThumbnailCache::getKey(const QString &binId, int pos, bool *ok)
+QString ThumbnailCache::getThumbHash(const QString &binId, bool *ok)
 {
     if (binId.isEmpty()) {
         *ok = false;
@@ -376,7 +495,7 @@ QString ThumbnailCache::getKey(const QString &binId, int pos, bool *ok)
     if (!*ok) {
         return QString();
     }
-    return binClip->hashForThumbs() + QLatin1Char('#') + QString::number(pos) + QStringLiteral(".jpg");
+    return binClip->hashForThumbs();
 }
 
 // static
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <QDir>
+#include <QHash>
 #include <QImage>
 #include <QMutex>
 #include <QUrl>
@@ -15,10 +16,14 @@
 #include <unordered_map>
 #include <vector>
 
+class ThumbnailPack;
+
 /** @class ThumbnailCache
     @brief This class class is an interface to the caches that store thumbnails.
     In Kdenlive, we use two such caches, a persistent that is stored on disk to allow thumbnails to be reused when reopening.
-    The other one is a volatile LRU cache that lives in memory.
+    The persistent cache stores all the thumbnails of a clip in a single packed file (see ThumbnailPack).
+    The other one is a volatile LRU cache that lives in memory, keyed by bin id and frame, and split in independently locked shards
+    so that threads requesting thumbnails do not wait on each other.
     Note that for the volatile cache uses a custom implementation.
     QCache is not suitable since it operates on pointers and since the object is removed from the cache when accessed.
     KImageCache is not suitable since it lacks a way to remove objects from the cache.
@@ -65,29 +70,60 @@ public:
     /** @brief Reset cache (discarding all thumbs stored in memory) */
     void clearCache();
 
-    /** @brief Ensure the cache is not corrupted */
+    /** @brief Ensure the cache (volatile and persistent) is not corrupted */
     bool checkIntegrity() const;
 
+    struct CacheStats
+    {
+        quint64 hits{0};
+        quint64 misses{0};
+        quint64 evictions{0};
+        /** Memory used by the stored thumbnails, in bytes */
+        qint64 memory{0};
+        qint64 budget{0};
+        int count{0};
+    };
+    /** @brief Set the maximum memory used by the volatile cache, in bytes. Least recently used thumbnails are dropped if needed */
+    void setVolatileBudget(qint64 bytes);
+    /** @brief Returns the usage counters of the volatile cache since the application started */
+    CacheStats volatileStats() const;
+
 protected:
     // Constructor is protected because class is a Singleton
     ThumbnailCache();
 
-    // Return the key associated to a thumbnail
-    static QString getKey(const QString &binId, int pos, bool *ok);
+    // Return the hash used to identify the thumbnails of a clip
+    static QString getThumbHash(const QString &binId, bool *ok);
     static QStringList getAudioKey(const QString &binId, bool *ok);
 
     // Return the dir where the persistent cache lives
     static const QDir getDir(bool audio, bool *ok);
 
+    /** @brief Returns the persistent thumbnail pack for a clip hash, or nullptr if the cache folder is not available.
+       The first time a pack is requested, the thumbnails of this clip stored in the legacy one file per thumbnail layout are migrated into it.
+       Must not be called with m_mutex locked */
+    std::shared_ptr<ThumbnailPack> getPack(const QString &thumbHash) const;
+
     static std::unique_ptr<ThumbnailCache> instance;
     static std::once_flag m_onceFlag; // flag to create the repository only once;
 
     class Cache_t;
+    // The volatile cache has its own locks
     std::unique_ptr<Cache_t> m_volatileCache;
+    // Protects the persistent packs
     mutable QMutex m_mutex;
 
-    // the following maps keeps track of the positions that we store for each clip in volatile caches.
-    // Note that we don't track deletions due to items dropped from the cache. So the maps can contain more items that are currently stored.
-    std::unordered_map<QString, std::vector<int>> m_storedVolatile;
-    mutable std::unordered_map<QString, std::vector<int>> m_storedOnDisk;
+    struct OpenPack
+    {
+        std::shared_ptr<ThumbnailPack> pack;
+        // Value of m_packClock when the pack was last requested
+        quint64 lastUsed;
+    };
+    // Opened persistent packs, by pack file path. Each one keeps a file descriptor and a mapping, so their number is bounded
+    mutable std::unordered_map<QString, OpenPack> m_packs;
+    mutable quint64 m_packClock{0};
+    // Thumbnails stored with the legacy one file per thumbnail layout that were not migrated yet, by clip hash
+    mutable QHash<QString, QStringList> m_legacyThumbs;
+    // The folder in which we looked for legacy thumbnails
+    mutable QString m_legacyScannedFolder;
 };
@@ -0,0 +1,400 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "thumbnailpack.hpp"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+// File header: magic, format version, reserved
+const char packMagic[8] = {'K', 'D', 'T', 'H', 'U', 'M', 'B', '\0'};
+constexpr quint32 packVersion = 1;
+constexpr qint64 headerSize = 16;
+// Record header: frame number, data size
+constexpr qint64 recordHeaderSize = 8;
+// Don't bother compacting packs wasting less than this
+constexpr qint64 compactThreshold = 4 * 1024 * 1024;
+
+QByteArray packHeader()
+{
+    QByteArray header(packMagic, sizeof(packMagic));
+    header.append(headerSize - header.size(), '\0');
+    qToLittleEndian<quint32>(packVersion, header.data() + 8);
+    return header;
+}
+
+QByteArray recordHeader(int frame, quint32 size)
+{
+    QByteArray header(recordHeaderSize, '\0');
+    qToLittleEndian<qint32>(frame, header.data());
+    qToLittleEndian<quint32>(size, header.data() + 4);
+    return header;
+}
+} // namespace
+
+ThumbnailPack::ThumbnailPack(const QDir &folder, const QString &clipHash)
+    : m_folder(folder)
+    , m_clipHash(clipHash)
+{
+}
+
+ThumbnailPack::~ThumbnailPack()
+{
+    closeFile();
+}
+
+// static
+QString ThumbnailPack::fileName(const QString &clipHash)
+{
+    return clipHash + QStringLiteral(".thumbs");
+}
+
+// static
+QString ThumbnailPack::legacyFileName(const QString &clipHash, int frame)
+{
+    return clipHash + QLatin1Char('#') + QString::number(frame) + QStringLiteral(".jpg");
+}
+
+bool ThumbnailPack::openFile(bool create)
+{
+    if (m_opened) {
+        return true;
+    }
+    const QString path = m_folder.absoluteFilePath(fileName(m_clipHash));
+    if (!create && (m_missing || !QFile::exists(path))) {
+        // Remember that there is no pack so that lookups don't hit the filesystem
+        m_missing = true;
+        return false;
+    }
+    m_missing = false;
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Cannot open thumbnail pack" << path << m_file.errorString();
+        return false;
+    }
+    m_index.clear();
+    m_wastedSize = 0;
+    const QByteArray header = packHeader();
+    if (m_file.size() < headerSize || m_file.peek(8) != header.left(8) || qFromLittleEndian<quint32>(m_file.peek(headerSize).constData() + 8) != packVersion) {
+        // New, corrupted or incompatible pack, restart from scratch
+        if (m_file.size() > 0) {
+            qWarning() << "Discarding invalid thumbnail pack" << path;
+        }
+        m_file.resize(0);
+        m_file.seek(0);
+        m_file.write(header);
+        m_file.flush();
+    }
+    m_opened = true;
+    if (!remap()) {
+        closeFile();
+        return false;
+    }
+    // Build the index from the record headers
+    qint64 pos = headerSize;
+    while (pos + recordHeaderSize <= m_mappedSize) {
+        int frame = qFromLittleEndian<qint32>(m_map + pos);
+        quint32 size = qFromLittleEndian<quint32>(m_map + pos + 4);
+        if (pos + recordHeaderSize + qint64(size) > m_mappedSize) {
+            break;
+        }
+        auto existing = m_index.find(frame);
+        if (existing != m_index.end()) {
+            m_wastedSize += recordHeaderSize + existing->second.second;
+        }
+        if (size == 0) {
+            // Removed frame
+            m_wastedSize += recordHeaderSize;
+            m_index.erase(frame);
+        } else {
+            m_index[frame] = {pos + recordHeaderSize, size};
+        }
+        pos += recordHeaderSize + size;
+    }
+    if (pos < m_mappedSize) {
+        // Last record was not completely written (crash while saving), drop it
+        qWarning() << "Truncating incomplete thumbnail pack" << path << "from" << m_mappedSize << "to" << pos;
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        m_mappedSize = 0;
+        m_file.resize(pos);
+        if (!remap()) {
+            closeFile();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ThumbnailPack::remap()
+{
+    qint64 size = m_file.size();
+    if (m_map != nullptr && size == m_mappedSize) {
+        return true;
+    }
+    if (m_map != nullptr) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        m_mappedSize = 0;
+    }
+    m_map = m_file.map(0, size);
+    if (m_map == nullptr) {
+        qWarning() << "Cannot map thumbnail pack" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+    m_mappedSize = size;
+    return true;
+}
+
+void ThumbnailPack::closeFile()
+{
+    if (m_map != nullptr) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_mappedSize = 0;
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_opened = false;
+}
+
+bool ThumbnailPack::contains(int frame)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!openFile(false)) {
+        return false;
+    }
+    return m_index.count(frame) > 0;
+}
+
+QByteArray ThumbnailPack::recordData(int frame) const
+{
+    auto it = m_index.find(frame);
+    if (it == m_index.end() || it->second.first + it->second.second > m_mappedSize) {
+        return QByteArray();
+    }
+    return QByteArray(reinterpret_cast<const char *>(m_map + it->second.first), int(it->second.second));
+}
+
+QImage ThumbnailPack::image(int frame)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!openFile(false) || m_index.count(frame) == 0) {
+        return QImage();
+    }
+    if (!remap()) {
+        return QImage();
+    }
+    // Copy the (small) encoded data so that decoding does not block other readers
+    const QByteArray data = recordData(frame);
+    locker.unlock();
+    return QImage::fromData(data, "JPG");
+}
+
+std::vector<int> ThumbnailPack::frames()
+{
+    QMutexLocker locker(&m_mutex);
+    std::vector<int> result;
+    if (!openFile(false)) {
+        return result;
+    }
+    result.reserve(m_index.size());
+    for (const auto &entry : m_index) {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+bool ThumbnailPack::appendRecord(int frame, const QByteArray &data)
+{
+    qint64 offset = m_file.size();
+    if (!m_file.seek(offset)) {
+        return false;
+    }
+    if (m_file.write(recordHeader(frame, quint32(data.size()))) != recordHeaderSize || m_file.write(data) != data.size()) {
+        qWarning() << "Error writing thumbnail pack" << m_file.fileName() << m_file.errorString();
+        // Drop the partial record
+        m_file.resize(offset);
+        return false;
+    }
+    auto existing = m_index.find(frame);
+    if (existing != m_index.end()) {
+        m_wastedSize += recordHeaderSize + existing->second.second;
+    }
+    if (data.isEmpty()) {
+        m_wastedSize += recordHeaderSize;
+        m_index.erase(frame);
+    } else {
+        m_index[frame] = {offset + recordHeaderSize, quint32(data.size())};
+    }
+    return true;
+}
+
+bool ThumbnailPack::store(int frame, const QImage &img)
+{
+    return store({{frame, img}});
+}
+
+bool ThumbnailPack::store(const std::vector<std::pair<int, QImage>> &images)
+{
+    // Encode outside of the lock
+    std::vector<std::pair<int, QByteArray>> encoded;
+    encoded.reserve(images.size());
+    for (const auto &img : images) {
+        if (img.second.isNull()) {
+            continue;
+        }
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        if (img.second.save(&buffer, "JPG") && !data.isEmpty()) {
+            encoded.emplace_back(img.first, data);
+        }
+    }
+    if (encoded.empty()) {
+        return images.empty();
+    }
+    QMutexLocker locker(&m_mutex);
+    if (!openFile(true)) {
+        return false;
+    }
+    bool result = true;
+    for (const auto &data : encoded) {
+        if (!appendRecord(data.first, data.second)) {
+            result = false;
+            break;
+        }
+    }
+    m_file.flush();
+    compact();
+    return result;
+}
+
+void ThumbnailPack::remove(const std::set<int> &frames)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!openFile(false)) {
+        return;
+    }
+    for (int frame : frames) {
+        if (m_index.count(frame) > 0) {
+            appendRecord(frame, QByteArray());
+        }
+    }
+    m_file.flush();
+    compact();
+}
+
+void ThumbnailPack::removeAll()
+{
+    QMutexLocker locker(&m_mutex);
+    closeFile();
+    m_index.clear();
+    m_wastedSize = 0;
+    m_missing = true;
+    const QString path = m_folder.absoluteFilePath(fileName(m_clipHash));
+    if (QFile::exists(path)) {
+        QFile::remove(path);
+    }
+}
+
+void ThumbnailPack::importLegacyFiles(const QStringList &files)
+{
+    if (files.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    if (!openFile(true)) {
+        return;
+    }
+    const QString prefix = m_clipHash + QLatin1Char('#');
+    for (const QString &file : files) {
+        if (!file.startsWith(prefix) || !file.endsWith(QLatin1String(".jpg"))) {
+            continue;
+        }
+        bool ok = false;
+        int frame = file.mid(prefix.size(), file.size() - prefix.size() - 4).toInt(&ok);
+        const QString path = m_folder.absoluteFilePath(file);
+        if (ok && m_index.count(frame) == 0) {
+            // Legacy thumbnails are already JPEG encoded, store them as is
+            QFile legacy(path);
+            if (legacy.open(QIODevice::ReadOnly)) {
+                const QByteArray data = legacy.readAll();
+                legacy.close();
+                if (!data.isEmpty() && !appendRecord(frame, data)) {
+                    // Keep the legacy file if we could not migrate it
+                    continue;
+                }
+            }
+        }
+        QFile::remove(path);
+    }
+    m_file.flush();
+}
+
+void ThumbnailPack::compact()
+{
+    if (m_wastedSize < compactThreshold || m_wastedSize < m_file.size() / 2) {
+        return;
+    }
+    if (!remap()) {
+        return;
+    }
+    // Collect live records in frame order
+    std::vector<int> frames;
+    frames.reserve(m_index.size());
+    for (const auto &entry : m_index) {
+        frames.push_back(entry.first);
+    }
+    std::sort(frames.begin(), frames.end());
+    QByteArray content = packHeader();
+    for (int frame : frames) {
+        const QByteArray data = recordData(frame);
+        content.append(recordHeader(frame, quint32(data.size())));
+        content.append(data);
+    }
+    const QString path = m_file.fileName();
+    // The file must not be open or mapped when we replace it (required on Windows)
+    closeFile();
+    QSaveFile saveFile(path);
+    if (!saveFile.open(QIODevice::WriteOnly) || saveFile.write(content) != content.size() || !saveFile.commit()) {
+        qWarning() << "Cannot compact thumbnail pack" << path << saveFile.errorString();
+    }
+    // Reopen and rebuild index
+    openFile(false);
+}
+
+bool ThumbnailPack::checkIntegrity()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_opened) {
+        return true;
+    }
+    m_file.flush();
+    if (!remap()) {
+        return false;
+    }
+    for (const auto &entry : m_index) {
+        qint64 offset = entry.second.first;
+        quint32 size = entry.second.second;
+        if (offset < headerSize + recordHeaderSize || offset + size > m_mappedSize || size < 2) {
+            return false;
+        }
+        if (qFromLittleEndian<qint32>(m_map + offset - recordHeaderSize) != entry.first) {
+            return false;
+        }
+        // JPEG start of image marker
+        if (m_map[offset] != 0xFF || m_map[offset + 1] != 0xD8) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QMutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+/** @class ThumbnailPack
+    @brief This class stores all the persistent thumbnails of a clip in a single packed file.
+    The file starts with a small header, followed by records made of the frame number, the data size and the JPEG encoded image.
+    Records are only ever appended: a thumbnail that is stored again supersedes the previous record for the same frame,
+    and removed frames are recorded as records without data. The index (frame -> data offset) is rebuilt when the pack is opened.
+    The file is memory-mapped for reads, so that a lookup does not require any filesystem call.
+    When too much space is wasted by superseded records, the pack is compacted.
+    This class is thread safe.
+ */
+class ThumbnailPack
+{
+public:
+    /** @brief Create a pack object for the given clip thumbnail hash in a cache folder. The file is only created when a thumbnail is stored */
+    ThumbnailPack(const QDir &folder, const QString &clipHash);
+    ~ThumbnailPack();
+
+    /** @brief Returns the file name of the pack for a given clip hash */
+    static QString fileName(const QString &clipHash);
+    /** @brief Returns the name of the legacy (one file per thumbnail) cache file for a frame */
+    static QString legacyFileName(const QString &clipHash, int frame);
+
+    /** @brief Returns true if the pack contains a thumbnail for this frame */
+    bool contains(int frame);
+    /** @brief Returns the thumbnail for this frame, or a null image if not found */
+    QImage image(int frame);
+    /** @brief Returns the frames stored in this pack */
+    std::vector<int> frames();
+
+    /** @brief Encode and append a thumbnail to the pack. Returns false on write error */
+    bool store(int frame, const QImage &img);
+    /** @brief Append several thumbnails to the pack with a single flush. Returns false on write error */
+    bool store(const std::vector<std::pair<int, QImage>> &images);
+    /** @brief Remove the given frames from the pack */
+    void remove(const std::set<int> &frames);
+    /** @brief Remove the pack file and all its thumbnails */
+    void removeAll();
+
+    /** @brief Import the legacy per-file thumbnails of this clip found in the pack folder, and delete them
+        @param files the legacy file names for this clip */
+    void importLegacyFiles(const QStringList &files);
+
+    /** @brief Check that all the indexed records are inside the file */
+    bool checkIntegrity();
+
+private:
+    /** @brief Open the file and build the index. Returns false if the pack does not exist (or could not be read) */
+    bool openFile(bool create);
+    /** @brief Map the file in memory if it grew since last mapping */
+    bool remap();
+    void closeFile();
+    /** @brief Append records without locking or flushing */
+    bool appendRecord(int frame, const QByteArray &data);
+    /** @brief Rewrite the pack without superseded or removed records */
+    void compact();
+    QByteArray recordData(int frame) const;
+
+    QDir m_folder;
+    QString m_clipHash;
+    QFile m_file;
+    bool m_opened{false};
+    /** True if we know that the pack file does not exist */
+    bool m_missing{false};
+    uchar *m_map{nullptr};
+    qint64 m_mappedSize{0};
+    /** Size of the data in the file not referenced by the index */
+    qint64 m_wastedSize{0};
+    /** Maps a frame to the offset and size of its data in the file */
+    std::unordered_map<int, std::pair<qint64, quint32>> m_index;
+    QMutex m_mutex;
+};
@@ -0,0 +1,127 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "lib/audio/audioCorrelation.h"
+#include "lib/audio/audioCorrelationInfo.h"
+#include "lib/audio/audioEnvelope.h"
+
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QtConcurrent/QtConcurrentMap>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+// Random envelope, normalized like AudioEnvelope does
+std::vector<qint64> randomEnvelope(size_t size, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<qint64> distribution(0, 1000000);
+    std::vector<qint64> envelope(size);
+    qint64 sum = 0;
+    for (auto &value : envelope) {
+        value = distribution(generator);
+        sum += value;
+    }
+    for (auto &value : envelope) {
+        value -= sum / qint64(size);
+    }
+    return envelope;
+}
+
+int shiftOf(const std::vector<qint64> &envMain, const std::vector<qint64> &envSub)
+{
+    std::unique_ptr<AudioCorrelationInfo> info(AudioCorrelation::correlateEnvelopes(envMain, envSub));
+    return int(info->maxIndex()) - int(envSub.size());
+}
+} // namespace
+
+TEST_CASE("Audio correlation finds the shift of a child envelope", "[AudioCorrelation]")
+{
+    const std::vector<qint64> envMain = randomEnvelope(3000, 12);
+    SECTION("Short child, direct correlation")
+    {
+        const std::vector<qint64> envSub(envMain.begin() + 1200, envMain.begin() + 1350);
+        CHECK(shiftOf(envMain, envSub) == 1200);
+    }
+    SECTION("Long child, FFT correlation")
+    {
+        const std::vector<qint64> envSub(envMain.begin() + 450, envMain.begin() + 2450);
+        CHECK(shiftOf(envMain, envSub) == 450);
+    }
+}
+
+TEST_CASE("Audio envelope from levels and cache", "[AudioCorrelation]")
+{
+    SECTION("Envelope is the sum of the level points of each frame")
+    {
+        const int channels = 2;
+        const int frames = 4;
+        QVector<int16_t> levels(frames * AUDIOLEVELS_POINTS_PER_FRAME * channels);
+        for (int i = 0; i < levels.size(); ++i) {
+            levels[i] = int16_t(i / (AUDIOLEVELS_POINTS_PER_FRAME * channels) + 1);
+        }
+        const qint64 pointsPerFrame = AUDIOLEVELS_POINTS_PER_FRAME * channels;
+        const std::vector<qint64> envelope = AudioEnvelope::envelopeFromLevels(levels, channels, 1, 5);
+        REQUIRE(envelope.size() == 5);
+        CHECK(envelope[0] == 2 * pointsPerFrame);
+        CHECK(envelope[1] == 3 * pointsPerFrame);
+        CHECK(envelope[2] == 4 * pointsPerFrame);
+        // Frames after the end of the levels
+        CHECK(envelope[3] == 0);
+        CHECK(envelope[4] == 0);
+    }
+    SECTION("Envelope cache round trip")
+    {
+        QTemporaryDir dir;
+        REQUIRE(dir.isValid());
+        const QString path = dir.filePath(QStringLiteral("clip_1_25_envelope.dat"));
+        const std::vector<qint64> envelope = randomEnvelope(1000, 3);
+        REQUIRE(AudioEnvelope::saveEnvelope(path, envelope));
+        CHECK(AudioEnvelope::loadEnvelope(path) == envelope);
+        // A truncated file is rejected
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::ReadWrite));
+        file.resize(file.size() - 4);
+        file.close();
+        CHECK(AudioEnvelope::loadEnvelope(path).empty());
+        CHECK(AudioEnvelope::loadEnvelope(dir.filePath(QStringLiteral("missing.dat"))).empty());
+    }
+}
+
+TEST_CASE("Multicam audio alignment", "[.][Benchmark]")
+{
+    // 10 cameras aligned on a master recording, at 25 fps
+    const int children = 10;
+    for (size_t minutes : {5, 30, 120}) {
+        const size_t frames = minutes * 60 * 25;
+        const std::vector<qint64> envMain = randomEnvelope(frames, 1);
+        std::vector<std::vector<qint64>> envChildren;
+        for (int i = 0; i < children; ++i) {
+            // Each camera started recording a bit later and stopped a bit earlier than the master
+            const size_t start = size_t(i + 1) * 25 * 7;
+            envChildren.emplace_back(envMain.begin() + qint64(start), envMain.end() - qint64(frames / 10));
+        }
+        QElapsedTimer timer;
+        timer.start();
+        for (const auto &envSub : envChildren) {
+            shiftOf(envMain, envSub);
+        }
+        const qint64 sequential = timer.elapsed();
+        timer.restart();
+        const QList<int> shifts = QtConcurrent::blockingMapped<QList<int>>(envChildren, [&envMain](const std::vector<qint64> &envSub) {
+            return shiftOf(envMain, envSub);
+        });
+        const qint64 parallel = timer.elapsed();
+        qDebug() << "Aligning" << children << "envelopes of" << minutes << "minutes: sequential" << sequential << "ms, parallel" << parallel << "ms";
+        for (int i = 0; i < children; ++i) {
+            CHECK(shifts.at(i) == (i + 1) * 25 * 7);
+        }
+    }
+}
@@ -7,9 +7,15 @@
 #include "catch.hpp"
 #include "test_utils.hpp"
 
+#include "jobs/audiolevels/audiolevelspyramid.h"
 #include "jobs/audiolevels/audiolevelstask.h"
 #include "jobs/audiolevels/generators.h"
 
+#include <QElapsedTimer>
+#include <cmath>
+#include <random>
+#include <vector>
+
 void computePeaksTestHelper(const QVector<int16_t> &input, const QVector<int16_t> &expectedOutput, const size_t channels)
 {
     QVector<int16_t> output(expectedOutput.size());
@@ -19,6 +25,24 @@ void computePeaksTestHelper(const QVector<int16_t> &input, const QVector<int16_t
     REQUIRE(output == expectedOutput);
 }
 
+// Straightforward implementation of computePeaks, one channel at a time
+void computePeaksReference(const int16_t *in, int16_t *out, const size_t nChannels, const size_t nSamplesIn, const size_t nSamplesOut)
+{
+    const float scale = static_cast<float>(nSamplesIn) / nSamplesOut;
+    for (size_t ch = 0; ch < nChannels; ++ch) {
+        for (size_t outIdx = 0; outIdx < nSamplesOut; ++outIdx) {
+            const size_t start = outIdx * scale;
+            size_t end = (outIdx + 1) * scale;
+            if (end > nSamplesIn) end = nSamplesIn;
+            int maxValue = std::abs(int(in[start * nChannels + ch]));
+            for (size_t inIdx = start; inIdx < end; ++inIdx) {
+                maxValue = std::max(maxValue, std::abs(int(in[inIdx * nChannels + ch])));
+            }
+            out[outIdx * nChannels + ch] = int16_t(std::min(maxValue, 32767));
+        }
+    }
+}
+
 void dummyClbk(const int progress, const QVector<int16_t> &levels)
 {
     REQUIRE(progress <= 100);
@@ -114,6 +138,80 @@ TEST_CASE("computePeaks large input")
     computePeaksTestHelper(input, expectedOutput, 1);
 }
 
+TEST_CASE("computePeaks random multi channel input")
+{
+    std::mt19937 generator(12);
+    std::uniform_int_distribution<int> distribution(-32768, 32767);
+    for (size_t channels = 1; channels <= 10; ++channels) {
+        for (size_t nSamplesIn : {1, 7, 64, 1601, 1920}) {
+            QVector<int16_t> input(int(nSamplesIn * channels));
+            for (auto &sample : input) {
+                sample = int16_t(distribution(generator));
+            }
+            // Absolute value of the smallest sample does not fit in 16 bits
+            input[0] = -32768;
+            QVector<int16_t> expectedOutput(int(AUDIOLEVELS_POINTS_PER_FRAME * channels));
+            computePeaksReference(input.constData(), expectedOutput.data(), channels, nSamplesIn, AUDIOLEVELS_POINTS_PER_FRAME);
+            computePeaksTestHelper(input, expectedOutput, channels);
+        }
+    }
+}
+
+TEST_CASE("computePeaks planar float input")
+{
+    std::mt19937 generator(34);
+    std::uniform_real_distribution<float> distribution(-1.2f, 1.2f);
+    const size_t nSamplesIn = 1920;
+    for (size_t channels : {1, 2, 6}) {
+        std::vector<std::vector<float>> planes(channels, std::vector<float>(nSamplesIn));
+        std::vector<const float *> planePointers;
+        // The same samples converted to s16 the way libswresample does
+        QVector<int16_t> converted(int(nSamplesIn * channels));
+        for (size_t ch = 0; ch < channels; ++ch) {
+            for (size_t i = 0; i < nSamplesIn; ++i) {
+                const float sample = distribution(generator);
+                planes[ch][i] = sample;
+                converted[int(i * channels + ch)] = int16_t(qBound(-32768L, lrintf(sample * 32768.f), 32767L));
+            }
+            planePointers.push_back(planes[ch].data());
+        }
+        QVector<int16_t> expectedOutput(int(AUDIOLEVELS_POINTS_PER_FRAME * channels));
+        computePeaks(converted.constData(), expectedOutput.data(), channels, nSamplesIn, AUDIOLEVELS_POINTS_PER_FRAME);
+        QVector<int16_t> output(expectedOutput.size());
+        computePeaks(planePointers.data(), output.data(), channels, nSamplesIn, AUDIOLEVELS_POINTS_PER_FRAME);
+        REQUIRE(output == expectedOutput);
+    }
+}
+
+TEST_CASE("computePeaks throughput", "[.][Benchmark]")
+{
+    // One minute of 8 channels audio at 48kHz, 25 fps
+    const size_t channels = 8;
+    const size_t samplesPerFrame = 1920;
+    const size_t frames = 25 * 60;
+    std::mt19937 generator(56);
+    QVector<int16_t> input(int(samplesPerFrame * frames * channels));
+    for (auto &sample : input) {
+        sample = int16_t(generator());
+    }
+    QVector<int16_t> output(int(AUDIOLEVELS_POINTS_PER_FRAME * frames * channels));
+    QElapsedTimer timer;
+    timer.start();
+    for (size_t f = 0; f < frames; ++f) {
+        computePeaksReference(input.constData() + f * samplesPerFrame * channels, output.data() + f * AUDIOLEVELS_POINTS_PER_FRAME * channels, channels,
+                              samplesPerFrame, AUDIOLEVELS_POINTS_PER_FRAME);
+    }
+    const qint64 reference = timer.nsecsElapsed();
+    timer.restart();
+    for (size_t f = 0; f < frames; ++f) {
+        computePeaks(input.constData() + f * samplesPerFrame * channels, output.data() + f * AUDIOLEVELS_POINTS_PER_FRAME * channels, channels,
+                     samplesPerFrame, AUDIOLEVELS_POINTS_PER_FRAME);
+    }
+    const qint64 optimized = timer.nsecsElapsed();
+    qDebug() << "computePeaks on one minute of 8 channels audio:" << optimized / 1000 << "us, per channel reference:" << reference / 1000 << "us";
+    CHECK(optimized > 0);
+}
+
 TEST_CASE("generateLibav bad stream index")
 {
     const auto output = generateLibav(9999, sourcesPath + "/dataset/mono.flac", 10, 30, &dummyClbk, 0);
@@ -224,6 +322,38 @@ TEST_CASE("both methods on multiple audio streams")
     }
 }
 
+TEST_CASE("generateLibavStreams on multiple audio streams")
+{
+    pCore->setCurrentProfile(QStringLiteral("dv_pal"));
+    const auto profileFps = pCore->getCurrentFps();
+    const QString path = sourcesPath + "/dataset/lots_of_audio_streams.mkv";
+    const auto mono = generateMLT(0, "avformat", path, 1, &dummyClbk, 0);
+    const size_t lengthInFrames = mono.size() / AUDIOLEVELS_POINTS_PER_FRAME;
+    REQUIRE(lengthInFrames > 0);
+    auto clbk = [](const int streamIdx, const int progress, const QVector<int16_t> &levels) {
+        REQUIRE(streamIdx >= 0);
+        dummyClbk(progress, levels);
+    };
+    SECTION("Same result as one stream at a time")
+    {
+        const auto output = generateLibavStreams({0, 1, 2}, path, lengthInFrames, profileFps, clbk, 0, 3);
+        REQUIRE(output.size() == 3);
+        for (int streamIdx = 0; streamIdx < 3; ++streamIdx) {
+            REQUIRE(output.value(streamIdx) == generateLibav(streamIdx, path, lengthInFrames, profileFps, &dummyClbk, 0));
+        }
+    }
+    SECTION("Invalid streams are skipped")
+    {
+        const auto output = generateLibavStreams({1, 9999}, path, lengthInFrames, profileFps, clbk, 0, 2);
+        REQUIRE(output.keys() == QList<int>{1});
+    }
+    SECTION("Canceled")
+    {
+        const auto output = generateLibavStreams({0, 1}, path, lengthInFrames, profileFps, clbk, 1, 2);
+        REQUIRE(output.isEmpty());
+    }
+}
+
 TEST_CASE("(de)serialize audio levels")
 {
     const auto input = QVector<int16_t>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
@@ -234,6 +364,87 @@ TEST_CASE("(de)serialize audio levels")
     REQUIRE(deserialized == input);
 }
 
+TEST_CASE("Audio levels pyramid")
+{
+    const int channels = 2;
+    const int points = 1001;
+    std::mt19937 generator(78);
+    std::uniform_int_distribution<int> distribution(0, 32767);
+    QVector<int16_t> levels(points * channels);
+    for (auto &level : levels) {
+        level = int16_t(distribution(generator));
+    }
+    const AudioLevelsPyramid pyramid(levels, channels);
+
+    SECTION("Each level stores the maximum of 2^k points")
+    {
+        REQUIRE(pyramid.channels() == channels);
+        REQUIRE(pyramid.level(0) == levels);
+        REQUIRE(pyramid.pointCount(pyramid.levelCount() - 1) == 1);
+        for (int k = 1; k < pyramid.levelCount(); ++k) {
+            const int blockSize = 1 << k;
+            REQUIRE(pyramid.pointCount(k) == (points + blockSize - 1) / blockSize);
+            for (int i = 0; i < pyramid.pointCount(k); ++i) {
+                for (int ch = 0; ch < channels; ++ch) {
+                    int16_t expected = 0;
+                    for (int j = i * blockSize; j < std::min(points, (i + 1) * blockSize); ++j) {
+                        expected = std::max(expected, levels[j * channels + ch]);
+                    }
+                    REQUIRE(pyramid.level(k)[i * channels + ch] == expected);
+                }
+            }
+        }
+    }
+
+    SECTION("Level selection")
+    {
+        REQUIRE(pyramid.levelForDensity(0.5) == 0);
+        REQUIRE(pyramid.levelForDensity(1.9) == 0);
+        REQUIRE(pyramid.levelForDensity(2) == 1);
+        REQUIRE(pyramid.levelForDensity(7.5) == 2);
+        REQUIRE(pyramid.levelForDensity(1e9) == pyramid.levelCount() - 1);
+    }
+
+    SECTION("Peaks")
+    {
+        // Below 2 points per output point, the full resolution levels are used
+        QVector<int16_t> expected(300 * channels);
+        computePeaks(levels.constData() + 100 * channels, expected.data(), channels, 500, 300);
+        REQUIRE(pyramid.peaks(100, 500, 300) == expected);
+        // Aligned blocks give the same result as the full resolution levels
+        expected.resize(25 * channels);
+        computePeaks(levels.constData() + 128 * channels, expected.data(), channels, 800, 25);
+        REQUIRE(pyramid.peaks(128, 800, 25) == expected);
+        // Global maximum
+        const auto peak = pyramid.peaks(0, points, 1);
+        for (int ch = 0; ch < channels; ++ch) {
+            int16_t maxValue = 0;
+            for (int i = 0; i < points; ++i) {
+                maxValue = std::max(maxValue, levels[i * channels + ch]);
+            }
+            REQUIRE(peak[ch] == maxValue);
+        }
+    }
+
+    SECTION("Cache file")
+    {
+        auto tmp = QTemporaryFile();
+        REQUIRE(tmp.open());
+        AudioLevelsTask::saveLevelsToCache(tmp.fileName(), levels, pyramid);
+        AudioLevelsPyramid loaded;
+        REQUIRE(AudioLevelsTask::getLevelsFromCache(tmp.fileName(), &loaded) == levels);
+        REQUIRE(loaded.levelCount() == pyramid.levelCount());
+        for (int k = 0; k < pyramid.levelCount(); ++k) {
+            REQUIRE(loaded.level(k) == pyramid.level(k));
+        }
+        // Cache files without reduced levels are still readable
+        AudioLevelsTask::saveLevelsToCache(tmp.fileName(), levels);
+        AudioLevelsPyramid missing;
+        REQUIRE(AudioLevelsTask::getLevelsFromCache(tmp.fileName(), &missing) == levels);
+        REQUIRE(missing.isEmpty());
+    }
+}
+
 TEST_CASE("MLT noise generator")
 {
     auto xml = QTemporaryFile();
@@ -9,10 +9,18 @@
 #include "doc/docundostack.hpp"
 #include "doc/kdenlivedoc.h"
 
+#include "bin/producerlifecycle.hpp"
+#include "bin/thumbnailproducerpool.hpp"
 #include "core.h"
+#include "jobs/cliploadtask.h"
+#include "mltcontroller/clipcontroller.h"
+#include "utils/mediaprobecache.hpp"
 #include "utils/thumbnailcache.hpp"
 
+#include <QElapsedTimer>
 #include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtConcurrent/QtConcurrentMap>
 
 TEST_CASE("Cache insert-remove", "[Cache]")
 {
@@ -45,6 +53,128 @@ TEST_CASE("Cache insert-remove", "[Cache]")
         ThumbnailCache::get()->storeThumbnail(binId, 0, img, false);
         REQUIRE(ThumbnailCache::get()->checkIntegrity());
     }
+    SECTION("Volatile cache budget and counters")
+    {
+        ThumbnailCache::get()->clearCache();
+        const ThumbnailCache::CacheStats initial = ThumbnailCache::get()->volatileStats();
+        QImage img(100, 100, QImage::Format_ARGB32_Premultiplied);
+        img.fill(Qt::red);
+        // Room for about 8 thumbnails in each shard
+        ThumbnailCache::get()->setVolatileBudget(16 * 8 * img.sizeInBytes());
+        for (int i = 0; i < 1000; i++) {
+            ThumbnailCache::get()->storeThumbnail(binId, i, img, false);
+        }
+        REQUIRE(ThumbnailCache::get()->checkIntegrity());
+        ThumbnailCache::CacheStats stats = ThumbnailCache::get()->volatileStats();
+        CHECK(stats.memory <= stats.budget);
+        CHECK(stats.count < 1000);
+        CHECK(stats.evictions - initial.evictions == quint64(1000 - stats.count));
+        // The last stored thumbnail is always available
+        CHECK_FALSE(ThumbnailCache::get()->getThumbnail(binId, 999, true).isNull());
+        CHECK(ThumbnailCache::get()->getThumbnail(binId, 0, true).isNull());
+        stats = ThumbnailCache::get()->volatileStats();
+        CHECK(stats.hits - initial.hits == 1);
+        CHECK(stats.misses - initial.misses == 1);
+        ThumbnailCache::get()->invalidateThumbsForClip(binId);
+        CHECK(ThumbnailCache::get()->volatileStats().count == 0);
+        ThumbnailCache::get()->clearCache();
+    }
+    SECTION("Persistent thumbnails pack")
+    {
+        const QString thumbHash = binModel->getClipByBinID(binId)->hash();
+        REQUIRE_FALSE(thumbHash.isEmpty());
+        ThumbnailCache::get()->invalidateThumbsForClip(binId);
+        QImage img(100, 100, QImage::Format_ARGB32_Premultiplied);
+        img.fill(Qt::red);
+        for (int i = 0; i < 10; i++) {
+            ThumbnailCache::get()->storeThumbnail(binId, i * 10, img, true);
+        }
+        REQUIRE(ThumbnailCache::get()->checkIntegrity());
+        // Drop volatile cache, thumbnails must be read back from the pack
+        ThumbnailCache::get()->clearCache();
+        REQUIRE(ThumbnailCache::get()->hasThumbnail(binId, 50));
+        REQUIRE_FALSE(ThumbnailCache::get()->hasThumbnail(binId, 55));
+        QImage result = ThumbnailCache::get()->getThumbnail(binId, 50);
+        REQUIRE(result.size() == img.size());
+        REQUIRE(ThumbnailCache::get()->checkIntegrity());
+
+        // Remove some frames
+        ThumbnailCache::get()->invalidateThumbsForClip(binId, {0, 50});
+        REQUIRE_FALSE(ThumbnailCache::get()->hasThumbnail(binId, 50));
+        REQUIRE(ThumbnailCache::get()->hasThumbnail(binId, 60));
+        ThumbnailCache::get()->clearCache();
+        REQUIRE_FALSE(ThumbnailCache::get()->hasThumbnail(binId, 0));
+        REQUIRE(ThumbnailCache::get()->hasThumbnail(binId, 90));
+
+        // Legacy thumbnails (one file per frame) are migrated into the pack
+        QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+        const QString legacyFile = cacheDir.absoluteFilePath(thumbHash + QStringLiteral("#200.jpg"));
+        REQUIRE(img.save(legacyFile));
+        ThumbnailCache::get()->clearCache();
+        REQUIRE(ThumbnailCache::get()->hasThumbnail(binId, 200));
+        REQUIRE_FALSE(QFile::exists(legacyFile));
+        REQUIRE(ThumbnailCache::get()->getThumbnail(binId, 200).size() == img.size());
+        REQUIRE(ThumbnailCache::get()->checkIntegrity());
+
+        // Remove all thumbnails
+        ThumbnailCache::get()->invalidateThumbsForClip(binId);
+        REQUIRE_FALSE(ThumbnailCache::get()->hasThumbnail(binId, 90));
+        REQUIRE_FALSE(ThumbnailCache::get()->hasThumbnail(binId, 200));
+    }
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
+
+TEST_CASE("Thumbnail cache contention", "[.][Benchmark]")
+{
+    auto binModel = pCore->projectItemModel();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    KdenliveDoc document(undoStack);
+    Mock<KdenliveDoc> docMock(document);
+    When(Method(docMock, getCacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+    KdenliveDoc &mockedDoc = docMock.get();
+    pCore->projectManager()->testSetDocument(&mockedDoc);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = mockedDoc.getTimeline(mockedDoc.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+
+    // Several clips, as when scrolling a timeline with many sequences
+    QStringList binIds;
+    for (int i = 0; i < 8; i++) {
+        binIds << KdenliveTests::createProducer(pCore->getProjectProfile(), "red", binModel, 2000, false);
+    }
+    QImage img(160, 90, QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::red);
+    for (const QString &binId : std::as_const(binIds)) {
+        for (int i = 0; i < 200; i++) {
+            ThumbnailCache::get()->storeThumbnail(binId, i, img, false);
+        }
+    }
+    QStringList hashes;
+    for (const QString &binId : std::as_const(binIds)) {
+        hashes << binModel->getClipByBinID(binId)->hashForThumbs();
+    }
+    const ThumbnailCache::CacheStats before = ThumbnailCache::get()->volatileStats();
+    const QVector<int> workers = {0, 1, 2, 3, 4, 5, 6, 7};
+    QElapsedTimer timer;
+    timer.start();
+    QtConcurrent::blockingMap(workers, [&binIds, &hashes](int worker) {
+        for (int round = 0; round < 50; round++) {
+            for (int i = 0; i < binIds.size(); i++) {
+                const int ix = (i + worker) % binIds.size();
+                for (int pos = 0; pos < 250; pos++) {
+                    ThumbnailCache::get()->getThumbnail(hashes.at(ix), binIds.at(ix), pos, true);
+                }
+            }
+        }
+    });
+    const qint64 elapsed = timer.nsecsElapsed();
+    const ThumbnailCache::CacheStats after = ThumbnailCache::get()->volatileStats();
+    const quint64 lookups = after.hits + after.misses - before.hits - before.misses;
+    qDebug() << "Thumbnail cache:" << lookups << "lookups from" << workers.size() << "threads in" << elapsed / 1000000 << "ms," << elapsed / qint64(lookups)
+             << "ns per lookup, hits:" << after.hits - before.hits << "misses:" << after.misses - before.misses;
+    CHECK(lookups == quint64(workers.size() * 50 * binIds.size() * 250));
+    CHECK(ThumbnailCache::get()->checkIntegrity());
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
 
@@ -87,3 +217,171 @@ TEST_CASE("getAudioKey() should dereference `ok` param", "ThumbnailCache") {
     }
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+TEST_CASE("Producer lifecycle budget", "[Cache]")
+{
+    QStringList released;
+    QString pinned;
+    ProducerLifecycle lifecycle([&released, &pinned](const QString &binId) {
+        if (binId == pinned) {
+            return false;
+        }
+        released << binId;
+        return true;
+    });
+    for (int i = 1; i <= 5; ++i) {
+        lifecycle.touch(QString::number(i), 100);
+    }
+    REQUIRE(lifecycle.openCount() == 5);
+    REQUIRE(lifecycle.openMemory() == 500);
+    // No budget, nothing is released
+    REQUIRE(lifecycle.enforceBudget() == 0);
+
+    SECTION("Least recently used producers are released first")
+    {
+        lifecycle.touch(QStringLiteral("1"), 100);
+        lifecycle.setBudget(3);
+        REQUIRE(lifecycle.enforceBudget() == 2);
+        CHECK(released == QStringList({QStringLiteral("2"), QStringLiteral("3")}));
+        CHECK(lifecycle.openCount() == 3);
+        CHECK(lifecycle.openMemory() == 300);
+        CHECK(lifecycle.isOpen(QStringLiteral("1")));
+        CHECK_FALSE(lifecycle.isOpen(QStringLiteral("2")));
+        // Using a released producer again reopens it
+        lifecycle.touch(QStringLiteral("2"), 100);
+        CHECK(lifecycle.reopenCount() == 1);
+        CHECK(lifecycle.releaseCount() == 2);
+    }
+
+    SECTION("Producers in use are kept open")
+    {
+        pinned = QStringLiteral("1");
+        lifecycle.setBudget(4);
+        REQUIRE(lifecycle.enforceBudget() == 1);
+        CHECK(released == QStringList({QStringLiteral("2")}));
+        CHECK(lifecycle.isOpen(QStringLiteral("1")));
+    }
+
+    SECTION("Removed clips are forgotten")
+    {
+        lifecycle.remove(QStringLiteral("3"));
+        CHECK(lifecycle.openCount() == 4);
+        CHECK(lifecycle.openMemory() == 400);
+        lifecycle.clear();
+        CHECK(lifecycle.openCount() == 0);
+        CHECK(lifecycle.openMemory() == 0);
+    }
+}
+
+TEST_CASE("Thumbnail producer pool", "[Cache]")
+{
+    Mlt::Profile profile;
+    auto makeProducer = [&profile]() { return std::make_unique<Mlt::Producer>(profile, "color", "red"); };
+    ThumbnailProducerPool pool(3, 2);
+    const QString binId = QStringLiteral("1");
+    const QByteArray source("<producer color red/>");
+    // Nothing to reuse yet
+    REQUIRE(pool.take(binId, source, 0) == nullptr);
+
+    SECTION("The producer closest before the requested frame is reused")
+    {
+        auto first = makeProducer();
+        auto second = makeProducer();
+        Mlt::Producer *secondPtr = second.get();
+        pool.release(binId, source, std::move(first), 10);
+        pool.release(binId, source, std::move(second), 100);
+        REQUIRE(pool.idleCount() == 2);
+        auto reused = pool.take(binId, source, 120);
+        CHECK(reused.get() == secondPtr);
+        CHECK(pool.idleCount() == 1);
+        CHECK(pool.reuseCount() == 1);
+        // Only a producer after the requested frame is left
+        CHECK(pool.take(binId, source, 5) != nullptr);
+        CHECK(pool.take(binId, source, 5) == nullptr);
+    }
+
+    SECTION("Producers of a changed clip are discarded")
+    {
+        pool.release(binId, source, makeProducer(), 10);
+        const QByteArray newSource("<producer color blue/>");
+        CHECK(pool.take(binId, newSource, 10) == nullptr);
+        CHECK(pool.idleCount() == 0);
+        // A producer taken before the change is not kept
+        pool.release(binId, source, makeProducer(), 10);
+        CHECK(pool.idleCount() == 0);
+        pool.release(binId, newSource, makeProducer(), 10);
+        CHECK(pool.idleCount() == 1);
+    }
+
+    SECTION("The number of idle producers is bounded")
+    {
+        for (int i = 0; i < 3; ++i) {
+            pool.release(binId, source, makeProducer(), i);
+        }
+        // Limited per clip
+        CHECK(pool.idleCount() == 2);
+        pool.release(QStringLiteral("2"), source, makeProducer(), 0);
+        pool.release(QStringLiteral("3"), source, makeProducer(), 0);
+        // Limited for all clips, the least recently used producer of clip 1 is closed
+        CHECK(pool.idleCount() == 3);
+        CHECK(pool.take(binId, source, 0) != nullptr);
+        CHECK(pool.take(binId, source, 0) == nullptr);
+        pool.remove(QStringLiteral("2"));
+        CHECK(pool.idleCount() == 1);
+        pool.clear();
+        CHECK(pool.idleCount() == 0);
+    }
+}
+
+TEST_CASE("Media probe cache hit does not open the file", "[Cache]")
+{
+    // Not a media file: any attempt to open it with avformat fails
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString resource = dir.filePath(QStringLiteral("clip.mp4"));
+    QFile file(resource);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(4096, 'x'));
+    file.close();
+    const MediaProbeCache::Properties properties = {
+        {"length", "250"}, {"seekable", "1"}, {"audio_index", "1"}, {"video_index", "0"}, {"meta.media.width", "320"}, {"meta.media.height", "240"}};
+
+    std::shared_ptr<Mlt::Producer> producer = ClipLoadTask::producerFromProbeCache(resource, properties);
+    REQUIRE(producer->is_valid());
+    CHECK(producer->get_length() == 250);
+    CHECK(producer->get_int("meta.media.width") == 320);
+
+    // Reloading the producer from its xml, like when the clip is loaded in the bin, keeps it unopened
+    const QByteArray xmlData = ClipController::producerXml(*producer.get(), true, false);
+    Mlt::Producer reloaded(pCore->getProjectProfile(), "xml-string", xmlData.constData());
+    REQUIRE(reloaded.is_valid());
+    CHECK(QString(reloaded.get("mlt_service")) == QLatin1String("avformat-novalidate"));
+    CHECK(reloaded.get_length() == 250);
+    CHECK(reloaded.get_int("meta.media.height") == 240);
+}
+
+TEST_CASE("Approximate thumbnails share their keyframe", "[Cache]")
+{
+    const std::vector<int> keyframes = {0, 25, 50};
+    const std::vector<int> frames = {3, 10, 20, 24, 40, 60};
+
+    SECTION("Exact frames are decoded at their own position")
+    {
+        const std::map<int, std::vector<int>> targets = KdenliveTests::cacheTaskTargets(frames, keyframes, true);
+        REQUIRE(targets.size() == frames.size());
+        for (int pos : frames) {
+            REQUIRE(targets.at(pos) == std::vector<int>({pos}));
+        }
+    }
+    SECTION("Frames snapped to the same keyframe are decoded once")
+    {
+        const std::map<int, std::vector<int>> targets = KdenliveTests::cacheTaskTargets(frames, keyframes, false);
+        const std::map<int, std::vector<int>> expected = {{0, {3, 10}}, {25, {20, 24}}, {50, {40, 60}}};
+        REQUIRE(targets == expected);
+    }
+    SECTION("Without keyframe index the requested frames are kept")
+    {
+        const std::map<int, std::vector<int>> targets = KdenliveTests::cacheTaskTargets(frames, {}, false);
+        REQUIRE(targets.size() == frames.size());
+    }
+}
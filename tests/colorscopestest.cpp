@@ -9,6 +9,12 @@
 #include "scopes/colorscopes/waveformgenerator.h"
 #include "scopes/colorscopes/rgbparadegenerator.h"
 #include "scopes/colorscopes/histogramgenerator.h"
+#include "scopes/colorscopes/scopeframe.h"
+
+#include <QElapsedTimer>
+#include <cmath>
+#include <random>
+#include <vector>
 
 // test for a bug where pixels were assumed to be RGB which was not true on
 // Windows, resulting in red and blue switched. BUG: 453149
@@ -69,3 +75,234 @@ TEST_CASE("Colorscope RGB/BGR handling")
         CHECK(rgbScope == bgrScope);
     }
 }
+
+TEST_CASE("Colorscope shared frame analysis")
+{
+    QImage inputImage(480, 320, QImage::Format_RGB32);
+    inputImage.fill(QColor(200, 100, 50));
+    const QSize scopeSize{256, 256};
+
+    SECTION("Large frames are decimated")
+    {
+        QImage largeImage = inputImage.scaled(3840, 2160).convertToFormat(QImage::Format_RGBA8888);
+        ScopeFrame frame(largeImage, 1920 * 1080);
+        CHECK(frame.image().size() == QSize(1920, 1080));
+        CHECK(frame.image().pixel(0, 0) == inputImage.pixel(0, 0));
+        // Small frames are kept as is
+        ScopeFrame smallFrame(inputImage, 1920 * 1080);
+        CHECK(smallFrame.image().size() == inputImage.size());
+    }
+
+    SECTION("Luma plane")
+    {
+        ScopeFrame frame(inputImage);
+        frame.computePlanes(ScopeFrame::Plane_LumaRec709);
+        const float *luma = frame.luma(ITURec::Rec_709);
+        const float expected = REC_709_R * 200 + REC_709_G * 100 + REC_709_B * 50;
+        CHECK(luma[0] == expected);
+        CHECK(luma[inputImage.width() * inputImage.height() - 1] == expected);
+        CHECK(frame.luma(ITURec::Rec_601)[0] == REC_601_R * 200 + REC_601_G * 100 + REC_601_B * 50);
+    }
+
+    SECTION("Scopes give the same result from a shared frame")
+    {
+        ScopeFrame frame(inputImage);
+        WaveformGenerator waveform{};
+        CHECK(waveform.calculateWaveform(scopeSize, 1., frame, WaveformGenerator::PaintMode_Green, true, ITURec::Rec_601) ==
+              waveform.calculateWaveform(scopeSize, 1., inputImage, WaveformGenerator::PaintMode_Green, true, ITURec::Rec_601));
+        HistogramGenerator histogram{};
+        const int components = HistogramGenerator::ComponentY | HistogramGenerator::ComponentR;
+        CHECK(histogram.calculateHistogram(scopeSize, 1., frame, components, ITURec::Rec_709, false, false) ==
+              histogram.calculateHistogram(scopeSize, 1., inputImage, components, ITURec::Rec_709, false, false));
+    }
+}
+
+// Per pixel implementations of the scope analysis, as done before the scanline kernels. Only the bins are computed, painting is left out.
+// They return a checksum of the bins so that the work is not optimized away.
+quint64 waveformReference(const QImage &image, const QSize &scopeSize, ITURec rec)
+{
+    const uint scopeW = scopeSize.width() - 2 * WaveformGenerator::distBorder;
+    const uint scopeH = scopeSize.height() - 2 * WaveformGenerator::distBorder;
+    std::vector<std::vector<uint>> waveValues(size_t(scopeW), std::vector<uint>(size_t(scopeH), 0));
+    const float hPrediv = (scopeH - 1) / 255.f;
+    const float wPrediv = (scopeW - 1) / float(image.width() - 1);
+    const int totalPixels = image.width() * image.height();
+    for (int i = 0; i < totalPixels; ++i) {
+        const int x = i % image.width();
+        const QRgb pixel = image.pixel(x, i / image.width());
+        float dY;
+        if (rec == ITURec::Rec_601) {
+            dY = REC_601_R * qRed(pixel) + REC_601_G * qGreen(pixel) + REC_601_B * qBlue(pixel);
+        } else {
+            dY = REC_709_R * qRed(pixel) + REC_709_G * qGreen(pixel) + REC_709_B * qBlue(pixel);
+        }
+        waveValues[size_t(x * wPrediv)][size_t(dY * hPrediv)]++;
+    }
+    quint64 sum = 0;
+    for (size_t i = 0; i < waveValues.size(); ++i) {
+        for (size_t j = 0; j < waveValues[i].size(); ++j) {
+            sum += waveValues[i][j] * (i + j);
+        }
+    }
+    return sum;
+}
+
+quint64 paradeReference(const QImage &image, const QSize &scopeSize)
+{
+    struct Bins
+    {
+        uint r, g, b;
+    };
+    const uint partW = (scopeSize.width() - 2 * 8 - RGBParadeGenerator::distRight - 2 * RGBParadeGenerator::distBorder) / 3;
+    std::vector<std::vector<Bins>> paradeVals(partW, std::vector<Bins>(256, {0, 0, 0}));
+    const float wPrediv = float(partW - 1) / (image.width() - 1);
+    const int totalPixels = image.width() * image.height();
+    for (int i = 0; i < totalPixels; ++i) {
+        const int x = i % image.width();
+        const QRgb pixel = image.pixel(x, i / image.width());
+        const size_t dx = size_t(x * double(wPrediv));
+        paradeVals[dx][qRed(pixel)].r++;
+        paradeVals[dx][qGreen(pixel)].g++;
+        paradeVals[dx][qBlue(pixel)].b++;
+    }
+    quint64 sum = 0;
+    for (size_t i = 0; i < paradeVals.size(); ++i) {
+        for (size_t j = 0; j < 256; ++j) {
+            sum += (paradeVals[i][j].r + 2 * paradeVals[i][j].g + 3 * paradeVals[i][j].b) * (i + j);
+        }
+    }
+    return sum;
+}
+
+quint64 histogramReference(const QImage &image, ITURec rec)
+{
+    std::vector<int> r(256, 0), g(256, 0), b(256, 0), y(256, 0), s(766, 0);
+    for (int Y = 0; Y < image.height(); ++Y) {
+        for (int X = 0; X < image.width(); ++X) {
+            const QRgb col = image.pixel(X, Y);
+            r[qRed(col)]++;
+            g[qGreen(col)]++;
+            b[qBlue(col)]++;
+            if (rec == ITURec::Rec_601) {
+                y[int(REC_601_R * qRed(col) + REC_601_G * qGreen(col) + REC_601_B * qBlue(col))]++;
+            } else {
+                y[int(REC_709_R * qRed(col) + REC_709_G * qGreen(col) + REC_709_B * qBlue(col))]++;
+            }
+            s[qRed(col)]++;
+            s[qGreen(col)]++;
+            s[qBlue(col)]++;
+        }
+    }
+    quint64 sum = 0;
+    for (size_t i = 0; i < 256; ++i) {
+        sum += (r[i] + 2 * g[i] + 3 * b[i] + 4 * y[i]) * i;
+    }
+    for (size_t i = 0; i < s.size(); ++i) {
+        sum += s[i] * i;
+    }
+    return sum;
+}
+
+quint64 vectorscopeReference(const QImage &image, const QSize &scopeSize)
+{
+    // Green2 paint mode in the YUV color space, the scope is accumulated with QImage::pixel / setPixel
+    const int cw = qMin(scopeSize.width(), scopeSize.height());
+    QImage baseScope(cw, cw, QImage::Format_ARGB32);
+    baseScope.fill(qRgba(0, 0, 0, 0));
+    const double avgPxPerPx = double(image.depth()) / 8 * (image.bytesPerLine() * image.height()) / cw / cw;
+    const int totalPixels = image.width() * image.height();
+    for (int i = 0; i < totalPixels; ++i) {
+        const QRgb pixel = image.pixel(i % image.width(), i / image.width());
+        const double u = -0.0005781 * qRed(pixel) - 0.001135 * qGreen(pixel) + 0.001713 * qBlue(pixel);
+        const double v = 0.002411 * qRed(pixel) - 0.002019 * qGreen(pixel) - 0.0003921 * qBlue(pixel);
+        const QPoint pt(int((scopeSize.width() - 1) * (VectorscopeGenerator::scaling * u + 1) / 2),
+                        int((scopeSize.height() - 1) * (1 - (VectorscopeGenerator::scaling * v + 1) / 2)));
+        if (pt.x() >= cw || pt.x() < 0 || pt.y() >= cw || pt.y() < 0) {
+            continue;
+        }
+        const QRgb px = baseScope.pixel(pt);
+        baseScope.setPixel(pt, qRgba(qRed(px) + int(ceil((255 - qRed(px)) / (4 * avgPxPerPx))), 255, qBlue(px) + int(ceil((255 - qBlue(px)) / (avgPxPerPx))),
+                                     qAlpha(px) + int(ceil((255 - qAlpha(px)) / (avgPxPerPx)))));
+    }
+    quint64 sum = 0;
+    for (int y = 0; y < cw; ++y) {
+        for (int x = 0; x < cw; ++x) {
+            sum += qAlpha(baseScope.pixel(x, y));
+        }
+    }
+    return sum;
+}
+
+TEST_CASE("Colorscope generation time", "[.][Benchmark]")
+{
+    const QSize scopeSize{720, 400};
+    const qreal scalingFactor = 1.0;
+    for (const QSize &frameSize : {QSize(1920, 1080), QSize(3840, 2160)}) {
+        // Noise, so that all bins are used
+        QImage inputImage(frameSize, QImage::Format_RGB32);
+        std::mt19937 generator(42);
+        for (int y = 0; y < inputImage.height(); ++y) {
+            auto *line = reinterpret_cast<QRgb *>(inputImage.scanLine(y));
+            for (int x = 0; x < inputImage.width(); ++x) {
+                line[x] = 0xff000000 | (generator() & 0xffffff);
+            }
+        }
+        const int runs = 10;
+        QElapsedTimer timer;
+
+        WaveformGenerator waveform{};
+        timer.start();
+        for (int i = 0; i < runs; ++i) {
+            QImage scope = waveform.calculateWaveform(scopeSize, scalingFactor, inputImage, WaveformGenerator::PaintMode::PaintMode_Green, true, ITURec::Rec_709);
+            REQUIRE_FALSE(scope.isNull());
+        }
+        qDebug() << "Waveform" << frameSize << ":" << timer.elapsed() / double(runs) << "ms per frame";
+        timer.restart();
+        for (int i = 0; i < runs; ++i) {
+            REQUIRE(waveformReference(inputImage, scopeSize, ITURec::Rec_709) > 0);
+        }
+        qDebug() << "Waveform" << frameSize << ":" << timer.elapsed() / double(runs) << "ms per frame for the per pixel reference (bins only)";
+
+        RGBParadeGenerator parade{};
+        timer.restart();
+        for (int i = 0; i < runs; ++i) {
+            QImage scope = parade.calculateRGBParade(scopeSize, scalingFactor, inputImage, RGBParadeGenerator::PaintMode::PaintMode_RGB, true, false);
+            REQUIRE_FALSE(scope.isNull());
+        }
+        qDebug() << "RGB Parade" << frameSize << ":" << timer.elapsed() / double(runs) << "ms per frame";
+        timer.restart();
+        for (int i = 0; i < runs; ++i) {
+            REQUIRE(paradeReference(inputImage, scopeSize) > 0);
+        }
+        qDebug() << "RGB Parade" << frameSize << ":" << timer.elapsed() / double(runs) << "ms per frame for the per pixel reference (bins only)";
+
+        HistogramGenerator histogram{};
+        const int allComponents = HistogramGenerator::ComponentY | HistogramGenerator::ComponentR | HistogramGenerator::ComponentG |
+                                  HistogramGenerator::ComponentB | HistogramGenerator::ComponentSum;
+        timer.restart();
+        for (int i = 0; i < runs; ++i) {
+            QImage scope = histogram.calculateHistogram(scopeSize, scalingFactor, inputImage, allComponents, ITURec::Rec_709, false, false);
+            REQUIRE_FALSE(scope.isNull());
+        }
+        qDebug() << "Histogram" << frameSize << ":" << timer.elapsed() / double(runs) << "ms per frame";
+        timer.restart();
+        for (int i = 0; i < runs; ++i) {
+            REQUIRE(histogramReference(inputImage, ITURec::Rec_709) > 0);
+        }
+        qDebug() << "Histogram" << frameSize << ":" << timer.elapsed() / double(runs) << "ms per frame for the per pixel reference (bins only)";
+
+        VectorscopeGenerator vectorscope{};
+        timer.restart();
+        for (int i = 0; i < runs; ++i) {
+            QImage scope = vectorscope.calculateVectorscope(scopeSize, scalingFactor, inputImage, 1, VectorscopeGenerator::PaintMode::PaintMode_Green2,
+                                                            VectorscopeGenerator::ColorSpace::ColorSpace_YUV, false);
+            REQUIRE_FALSE(scope.isNull());
+        }
+        qDebug() << "Vectorscope" << frameSize << ":" << timer.elapsed() / double(runs) << "ms per frame";
+        timer.restart();
+        for (int i = 0; i < runs; ++i) {
+            REQUIRE(vectorscopeReference(inputImage, scopeSize) > 0);
+        }
+        qDebug() << "Vectorscope" << frameSize << ":" << timer.elapsed() / double(runs) << "ms per frame for the per pixel reference";
+    }
+}
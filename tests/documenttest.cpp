@@ -5,9 +5,13 @@
 
 #include "test_utils.hpp"
 // test specific headers
+#include "bin/projectclip.h"
 #include "doc/documentchecker.h"
+#include "doc/documentsearchindex.h"
 #include "xml/xml.hpp"
 
+#include <QTemporaryDir>
+
 TEST_CASE("Basic tests of the document checker parts", "[DocumentChecker]")
 {
     QString path = sourcesPath + "/dataset/test-mix.kdenlive";
@@ -61,3 +65,61 @@ TEST_CASE("Missing project items", "[DocumentChecker]")
         CHECK(results.value(DocumentChecker::MissingType::Proxy) == 1);
     }
 }
+
+TEST_CASE("Missing items search index", "[DocumentChecker]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    QDir root(dir.path());
+    REQUIRE(root.mkpath(QStringLiteral("a/b/c")));
+    REQUIRE(root.mkpath(QStringLiteral("d/slides")));
+    auto writeFile = [&root](const QString &name, const QByteArray &data) {
+        QFile file(root.absoluteFilePath(name));
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write(data);
+        file.close();
+    };
+    writeFile(QStringLiteral("a/b/c/clip.mp4"), QByteArray(5000, 'x'));
+    writeFile(QStringLiteral("a/clip.mp4"), QByteArray(6000, 'y'));
+    writeFile(QStringLiteral("a/b/renamed.mp4"), QByteArray(5000, 'z'));
+    writeFile(QStringLiteral("d/slides/img_0001.png"), QByteArray(100, 'i'));
+    writeFile(QStringLiteral("d/slides/img_0002.png"), QByteArray(100, 'j'));
+    const QString canonicalRoot = QFileInfo(dir.path()).canonicalFilePath();
+
+    std::atomic<bool> abort{false};
+    DocumentSearchIndex index(dir.path());
+    REQUIRE(index.build(abort));
+    CHECK(index.fileCount() == 5);
+    CHECK(index.folderCount() == 6);
+
+    SECTION("Name lookup returns the closest match")
+    {
+        CHECK(index.findFileByName(QStringLiteral("clip.mp4")) == canonicalRoot + QStringLiteral("/a/clip.mp4"));
+        CHECK(index.findFileByName(QStringLiteral("CLIP.MP4")) == canonicalRoot + QStringLiteral("/a/clip.mp4"));
+        CHECK(index.findFileByName(QStringLiteral("missing.mp4")).isEmpty());
+    }
+
+    SECTION("Hash lookup finds renamed files")
+    {
+        const QString hash = QString::fromLatin1(ProjectClip::calculateHash(root.absoluteFilePath(QStringLiteral("a/b/renamed.mp4"))).first.toHex());
+        index.prefetchHashes({5000});
+        CHECK(index.findFileByHash(5000, hash) == canonicalRoot + QStringLiteral("/a/b/renamed.mp4"));
+        CHECK(index.findFileByHash(6000, hash).isEmpty());
+    }
+
+    SECTION("Slideshow lookup")
+    {
+        CHECK(index.findSlideshowByName(QStringLiteral("/old/place/img_%04d.png")) == canonicalRoot + QStringLiteral("/d/slides/img_%04d.png"));
+        CHECK(index.findSlideshowByName(QStringLiteral("/old/slides/.all.png")) == canonicalRoot + QStringLiteral("/d/slides/.all.png"));
+        const QString hash =
+            QString::fromLatin1(ProjectClip::getFolderHash(QDir(root.absoluteFilePath(QStringLiteral("d/slides"))), QStringLiteral(".all.png")).toHex());
+        CHECK(index.findSlideshowByHash(QStringLiteral("/old/place/.all.png"), hash, abort) == canonicalRoot + QStringLiteral("/d/slides/.all.png"));
+    }
+
+    SECTION("Aborted walk")
+    {
+        abort = true;
+        DocumentSearchIndex aborted(dir.path());
+        CHECK_FALSE(aborted.build(abort));
+    }
+}
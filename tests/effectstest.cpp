@@ -12,6 +12,10 @@
 #include "effects/effectsrepository.hpp"
 #include "effects/effectstack/model/effectstackmodel.hpp"
 
+#include <QScopeGuard>
+#include <QStandardPaths>
+#include <algorithm>
+
 QString anEffect;
 TEST_CASE("Effects stack", "[Effects]")
 {
@@ -102,3 +106,59 @@ TEST_CASE("Effects stack", "[Effects]")
     clip.reset();
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+// A repository created outside of the singleton, to check the asset cache
+class CachedEffectsRepository : public EffectsRepository
+{
+public:
+    using EffectsRepository::invalidateCache;
+    // Number of assets restored from the cache whose xml was not parsed yet
+    int unparsedXml() const
+    {
+        int count = 0;
+        for (const auto &asset : m_assets) {
+            if (!asset.second.xmlData.isEmpty()) {
+                count++;
+            }
+        }
+        return count;
+    }
+};
+
+TEST_CASE("Effects repository cache", "[Effects]")
+{
+    auto sortedNames = [](const AbstractAssetsRepository<AssetListType::AssetType> &repository) {
+        QVector<QPair<QString, QString>> names = repository.getNames();
+        std::sort(names.begin(), names.end());
+        return names;
+    };
+    // Keep the cache of the user untouched, the test cache goes to a test location
+    QStandardPaths::setTestModeEnabled(true);
+    auto restore = qScopeGuard([]() { QStandardPaths::setTestModeEnabled(false); });
+    // Parse all effects, which writes the cache
+    std::unique_ptr<CachedEffectsRepository> parsed(new CachedEffectsRepository());
+    parsed->invalidateCache();
+    parsed.reset(new CachedEffectsRepository());
+    REQUIRE(parsed->unparsedXml() == 0);
+
+    // The effects are now restored from the cache, their xml is only parsed when used
+    CachedEffectsRepository cached;
+    REQUIRE(cached.unparsedXml() > 0);
+    const QVector<QPair<QString, QString>> names = sortedNames(*parsed);
+    REQUIRE(!names.isEmpty());
+    REQUIRE(sortedNames(cached) == names);
+    for (const auto &name : names) {
+        const QString &id = name.first;
+        REQUIRE(cached.getType(id) == parsed->getType(id));
+        REQUIRE(cached.getVersion(id) == parsed->getVersion(id));
+        REQUIRE(cached.getDescription(id) == parsed->getDescription(id));
+        REQUIRE(cached.isUnique(id) == parsed->isUnique(id));
+        QDomElement cachedXml = cached.getXml(id);
+        QDomElement parsedXml = parsed->getXml(id);
+        REQUIRE(cachedXml.tagName() == parsedXml.tagName());
+        REQUIRE(cachedXml.attributes().count() == parsedXml.attributes().count());
+        REQUIRE(cachedXml.attribute(QStringLiteral("id")) == parsedXml.attribute(QStringLiteral("id")));
+        REQUIRE(cachedXml.childNodes().count() == parsedXml.childNodes().count());
+    }
+    cached.invalidateCache();
+}
@@ -8,6 +8,7 @@
 #include "doc/kdenlivedoc.h"
 #include "timeline2/model/builders/meltBuilder.hpp"
 
+#include <KAutoSaveFile>
 #include <QTemporaryFile>
 #include <QUndoGroup>
 
@@ -162,6 +163,77 @@ TEST_CASE("Save File", "[SF]")
     }
 }
 
+TEST_CASE("Autosave", "[AUTOSAVE]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    QDir dir = QDir::temp();
+    const QString reloadFile = dir.absoluteFilePath(QStringLiteral("autosave-reload.kdenlive"));
+
+    SECTION("Write the autosave file")
+    {
+        pCore->setCurrentProfile(QStringLiteral("dv_pal"));
+        KdenliveDoc document(undoStack);
+        pCore->projectManager()->testSetDocument(&document);
+        QDateTime documentDate = QDateTime::currentDateTime();
+        KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+        auto timeline = document.getTimeline(document.uuid());
+        pCore->projectManager()->testSetActiveTimeline(timeline);
+        KdenliveTests::resetNextId();
+
+        QString binId = KdenliveTests::createProducer(pCore->getProjectProfile(), "red", binModel, 20, false);
+        int tid1 = timeline->getTrackIndexFromPosition(2);
+        int cid1 = -1;
+        REQUIRE(timeline->requestClipInsertion(binId, tid1, 10, cid1, true, true, false));
+        int cid2 = -1;
+        REQUIRE(timeline->requestClipInsertion(binId, tid1, 50, cid2, true, true, false));
+
+        document.m_autosave = new KAutoSaveFile(QUrl::fromLocalFile(dir.absoluteFilePath(QStringLiteral("autosave-test.kdenlive"))), &document);
+        pCore->projectManager()->testAutoSave();
+        QFile autosave(document.m_autosave->fileName());
+        REQUIRE(autosave.open(QIODevice::ReadOnly));
+        const QByteArray scene = autosave.readAll();
+        autosave.close();
+        REQUIRE(scene.contains("<track "));
+        QFile copy(reloadFile);
+        REQUIRE(copy.open(QIODevice::WriteOnly));
+        REQUIRE(copy.write(scene) == scene.size());
+        copy.close();
+        undoStack->undo();
+        undoStack->undo();
+        pCore->projectManager()->closeCurrentDocument(false, false);
+    }
+    SECTION("Reload the autosave file")
+    {
+        KdenliveTests::resetNextId();
+        QUrl openURL = QUrl::fromLocalFile(reloadFile);
+        QUndoGroup *undoGroup = new QUndoGroup();
+        undoGroup->addStack(undoStack.get());
+        DocOpenResult openResults = KdenliveDoc::Open(openURL, QDir::temp().path(), undoGroup, false, nullptr);
+        REQUIRE(openResults.isSuccessful() == true);
+
+        std::unique_ptr<KdenliveDoc> openedDoc = openResults.getDocument();
+        pCore->projectManager()->testSetDocument(openedDoc.get());
+        const QUuid uuid = openedDoc->uuid();
+        QDateTime documentDate = QFileInfo(openURL.toLocalFile()).lastModified();
+        KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+        pCore->projectManager()->testSetActiveTimeline();
+        auto timeline = openedDoc->getTimeline(uuid);
+        REQUIRE(timeline->checkConsistency());
+        int tid1 = timeline->getTrackIndexFromPosition(2);
+        REQUIRE(timeline->getTrackClipsCount(tid1) == 2);
+        int cid1 = timeline->getClipByStartPosition(tid1, 10);
+        int cid2 = timeline->getClipByStartPosition(tid1, 50);
+        REQUIRE(cid1 > -1);
+        REQUIRE(cid2 > -1);
+        REQUIRE(timeline->getClipPlaytime(cid1) == 20);
+        REQUIRE(timeline->getClipPlaytime(cid2) == 20);
+        pCore->projectManager()->closeCurrentDocument(false, false);
+        QFile::remove(reloadFile);
+    }
+}
+
 TEST_CASE("Check File Corruption", "[CFC]")
 {
     auto binModel = pCore->projectItemModel();
@@ -9,7 +9,9 @@
 #include "doc/docundostack.hpp"
 #include "doc/kdenlivedoc.h"
 #include "effects/effectstack/model/effectitemmodel.hpp"
+#include <QElapsedTimer>
 #include <memory>
+#include <mlt++/MltProperties.h>
 
 using namespace fakeit;
 
@@ -265,3 +267,126 @@ TEST_CASE("Keyframe model", "[KeyframeModel]")
     timeline.reset();
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+TEST_CASE("Keyframe interpolation cache", "[KeyframeModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+
+    const QString binId = KdenliveTests::createProducer(pCore->getProjectProfile(), "red", binModel, 1000, false);
+    std::shared_ptr<ProjectClip> clip = binModel->getClipByBinID(binId);
+    auto effectstack = clip->getEffectStack();
+    effectstack->appendEffect(QStringLiteral("audiobalance"));
+    REQUIRE(effectstack->rowCount() == 1);
+    auto effect = std::dynamic_pointer_cast<EffectItemModel>(effectstack->getEffectStackRow(0));
+    effect->prepareKeyframes();
+    QModelIndex index = effect->index(0, 0);
+    auto model = std::make_shared<KeyframeModel>(effect, index, undoStack);
+    const double fps = pCore->getCurrentFps();
+
+    REQUIRE(KdenliveTests::addKeyframe(model, GenTime(10, fps), KeyframeType::Linear, 0.2));
+    REQUIRE(KdenliveTests::addKeyframe(model, GenTime(50, fps), KeyframeType::Linear, 0.8));
+
+    SECTION("Batch evaluation matches single queries")
+    {
+        const QVector<QVariant> values = model->getInterpolatedValues(0, 80);
+        REQUIRE(values.size() == 80);
+        for (int i = 0; i < 80; ++i) {
+            CHECK(values.at(i) == model->getInterpolatedValue(i));
+        }
+        // Linear interpolation between the keyframes
+        CHECK(values.at(10).toDouble() < values.at(30).toDouble());
+        CHECK(values.at(30).toDouble() < values.at(50).toDouble());
+    }
+
+    SECTION("Cache follows keyframe changes")
+    {
+        const double before = model->getInterpolatedValue(30).toDouble();
+        REQUIRE(KdenliveTests::addKeyframe(model, GenTime(30, fps), KeyframeType::Linear, 0.1));
+        CHECK(model->getInterpolatedValue(40).toDouble() < before);
+        undoStack->undo();
+        CHECK(model->getInterpolatedValue(30).toDouble() == Approx(before));
+    }
+
+    SECTION("Sparse batch matches single queries")
+    {
+        const std::vector<int> frames{0, 10, 25, 25, 49, 79};
+        const QVector<QVariant> values = model->getInterpolatedValues(frames);
+        REQUIRE(values.size() == int(frames.size()));
+        for (size_t i = 0; i < frames.size(); ++i) {
+            CHECK(values.at(int(i)) == model->getInterpolatedValue(frames.at(i)));
+        }
+    }
+
+    SECTION("Cache follows external parameter changes")
+    {
+        REQUIRE(model->getInterpolatedValue(20).toDouble() < model->getInterpolatedValue(40).toDouble());
+        const QString name = effect->data(index, AssetParameterModel::NameRole).toString();
+        effect->setParameter(name, QStringLiteral("10=0.2;50=0.2"), false, index);
+        model->refresh();
+        CHECK(model->getInterpolatedValue(20).toDouble() == Approx(model->getInterpolatedValue(40).toDouble()));
+    }
+
+    clip.reset();
+    timeline.reset();
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
+
+TEST_CASE("Keyframe interpolation with dense keyframes", "[.][Benchmark]")
+{
+    auto binModel = pCore->projectItemModel();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+
+    // Tracking data: one keyframe every 2 frames
+    const int frames = 4000;
+    const QString binId = KdenliveTests::createProducer(pCore->getProjectProfile(), "red", binModel, frames, false);
+    std::shared_ptr<ProjectClip> clip = binModel->getClipByBinID(binId);
+    auto effectstack = clip->getEffectStack();
+    effectstack->appendEffect(QStringLiteral("audiobalance"));
+    auto effect = std::dynamic_pointer_cast<EffectItemModel>(effectstack->getEffectStackRow(0));
+    effect->prepareKeyframes();
+    QModelIndex index = effect->index(0, 0);
+    auto model = std::make_shared<KeyframeModel>(effect, index, undoStack);
+    const double fps = pCore->getCurrentFps();
+    for (int i = 2; i < frames; i += 2) {
+        KdenliveTests::addKeyframe(model, GenTime(i, fps), KeyframeType::Linear, (i % 100) / 100.);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    // Previous behavior: parse the whole animation for each query
+    for (int i = 1; i < frames; i += 2) {
+        Mlt::Properties props;
+        props.set("key", effect->data(index, AssetParameterModel::ValueRole).toString().toUtf8().constData());
+        (void)props.anim_get_double("key", 0, frames);
+        (void)props.anim_get_double("key", i);
+    }
+    const qint64 reparse = timer.elapsed();
+    timer.restart();
+    for (int i = 1; i < frames; i += 2) {
+        (void)model->getInterpolatedValue(i);
+    }
+    const qint64 cached = timer.elapsed();
+    timer.restart();
+    const QVector<QVariant> values = model->getInterpolatedValues(0, frames);
+    const qint64 batch = timer.elapsed();
+    qDebug() << "Interpolating" << frames / 2 << "frames between" << model->rowCount() << "keyframes: reparse" << reparse << "ms, cached" << cached
+             << "ms, batch of" << values.size() << "frames" << batch << "ms";
+    CHECK(values.size() == frames);
+
+    clip.reset();
+    timeline.reset();
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
@@ -10,6 +10,8 @@
 
 #include "core.h"
 
+#include <QElapsedTimer>
+
 using namespace fakeit;
 
 TEST_CASE("Cut undo/redo", "[MoveClips]")
@@ -108,3 +110,137 @@ TEST_CASE("Cut undo/redo", "[MoveClips]")
     }
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+TEST_CASE("Clip range queries", "[MoveClips]")
+{
+    // Create timeline
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    // Create document
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+
+    int tid = timeline->getTrackIndexFromPosition(3);
+    QString binId = KdenliveTests::createProducer(pCore->getProjectProfile(), "red", binModel, 20, false);
+
+    // Insert 100 clips of 20 frames, separated by a 10 frames blank
+    std::vector<int> clips;
+    for (int i = 0; i < 100; i++) {
+        int cid;
+        REQUIRE(timeline->requestClipInsertion(binId, tid, i * 30, cid));
+        clips.push_back(cid);
+    }
+
+    // Compare the indexed query with a plain scan of all clips
+    auto checkRanges = [&]() {
+        for (int start = 0; start < 3100; start += 7) {
+            for (int end : {-1, start + 1, start + 15, start + 100}) {
+                std::unordered_set<int> expected;
+                for (int cid : clips) {
+                    if (timeline->getClipTrackId(cid) != tid) {
+                        continue;
+                    }
+                    int pos = timeline->getClipPosition(cid);
+                    int length = timeline->getClipPlaytime(cid);
+                    if (end > -1 && pos >= end) {
+                        continue;
+                    }
+                    if (pos + length - 1 >= start) {
+                        expected.insert(cid);
+                    }
+                }
+                if (timeline->getItemsInRange(tid, start, end, false) != expected) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    REQUIRE(checkRanges());
+
+    SECTION("Resize and move clips")
+    {
+        // Shrink and extend on both sides
+        REQUIRE(timeline->requestItemResize(clips[10], 12, true) == 12);
+        REQUIRE(timeline->requestItemResize(clips[20], 15, false) == 15);
+        REQUIRE(timeline->requestItemResize(clips[30], 25, true) == 25);
+        REQUIRE(timeline->requestItemResize(clips[40], 28, false) == 28);
+        REQUIRE(checkRanges());
+        // Move clips in the blanks left by the resizes and at the end of the track
+        REQUIRE(timeline->requestClipMove(clips[50], tid, 3200));
+        REQUIRE(timeline->requestClipMove(clips[51], tid, 1500));
+        REQUIRE(checkRanges());
+        REQUIRE(timeline->checkConsistency());
+
+        // Delete a clip
+        REQUIRE(timeline->requestItemDeletion(clips[60]));
+        REQUIRE(checkRanges());
+
+        undoStack->undo();
+        undoStack->undo();
+        undoStack->undo();
+        REQUIRE(checkRanges());
+        undoStack->redo();
+        undoStack->redo();
+        undoStack->redo();
+        REQUIRE(checkRanges());
+        REQUIRE(timeline->checkConsistency());
+    }
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
+
+TEST_CASE("Group move latency vs clip count", "[.][Benchmark]")
+{
+    // Create timeline
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    // Create document
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+
+    int tid = timeline->getTrackIndexFromPosition(3);
+    QString binId = KdenliveTests::createProducer(pCore->getProjectProfile(), "red", binModel, 20, false);
+
+    std::vector<int> clips;
+    for (int count : {250, 1000, 3000}) {
+        // Fill the track up to count clips of 10 frames, separated by a 2 frames blank
+        while (int(clips.size()) < count) {
+            int cid;
+            REQUIRE(timeline->requestClipInsertion(binId, tid, int(clips.size()) * 12, cid, false));
+            REQUIRE(timeline->requestItemResize(cid, 10, true, false) == 10);
+            clips.push_back(cid);
+        }
+        // Group the 50 clips in the middle of the track
+        std::unordered_set<int> ids;
+        for (int i = count / 2; i < count / 2 + 50; i++) {
+            ids.insert(clips[size_t(i)]);
+        }
+        int gid = timeline->requestClipsGroup(ids, false);
+        REQUIRE(gid > -1);
+        int movedClip = clips[size_t(count / 2)];
+
+        const int moves = 100;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < moves; i++) {
+            REQUIRE(timeline->requestGroupMove(movedClip, gid, 0, i % 2 == 0 ? 1 : -1, true, true, false));
+        }
+        qint64 elapsed = timer.nsecsElapsed();
+        qDebug() << "::: Group move of 50 clips on a track with" << count << "clips:" << (elapsed / moves / 1000) << "µs per move";
+        REQUIRE(timeline->requestClipUngroup(movedClip, false));
+    }
+    REQUIRE(timeline->checkConsistency());
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
@@ -291,3 +291,50 @@ TEST_CASE("Tests of the render functions to use guides for sections", "[RenderRe
         CHECK(model2->isValid() == false);
     }
 }
+
+TEST_CASE("Tests of the split points used for segmented rendering", "[RenderRequestSegments]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> markerModel(new MarkerListModel(QString(), undoStack));
+    markerModel->loadCategories(KdenliveDoc::getDefaultGuideCategories(), false);
+
+    RenderRequest *r = new RenderRequest();
+    KdenliveTests::setRenderRequestBounds(r, 0, 2999);
+    r->setGuideParams(markerModel, false, -1);
+
+    SECTION("Even split without guides")
+    {
+        r->setSegmentCount(4);
+        QVector<std::pair<int, int>> segments = r->getSegmentsInOut();
+        REQUIRE(segments.size() == 4);
+        CHECK(segments.at(0) == std::make_pair(0, 749));
+        CHECK(segments.at(1) == std::make_pair(750, 1499));
+        CHECK(segments.at(2) == std::make_pair(1500, 2249));
+        CHECK(segments.at(3) == std::make_pair(2250, 2999));
+    }
+
+    SECTION("Split points move to close guides")
+    {
+        // Close to the first split point
+        markerModel->addMarker(GenTime(800, pCore->getCurrentFps()), QStringLiteral("scene"), 0);
+        // Too far from any split point
+        markerModel->addMarker(GenTime(2000, pCore->getCurrentFps()), QStringLiteral("scene"), 0);
+        r->setSegmentCount(4);
+        QVector<std::pair<int, int>> segments = r->getSegmentsInOut();
+        REQUIRE(segments.size() == 4);
+        CHECK(segments.at(0) == std::make_pair(0, 799));
+        CHECK(segments.at(1) == std::make_pair(800, 1499));
+        CHECK(segments.at(2) == std::make_pair(1500, 2249));
+        CHECK(segments.at(3) == std::make_pair(2250, 2999));
+    }
+
+    SECTION("Short ranges are not split")
+    {
+        r->setSegmentCount(4);
+        KdenliveTests::setRenderRequestBounds(r, 100, 299);
+        QVector<std::pair<int, int>> segments = r->getSegmentsInOut();
+        REQUIRE(segments.size() == 1);
+        CHECK(segments.at(0) == std::make_pair(100, 299));
+    }
+    delete r;
+}
@@ -10,6 +10,7 @@
 #include "definitions.h"
 #include "doc/docundostack.hpp"
 #include "doc/kdenlivedoc.h"
+#include <QElapsedTimer>
 #include <qjsonarray.h>
 
 using namespace fakeit;
@@ -259,6 +260,81 @@ surrounded by whitespace
         REQUIRE(subtitleModel->rowCount() == 0);
     }
 
+    SECTION("Row and position lookups")
+    {
+        int subId = KdenliveTests::getNextId();
+        int subId2 = KdenliveTests::getNextId();
+        int subId3 = KdenliveTests::getNextId();
+        double fps = pCore->getCurrentFps();
+        REQUIRE(subtitleModel->addSubtitle(subId, {0, GenTime(0, fps)},
+                                           SubtitleEvent(true, GenTime(500, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Long")), false, false));
+        REQUIRE(subtitleModel->addSubtitle(subId2, {0, GenTime(100, fps)},
+                                           SubtitleEvent(true, GenTime(120, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Second")), false, false));
+        REQUIRE(subtitleModel->addSubtitle(subId3, {0, GenTime(200, fps)},
+                                           SubtitleEvent(true, GenTime(220, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Third")), false, false));
+        // Re-insert the middle subtitle, like an undo would, rows stay ordered by id
+        REQUIRE(subtitleModel->removeSubtitle(subId2));
+        REQUIRE(subtitleModel->getSubtitleIndex(subId3) == 1);
+        REQUIRE(subtitleModel->addSubtitle(subId2, {0, GenTime(100, fps)},
+                                           SubtitleEvent(true, GenTime(120, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Second")), false, false));
+        REQUIRE(subtitleModel->getSubtitleIndex(subId) == 0);
+        REQUIRE(subtitleModel->getSubtitleIndex(subId2) == 1);
+        REQUIRE(subtitleModel->getSubtitleIndex(subId3) == 2);
+        REQUIRE(subtitleModel->getSubtitleIdFromIndex(1).first == subId2);
+        REQUIRE(subtitleModel->data(subtitleModel->index(2), SubtitleModel::SubtitleRole).toString() == QStringLiteral("Third"));
+        REQUIRE(subtitleModel->getNextSub(subId) == subId2);
+        REQUIRE(subtitleModel->getPreviousSub(subId3) == subId2);
+        REQUIRE(subtitleModel->getSubtitleIdByPosition(0, 200) == subId3);
+        // The first subtitle covers the whole range
+        REQUIRE(subtitleModel->getItemsInRange(0, 300, 300) == std::unordered_set<int>({subId}));
+        REQUIRE(subtitleModel->getItemsInRange(-1, 110, 210) == std::unordered_set<int>({subId, subId2, subId3}));
+        REQUIRE(subtitleModel->moveSubtitle(subId3, 0, GenTime(300, fps), false, false));
+        REQUIRE(subtitleModel->getSubtitleIdByPosition(0, 200) == -1);
+        REQUIRE(subtitleModel->getSubtitleIdByPosition(0, 300) == subId3);
+        REQUIRE(subtitleModel->getItemsInRange(0, 310, 310) == std::unordered_set<int>({subId, subId3}));
+        subtitleModel->removeAllSubtitles();
+        REQUIRE(subtitleModel->rowCount() == 0);
+    }
+
+    SECTION("Subtitle edits are flushed to the work file")
+    {
+        int subId = KdenliveTests::getNextId();
+        int subId2 = KdenliveTests::getNextId();
+        int subId3 = KdenliveTests::getNextId();
+        double fps = pCore->getCurrentFps();
+        REQUIRE(subtitleModel->addSubtitle(subId, {0, GenTime(0, fps)},
+                                           SubtitleEvent(true, GenTime(50, fps), "Default", "", 0, 0, 0, "", QStringLiteral("First")), false, true));
+        REQUIRE(subtitleModel->addSubtitle(subId2, {0, GenTime(100, fps)},
+                                           SubtitleEvent(true, GenTime(120, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Second")), false, true));
+        REQUIRE(subtitleModel->addSubtitle(subId3, {0, GenTime(200, fps)},
+                                           SubtitleEvent(true, GenTime(220, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Third")), false, true));
+        REQUIRE(subtitleModel->moveSubtitle(subId3, 0, GenTime(300, fps), true, false));
+        REQUIRE(subtitleModel->editSubtitle(subId, QStringLiteral("First\nline")));
+        REQUIRE(subtitleModel->editSubtitle(subId2, QStringLiteral("Edited")));
+        const QString workFile = document.subTitlePath(timeline->uuid(), 0, false);
+        QFile work(workFile);
+        // No event loop runs here, so the update timer did not fire and the last edit is still pending
+        if (work.open(QIODevice::ReadOnly)) {
+            CHECK_FALSE(work.readAll().contains("Edited"));
+            work.close();
+        }
+        subtitleModel->syncSubtitleFile();
+
+        // The work file has the same content as the former synchronous rewrite through the json representation
+        QTemporaryFile expected(QDir::temp().absoluteFilePath(QStringLiteral("XXXXXX.ass")));
+        REQUIRE(expected.open());
+        expected.close();
+        REQUIRE(subtitleModel->saveSubtitleData(subtitleModel->toJson(), expected.fileName()) == 3);
+        REQUIRE(expected.open());
+        REQUIRE(work.open(QIODevice::ReadOnly));
+        const QByteArray content = work.readAll();
+        CHECK(content.contains("Edited"));
+        CHECK(content == expected.readAll());
+
+        subtitleModel->removeAllSubtitles();
+        REQUIRE(subtitleModel->rowCount() == 0);
+    }
+
     SECTION("Read start/end time of the subtitles")
     {
         // srt
@@ -321,3 +397,112 @@ surrounded by whitespace
     binModel->clean();
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+TEST_CASE("Subtitle edit latency", "[.][Benchmark]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    pCore->setCurrentProfile(QStringLiteral("dv_pal"));
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+    KdenliveTests::resetNextId();
+    document.setDocumentProperty(QStringLiteral("documentid"), QString::number(QDateTime::currentMSecsSinceEpoch()));
+    std::shared_ptr<SubtitleModel> subtitleModel = timeline->createSubtitleModel();
+    double fps = pCore->getCurrentFps();
+    const int edits = 50;
+
+    for (int count : {500, 1000, 3000}) {
+        std::vector<int> ids;
+        for (int i = 0; i < count; i++) {
+            int subId = KdenliveTests::getNextId();
+            const QString text = QStringLiteral("Subtitle %1").arg(i);
+            REQUIRE(subtitleModel->addSubtitle(subId, {0, GenTime(i * 50, fps)},
+                                               SubtitleEvent(true, GenTime(i * 50 + 40, fps), "Default", "", 0, 0, 0, "", text), false, false));
+            ids.push_back(subId);
+        }
+        subtitleModel->syncSubtitleFile();
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < edits; i++) {
+            REQUIRE(subtitleModel->editSubtitle(ids.at(size_t(i * count / edits)), QStringLiteral("Edited %1").arg(i)));
+        }
+        const qint64 editTime = timer.nsecsElapsed();
+        timer.restart();
+        subtitleModel->syncSubtitleFile();
+        const qint64 syncTime = timer.nsecsElapsed();
+        // Cost of one full rewrite through the json representation, as was done for each edit
+        QTemporaryFile tmp(QDir::temp().absoluteFilePath(QStringLiteral("XXXXXX.ass")));
+        REQUIRE(tmp.open());
+        timer.restart();
+        subtitleModel->saveSubtitleData(subtitleModel->toJson(), tmp.fileName());
+        const qint64 rewriteTime = timer.nsecsElapsed();
+        qDebug() << count << "subtitles, per edit:" << editTime / edits / 1000 << "us, file update:" << syncTime / 1000
+                 << "us, json rewrite:" << rewriteTime / 1000 << "us";
+        CHECK(editTime > 0);
+        subtitleModel->removeAllSubtitles();
+        REQUIRE(subtitleModel->rowCount() == 0);
+    }
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
+
+TEST_CASE("Subtitle row lookups", "[.][Benchmark]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    pCore->setCurrentProfile(QStringLiteral("dv_pal"));
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+    KdenliveTests::resetNextId();
+    document.setDocumentProperty(QStringLiteral("documentid"), QString::number(QDateTime::currentMSecsSinceEpoch()));
+    std::shared_ptr<SubtitleModel> subtitleModel = timeline->createSubtitleModel();
+    double fps = pCore->getCurrentFps();
+
+    const int count = 10000;
+    std::vector<int> ids;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < count; i++) {
+        int subId = KdenliveTests::getNextId();
+        const QString text = QStringLiteral("Subtitle %1").arg(i);
+        REQUIRE(subtitleModel->addSubtitle(subId, {0, GenTime(i * 50, fps)},
+                                           SubtitleEvent(true, GenTime(i * 50 + 40, fps), "Default", "", 0, 0, 0, "", text), false, false));
+        ids.push_back(subId);
+    }
+    const qint64 addTime = timer.nsecsElapsed();
+    timer.restart();
+    // What a view does when it is populated
+    for (int row = 0; row < count; row++) {
+        const QModelIndex ix = subtitleModel->index(row);
+        REQUIRE(subtitleModel->data(ix, SubtitleModel::IdRole).toInt() == ids.at(size_t(row)));
+        subtitleModel->data(ix, SubtitleModel::StartFrameRole);
+        subtitleModel->data(ix, SubtitleModel::EndFrameRole);
+    }
+    const qint64 dataTime = timer.nsecsElapsed();
+    timer.restart();
+    for (int i = 0; i < count; i++) {
+        REQUIRE(subtitleModel->getSubtitleIndex(ids.at(size_t(i))) == i);
+        subtitleModel->getNextSub(ids.at(size_t(i)));
+    }
+    const qint64 lookupTime = timer.nsecsElapsed();
+    timer.restart();
+    for (int i = 0; i < count; i += 10) {
+        REQUIRE(subtitleModel->getItemsInRange(-1, i * 50 + 10, i * 50 + 10).size() == 1);
+    }
+    const qint64 rangeTime = timer.nsecsElapsed();
+    qDebug() << count << "subtitles, add:" << addTime / 1000000 << "ms, data for all rows:" << dataTime / 1000000
+             << "ms, row and next lookups:" << lookupTime / 1000000 << "ms, range queries:" << rangeTime / 1000000 << "ms";
+    CHECK(dataTime > 0);
+    subtitleModel->removeAllSubtitles();
+    REQUIRE(subtitleModel->rowCount() == 0);
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
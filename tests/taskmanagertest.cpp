@@ -0,0 +1,147 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "jobs/taskmanager.h"
+
+#include <QMutex>
+#include <QSemaphore>
+#include <functional>
+
+/** @brief Order in which the test tasks were given a thread */
+struct TaskLog
+{
+    QMutex mutex;
+    QVector<int> order;
+    void add(int id)
+    {
+        QMutexLocker lk(&mutex);
+        order << id;
+    }
+};
+
+class SchedulerTestTask : public AbstractTask
+{
+public:
+    SchedulerTestTask(TaskManager &manager, TaskLog &log, int clipId, JOBTYPE type, std::function<void(AbstractTask *)> work)
+        : AbstractTask(ObjectId(KdenliveObjectType::BinClip, clipId, QUuid()), type, nullptr)
+        , m_manager(manager)
+        , m_log(log)
+        , m_work(std::move(work))
+    {
+    }
+
+    void run() override
+    {
+        // Log before the manager knows the task left the queue, yielding tasks can only resume after this point
+        m_log.add(m_owner.itemId);
+        m_manager.taskStarted(this);
+        m_work(this);
+        m_manager.taskDone(m_owner.itemId, this);
+    }
+
+private:
+    TaskManager &m_manager;
+    TaskLog &m_log;
+    std::function<void(AbstractTask *)> m_work;
+};
+
+TEST_CASE("Tasks are started by priority class", "[TaskManager]")
+{
+    TaskManager manager(nullptr);
+    KdenliveTests::setTaskPoolThreads(manager, 1);
+    TaskLog log;
+    QSemaphore gate;
+    QSemaphore done;
+    auto finish = [&done](AbstractTask *) { done.release(); };
+
+    // Occupy the only thread so that the next tasks are queued
+    manager.startTask(1, new SchedulerTestTask(manager, log, 1, AbstractTask::FILTERCLIPJOB, [&gate, &done](AbstractTask *) {
+                          gate.acquire();
+                          done.release();
+                      }));
+    manager.startTask(2, new SchedulerTestTask(manager, log, 2, AbstractTask::CACHEJOB, finish));
+    manager.startTask(3, new SchedulerTestTask(manager, log, 3, AbstractTask::ANALYSECLIPJOB, finish));
+    manager.startTask(4, new SchedulerTestTask(manager, log, 4, AbstractTask::THUMBJOB, finish));
+    manager.startTask(5, new SchedulerTestTask(manager, log, 5, AbstractTask::THUMBJOB, finish));
+
+    // Pending tasks of the Clip Monitor clip and of the visible timeline clips move to the interactive class
+    manager.prioritizeClip(5);
+    manager.prioritizeVisibleClips({3, 4});
+    // Clip 3 is scrolled out of view and returns to its default class
+    manager.prioritizeVisibleClips({4});
+
+    gate.release();
+    REQUIRE(done.tryAcquire(5, 5000));
+    REQUIRE(log.order == QVector<int>({1, 5, 4, 3, 2}));
+}
+
+TEST_CASE("Concurrency limit of a job type", "[TaskManager]")
+{
+    TaskManager manager(nullptr);
+    KdenliveTests::setTaskPoolThreads(manager, 3);
+    manager.setConcurrencyLimit(AbstractTask::ANALYSECLIPJOB, 1);
+    TaskLog log;
+    QMutex countMutex;
+    int running = 0;
+    int maxRunning = 0;
+    QSemaphore started;
+    QSemaphore gate;
+    QSemaphore done;
+    auto analysis = [&](AbstractTask *) {
+        countMutex.lock();
+        maxRunning = qMax(maxRunning, ++running);
+        countMutex.unlock();
+        started.release();
+        gate.acquire();
+        countMutex.lock();
+        running--;
+        countMutex.unlock();
+        done.release();
+    };
+    for (int cid = 1; cid <= 3; ++cid) {
+        manager.startTask(cid, new SchedulerTestTask(manager, log, cid, AbstractTask::ANALYSECLIPJOB, analysis));
+    }
+    // Other job types still get a thread
+    manager.startTask(4, new SchedulerTestTask(manager, log, 4, AbstractTask::FILTERCLIPJOB, [&done](AbstractTask *) { done.release(); }));
+    REQUIRE(done.tryAcquire(1, 5000));
+    REQUIRE(started.tryAcquire(1, 5000));
+    // The other analysis tasks wait for a slot even though a thread is free
+    REQUIRE_FALSE(started.tryAcquire(1, 200));
+
+    gate.release(3);
+    REQUIRE(done.tryAcquire(3, 5000));
+    REQUIRE(started.available() == 2);
+    REQUIRE(maxRunning == 1);
+}
+
+TEST_CASE("Background task yields its thread to a higher class", "[TaskManager]")
+{
+    TaskManager manager(nullptr);
+    KdenliveTests::setTaskPoolThreads(manager, 1);
+    TaskLog log;
+    QSemaphore bgStarted;
+    QSemaphore bgGo;
+    QSemaphore done;
+    manager.startTask(1, new SchedulerTestTask(manager, log, 1, AbstractTask::CACHEJOB, [&](AbstractTask *task) {
+                          // Nothing is waiting, returns immediately
+                          manager.yieldTask(task);
+                          log.add(-2);
+                          bgStarted.release();
+                          bgGo.acquire();
+                          manager.yieldTask(task);
+                          log.add(-1);
+                          done.release();
+                      }));
+    REQUIRE(bgStarted.tryAcquire(1, 5000));
+    // The only thread is busy, this task is queued
+    manager.startTask(2, new SchedulerTestTask(manager, log, 2, AbstractTask::LOADJOB, [&done](AbstractTask *) { done.release(); }));
+    bgGo.release();
+    REQUIRE(done.tryAcquire(2, 5000));
+    // The background task resumed once the load task was out of the queue
+    REQUIRE(log.order == QVector<int>({1, -2, 2, -1}));
+}
@@ -7,6 +7,7 @@
 #include "bin/projectfolder.h"
 #include "doc/documentchecker.h"
 #include "doc/kdenlivedoc.h"
+#include "jobs/cachetask.h"
 #include "src/assets/keyframes/model/keyframemodel.hpp"
 #include "src/renderpresets/renderpresetrepository.hpp"
 #include "src/utils/thumbnailcache.hpp"
@@ -293,3 +294,13 @@ bool KdenliveTests::effectFilterName(EffectFilter &filter, std::shared_ptr<TreeI
 {
     return filter.filterName(item);
 }
+
+void KdenliveTests::setTaskPoolThreads(TaskManager &manager, int threads)
+{
+    manager.m_taskPool.setMaxThreadCount(threads);
+}
+
+std::map<int, std::vector<int>> KdenliveTests::cacheTaskTargets(const std::vector<int> &frames, const std::vector<int> &keyframes, bool exactFrames)
+{
+    return CacheTask::decodeTargets(frames, keyframes, exactFrames);
+}
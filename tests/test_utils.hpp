@@ -9,6 +9,7 @@
 #include "tests_definitions.h"
 #include <QString>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <random>
 #include <string>
@@ -142,4 +143,6 @@ public:
     static int modelSize(std::shared_ptr<AbstractTreeModel> model);
     static bool effectFilterName(EffectFilter &filter, std::shared_ptr<TreeItem> item);
     static void updateProjectProfile(KdenliveDoc *doc, bool reloadProducers = false) { doc->updateProjectProfile(reloadProducers, false); }
+    static void setTaskPoolThreads(TaskManager &manager, int threads);
+    static std::map<int, std::vector<int>> cacheTaskTargets(const std::vector<int> &frames, const std::vector<int> &keyframes, bool exactFrames);
 };
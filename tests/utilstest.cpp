@@ -6,10 +6,18 @@
 #include "catch.hpp"
 #include "test_utils.hpp"
 // test specific headers
+#include "audiomixer/audiolevelring.hpp"
+#include "utils/filefingerprintcache.hpp"
 #include "utils/gentime.h"
+#include "utils/mediaprobecache.hpp"
 #include "utils/qstringutils.h"
 #include "utils/timecode.h"
 
+#include <QTemporaryDir>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 TEST_CASE("Testing for different utils", "[Utils]")
 {
 
@@ -161,3 +169,152 @@ TEST_CASE("Testing for timecodes", "[Timecodes]")
         REQUIRE(res == QStringLiteral("01:02:03:05"));
     }
 }
+
+TEST_CASE("File fingerprint cache", "[Utils]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString cacheFile = dir.filePath(QStringLiteral("fingerprints.dat"));
+    const QString media = dir.filePath(QStringLiteral("media.bin"));
+    auto writeMedia = [&media](const QByteArray &data) {
+        QFile file(media);
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write(data);
+        file.close();
+    };
+    writeMedia(QByteArray(3000000, 'a'));
+
+    FileFingerprintCache cache(cacheFile);
+    CHECK_FALSE(cache.isCached(media));
+    const QPair<QByteArray, qint64> hash = cache.fingerprint(media);
+    CHECK(hash == FileFingerprintCache::calculateHash(media));
+    CHECK(hash.second == 3000000);
+    CHECK(cache.isCached(media));
+    // Missing files are neither hashed nor cached
+    CHECK(cache.fingerprint(dir.filePath(QStringLiteral("missing.bin"))).first.isEmpty());
+
+    SECTION("Entries are persistent")
+    {
+        REQUIRE(cache.save());
+        FileFingerprintCache other(cacheFile);
+        CHECK(other.isCached(media));
+        CHECK(other.fingerprint(media) == hash);
+    }
+
+    SECTION("Modified files are hashed again")
+    {
+        // Same size, different content and modification time
+        QByteArray data(3000000, 'a');
+        data[10] = 'b';
+        writeMedia(data);
+        QFile file(media);
+        REQUIRE(file.open(QIODevice::ReadWrite));
+        REQUIRE(file.setFileTime(QDateTime::currentDateTime().addSecs(60), QFileDevice::FileModificationTime));
+        file.close();
+        CHECK_FALSE(cache.isCached(media));
+        const QPair<QByteArray, qint64> updated = cache.fingerprint(media);
+        CHECK(updated.first != hash.first);
+        CHECK(updated == FileFingerprintCache::calculateHash(media));
+    }
+
+    SECTION("Prefetch fills the cache")
+    {
+        QStringList files;
+        for (int i = 0; i < 8; ++i) {
+            const QString path = dir.filePath(QStringLiteral("clip%1.bin").arg(i));
+            QFile file(path);
+            REQUIRE(file.open(QIODevice::WriteOnly));
+            file.write(QByteArray(1000 + i, char('a' + i)));
+            file.close();
+            files << path;
+        }
+        cache.prefetch(files);
+        for (const QString &path : std::as_const(files)) {
+            CHECK(cache.isCached(path));
+        }
+    }
+}
+
+TEST_CASE("Media probe cache", "[Utils]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString cacheFile = dir.filePath(QStringLiteral("mediaprobe.dat"));
+    const QString key = MediaProbeCache::key(QByteArray("hash"), 1000, QStringLiteral("25/1"));
+    // The key depends on the probe context
+    CHECK(key != MediaProbeCache::key(QByteArray("hash"), 1000, QStringLiteral("30/1")));
+    const MediaProbeCache::Properties properties = {{"length", "250"}, {"meta.media.nb_streams", "2"}, {"audio_index", "1"}};
+
+    MediaProbeCache cache(cacheFile);
+    MediaProbeCache::Properties result;
+    CHECK_FALSE(cache.lookup(key, result));
+    cache.store(key, properties);
+    REQUIRE(cache.lookup(key, result));
+    CHECK(result == properties);
+    REQUIRE(cache.save());
+
+    MediaProbeCache other(cacheFile);
+    result.clear();
+    REQUIRE(other.lookup(key, result));
+    CHECK(result == properties);
+    other.remove(key);
+    CHECK_FALSE(other.lookup(key, result));
+}
+
+TEST_CASE("Audio level ring", "[Utils]")
+{
+    AudioLevelRing ring(30, 2);
+    REQUIRE(ring.capacity() == 32);
+    QVector<double> levels;
+    CHECK_FALSE(ring.read(0, levels));
+    for (int pos = 0; pos < 40; pos++) {
+        const double values[2] = {double(pos), -double(pos)};
+        ring.push(pos, values);
+    }
+    // The oldest frames were overwritten
+    CHECK_FALSE(ring.read(7, levels));
+    REQUIRE(ring.read(8, levels));
+    CHECK(levels == QVector<double>({8., -8.}));
+    REQUIRE(ring.read(39, levels));
+    CHECK(levels == QVector<double>({39., -39.}));
+    // A frame notified again keeps its first levels
+    const double other[2] = {0., 0.};
+    ring.push(39, other);
+    REQUIRE(ring.read(39, levels));
+    CHECK(levels == QVector<double>({39., -39.}));
+    ring.clear();
+    CHECK_FALSE(ring.read(39, levels));
+    ring.push(39, other);
+    REQUIRE(ring.read(39, levels));
+    CHECK(levels == QVector<double>({0., 0.}));
+
+    SECTION("Levels are never read half written")
+    {
+        AudioLevelRing shared(4, 8);
+        std::atomic<bool> done{false};
+        std::thread writer([&shared, &done]() {
+            double values[8];
+            // Cycle on a few frames, so that the reader finds them while they are overwritten
+            for (int i = 0; i < 200000; i++) {
+                std::fill(std::begin(values), std::end(values), double(i));
+                shared.push(i % 4, values);
+            }
+            done = true;
+        });
+        int reads = 0;
+        int pos = 0;
+        bool consistent = true;
+        while (!done) {
+            if (shared.read(pos, levels)) {
+                reads++;
+                for (double value : std::as_const(levels)) {
+                    consistent = consistent && value == levels.constFirst() && int(value) % 4 == pos;
+                }
+            }
+            pos = (pos + 1) % 4;
+        }
+        writer.join();
+        CHECK(consistent);
+        qDebug() << "Concurrent reads:" << reads;
+    }
+}